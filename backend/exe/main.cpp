@@ -1,7 +1,11 @@
 ﻿#include "server.hpp"
 #include "api.hpp"
 #include "curl.hpp"
+#include "database_writer.hpp"
+#include "event_journal.hpp"
 #include "packet_sender_impl.hpp"
+#include "statistics.hpp"
+#include "trace.hpp"
 #include "packets/packet_parser.hpp"
 
 #include <iostream>
@@ -9,6 +13,10 @@
 #include <unordered_map>
 #include <array>
 #include <fstream>
+#include <map>
+#include <algorithm>
+#include <mutex>
+#include <thread>
 
 #include <sockpp/tcp_acceptor.h>
 
@@ -30,6 +38,19 @@ void log_message(const std::string& message)
 	logfile << std::format("[{:%m/%d/%y %H:%M:%S}] ", time) << message << '\n';
 }
 
+void log_statistics()
+{
+	std::stringstream ss;
+	ss << "[STATS]";
+
+	for (auto&& stats : statistics().data())
+	{
+		ss << '\n' << stats;
+	}
+
+	log_message(ss.str());
+}
+
 inline std::uint32_t read_u32(const std::vector<std::byte>& input, std::size_t index)
 {
 	std::array<std::byte, 4> bytes;
@@ -90,32 +111,155 @@ struct curlpp_ : cURL
 
 /*
 * task-glacier 127.0.0.1 5000 /var/lib/task-glacier.db3
+* 
+* optional settings follow the positional arguments as --name=value
+* 
+* --stats-interval=<seconds>	write the packet statistics to the log file periodically
+* --trace=<file>				write chrome trace events for request handling to the file
+* --commit-window-ms=<ms>		how long database writes are collected before they are committed together (default 5)
+* --commit-window-records=<n>	commit early once this many writes are waiting (default 100)
+* --snapshot=<file>			load from and save the in-memory state to a snapshot file to speed up startup
+* --snapshot-interval=<seconds>	how often the snapshot is saved while connected (default 300). it's also saved when the client disconnects
+* --journal=<directory>		append task changes to an event journal in the directory instead of rewriting the whole task
+* --durability=<profile>		safe, balanced or fast. how much recent work can be lost to a power failure (default balanced)
+* --session-horizon=<days>	sessions of tasks finished longer ago are only loaded when needed (default 0, everything is loaded)
+* --session-cache=<tasks>	how many tasks keep their old sessions in memory after they've been loaded (default 100)
+* --archive-after=<days>	move subtrees finished longer ago to the archive at startup and then every hour (default 0, nothing is archived)
 */
 int main(int argc, char** argv)
 {
-	if (argc < 5)
+	std::vector<std::string> arguments;
+	std::map<std::string, std::string, std::less<>> options;
+
+	for (int i = 1; i < argc; i++)
+	{
+		const std::string_view arg = argv[i];
+
+		if (arg.starts_with("--"))
+		{
+			const auto equals = arg.find('=');
+
+			options[std::string(arg.substr(2, equals - 2))] = equals == std::string_view::npos ? "" : std::string(arg.substr(equals + 1));
+		}
+		else
+		{
+			arguments.emplace_back(arg);
+		}
+	}
+
+	if (arguments.size() < 4)
 	{
-		std::cerr << "task-glacier <ip address> <port> <database> <logfile> <hidden>\n";
+		std::cerr << "task-glacier <ip address> <port> <database> <logfile> <hidden> [--stats-interval=<seconds>] [--trace=<file>] [--commit-window-ms=<ms>] [--commit-window-records=<n>] [--durability=safe|balanced|fast] [--snapshot=<file>] [--snapshot-interval=<seconds>] [--journal=<directory>] [--session-horizon=<days>] [--session-cache=<tasks>] [--archive-after=<days>]\n";
 		return -1;
 	}
 
-	logfile = std::ofstream(argv[4]);
+	logfile = std::ofstream(arguments[3]);
 
 	sockpp::initialize();
 
 	curlpp_ curl;
 	
 
-	const std::string ip_address = argv[1];
+	const std::string ip_address = arguments[0];
 
-	const int port = std::atoi(argv[2]);
+	const int port = std::atoi(arguments[1].c_str());
 
 	std::stringstream arg_output;
-	arg_output << ip_address << ' ' << port << ' ' << argv[3] << ' ' << argv[4] << '\n';
+	arg_output << ip_address << ' ' << port << ' ' << arguments[2] << ' ' << arguments[3] << '\n';
 
 	log_message(arg_output.str());
 
-	bool hidden = argc > 5 && std::string(argv[5]) == "true";
+	bool hidden = arguments.size() > 4 && arguments[4] == "true";
+
+	std::optional<std::chrono::seconds> statsInterval;
+
+	if (auto option = options.find("stats-interval"); option != options.end())
+	{
+		statsInterval = std::chrono::seconds(std::atoi(option->second.c_str()));
+	}
+
+	auto lastStatsDump = std::chrono::steady_clock::now();
+
+	if (auto option = options.find("trace"); option != options.end())
+	{
+		if (!tracer().open(option->second))
+		{
+			log_message("Failed to open trace file " + option->second);
+		}
+	}
+
+	CommitWindow commitWindow;
+
+	if (auto option = options.find("commit-window-ms"); option != options.end())
+	{
+		commitWindow.time = std::chrono::milliseconds(std::atoi(option->second.c_str()));
+	}
+
+	if (auto option = options.find("commit-window-records"); option != options.end())
+	{
+		commitWindow.records = std::max(1, std::atoi(option->second.c_str()));
+	}
+
+	DurabilityProfile durability = DEFAULT_DURABILITY;
+
+	if (auto option = options.find("durability"); option != options.end())
+	{
+		if (option->second == "safe")
+		{
+			durability = DurabilityProfile::SAFE;
+		}
+		else if (option->second == "balanced")
+		{
+			durability = DurabilityProfile::BALANCED;
+		}
+		else if (option->second == "fast")
+		{
+			durability = DurabilityProfile::FAST;
+		}
+		else
+		{
+			log_message("Unknown durability profile " + option->second + ", using balanced");
+		}
+	}
+
+	std::string snapshotFile;
+	std::chrono::seconds snapshotInterval = std::chrono::minutes(5);
+
+	if (auto option = options.find("snapshot"); option != options.end())
+	{
+		snapshotFile = option->second;
+	}
+
+	if (auto option = options.find("snapshot-interval"); option != options.end())
+	{
+		snapshotInterval = std::chrono::seconds(std::atoi(option->second.c_str()));
+	}
+
+	std::string journalDirectory;
+
+	if (auto option = options.find("journal"); option != options.end())
+	{
+		journalDirectory = option->second;
+	}
+
+	SessionHistory sessionHistory;
+
+	if (auto option = options.find("session-horizon"); option != options.end())
+	{
+		sessionHistory.horizon = std::chrono::days(std::max(0, std::atoi(option->second.c_str())));
+	}
+
+	if (auto option = options.find("session-cache"); option != options.end())
+	{
+		sessionHistory.cacheSize = std::max(1, std::atoi(option->second.c_str()));
+	}
+
+	std::chrono::days archiveAfter = std::chrono::days(0);
+
+	if (auto option = options.find("archive-after"); option != options.end())
+	{
+		archiveAfter = std::chrono::days(std::max(0, std::atoi(option->second.c_str())));
+	}
 
 	if (hidden)
 	{
@@ -128,76 +272,161 @@ int main(int argc, char** argv)
 
 	Clock clock;
 
-	// ctrl-c app to kill it
-	while (true)
+	// the same tasks are shared by every connected client
+	PacketSenderImpl sender;
+	DatabaseImpl database(arguments[2], sender, durability);
+	database.snapshot_file(snapshotFile);
+
+	DatabaseWriter writer(database, commitWindow);
+
+	std::optional<EventJournal> journal;
+
+	if (!journalDirectory.empty())
 	{
-		auto connection = acceptor.accept();
+		journal.emplace(writer, journalDirectory);
+	}
 
-		std::cout << "Connected\n";
+	Database& db = journal ? static_cast<Database&>(*journal) : writer;
 
-		logfile << "Connected\n";
+	API api(clock, curl, db, sender, sessionHistory);
+	api.archive_after(archiveAfter);
+	api.archive_finished_tasks();
+	api.m_backup.start();
 
-		auto socket = std::make_unique<sockpp::tcp_socket>(std::move(connection));
+	// requests from all of the clients are handled one at a time
+	std::mutex apiMutex;
 
-		auto sender = PacketSenderImpl{ socket.get() };
-		DatabaseImpl db(argv[3], sender);
+	auto lastSnapshot = std::chrono::steady_clock::now();
+	auto lastArchive = std::chrono::steady_clock::now();
 
-		API api(clock, curl, db, sender);
+	const auto handle_client = [&](sockpp::tcp_socket socket)
+	{
+		ClientQueue queue;
+		sender.add_client(queue);
 
-		while (socket->is_open())
-		{
-			auto now = clock.now();
+		std::thread writeThread(&PacketSenderImpl::write_packets, &sender, socket.clone(), std::ref(queue));
 
-			std::vector<std::byte> input(4);
-			if (socket->read_n(input.data(), 4) == -1)
+		// reused for every request from the client. the strings in request point into input
+		std::vector<std::byte> input;
+		RequestPacket request;
+
+		while (socket.is_open())
+		{
+			input.resize(4);
+			if (socket.read_n(input.data(), 4) == -1)
 			{
 				log_message("Error with socket");
-				log_message(std::to_string(socket->last_error()));
+				log_message(std::to_string(socket.last_error()));
 
 				break;
 			}
 
 			const auto length = read_u32(input, 0);
 
+			// the length includes itself. anything shorter leaves no way to find the next packet
+			if (length < 4)
+			{
+				log_message(std::format("Invalid packet length {}", length));
+
+				break;
+			}
+
 			input.resize(length);
-			if (socket->read_n(input.data() + 4, length - 4) == -1)
+			if (socket.read_n(input.data() + 4, length - 4) == -1)
 			{
 				log_message("Error with socket");
-				log_message(std::to_string(socket->last_error()));
+				log_message(std::to_string(socket.last_error()));
 
 				break;
 			}
 
-			ParseResult result;
-			
-			try
+			std::lock_guard lock(apiMutex);
+
+			sender.set_current(&queue);
+
+			// the client sends strings with the length it negotiated for the ones it receives. only while parsing, the
+			// journal and snapshots always use the same length
+			const auto parsed = [&]
+				{
+					const StringLengthScope scope(string_length(sender.protocol_version()));
+
+					return parse_request(input, api.m_app.timeCategories(), request);
+				}();
+
+			if (!parsed)
 			{
-				result = parse_packet(input, api.m_app.timeCategories());
+				const auto failure = unpack_failure(input, parsed.error());
+
+				log_message(std::format("[RX] {}", failure.message));
+
+				sender.send(failure);
 			}
-			catch (const std::exception& e)
+			else if (const Message* message = request_message(request))
 			{
-				std::cout << e.what() << std::endl;
-				log_message(e.what());
+				std::stringstream ss;
+				ss << "[RX] " << *message;
+
+				log_message(ss.str());
+
+				statistics().record_bytes_in(message->packetType(), input.size());
+
+				api.process_packet(request);
 			}
-			catch (...)
+
+			sender.set_current(nullptr);
+
+			// only checked between packets. an idle connection has nothing new to report
+			if (statsInterval && std::chrono::steady_clock::now() - lastStatsDump >= statsInterval.value())
 			{
-				std::cout << "parse_packet failed with unknown exception" << std::endl;
-				log_message("parse_packet failed with unknown exception");
+				log_statistics();
+
+				lastStatsDump = std::chrono::steady_clock::now();
 			}
 
-			if (result.packet)
+			if (!snapshotFile.empty() && std::chrono::steady_clock::now() - lastSnapshot >= snapshotInterval)
 			{
-				std::stringstream ss;
-				ss << "[RX] " << *result.packet;
+				db.write_snapshot(api.m_app, api.m_bugzilla, sender);
 
-				log_message(ss.str());
+				lastSnapshot = std::chrono::steady_clock::now();
+			}
+
+			// subscribed clients are told about the archived subtrees, whichever of them sent the last packet
+			if (std::chrono::steady_clock::now() - lastArchive >= std::chrono::hours(1))
+			{
+				api.archive_finished_tasks();
 
-				api.process_packet(*result.packet);
+				lastArchive = std::chrono::steady_clock::now();
 			}
 		}
 
+		sender.remove_client(queue);
+		queue.close();
+		writeThread.join();
+
+		std::lock_guard lock(apiMutex);
+
+		// everything the client changed is on disk when it disconnects
+		if (journal)
+		{
+			journal->compact(sender);
+		}
+		db.flush(sender);
+		db.write_snapshot(api.m_app, api.m_bugzilla, sender);
+
 		std::cout << "Disconnected\n";
 
 		logfile << "Disconnected\n";
+	};
+
+	// ctrl-c app to kill it
+	while (true)
+	{
+		auto connection = acceptor.accept();
+
+		std::cout << "Connected\n";
+
+		logfile << "Connected\n";
+
+		std::thread(handle_client, std::move(connection)).detach();
 	}
 }
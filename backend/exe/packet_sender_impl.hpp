@@ -6,24 +6,52 @@
 
 #include <iostream>
 #include <fstream>
+#include <mutex>
 
 extern std::ofstream logfile;
 
-struct PacketSenderImpl : PacketSender
+struct PacketSenderImpl : Broadcaster
 {
-	sockpp::tcp_socket* socket;
+	// messages are logged by whichever thread sends them and written by one thread per client
+	std::mutex mutex;
 
-	PacketSenderImpl(sockpp::tcp_socket* socket) : socket(socket) {}
+	// writes everything queued for the client to its socket, until the queue is closed. the send is recorded when it's
+	// queued, this thread doesn't know which request it was for
+	void write_packets(sockpp::tcp_socket socket, ClientQueue& queue)
+	{
+		while (const Frame frame = queue.pop())
+		{
+			if (frame.chunk)
+			{
+				socket.write_n(frame.header().data(), frame.header().size());
+			}
+			socket.write_n(frame.payload().data(), frame.payload().size());
+		}
+
+		// the client stopped reading, shutting the socket down ends the read loop on the other thread as well
+		if (queue.overflowed())
+		{
+			{
+				std::lock_guard lock(mutex);
+
+				std::cout << "Client fell too far behind, disconnecting\n";
+
+				logfile << "Client fell too far behind, disconnecting\n";
+			}
+
+			socket.shutdown();
+		}
+	}
 
-	void send(std::unique_ptr<Message> message) override
+protected:
+	void packed(const Message& message, const SharedPacket& packet) override
 	{
-		auto time = std::chrono::system_clock::now();
+		std::lock_guard lock(mutex);
 
-		std::cout << std::format("[{:%m/%d/%y %H:%M:%S}]", time) << " [TX] " << *message << '\n';
+		auto time = std::chrono::system_clock::now();
 
-		logfile << std::format("[{:%m/%d/%y %H:%M:%S}]", time) << " [TX] " << *message << '\n';
+		std::cout << std::format("[{:%m/%d/%y %H:%M:%S}]", time) << " [TX] " << message << '\n';
 
-		const auto output = message->pack();
-		socket->write_n(output.data(), output.size());
+		logfile << std::format("[{:%m/%d/%y %H:%M:%S}]", time) << " [TX] " << message << '\n';
 	}
 };
@@ -8,304 +8,378 @@
 #include "packets/time_entry.hpp"
 #include "packets/weekly_report.hpp"
 #include "packets/time_entry_data_packet.hpp"
+#include "packets/protocol_version.hpp"
 
 #include <iostream>
+#include <unordered_set>
 
 #include "packets/update_task_times.hpp"
 #include "packets/version.hpp"
+#include "packets/stats.hpp"
+#include "packets/sync_position.hpp"
+
+#include "statistics.hpp"
+#include "trace.hpp"
+
+template<typename T>
+void API::process(const T& message)
+{
+	RequestTimer timer(message.packetType());
+	TG_TRACE_SPAN(magic_enum::enum_name(message.packetType()), "api");
+
+	// the temporary containers of the request are released together once it's done
+	RequestArena::Scope scratch(m_app.scratch());
+
+	// sessions loaded by the previous request are no longer referenced
+	m_app.evict_sessions();
+
+	handle(message);
+
+	m_app.release_kept_sessions();
+}
+
+void API::process_packet(const RequestPacket& packet)
+{
+	std::visit([this]<typename T>(const T& message)
+		{
+			if constexpr (!std::same_as<T, std::monostate>)
+			{
+				process(message);
+			}
+		}, packet);
+}
 
 void API::process_packet(const Message& message)
 {
+	// the packet type says which message it is
 	switch (message.packetType())
 	{
-	case PacketType::VERSION_REQUEST:
-		m_sender->send(std::make_unique<VersionMessage>("0.14.1"));
+		using enum PacketType;
+
+	case VERSION_REQUEST:
+	case REQUEST_CONFIGURATION:
+	case REQUEST_CONFIGURATION_WITHOUT_TASKS:
+	case REQUEST_TIME_ENTRY:
+	case BULK_TASK_UPDATE_START:
+	case BULK_TASK_UPDATE_FINISH:
+		process(static_cast<const BasicMessage&>(message));
 		break;
-	case PacketType::CREATE_TASK:
-		create_task(static_cast<const CreateTaskMessage&>(message));
+	case BUGZILLA_REFRESH:
+	case REQUEST_STATS:
+	case DATABASE_FLUSH:
+	case ENABLE_TASK_INFO_DELTA:
+		process(static_cast<const RequestMessage&>(message));
 		break;
-	case PacketType::START_TASK:
-	case PacketType::START_UNSPECIFIED_TASK:
-		start_task(static_cast<const TaskMessage&>(message));
+	case CREATE_TASK:
+		process(CreateTaskView(static_cast<const CreateTaskMessage&>(message)));
 		break;
-	case PacketType::STOP_TASK:
-		stop_task(static_cast<const TaskMessage&>(message));
+	case START_TASK:
+	case START_UNSPECIFIED_TASK:
+	case STOP_TASK:
+	case STOP_UNSPECIFIED_TASK:
+	case FINISH_TASK:
+	case REQUEST_TASK:
+	case REQUEST_ARCHIVED_TASKS:
+	case SUBSCRIBE_TASKS:
+	case UNSUBSCRIBE_TASKS:
+		process(static_cast<const TaskMessage&>(message));
 		break;
-	case PacketType::STOP_UNSPECIFIED_TASK:
-		stop_unspecified_task(static_cast<const TaskMessage&>(message));
+	case UPDATE_TASK:
+		process(UpdateTaskView(static_cast<const UpdateTaskMessage&>(message)));
 		break;
-	case PacketType::FINISH_TASK:
-		finish_task(static_cast<const TaskMessage&>(message));
+	case ADD_TASK_SESSION:
+	case EDIT_TASK_SESSION:
+	case REMOVE_TASK_SESSION:
+		process(static_cast<const UpdateTaskTimesMessage&>(message));
 		break;
-	case PacketType::UPDATE_TASK:
-		update_task(static_cast<const UpdateTaskMessage&>(message));
+	case REQUEST_DAILY_REPORT:
+		process(static_cast<const RequestDailyReportMessage&>(message));
 		break;
-	case PacketType::ADD_TASK_SESSION:
-	{
-		const auto& update = static_cast<const UpdateTaskTimesMessage&>(message);
+	case REQUEST_WEEKLY_REPORT:
+		process(static_cast<const RequestWeeklyReportMessage&>(message));
+		break;
+	case TIME_ENTRY_MODIFY:
+		process(TimeEntryModifyView(static_cast<const TimeEntryModifyPacket&>(message)));
+		break;
+	case BACKUP_CONFIGURATION:
+		process(static_cast<const BackupConfigurationMessage&>(message));
+		break;
+	case BUGZILLA_INFO:
+		process(BugzillaInfoView(static_cast<const BugzillaInfoMessage&>(message)));
+		break;
+	case REQUEST_TASKS:
+		process(static_cast<const RequestTasksMessage&>(message));
+		break;
+	case REQUEST_RESYNC:
+		process(static_cast<const RequestResyncMessage&>(message));
+		break;
+	case REQUEST_PROTOCOL_VERSION:
+		process(static_cast<const RequestProtocolVersionMessage&>(message));
+		break;
+	default:
+		break;
+	}
+}
 
-		auto* task = m_app.find_task(update.taskID);
+void API::handle(const RequestMessage& message)
+{
+	switch (message.packetType())
+	{
+	case PacketType::ENABLE_TASK_INFO_DELTA:
+		m_sender->enable_deltas();
+		m_sender->send(SuccessResponse(message.origin()));
+		break;
+	case PacketType::BUGZILLA_REFRESH:
+		m_bugzilla.perform_refresh(message, m_app, *this, *m_database);
+		break;
+	case PacketType::REQUEST_STATS:
+	{
+		auto stats = std::make_unique<StatsMessage>(message.origin());
+		stats->packets = statistics().data();
 
-		if (!task)
-		{
-			m_sender->send(std::make_unique<FailureResponse>(update.origin(), std::format("Task with ID {} does not exist.", update.taskID)));
-			break;
-		}
+		m_sender->send(std::move(stats));
 
-		if (!update.stop.has_value())
-		{
-			m_sender->send(std::make_unique<FailureResponse>(update.origin(), "New session must have a stop time."));
-			break;
-		}
+		break;
+	}
+	case PacketType::DATABASE_FLUSH:
+		m_database->flush(*m_sender);
 
-		if (update.stop.has_value() && update.stop <= update.start)
-		{
-			m_sender->send(std::make_unique<FailureResponse>(update.origin(), "Stop time cannot be before start time."));
-			break;
-		}
+		m_sender->send(SuccessResponse(message.origin()));
 
-		const Task* overlap_task = nullptr;
-		const TaskTimes* overlap_time = nullptr;
+		break;
+	default:
+		break;
+	}
+}
 
-		const auto detect = [update, &overlap_task, &overlap_time](const Task& task)
-		{
-			if (overlap_task)
-			{
-				return;
-			}
+void API::handle(const TaskMessage& message)
+{
+	switch (message.packetType())
+	{
+	case PacketType::START_TASK:
+	case PacketType::START_UNSPECIFIED_TASK:
+		start_task(message);
+		break;
+	case PacketType::STOP_TASK:
+		stop_task(message);
+		break;
+	case PacketType::STOP_UNSPECIFIED_TASK:
+		stop_unspecified_task(message);
+		break;
+	case PacketType::FINISH_TASK:
+		finish_task(message);
+		break;
+	case PacketType::REQUEST_TASK:
+		request_task(message);
+		break;
+	case PacketType::REQUEST_ARCHIVED_TASKS:
+		request_archived_tasks(message);
+		break;
+	case PacketType::SUBSCRIBE_TASKS:
+	case PacketType::UNSUBSCRIBE_TASKS:
+		subscribe(message);
+		break;
+	default:
+		break;
+	}
+}
 
-			for (const TaskTimes& times : task.m_times)
-			{
-				bool overlap_detected = false;
+void API::handle(const UpdateTaskTimesMessage& message)
+{
+	switch (message.packetType())
+	{
+	case PacketType::ADD_TASK_SESSION:
+		add_session(message);
+		break;
+	case PacketType::EDIT_TASK_SESSION:
+		edit_session(message);
+		break;
+	case PacketType::REMOVE_TASK_SESSION:
+		remove_session(message);
+		break;
+	default:
+		break;
+	}
+}
 
-				if (update.start >= times.start && (!times.stop.has_value() || update.start <= times.stop.value()))
-				{
-					overlap_detected = true;
-				}
-				else if (times.start >= update.start && times.start <= update.stop.value())
-				{
-					overlap_detected = true;
-				}
-				else if (update.stop.value() >= times.start && update.stop.value() <= times.stop.value())
-				{
-					overlap_detected = true;
-				}
+void API::handle(const RequestDailyReportMessage& message)
+{
+	auto report = create_daily_report(message.origin(), message.month, message.day, message.year);
 
-				if (overlap_detected)
-				{
-					overlap_task = &task;
-					overlap_time = &times;
-					break;
-				}
-			}
-		};
+	m_sender->send(std::make_unique<DailyReportMessage>(report));
+}
 
-		m_app.for_each_task_sorted(detect);
+void API::handle(const RequestWeeklyReportMessage& message)
+{
+	create_weekly_report(message.origin(), message.month, message.day, message.year);
+}
 
-		if (overlap_task)
-		{
-			m_sender->send(std::make_unique<FailureResponse>(update.origin(), std::format("Overlap detected with '{}'.", overlap_task->m_name)));
-			break;
-		}
+void API::handle(const BugzillaInfoView& message)
+{
+	m_bugzilla.receive_info(message, m_app, *this, *m_database);
+}
 
-		if (update.checkForOverlaps)
-		{
-			m_sender->send(std::make_unique<SuccessResponse>(update.origin()));
-		}
-		else
-		{
-			task->m_times.push_back(TaskTimes{ update.start, update.stop });
+void API::handle(const RequestProtocolVersionMessage& message)
+{
+	// use the newest version both sides understand
+	const std::int32_t version = std::clamp(message.version, 1, CURRENT_PROTOCOL_VERSION);
 
-			m_app.fill_session_time_entry(*task, task->m_times.back());
+	m_sender->set_protocol_version(version);
+	m_sender->send(SuccessResponse(message.origin()));
+	m_sender->send(std::make_unique<ProtocolVersionMessage>(version));
+}
 
-			std::sort(task->m_times.begin(), task->m_times.end());
+void API::add_session(const UpdateTaskTimesMessage& update)
+{
+	auto* task = m_app.find_task(update.taskID);
 
-			m_database->write_task(*task, *m_sender);
+	if (!task)
+	{
+		m_sender->send(FailureResponse(update.origin(), std::format("Task with ID {} does not exist.", update.taskID)));
+		return;
+	}
 
-			m_sender->send(std::make_unique<SuccessResponse>(update.origin()));
-			send_task_info(*task, false);
-		}
-		break;
+	if (!update.stop.has_value())
+	{
+		m_sender->send(FailureResponse(update.origin(), "New session must have a stop time."));
+		return;
 	}
-	case PacketType::EDIT_TASK_SESSION:
+
+	if (update.stop.has_value() && update.stop <= update.start)
 	{
-		const auto& update = static_cast<const UpdateTaskTimesMessage&>(message);
+		m_sender->send(FailureResponse(update.origin(), "Stop time cannot be before start time."));
+		return;
+	}
 
-		auto* task = m_app.find_task(update.taskID);
+	m_app.keep_sessions(*task);
+	m_app.load_sessions_between(update.start, update.stop.value());
 
-		if (!task)
-		{
-			m_sender->send(std::make_unique<FailureResponse>(update.origin(), std::format("Task with ID {} does not exist.", update.taskID)));
-			break;
-		}
+	const Task* overlap_task = m_app.find_overlapping_session(update.start, update.stop.value());
 
-		if (update.sessionIndex >= task->m_times.size())
-		{
-			m_sender->send(std::make_unique<FailureResponse>(update.origin(), "Invalid session index."));
-			break;
-		}
+	if (overlap_task)
+	{
+		m_sender->send(FailureResponse(update.origin(), std::format("Overlap detected with '{}'.", overlap_task->m_name)));
+		return;
+	}
 
-		if (update.stop.has_value() && update.stop <= update.start)
-		{
-			m_sender->send(std::make_unique<FailureResponse>(update.origin(), "Stop time cannot be before start time."));
-			break;
-		}
+	if (update.checkForOverlaps)
+	{
+		m_sender->send(SuccessResponse(update.origin()));
+	}
+	else
+	{
+		task->m_times.push_back(TaskTimes{ update.start, update.stop });
 
-		TaskTimes& times = task->m_times.at(update.sessionIndex);
+		m_app.fill_session_time_entry(*task, task->m_times.back());
 
-		if (times.stop.has_value() && !update.stop.has_value())
-		{
-			m_sender->send(std::make_unique<FailureResponse>(update.origin(), "Cannot remove stop time."));
-			break;
-		}
-		else if (!times.stop.has_value() && update.stop.has_value())
-		{
-			m_sender->send(std::make_unique<FailureResponse>(update.origin(), "Cannot add stop time."));
-			break;
-		}
+		std::sort(task->m_times.begin(), task->m_times.end());
 
-		const Task* overlap_task = nullptr;
-		const TaskTimes* overlap_time = nullptr;
+		m_app.task_sessions_changed(*task);
 
-		const auto detect = [task, update, &overlap_task, &overlap_time](const Task& other_task)
-		{
-			if (task == &other_task)
-			{
-				return;
-			}
-			if (overlap_task)
-			{
-				return;
-			}
+		m_database->write_task(*task, *m_sender);
 
-			for (const TaskTimes& times : other_task.m_times)
-			{
-				bool overlap_detected = false;
+		m_sender->send(SuccessResponse(update.origin()));
+		broadcast_task_info(*task, false);
+	}
+}
 
-				if (update.start >= times.start && (!times.stop.has_value() || update.start <= times.stop.value()))
-				{
-					overlap_detected = true;
-				}
-				else if (times.start >= update.start && times.start <= update.stop.value())
-				{
-					overlap_detected = true;
-				}
-				else if (update.stop.has_value() && times.stop.has_value() && update.stop.value() >= times.start && update.stop.value() <= times.stop.value())
-				{
-					overlap_detected = true;
-				}
+void API::edit_session(const UpdateTaskTimesMessage& update)
+{
+	auto* task = m_app.find_task(update.taskID);
 
-				if (overlap_detected)
-				{
-					overlap_task = &other_task;
-					overlap_time = &times;
-					break;
-				}
-			}
-		};
+	if (!task)
+	{
+		m_sender->send(FailureResponse(update.origin(), std::format("Task with ID {} does not exist.", update.taskID)));
+		return;
+	}
 
-		m_app.for_each_task_sorted(detect);
+	m_app.keep_sessions(*task);
 
-		if (overlap_task)
-		{
-			m_sender->send(std::make_unique<FailureResponse>(update.origin(), std::format("Overlap detected with '{}'.", overlap_task->m_name)));
-			break;
-		}
+	if (update.sessionIndex >= task->m_times.size())
+	{
+		m_sender->send(FailureResponse(update.origin(), "Invalid session index."));
+		return;
+	}
 
-		if (update.checkForOverlaps)
-		{
-			m_sender->send(std::make_unique<SuccessResponse>(update.origin()));
-		}
-		else
-		{
-			times.start = update.start;
-			times.stop = update.stop;
+	if (update.stop.has_value() && update.stop <= update.start)
+	{
+		m_sender->send(FailureResponse(update.origin(), "Stop time cannot be before start time."));
+		return;
+	}
 
-			m_database->write_task(*task, *m_sender);
+	TaskTimes& times = task->m_times.at(update.sessionIndex);
 
-			m_sender->send(std::make_unique<SuccessResponse>(update.origin()));
-			send_task_info(*task, false);
-		}
-		break;
+	if (times.stop.has_value() && !update.stop.has_value())
+	{
+		m_sender->send(FailureResponse(update.origin(), "Cannot remove stop time."));
+		return;
 	}
-	case PacketType::REMOVE_TASK_SESSION:
+	else if (!times.stop.has_value() && update.stop.has_value())
 	{
-		const auto& update = static_cast<const UpdateTaskTimesMessage&>(message);
+		m_sender->send(FailureResponse(update.origin(), "Cannot add stop time."));
+		return;
+	}
 
-		auto* task = m_app.find_task(update.taskID);
+	m_app.load_sessions_between(update.start, update.stop.value_or(std::chrono::milliseconds::max()));
 
-		if (!task)
-		{
-			m_sender->send(std::make_unique<FailureResponse>(update.origin(), std::format("Task with ID {} does not exist.", update.taskID)));
-			break;
-		}
+	// the task's own sessions can't overlap the one being edited
+	const Task* overlap_task = m_app.find_overlapping_session(update.start, update.stop.value_or(std::chrono::milliseconds::max()), task);
 
-		if (update.sessionIndex >= static_cast<std::int32_t>(task->m_times.size()))
-		{
-			m_sender->send(std::make_unique<FailureResponse>(update.origin(), "Invalid session index."));
-			break;
-		}
+	if (overlap_task)
+	{
+		m_sender->send(FailureResponse(update.origin(), std::format("Overlap detected with '{}'.", overlap_task->m_name)));
+		return;
+	}
 
-		task->m_times.erase(task->m_times.begin() + update.sessionIndex);
+	if (update.checkForOverlaps)
+	{
+		m_sender->send(SuccessResponse(update.origin()));
+	}
+	else
+	{
+		times.start = update.start;
+		times.stop = update.stop;
 
-		m_database->remove_sessions(task->taskID(), *m_sender);
+		m_app.session_changed(*task, update.sessionIndex);
 
 		m_database->write_task(*task, *m_sender);
 
-		m_sender->send(std::make_unique<SuccessResponse>(update.origin()));
-		send_task_info(*task, false);
-
-		break;
+		m_sender->send(SuccessResponse(update.origin()));
+		broadcast_task_info(*task, false);
 	}
-	case PacketType::REQUEST_TASK:
-		request_task(static_cast<const TaskMessage&>(message));
-		break;
-	case PacketType::REQUEST_CONFIGURATION:
-	case PacketType::BULK_TASK_UPDATE_START:
-	case PacketType::BULK_TASK_UPDATE_FINISH:
-	case PacketType::REQUEST_TIME_ENTRY:
-		handle_basic(static_cast<const BasicMessage&>(message));
-		break;
-	case PacketType::REQUEST_DAILY_REPORT:
-	{
-		const auto& request = static_cast<const RequestDailyReportMessage&>(message);
-
-		auto report = create_daily_report(request.origin(), request.month, request.day, request.year);
+}
 
-		m_sender->send(std::make_unique<DailyReportMessage>(report));
+void API::remove_session(const UpdateTaskTimesMessage& update)
+{
+	auto* task = m_app.find_task(update.taskID);
 
-		break;
-	}
-	case PacketType::REQUEST_WEEKLY_REPORT:
+	if (!task)
 	{
-		const auto& request = static_cast<const RequestWeeklyReportMessage&>(message);
-
-		create_weekly_report(request.origin(), request.month, request.day, request.year);
-		break;
+		m_sender->send(FailureResponse(update.origin(), std::format("Task with ID {} does not exist.", update.taskID)));
+		return;
 	}
-	case PacketType::TIME_ENTRY_MODIFY:
-		time_entry_modify(static_cast<const TimeEntryModifyPacket&>(message));
-		break;
-	case PacketType::BUGZILLA_INFO:
-	{
-		const auto& info = static_cast<const BugzillaInfoMessage&>(message);
 
-		m_bugzilla.receive_info(info, m_app, *this, *m_database);
+	m_app.keep_sessions(*task);
 
-		break;
-	}
-	case PacketType::BUGZILLA_REFRESH:
+	if (update.sessionIndex >= static_cast<std::int32_t>(task->m_times.size()))
 	{
-		const auto& request = static_cast<const RequestMessage&>(message);
+		m_sender->send(FailureResponse(update.origin(), "Invalid session index."));
+		return;
+	}
 
-		m_bugzilla.perform_refresh(request, m_app, *this, *m_database);
+	task->m_times.erase(task->m_times.begin() + update.sessionIndex);
 
-		break;
-	}
-	}
+	m_app.task_sessions_changed(*task);
+
+	m_database->remove_sessions(task->taskID(), *m_sender);
+
+	m_database->write_task(*task, *m_sender);
+
+	m_sender->send(SuccessResponse(update.origin()));
+	broadcast_task_info(*task, false);
 }
 
-void API::create_task(const CreateTaskMessage& message)
+void API::create_task(const CreateTaskView& message)
 {
 	const auto result = m_app.create_task(message.name, message.parentID);
 
@@ -315,13 +389,13 @@ void API::create_task(const CreateTaskMessage& message)
 
 		m_app.configure_task_time_entry(task->taskID(), message.timeEntry); 
 
-		m_sender->send(std::make_unique<SuccessResponse>(message.origin()));
+		m_sender->send(SuccessResponse(message.origin()));
 
-		send_task_info(*task, true);
+		broadcast_task_info(*task, true);
 	}
 	else
 	{
-		m_sender->send(std::make_unique<FailureResponse>(message.origin(), result.error()));
+		m_sender->send(FailureResponse(message.origin(), result.error()));
 	}
 }
 
@@ -340,7 +414,7 @@ void API::start_task(const TaskMessage& message)
 		{
 			failure = std::format("Cannot start task with ID {}. Unspecified task is active.", message.taskID);
 		}
-		m_sender->send(std::make_unique<FailureResponse>(message.origin(), failure));
+		m_sender->send(FailureResponse(message.origin(), failure));
 
 		return;
 	}
@@ -349,15 +423,15 @@ void API::start_task(const TaskMessage& message)
 
 	if (result)
 	{
-		m_sender->send(std::make_unique<FailureResponse>(message.origin(), result.value()));
+		m_sender->send(FailureResponse(message.origin(), result.value()));
 	}
 	else
 	{
-		m_sender->send(std::make_unique<SuccessResponse>(message.origin()));
+		m_sender->send(SuccessResponse(message.origin()));
 
 		if (currentActiveTask)
 		{
-			send_task_info(*currentActiveTask, false);
+			broadcast_task_info(*currentActiveTask, false);
 		}
 
 		auto* task = m_app.find_task(message.taskID);
@@ -365,11 +439,11 @@ void API::start_task(const TaskMessage& message)
 		// don't send the unspecified task
 		if (task->taskID() != UNSPECIFIED_TASK)
 		{
-			send_task_info(*task, false);
+			broadcast_task_info(*task, false);
 		}
 		else
 		{
-			m_sender->send(std::make_unique<BasicMessage>(PacketType::UNSPECIFIED_TASK_ACTIVE));
+			m_sender->broadcast(std::make_unique<BasicMessage>(PacketType::UNSPECIFIED_TASK_ACTIVE), {});
 		}
 	}
 }
@@ -378,7 +452,7 @@ void API::stop_task(const TaskMessage& message)
 {
 	if (message.taskID == UNSPECIFIED_TASK)
 	{
-		m_sender->send(std::make_unique<FailureResponse>(message.origin(), "Unspecified task cannot be stopped."));
+		m_sender->send(FailureResponse(message.origin(), "Unspecified task cannot be stopped."));
 
 		return;
 	}
@@ -387,15 +461,15 @@ void API::stop_task(const TaskMessage& message)
 
 	if (result)
 	{
-		m_sender->send(std::make_unique<FailureResponse>(message.origin(), result.value()));
+		m_sender->send(FailureResponse(message.origin(), result.value()));
 	}
 	else
 	{
-		m_sender->send(std::make_unique<SuccessResponse>(message.origin()));
+		m_sender->send(SuccessResponse(message.origin()));
 
 		auto* task = m_app.find_task(message.taskID);
 
-		send_task_info(*task, false);
+		broadcast_task_info(*task, false);
 	}
 }
 
@@ -403,14 +477,14 @@ void API::stop_unspecified_task(const TaskMessage& message)
 {
 	if (message.packetType() == PacketType::STOP_TASK)
 	{
-		m_sender->send(std::make_unique<FailureResponse>(message.origin(), "Unspecified task cannot be stopped."));
+		m_sender->send(FailureResponse(message.origin(), "Unspecified task cannot be stopped."));
 
 		return;
 	}
 
 	if (m_app.find_task(message.taskID) == nullptr)
 	{
-		m_sender->send(std::make_unique<FailureResponse>(message.origin(), std::format("Task with ID {} does not exist.", message.taskID)));
+		m_sender->send(FailureResponse(message.origin(), std::format("Task with ID {} does not exist.", message.taskID)));
 
 		return;
 	}
@@ -428,15 +502,15 @@ void API::stop_unspecified_task(const TaskMessage& message)
 
 	if (result)
 	{
-		m_sender->send(std::make_unique<FailureResponse>(message.origin(), result.value()));
+		m_sender->send(FailureResponse(message.origin(), result.value()));
 	}
 	else
 	{
-		m_sender->send(std::make_unique<SuccessResponse>(message.origin()));
+		m_sender->send(SuccessResponse(message.origin()));
 
 		auto* task = m_app.find_task(message.taskID);
 
-		send_task_info(*task, false);
+		broadcast_task_info(*task, false);
 	}
 }
 
@@ -444,7 +518,7 @@ void API::finish_task(const TaskMessage& message)
 {
 	if (message.taskID == UNSPECIFIED_TASK && message.packetType() == PacketType::FINISH_TASK)
 	{
-		m_sender->send(std::make_unique<FailureResponse>(message.origin(), "Unspecified task cannot be finished."));
+		m_sender->send(FailureResponse(message.origin(), "Unspecified task cannot be finished."));
 
 		return;
 	}
@@ -453,25 +527,25 @@ void API::finish_task(const TaskMessage& message)
 
 	if (result)
 	{
-		m_sender->send(std::make_unique<FailureResponse>(message.origin(), result.value()));
+		m_sender->send(FailureResponse(message.origin(), result.value()));
 	}
 	else
 	{
-		m_sender->send(std::make_unique<SuccessResponse>(message.origin()));
+		m_sender->send(SuccessResponse(message.origin()));
 
 		auto* task = m_app.find_task(message.taskID);
 
-		send_task_info(*task, false);
+		broadcast_task_info(*task, false);
 	}
 }
 
-void API::update_task(const UpdateTaskMessage& message)
+void API::update_task(const UpdateTaskView& message)
 {
 	auto* task = m_app.find_task(message.taskID);
 
 	if (!task)
 	{
-		m_sender->send(std::make_unique<FailureResponse>(message.origin(), std::format("Task with ID {} does not exist.", message.taskID)));
+		m_sender->send(FailureResponse(message.origin(), std::format("Task with ID {} does not exist.", message.taskID)));
 
 		return;
 	}
@@ -483,6 +557,8 @@ void API::update_task(const UpdateTaskMessage& message)
 	task->locked = message.locked;
 	task->indexInParent = message.indexInParent;
 
+	m_app.task_changed(*task);
+
 	std::optional<std::string> result;
 
 	if (message.name != task->m_name)
@@ -500,6 +576,8 @@ void API::update_task(const UpdateTaskMessage& message)
 			task->state = message.state;
 			task->m_finishTime = std::nullopt;
 
+			m_app.task_changed(*task);
+
 			m_database->write_task(*task, *m_sender);
 		}
 		else
@@ -509,21 +587,21 @@ void API::update_task(const UpdateTaskMessage& message)
 	}
 	else // assume time entry changed
 	{
-		task->timeEntry = message.timeEntry;
+		task->timeEntry.assign(message.timeEntry.begin(), message.timeEntry.end());
 
 		m_database->write_task(*task, *m_sender);
 	}
 	
 	if (result)
 	{
-		m_sender->send(std::make_unique<FailureResponse>(message.origin(), result.value()));
+		m_sender->send(FailureResponse(message.origin(), result.value()));
 	}
 	else
 	{
 		if (indexChanged)
 		{
 			// find all tasks for the parent and fix the index values, keeping the current task as is
-			std::vector<Task*> children = m_app.find_tasks_with_parent(task->parentID());
+			std::pmr::vector<Task*> children = m_app.find_tasks_with_parent(task->parentID());
 			std::sort(children.begin(), children.end(), [&](Task* a, Task* b) { 
 				if (a->indexInParent == b->indexInParent)
 				{
@@ -540,9 +618,12 @@ void API::update_task(const UpdateTaskMessage& message)
 				if (child->indexInParent != expectedIndex)
 				{
 					child->indexInParent = expectedIndex;
+
+					m_app.task_changed(*child);
+
 					if (!m_app.is_bulk_update())
 					{
-						send_task_info(*child, false);
+						broadcast_task_info(*child, false);
 					}
 					else
 					{
@@ -554,11 +635,11 @@ void API::update_task(const UpdateTaskMessage& message)
 			}
 		}
 
-		m_sender->send(std::make_unique<SuccessResponse>(message.origin()));
+		m_sender->send(SuccessResponse(message.origin()));
 
 		if (!m_app.is_bulk_update())
 		{
-			send_task_info(*task, false);
+			broadcast_task_info(*task, false);
 		}
 		else
 		{
@@ -573,43 +654,284 @@ void API::request_task(const TaskMessage& message)
 
 	if (task)
 	{
-		m_sender->send(std::make_unique<SuccessResponse>(message.origin()));
+		m_sender->send(SuccessResponse(message.origin()));
 
 		send_task_info(*task, false);
 	}
 	else
 	{
-		m_sender->send(std::make_unique<FailureResponse>(message.origin(), std::format("Task with ID {} does not exist.", message.taskID)));
+		m_sender->send(FailureResponse(message.origin(), std::format("Task with ID {} does not exist.", message.taskID)));
 	}
 }
 
-void API::handle_basic(const BasicMessage& message)
+void API::request_archived_tasks(const TaskMessage& message)
 {
-	if (message.packetType() == PacketType::REQUEST_CONFIGURATION)
+	const auto tasks = m_database->load_archived_tasks(message.taskID, m_app.timeCategories(), *m_sender);
+
+	if (tasks.empty() && message.taskID != NO_PARENT && !m_app.find_task(message.taskID))
 	{
-		TimeEntryDataPacket data({});
+		m_sender->send(FailureResponse(message.origin(), std::format("Task with ID {} does not exist.", message.taskID)));
+		return;
+	}
 
-		auto& time_categories = m_app.timeCategories();
-		
-		for (auto&& category : time_categories.categories)
+	m_sender->send(SuccessResponse(message.origin()));
+
+	m_sender->send(std::make_unique<BasicMessage>(PacketType::ARCHIVED_TASK_INFO_START));
+
+	for (const Task& task : tasks)
+	{
+		send_task_info(task, false);
+	}
+
+	m_sender->send(std::make_unique<BasicMessage>(PacketType::ARCHIVED_TASK_INFO_FINISH));
+}
+
+void API::request_tasks(const RequestTasksMessage& message)
+{
+	if (message.parentID != NO_PARENT && !m_app.find_task(message.parentID))
+	{
+		m_sender->send(FailureResponse(message.origin(), std::format("Task with ID {} does not exist.", message.parentID)));
+		return;
+	}
+
+	const auto include = [&](TaskID id)
 		{
-			TimeCategory packet = TimeCategory(category.id, category.name);
+			return !message.unfinishedOnly || m_app.task_record(id)->state != TaskState::FINISHED;
+		};
+
+	// answered from the children index, only the requested part of the tree is visited
+	std::pmr::vector<TaskID> matches(m_app.scratch().resource());
+	std::pmr::vector<TaskID> parents({ message.parentID }, m_app.scratch().resource());
+
+	while (!parents.empty())
+	{
+		std::pmr::vector<TaskID> next(m_app.scratch().resource());
 
-			for (auto&& code : category.codes)
+		for (TaskID parent : parents)
+		{
+			for (TaskID child : m_app.children(parent))
 			{
-				TimeCode codePacket = TimeCode(code.id, code.name, code.archived);
+				if (!include(child))
+				{
+					continue;
+				}
 
-				packet.codes.push_back(codePacket);
+				matches.push_back(child);
+
+				if (message.subtree)
+				{
+					next.push_back(child);
+				}
 			}
-			data.timeCategories.push_back(packet);
 		}
-		m_sender->send(std::make_unique<TimeEntryDataPacket>(data));
+		parents = std::move(next);
+	}
 
-		m_app.send_all_tasks();
+	const std::size_t first = std::min<std::size_t>(std::max(message.offset, 0), matches.size());
+	const std::size_t last = message.limit > 0 ? std::min<std::size_t>(first + message.limit, matches.size()) : matches.size();
+
+	auto page = std::make_unique<TaskPageMessage>(message.requestID, message.parentID);
+	page->offset = static_cast<std::int32_t>(first);
+	page->total = static_cast<std::int32_t>(matches.size());
+
+	for (std::size_t i = first; i < last; i++)
+	{
+		const auto children = m_app.children(matches[i]);
+
+		page->tasks.push_back(TaskPageEntry{ matches[i], static_cast<std::int32_t>(std::count_if(children.begin(), children.end(), include)) });
+	}
+
+	m_sender->send(SuccessResponse(message.origin()));
+	m_sender->send(std::move(page));
+
+	for (std::size_t i = first; i < last; i++)
+	{
+		send_task_info(*m_app.find_task(matches[i]), false);
+
+		m_app.evict_sessions();
+	}
+}
+
+std::size_t API::archive_finished_tasks()
+{
+	if (m_archiveAfter.count() == 0)
+	{
+		return 0;
+	}
+
+	RequestArena::Scope scratch(m_app.scratch());
+
+	const std::size_t archived = m_app.archive_tasks(m_clock->now() - m_archiveAfter);
+
+	m_app.release_kept_sessions();
+
+	return archived;
+}
+
+void API::resync(const RequestResyncMessage& message)
+{
+	m_sender->send(SuccessResponse(message.origin()));
+
+	auto changes = m_changes.changes_since(message.epoch, message.sequence);
+
+	if (changes && std::ranges::any_of(*changes, [](const ChangeLog::Change& change) { return change.type == ChangeLog::ChangeType::REMOVAL; }))
+	{
+		changes.reset();
+	}
+
+	m_sender->send(std::make_unique<SyncPositionMessage>(m_changes.epoch(), m_changes.sequence(), !changes.has_value()));
+
+	if (!changes)
+	{
+		send_configuration(true);
+		return;
+	}
+
+	bool timeCategoriesChanged = false;
+	bool bugzillaChanged = false;
+
+	// in the order they first changed so that new parents come before their new children
+	std::pmr::vector<TaskID> tasks(m_app.scratch().resource());
+	std::pmr::unordered_set<TaskID> seen(m_app.scratch().resource());
+	std::pmr::vector<TaskID> archived(m_app.scratch().resource());
+
+	for (const ChangeLog::Change& change : *changes)
+	{
+		switch (change.type)
+		{
+		case ChangeLog::ChangeType::TASK:
+			if (change.taskID != UNSPECIFIED_TASK && seen.insert(change.taskID).second)
+			{
+				tasks.push_back(change.taskID);
+			}
+			break;
+		case ChangeLog::ChangeType::TIME_CATEGORIES:
+			timeCategoriesChanged = true;
+			break;
+		case ChangeLog::ChangeType::BUGZILLA:
+			bugzillaChanged = true;
+			break;
+		case ChangeLog::ChangeType::ARCHIVED:
+			archived.push_back(change.taskID);
+			break;
+		case ChangeLog::ChangeType::REMOVAL:
+			break;
+		}
+	}
+
+	if (timeCategoriesChanged)
+	{
+		send_time_categories();
+	}
+
+	m_sender->send(std::make_unique<BasicMessage>(PacketType::BULK_TASK_INFO_START));
+
+	for (TaskID id : tasks)
+	{
+		if (const Task* task = m_app.find_task(id))
+		{
+			send_task_info(*task, false);
+
+			m_app.evict_sessions();
+		}
+	}
+
+	if (m_app.active_task() == &m_app.unspecified_task())
+	{
+		m_sender->send(std::make_unique<BasicMessage>(PacketType::UNSPECIFIED_TASK_ACTIVE));
+	}
 
+	m_sender->send(std::make_unique<BasicMessage>(PacketType::BULK_TASK_INFO_FINISH));
+
+	// changed tasks that were archived afterwards have already been skipped, they're only removed
+	for (TaskID id : archived)
+	{
+		m_sender->send(std::make_unique<TaskMessage>(PacketType::TASKS_ARCHIVED, RequestID(0), id));
+	}
+
+	if (bugzillaChanged)
+	{
 		m_bugzilla.send_info();
+	}
+}
+
+void API::subscribe(const TaskMessage& message)
+{
+	if (message.taskID != NO_PARENT && !m_app.find_task(message.taskID))
+	{
+		m_sender->send(FailureResponse(message.origin(), std::format("Task with ID {} does not exist.", message.taskID)));
+		return;
+	}
 
-		m_sender->send(std::make_unique<BasicMessage>(PacketType::REQUEST_CONFIGURATION_COMPLETE));
+	if (message.packetType() == PacketType::SUBSCRIBE_TASKS)
+	{
+		m_sender->subscribe(message.taskID);
+	}
+	else
+	{
+		m_sender->unsubscribe(message.taskID);
+	}
+
+	m_sender->send(SuccessResponse(message.origin()));
+}
+
+void API::send_time_categories()
+{
+	TimeEntryDataPacket data({});
+
+	auto& time_categories = m_app.timeCategories();
+	
+	for (auto&& category : time_categories.categories)
+	{
+		TimeCategory packet = TimeCategory(category.id, category.name);
+
+		for (auto&& code : category.codes)
+		{
+			TimeCode codePacket = TimeCode(code.id, code.name, code.archived);
+
+			packet.codes.push_back(codePacket);
+		}
+		data.timeCategories.push_back(packet);
+	}
+	m_sender->send(std::make_unique<TimeEntryDataPacket>(data));
+}
+
+void API::send_configuration(bool sendTasks)
+{
+	send_time_categories();
+
+	if (sendTasks)
+	{
+		m_app.send_all_tasks();
+	}
+	else if (m_app.active_task() == &m_app.unspecified_task())
+	{
+		// the client requests the tasks itself, but the unspecified task is never part of them
+		m_sender->send(std::make_unique<BasicMessage>(PacketType::UNSPECIFIED_TASK_ACTIVE));
+	}
+
+	m_bugzilla.send_info();
+
+	if (const auto backup = m_backup.configuration(); !backup.location.empty())
+	{
+		m_sender->send(std::make_unique<BackupConfigurationMessage>(RequestID(0), backup.location, backup.frequency.count(), backup.keep));
+	}
+
+	m_sender->send(std::make_unique<BasicMessage>(PacketType::REQUEST_CONFIGURATION_COMPLETE));
+}
+
+void API::handle(const BasicMessage& message)
+{
+	if (message.packetType() == PacketType::VERSION_REQUEST)
+	{
+		m_sender->send(std::make_unique<VersionMessage>("0.14.1"));
+	}
+	else if (message.packetType() == PacketType::REQUEST_CONFIGURATION || message.packetType() == PacketType::REQUEST_CONFIGURATION_WITHOUT_TASKS)
+	{
+		// the position to resync from after a reconnect, the configuration is everything up to it
+		m_sender->send(std::make_unique<SyncPositionMessage>(m_changes.epoch(), m_changes.sequence(), true));
+
+		send_configuration(message.packetType() == PacketType::REQUEST_CONFIGURATION);
 	}
 	else if (message.packetType() == PacketType::BULK_TASK_UPDATE_START)
 	{
@@ -628,23 +950,17 @@ void API::handle_basic(const BasicMessage& message)
 
 void API::send_task_info(const Task& task, bool newTask)
 {
-	auto info = std::make_unique<TaskInfoMessage>(task.taskID(), task.parentID(), task.m_name);
+	TG_TRACE_SPAN("send_task_info", "api");
 
-	info->state = task.state;
-	info->createTime = task.createTime();
-	info->finishTime = task.m_finishTime;
-	info->newTask = newTask;
-	info->indexInParent = task.indexInParent;
-	info->serverControlled = task.serverControlled;
-	info->locked = task.locked;
-	info->times = task.m_times;
-	info->timeEntry = task.timeEntry;
-	info->labels = task.labels;
+	m_sender->send(m_app.task_info(task, newTask));
+}
 
-	m_sender->send(std::move(info));
+void API::broadcast_task_info(const Task& task, bool newTask)
+{
+	m_app.broadcast_task_info(task, newTask);
 }
 
-void API::time_entry_modify(const TimeEntryModifyPacket& message)
+void API::time_entry_modify(const TimeEntryModifyView& message)
 {
 	std::int32_t categoryIndex = -1;
 
@@ -661,11 +977,11 @@ void API::time_entry_modify(const TimeEntryModifyPacket& message)
 
 			if (result != m_app.timeCategories().categories.end())
 			{
-				m_sender->send(std::make_unique<FailureResponse>(message.origin(), std::format("Time Category with name '{}' already exists", category.name)));
+				m_sender->send(FailureResponse(message.origin(), std::format("Time Category with name '{}' already exists", category.name)));
 				return;
 			}
 
-			TimeCategory newCategory{ m_app.m_nextTimeCategoryID, category.name };
+			TimeCategory newCategory{ m_app.m_nextTimeCategoryID, std::string(category.name) };
 
 			m_app.m_nextTimeCategoryID++;
 
@@ -686,7 +1002,7 @@ void API::time_entry_modify(const TimeEntryModifyPacket& message)
 			else
 			{
 				// failed to find a time category with the given ID
-				m_sender->send(std::make_unique<FailureResponse>(message.origin(), std::format("Time Category with ID {} does not exist", category.id)));
+				m_sender->send(FailureResponse(message.origin(), std::format("Time Category with ID {} does not exist", category.id)));
 				return;
 			}
 		}
@@ -696,7 +1012,7 @@ void API::time_entry_modify(const TimeEntryModifyPacket& message)
 			return;
 		}
 
-		const auto add_code_to_category = [request = message.origin(), app = &m_app, database = m_database, sender = m_sender](TimeCategory& category, const TimeEntryModifyPacket::Code& code)
+		const auto add_code_to_category = [request = message.origin(), app = &m_app, database = m_database, sender = m_sender](TimeCategory& category, const TimeEntryModifyView::Code& code)
 			{
 				const bool newCode = code.codeID == TimeCodeID(0);
 
@@ -706,12 +1022,12 @@ void API::time_entry_modify(const TimeEntryModifyPacket& message)
 
 					if (existing != category.codes.end())
 					{
-						sender->send(std::make_unique<FailureResponse>(request, std::format("Time Code with name '{}' already exists on Time Category '{}'", code.name, category.name)));
+						sender->send(FailureResponse(request, std::format("Time Code with name '{}' already exists on Time Category '{}'", code.name, category.name)));
 						return true;
 					}
 					else
 					{
-						TimeCode timeCode{ app->m_nextTimeCodeID, code.name, code.archived };
+						TimeCode timeCode{ app->m_nextTimeCodeID, std::string(code.name), code.archived };
 
 						app->m_nextTimeCodeID++;
 
@@ -753,7 +1069,7 @@ void API::time_entry_modify(const TimeEntryModifyPacket& message)
 					}
 					else
 					{
-						m_sender->send(std::make_unique<FailureResponse>(message.origin(), std::format("Time Code with ID {} does not exist", code.codeID)));
+						m_sender->send(FailureResponse(message.origin(), std::format("Time Code with ID {} does not exist", code.codeID)));
 						return;
 					}
 				}
@@ -780,7 +1096,7 @@ void API::time_entry_modify(const TimeEntryModifyPacket& message)
 		}
 		
 	}
-	m_sender->send(std::make_unique<SuccessResponse>(message.origin()));
+	m_sender->send(SuccessResponse(message.origin()));
 
 	TimeEntryDataPacket data({});
 
@@ -805,7 +1121,7 @@ DailyReportMessage API::create_daily_report(RequestOrigin request, int month, in
 
 	// search for tasks on the given day
 
-	std::vector<MicroTask::FindTasksOnDay> tasks = m_app.find_tasks_on_day(month, day, year);
+	std::pmr::vector<MicroTask::FindTasksOnDay> tasks = m_app.find_tasks_on_day(month, day, year);
 
 	report.report = { !tasks.empty(), month, day, year };
 
@@ -899,4 +1215,30 @@ void API::create_weekly_report(RequestOrigin request, int month, int day, int ye
 	}
 
 	m_sender->send(std::make_unique<WeeklyReportMessage>(report));
+}
+
+void API::configure_backup(const BackupConfigurationMessage& message)
+{
+	// an empty location turns off backups
+	if (!message.backupLocation.empty() && message.backupFrequencyMinutes <= 0)
+	{
+		m_sender->send(FailureResponse(message.origin(), "Backup frequency must be at least 1 minute."));
+		return;
+	}
+
+	if (message.numberOfBackupsToKeep < 0)
+	{
+		m_sender->send(FailureResponse(message.origin(), "Number of backups to keep cannot be negative."));
+		return;
+	}
+
+	BackupConfiguration configuration;
+	configuration.location = message.backupLocation;
+	configuration.frequency = std::chrono::minutes(message.backupFrequencyMinutes);
+	configuration.keep = message.numberOfBackupsToKeep;
+
+	m_backup.configure(configuration);
+	m_database->write_backup_configuration(configuration, *m_sender);
+
+	m_sender->send(SuccessResponse(message.origin()));
 }
\ No newline at end of file
@@ -3,11 +3,18 @@
 
 #include "server.hpp"
 #include "curl.hpp"
+#include "backup.hpp"
 #include "bugzilla.hpp"
+#include "change_log.hpp"
 #include "database.hpp"
 
+#include "packets/backup_configuration.hpp"
 #include "packets/create_task.hpp"
+#include "packets/packet_parser.hpp"
+#include "packets/request_resync.hpp"
+#include "packets/request_tasks.hpp"
 #include "packets/task.hpp"
+#include "packets/task_page.hpp"
 #include "packets/update_task.hpp"
 #include "packets/time_entry_modify_packet.hpp"
 
@@ -18,41 +25,89 @@
 class API
 {
 public:
-	API(const Clock& clock, cURL& curl, Database& database, PacketSender& sender) 
+	API(const Clock& clock, cURL& curl, Database& database, PacketSender& sender, SessionHistory sessionHistory = {})
 		: m_clock(&clock), 
-		m_app(*this, clock, database, sender),
+		m_changes(database),
+		m_app(*this, clock, m_changes, sender, sessionHistory),
 		m_bugzilla(clock, curl, sender),
-		m_database(&database),
+		m_backup(clock, m_changes, sender),
+		m_database(&m_changes),
 		m_sender(&sender)
 	{
-		database.load(m_bugzilla, m_app, *this);
+		m_changes.load(m_bugzilla, m_app, *this);
 	}
 
+	// a request decoded by parse_request
+	void process_packet(const RequestPacket& packet);
 	void process_packet(const Message& message);
 
+	// responses to the client whose request is being handled
 	void send_task_info(const Task& task, bool newTask);
+	// the task changed, every client looking at it is told
+	void broadcast_task_info(const Task& task, bool newTask);
+
+	// subtrees finished this long ago are archived by archive_finished_tasks. 0 never archives
+	void archive_after(std::chrono::days days) { m_archiveAfter = days; }
+
+	// called at startup and then on a timer, not while handling a request. returns the number of tasks archived
+	std::size_t archive_finished_tasks();
 
 private:
-	void create_task(const CreateTaskMessage& message);
+	// times the request and hands it to the handler for its type
+	template<typename T>
+	void process(const T& message);
+
+	void handle(const BasicMessage& message);
+	void handle(const RequestMessage& message);
+	void handle(const CreateTaskView& message) { create_task(message); }
+	void handle(const TaskMessage& message);
+	void handle(const UpdateTaskView& message) { update_task(message); }
+	void handle(const UpdateTaskTimesMessage& message);
+	void handle(const RequestDailyReportMessage& message);
+	void handle(const RequestWeeklyReportMessage& message);
+	void handle(const TimeEntryModifyView& message) { time_entry_modify(message); }
+	void handle(const BackupConfigurationMessage& message) { configure_backup(message); }
+	void handle(const BugzillaInfoView& message);
+	void handle(const RequestTasksMessage& message) { request_tasks(message); }
+	void handle(const RequestResyncMessage& message) { resync(message); }
+	void handle(const RequestProtocolVersionMessage& message);
+
+	void create_task(const CreateTaskView& message);
 	void start_task(const TaskMessage& message);
 	void stop_task(const TaskMessage& message);
 	void stop_unspecified_task(const TaskMessage& message);
 	void finish_task(const TaskMessage& message);
-	void update_task(const UpdateTaskMessage& message);
+	void update_task(const UpdateTaskView& message);
+	void add_session(const UpdateTaskTimesMessage& update);
+	void edit_session(const UpdateTaskTimesMessage& update);
+	void remove_session(const UpdateTaskTimesMessage& update);
 	void request_task(const TaskMessage& message);
+	void request_archived_tasks(const TaskMessage& message);
+	void request_tasks(const RequestTasksMessage& message);
+	void resync(const RequestResyncMessage& message);
+	void subscribe(const TaskMessage& message);
 
-	void handle_basic(const BasicMessage& message);
+	void send_configuration(bool sendTasks);
+	void send_time_categories();
 
-	void time_entry_modify(const TimeEntryModifyPacket& message);
+	void time_entry_modify(const TimeEntryModifyView& message);
+
+	void configure_backup(const BackupConfigurationMessage& message);
 
 	DailyReportMessage create_daily_report(RequestOrigin request, int month, int day, int year);
 	void create_weekly_report(RequestOrigin request, int month, int day, int year);
 
 	const Clock* m_clock;
+
+	std::chrono::days m_archiveAfter = std::chrono::days(0);
+
+	// every write goes through the change log so that reconnecting clients can be sent only what changed
+	ChangeLog m_changes;
 	
 public:
 	MicroTask m_app;
 	Bugzilla m_bugzilla;
+	BackupScheduler m_backup;
 private:
 	Database* m_database;
 	PacketSender* m_sender;
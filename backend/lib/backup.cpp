@@ -0,0 +1,273 @@
+#include "backup.hpp"
+#include "packets.hpp"
+#include "trace.hpp"
+
+#include <algorithm>
+#include <charconv>
+#include <format>
+
+namespace
+{
+	constexpr std::string_view BACKUP_PREFIX = "backup-";
+	constexpr std::string_view BACKUP_EXTENSION = ".db3";
+
+	std::optional<int> parse_number(std::string_view text)
+	{
+		int value = 0;
+		const auto result = std::from_chars(text.data(), text.data() + text.size(), value);
+
+		if (result.ec != std::errc() || result.ptr != text.data() + text.size())
+		{
+			return std::nullopt;
+		}
+		return value;
+	}
+}
+
+std::string backup_file_name(std::chrono::milliseconds time)
+{
+	const auto seconds = std::chrono::sys_seconds(std::chrono::floor<std::chrono::seconds>(time));
+
+	return std::format("{}{:%Y%m%d-%H%M%S}{}", BACKUP_PREFIX, seconds, BACKUP_EXTENSION);
+}
+
+std::optional<std::chrono::milliseconds> backup_file_time(const std::string& name)
+{
+	// backup-YYYYMMDD-HHMMSS.db3
+	const std::string_view view = name;
+
+	if (view.size() != BACKUP_PREFIX.size() + 15 + BACKUP_EXTENSION.size() || !view.starts_with(BACKUP_PREFIX) || !view.ends_with(BACKUP_EXTENSION))
+	{
+		return std::nullopt;
+	}
+
+	const std::string_view stamp = view.substr(BACKUP_PREFIX.size(), 15);
+
+	if (stamp[8] != '-')
+	{
+		return std::nullopt;
+	}
+
+	const auto year = parse_number(stamp.substr(0, 4));
+	const auto month = parse_number(stamp.substr(4, 2));
+	const auto day = parse_number(stamp.substr(6, 2));
+	const auto hour = parse_number(stamp.substr(9, 2));
+	const auto minute = parse_number(stamp.substr(11, 2));
+	const auto second = parse_number(stamp.substr(13, 2));
+
+	if (!year || !month || !day || !hour || !minute || !second)
+	{
+		return std::nullopt;
+	}
+
+	const auto date = std::chrono::year_month_day(std::chrono::year(*year), std::chrono::month(*month), std::chrono::day(*day));
+
+	if (!date.ok())
+	{
+		return std::nullopt;
+	}
+
+	const auto time = std::chrono::sys_days(date).time_since_epoch() + std::chrono::hours(*hour) + std::chrono::minutes(*minute) + std::chrono::seconds(*second);
+
+	return std::chrono::duration_cast<std::chrono::milliseconds>(time);
+}
+
+std::vector<std::filesystem::path> find_backups(const std::filesystem::path& location)
+{
+	std::vector<std::filesystem::path> backups;
+
+	std::error_code error;
+
+	for (auto&& entry : std::filesystem::directory_iterator(location, error))
+	{
+		if (entry.is_regular_file() && backup_file_time(entry.path().filename().string()))
+		{
+			backups.push_back(entry.path());
+		}
+	}
+
+	std::ranges::sort(backups);
+
+	return backups;
+}
+
+std::filesystem::path backup_journal_directory(const std::filesystem::path& backup)
+{
+	auto directory = backup;
+	directory.replace_extension(".journal");
+	return directory;
+}
+
+BackupScheduler::BackupScheduler(const Clock& clock, Database& database, PacketSender& sender)
+	: m_clock(&clock), m_database(&database), m_sender(&sender)
+{
+}
+
+BackupScheduler::~BackupScheduler()
+{
+	if (m_thread.joinable())
+	{
+		{
+			std::lock_guard lock(m_mutex);
+			m_stop = true;
+		}
+		m_wake.notify_one();
+
+		m_thread.join();
+	}
+}
+
+void BackupScheduler::configure(const BackupConfiguration& configuration)
+{
+	std::optional<std::chrono::milliseconds> lastBackup;
+
+	if (!configuration.location.empty())
+	{
+		const auto backups = find_backups(configuration.location);
+
+		if (!backups.empty())
+		{
+			lastBackup = backup_file_time(backups.back().filename().string());
+		}
+	}
+
+	{
+		std::lock_guard lock(m_mutex);
+
+		m_configuration = configuration;
+		m_lastBackup = lastBackup;
+		m_lastAttempt = lastBackup;
+	}
+	m_wake.notify_one();
+}
+
+BackupConfiguration BackupScheduler::configuration() const
+{
+	std::lock_guard lock(m_mutex);
+
+	return m_configuration;
+}
+
+std::optional<std::chrono::milliseconds> BackupScheduler::last_backup() const
+{
+	std::lock_guard lock(m_mutex);
+
+	return m_lastBackup;
+}
+
+void BackupScheduler::start()
+{
+	if (!m_thread.joinable())
+	{
+		m_thread = std::thread([this]() { run(); });
+	}
+}
+
+bool BackupScheduler::perform_backup()
+{
+	TG_TRACE_SPAN("backup", "backup");
+
+	const auto now = m_clock->now();
+
+	std::optional<std::chrono::milliseconds> lastBackup;
+	BackupConfiguration configuration;
+
+	{
+		std::lock_guard lock(m_mutex);
+
+		m_lastAttempt = now;
+		lastBackup = m_lastBackup;
+		configuration = m_configuration;
+	}
+
+	const auto failed = [&](const std::string& error)
+	{
+		m_sender->send_to_all(std::make_unique<BackupFailedMessage>(error, lastBackup.value_or(std::chrono::milliseconds(0))));
+		return false;
+	};
+
+	if (configuration.location.empty())
+	{
+		return failed("Backup location has not been configured");
+	}
+
+	std::error_code error;
+	std::filesystem::create_directories(configuration.location, error);
+
+	if (error)
+	{
+		return failed(error.message());
+	}
+
+	const auto file = std::filesystem::path(configuration.location) / backup_file_name(now);
+
+	if (auto backupError = m_database->backup(file))
+	{
+		return failed(*backupError);
+	}
+
+	{
+		std::lock_guard lock(m_mutex);
+
+		m_lastBackup = now;
+	}
+
+	remove_old_backups(configuration);
+
+	m_sender->send_to_all(std::make_unique<BackupPerformedMessage>(now));
+
+	return true;
+}
+
+void BackupScheduler::run()
+{
+	std::unique_lock lock(m_mutex);
+
+	while (!m_stop)
+	{
+		if (!m_configuration.enabled())
+		{
+			m_wake.wait(lock);
+			continue;
+		}
+
+		const auto due = m_lastAttempt.value_or(std::chrono::milliseconds(0)) + m_configuration.frequency;
+		const auto now = m_clock->now();
+
+		// woken early by a new configuration or when stopping, the due time is checked again either way
+		if (now < due)
+		{
+			m_wake.wait_for(lock, due - now);
+			continue;
+		}
+
+		lock.unlock();
+
+		perform_backup();
+
+		lock.lock();
+	}
+}
+
+void BackupScheduler::remove_old_backups(const BackupConfiguration& configuration)
+{
+	if (configuration.keep <= 0)
+	{
+		return;
+	}
+
+	const auto backups = find_backups(configuration.location);
+
+	if (backups.size() <= static_cast<std::size_t>(configuration.keep))
+	{
+		return;
+	}
+
+	for (std::size_t i = 0; i < backups.size() - configuration.keep; i++)
+	{
+		// a backup that can't be removed now will be tried again after the next backup
+		std::error_code error;
+		std::filesystem::remove(backups[i], error);
+		std::filesystem::remove_all(backup_journal_directory(backups[i]), error);
+	}
+}
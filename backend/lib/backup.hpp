@@ -0,0 +1,80 @@
+#pragma once
+
+#include "clock.hpp"
+#include "database.hpp"
+#include "packet_sender.hpp"
+#include "packets/backup_failed.hpp"
+#include "packets/backup_performed.hpp"
+
+#include <chrono>
+#include <condition_variable>
+#include <filesystem>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+
+struct BackupConfiguration
+{
+	std::string location;
+	std::chrono::minutes frequency = std::chrono::minutes(0);
+
+	// 0 keeps every backup
+	int keep = 0;
+
+	bool enabled() const { return !location.empty() && frequency.count() > 0; }
+};
+
+// backups are named by the time they were made, sorting them by name sorts them from oldest to newest
+std::string backup_file_name(std::chrono::milliseconds time);
+std::optional<std::chrono::milliseconds> backup_file_time(const std::string& name);
+
+// every backup in the folder, oldest first
+std::vector<std::filesystem::path> find_backups(const std::filesystem::path& location);
+
+// the journal segments that go with a backup made while the event journal is in use. they're restored by starting the
+// server on the backup with this directory as its journal
+std::filesystem::path backup_journal_directory(const std::filesystem::path& backup);
+
+// copies the database into the backup folder whenever the configured frequency has passed since the last backup.
+// the result of every backup is sent as BACKUP_PERFORMED or BACKUP_FAILED
+//
+// nothing happens in the background until start() is called, perform_backup() can be used without it
+class BackupScheduler
+{
+public:
+	BackupScheduler(const Clock& clock, Database& database, PacketSender& sender);
+	~BackupScheduler();
+
+	BackupScheduler(const BackupScheduler&) = delete;
+	BackupScheduler& operator=(const BackupScheduler&) = delete;
+
+	// the time of the last backup is taken from the newest backup already in the folder
+	void configure(const BackupConfiguration& configuration);
+	BackupConfiguration configuration() const;
+
+	std::optional<std::chrono::milliseconds> last_backup() const;
+
+	void start();
+
+	bool perform_backup();
+
+private:
+	void run();
+	void remove_old_backups(const BackupConfiguration& configuration);
+
+	const Clock* m_clock;
+	Database* m_database;
+	PacketSender* m_sender;
+
+	mutable std::mutex m_mutex;
+	std::condition_variable m_wake;
+	BackupConfiguration m_configuration;
+	std::optional<std::chrono::milliseconds> m_lastBackup;
+	// a failed backup is retried after the frequency has passed again, not right away
+	std::optional<std::chrono::milliseconds> m_lastAttempt;
+	bool m_stop = false;
+
+	std::thread m_thread;
+};
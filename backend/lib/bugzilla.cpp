@@ -1,5 +1,6 @@
 #include "bugzilla.hpp"
 #include "api.hpp"
+#include "trace.hpp"
 
 #include "packets/success_response.hpp"
 #include "packets/failure_response.hpp"
@@ -8,27 +9,27 @@
 #include <memory>
 #include <string>
 
-void Bugzilla::receive_info(const BugzillaInfoMessage& info, MicroTask& app, API& api, Database& database)
+void Bugzilla::receive_info(const BugzillaInfoView& info, MicroTask& app, API& api, Database& database)
 {
 	BugzillaInstance* instance = nullptr;
 
 	if (info.instanceID._val == 0)
 	{
-		m_bugzilla.emplace(info.name, BugzillaInstance(m_nextBugzillaID));
+		m_bugzilla.emplace(std::string(info.name), BugzillaInstance(m_nextBugzillaID));
 		++m_nextBugzillaID;
 
 		database.write_next_bugzilla_instance_id(m_nextBugzillaID, *m_sender);
 	}
 	
-	instance = &m_bugzilla.at(info.name);
+	instance = &m_bugzilla.at(std::string(info.name));
 
 	instance->bugzillaName = info.name;
 	instance->bugzillaURL = info.URL;
 	instance->bugzillaApiKey = info.apiKey;
 	instance->bugzillaUsername = info.username;
 	instance->bugzillaRootTaskID = info.rootTaskID;
-	instance->bugzillaGroupTasksBy = info.groupTasksBy;
-	instance->bugzillaLabelToField = info.labelToField;
+	instance->bugzillaGroupTasksBy.assign(info.groupTasksBy.begin(), info.groupTasksBy.end());
+	instance->bugzillaLabelToField = { info.labelToField.begin(), info.labelToField.end() };
 
 	database.write_bugzilla_instance(*instance, *m_sender);
 
@@ -37,17 +38,16 @@ void Bugzilla::receive_info(const BugzillaInfoMessage& info, MicroTask& app, API
 	// get the field values from bugzilla
 	if (m_curl)
 	{
-		m_bugzilla.at(info.name).fields.clear();
+		instance->fields.clear();
 
-		std::string request = info.URL + "/rest/field/bug?api_key=" + info.apiKey;
+		std::string request = std::format("{}/rest/field/bug?api_key={}", info.URL, info.apiKey);
 
-		auto result = m_curl->execute_request(request);
+		auto result = execute_request(request);
 
 		if (result)
 		{
 			simdjson::dom::parser parser;
-			auto json = simdjson::padded_string(result.value());
-			simdjson::dom::element doc = parser.parse(json);
+			simdjson::dom::element doc = parse_response(parser, result.value());
 
 			for (auto field : doc["fields"])
 			{
@@ -69,7 +69,7 @@ void Bugzilla::receive_info(const BugzillaInfoMessage& info, MicroTask& app, API
 					}
 				}
 
-				m_bugzilla.at(info.name).fields[name] = values;
+				instance->fields[name] = values;
 			}
 		}
 	}
@@ -91,9 +91,11 @@ void Bugzilla::build_group_by_task(BugzillaInstance& instance, MicroTask& app, A
 		if (!task)
 		{
 			// make sure the parent task isn't finished
-			if (app.find_task(parent) != nullptr)
+			if (Task* parentTask = app.find_task(parent))
 			{
-				app.find_task(parent)->state = TaskState::PENDING;
+				parentTask->state = TaskState::PENDING;
+
+				app.task_changed(*parentTask);
 			}
 
 			const auto result = app.create_task(value, parent, true);
@@ -142,9 +144,11 @@ Task* Bugzilla::parent_task_for_bug(BugzillaInstance& instance, MicroTask& app,
 	if (!task)
 	{
 		// make sure the parent task isn't finished
-		if (app.find_task(currentParent) != nullptr)
+		if (Task* parentTask = app.find_task(currentParent))
 		{
-			app.find_task(currentParent)->state = TaskState::PENDING;
+			parentTask->state = TaskState::PENDING;
+
+			app.task_changed(*parentTask);
 		}
 
 		const auto result = app.create_task(groupBy, currentParent, true);
@@ -178,38 +182,40 @@ void Bugzilla::send_info()
 
 void Bugzilla::perform_refresh(const RequestMessage& request, MicroTask& app, API& api, Database& database)
 {
+	TG_TRACE_SPAN("bugzilla_refresh", "bugzilla");
+
 	try
 	{
 		std::pair<std::vector<Task*>, std::vector<Task*>> task_updates = refresh(request, app, api, database);
 
 		if (request.requestID != RequestID(0))
 		{
-			m_sender->send(std::make_unique<SuccessResponse>(request.origin()));
+			m_sender->send(SuccessResponse(request.origin()));
 		}
 
 		if (!task_updates.first.empty() || !task_updates.second.empty())
 		{
-			m_sender->send(std::make_unique<BasicMessage>(PacketType::BULK_TASK_INFO_START));
+			m_sender->broadcast(std::make_unique<BasicMessage>(PacketType::BULK_TASK_INFO_START), {});
 		}
 
 		for (Task* task : task_updates.first)
 		{
-			api.send_task_info(*task, true);
+			api.broadcast_task_info(*task, true);
 		}
 
 		for (Task* task : task_updates.second)
 		{
-			api.send_task_info(*task, false);
+			api.broadcast_task_info(*task, false);
 		}
 
 		if (!task_updates.first.empty() || !task_updates.second.empty())
 		{
-			m_sender->send(std::make_unique<BasicMessage>(PacketType::BULK_TASK_INFO_FINISH));
+			m_sender->broadcast(std::make_unique<BasicMessage>(PacketType::BULK_TASK_INFO_FINISH), {});
 		}
 	}
 	catch (const std::exception& e)
 	{
-		m_sender->send(std::make_unique<FailureResponse>(request.origin(), e.what()));
+		m_sender->send(FailureResponse(request.origin(), e.what()));
 	}
 }
 
@@ -227,7 +233,7 @@ std::pair<std::vector<Task*>, std::vector<Task*>> Bugzilla::refresh(const Reques
 			{
 				if (request.requestID != RequestID(0))
 				{
-					m_sender->send(std::make_unique<FailureResponse>(request.origin(), std::format("Root task {} does not exist", info.bugzillaRootTaskID)));
+					m_sender->send(FailureResponse(request.origin(), std::format("Root task {} does not exist", info.bugzillaRootTaskID)));
 				}
 				return tasks_changed;
 			}
@@ -239,13 +245,12 @@ std::pair<std::vector<Task*>, std::vector<Task*>> Bugzilla::refresh(const Reques
 
 			const auto refresh = [&](const std::string& requestAddress) -> bool
 			{
-					auto result = m_curl->execute_request(requestAddress);
+					auto result = execute_request(requestAddress);
 
 					if (!result) return false;
 
 					simdjson::dom::parser parser;
-					auto json = simdjson::padded_string(result.value());
-					simdjson::dom::element doc = parser.parse(json);
+					simdjson::dom::element doc = parse_response(parser, result.value());
 
 					std::vector<TaskID> bugTasks;
 					std::map<TaskID, TaskState> startingStates;
@@ -253,7 +258,12 @@ std::pair<std::vector<Task*>, std::vector<Task*>> Bugzilla::refresh(const Reques
 					for (auto&& [bug, task] : info.bugToTaskID)
 					{
 						bugTasks.push_back(task);
-						startingStates[task] = app.find_task(task)->state;
+
+						// tasks of bugs that were resolved long ago might have been archived
+						if (const Task* bugTask = app.find_task(task))
+						{
+							startingStates[task] = bugTask->state;
+						}
 					}
 
 					// finish all the non-bug children of the root task. we'll find the parents and set them back to pending as we need them
@@ -281,6 +291,8 @@ std::pair<std::vector<Task*>, std::vector<Task*>> Bugzilla::refresh(const Reques
 									nextParent->state = TaskState::PENDING;
 									nextParent->m_finishTime = std::nullopt;
 
+									app.task_changed(*nextParent);
+
 									nextParent = app.find_task(nextParent->parentID());
 								}
 							}();
@@ -292,6 +304,13 @@ std::pair<std::vector<Task*>, std::vector<Task*>> Bugzilla::refresh(const Reques
 
 						auto iter = info.bugToTaskID.find(bug_id);
 
+						// the task of a bug that was resolved long ago might have been archived. a bug that's back gets a new task
+						if (iter != info.bugToTaskID.end() && !app.find_task(iter->second) && std::string_view(bug["status"]) != "RESOLVED")
+						{
+							info.bugToTaskID.erase(iter);
+							iter = info.bugToTaskID.end();
+						}
+
 						if (iter != info.bugToTaskID.end())
 						{
 							auto name = std::format("{} - {}{}", bug_id, cc_only ? "(cc) " : "", std::string_view(bug["summary"]));
@@ -347,7 +366,11 @@ std::pair<std::vector<Task*>, std::vector<Task*>> Bugzilla::refresh(const Reques
 					for (auto&& [bug, task] : info.bugToTaskID)
 					{
 						bugTasks.push_back(task);
-						startingStates[task] = app.find_task(task)->state;
+
+						if (const Task* bugTask = app.find_task(task))
+						{
+							startingStates[task] = bugTask->state;
+						}
 					}
 
 					for (auto&& [taskID, state] : helperTasks)
@@ -406,6 +429,22 @@ std::pair<std::vector<Task*>, std::vector<Task*>> Bugzilla::refresh(const Reques
 	return tasks_changed;
 }
 
+std::optional<std::string> Bugzilla::execute_request(const std::string& request)
+{
+	TG_TRACE_SPAN("curl", "bugzilla");
+
+	return m_curl->execute_request(request);
+}
+
+simdjson::dom::element Bugzilla::parse_response(simdjson::dom::parser& parser, const std::string& response)
+{
+	TG_TRACE_SPAN("parse_json", "bugzilla");
+
+	// the parser owns the parsed document, the element stays valid after the padded copy goes away
+	auto json = simdjson::padded_string(response);
+	return parser.parse(json);
+}
+
 void Bugzilla::load_instance(const BugzillaInstance& instance)
 {
 	m_bugzilla.emplace(instance.bugzillaName, instance);
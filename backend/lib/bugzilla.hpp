@@ -51,7 +51,7 @@ public:
 	{
 	}
 
-	void receive_info(const BugzillaInfoMessage& info, MicroTask& app, API& api, Database& database);
+	void receive_info(const BugzillaInfoView& info, MicroTask& app, API& api, Database& database);
 	void send_info();
 
 	void perform_refresh(const RequestMessage& request, MicroTask& app, API& api, Database& database);
@@ -63,11 +63,16 @@ public:
 	void load_instance(const BugzillaInstance& instance);
 	void next_instance_id(BugzillaInstanceID next);
 
+	const std::map<std::string, BugzillaInstance>& instances() const { return m_bugzilla; }
+
 private:
 	void build_group_by_task(BugzillaInstance& instance, MicroTask& app, API& api, TaskID parent, std::span<const std::string> groupTaskBy);
 
 	class Task* parent_task_for_bug(BugzillaInstance& instance, MicroTask& app, API& api, const simdjson::dom::element& bug, TaskID currentParent, std::span<const std::string> groupTaskBy, std::vector<Task*>& new_tasks);
 
+	std::optional<std::string> execute_request(const std::string& request);
+	simdjson::dom::element parse_response(simdjson::dom::parser& parser, const std::string& response);
+
 	const Clock* m_clock;
 	cURL* m_curl;
 	PacketSender* m_sender;
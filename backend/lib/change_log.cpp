@@ -0,0 +1,235 @@
+#include "change_log.hpp"
+
+#include "server.hpp"
+
+#include <algorithm>
+#include <limits>
+#include <random>
+#include <unordered_set>
+
+static std::int64_t random_epoch()
+{
+	std::random_device device;
+	std::mt19937_64 generator(device());
+
+	// 0 is what a client sends before its first sync
+	return std::uniform_int_distribution<std::int64_t>(1, std::numeric_limits<std::int64_t>::max())(generator);
+}
+
+ChangeLog::ChangeLog(Database& database, std::size_t capacity)
+	: m_database(&database),
+	m_epoch(random_epoch()),
+	m_capacity(std::max<std::size_t>(capacity, 1))
+{
+}
+
+std::optional<std::vector<ChangeLog::Change>> ChangeLog::changes_since(std::int64_t epoch, std::int64_t sequence) const
+{
+	if (epoch != m_epoch || sequence < m_dropped || sequence > m_sequence)
+	{
+		return std::nullopt;
+	}
+
+	const auto first = std::upper_bound(m_changes.begin(), m_changes.end(), sequence, [](std::int64_t sequence, const Change& change) { return sequence < change.sequence; });
+
+	return std::vector<Change>(first, m_changes.end());
+}
+
+void ChangeLog::record(ChangeType type, TaskID taskID)
+{
+	m_changes.push_back(Change{ ++m_sequence, type, taskID });
+
+	if (m_changes.size() > m_capacity)
+	{
+		m_dropped = m_changes.front().sequence;
+		m_changes.pop_front();
+	}
+}
+
+void ChangeLog::load(Bugzilla& bugzilla, MicroTask& app, API& api)
+{
+	m_database->load(bugzilla, app, api);
+}
+
+std::vector<TaskTimes> ChangeLog::load_sessions(TaskID task, const TimeCategories& timeCategories)
+{
+	return m_database->load_sessions(task, timeCategories);
+}
+
+std::vector<TaskID> ChangeLog::find_tasks_with_sessions(std::chrono::milliseconds start, std::chrono::milliseconds end)
+{
+	return m_database->find_tasks_with_sessions(start, end);
+}
+
+bool ChangeLog::has_uncommitted_writes(TaskID task) const
+{
+	return m_database->has_uncommitted_writes(task);
+}
+
+void ChangeLog::evicting_sessions(const Task& task, PacketSender& sender)
+{
+	m_database->evicting_sessions(task, sender);
+}
+
+void ChangeLog::write_task(const Task& task, PacketSender& sender)
+{
+	record(ChangeType::TASK, task.taskID());
+
+	m_database->write_task(task, sender);
+}
+
+void ChangeLog::write_next_task_id(TaskID nextID, PacketSender& sender)
+{
+	m_database->write_next_task_id(nextID, sender);
+}
+
+void ChangeLog::write_event(const TaskEvent& event, const Task& task, PacketSender& sender)
+{
+	record(ChangeType::TASK, task.taskID());
+
+	m_database->write_event(event, task, sender);
+}
+
+void ChangeLog::write_bugzilla_instance(const BugzillaInstance& instance, PacketSender& sender)
+{
+	record(ChangeType::BUGZILLA);
+
+	m_database->write_bugzilla_instance(instance, sender);
+}
+
+void ChangeLog::write_next_bugzilla_instance_id(BugzillaInstanceID nextID, PacketSender& sender)
+{
+	m_database->write_next_bugzilla_instance_id(nextID, sender);
+}
+
+void ChangeLog::remove_bugzilla_instance(int ID)
+{
+	record(ChangeType::REMOVAL);
+
+	m_database->remove_bugzilla_instance(ID);
+}
+
+void ChangeLog::bugzilla_refreshed(int ID)
+{
+	record(ChangeType::BUGZILLA);
+
+	m_database->bugzilla_refreshed(ID);
+}
+
+void ChangeLog::write_session(TaskID task, const TaskTimes& session, PacketSender& sender)
+{
+	record(ChangeType::TASK, task);
+
+	m_database->write_session(task, session, sender);
+}
+
+void ChangeLog::remove_sessions(TaskID task, PacketSender& sender)
+{
+	record(ChangeType::TASK, task);
+
+	m_database->remove_sessions(task, sender);
+}
+
+void ChangeLog::write_time_entry(TaskID task, PacketSender& sender)
+{
+	record(ChangeType::TASK, task);
+
+	m_database->write_time_entry(task, sender);
+}
+
+void ChangeLog::remove_time_entry()
+{
+	m_database->remove_time_entry();
+}
+
+void ChangeLog::write_time_entry_config(const TimeCategory& entry, PacketSender& sender)
+{
+	record(ChangeType::TIME_CATEGORIES);
+
+	m_database->write_time_entry_config(entry, sender);
+}
+
+void ChangeLog::write_next_time_category_id(TimeCategoryID nextID, PacketSender& sender)
+{
+	m_database->write_next_time_category_id(nextID, sender);
+}
+
+void ChangeLog::write_next_time_code_id(TimeCodeID nextID, PacketSender& sender)
+{
+	m_database->write_next_time_code_id(nextID, sender);
+}
+
+void ChangeLog::remove_time_category(const TimeCategory& entry, PacketSender& sender)
+{
+	record(ChangeType::TIME_CATEGORIES);
+
+	m_database->remove_time_category(entry, sender);
+}
+
+void ChangeLog::remove_time_code(const TimeCategory& entry, const TimeCode& code, PacketSender& sender)
+{
+	record(ChangeType::TIME_CATEGORIES);
+
+	m_database->remove_time_code(entry, code, sender);
+}
+
+void ChangeLog::write_backup_configuration(const BackupConfiguration& configuration, PacketSender& sender)
+{
+	m_database->write_backup_configuration(configuration, sender);
+}
+
+void ChangeLog::archive_tasks(const std::vector<Task>& tasks, PacketSender& sender)
+{
+	std::unordered_set<TaskID> archived;
+
+	for (const Task& task : tasks)
+	{
+		archived.insert(task.taskID());
+	}
+
+	// one change for each subtree, the client removes everything below it
+	for (const Task& task : tasks)
+	{
+		if (!archived.contains(task.parentID()))
+		{
+			record(ChangeType::ARCHIVED, task.taskID());
+		}
+	}
+
+	m_database->archive_tasks(tasks, sender);
+}
+
+std::vector<Task> ChangeLog::load_archived_tasks(TaskID parent, const TimeCategories& timeCategories, PacketSender& sender)
+{
+	return m_database->load_archived_tasks(parent, timeCategories, sender);
+}
+
+void ChangeLog::start_transaction(PacketSender& sender)
+{
+	m_database->start_transaction(sender);
+}
+
+void ChangeLog::finish_transaction(PacketSender& sender)
+{
+	m_database->finish_transaction(sender);
+}
+
+bool ChangeLog::transaction_in_progress() const
+{
+	return m_database->transaction_in_progress();
+}
+
+void ChangeLog::flush(PacketSender& sender)
+{
+	m_database->flush(sender);
+}
+
+void ChangeLog::write_snapshot(MicroTask& app, const Bugzilla& bugzilla, PacketSender& sender)
+{
+	m_database->write_snapshot(app, bugzilla, sender);
+}
+
+std::optional<std::string> ChangeLog::backup(const std::filesystem::path& file)
+{
+	return m_database->backup(file);
+}
@@ -0,0 +1,111 @@
+#pragma once
+
+#include "database.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <optional>
+#include <vector>
+
+// sits in front of the database and numbers every change written through it, so that a client that reconnects is only
+// sent what changed since it last synced. every change to the tasks, time categories and bugzilla instances is written
+// to the database, which makes this the one place they all pass through
+//
+// only the most recent changes are kept. a client that is further behind than that, or that synced with an earlier
+// run of the server, has to sync everything again
+struct ChangeLog : Database
+{
+	enum class ChangeType : std::uint8_t
+	{
+		TASK,
+		TIME_CATEGORIES,
+		BUGZILLA,
+		// the task and everything below it was archived, a client is sent TASKS_ARCHIVED for it
+		ARCHIVED,
+		// a bugzilla instance was removed. there's no message to remove it from a client
+		REMOVAL,
+	};
+
+	struct Change
+	{
+		std::int64_t sequence;
+		ChangeType type;
+		// only set for TASK and ARCHIVED
+		TaskID taskID = NO_PARENT;
+	};
+
+	ChangeLog(Database& database, std::size_t capacity = 10000);
+
+	// identifies this run of the server, sequence numbers from another run mean nothing
+	std::int64_t epoch() const { return m_epoch; }
+	// sequence number of the latest change, 0 before the first
+	std::int64_t sequence() const { return m_sequence; }
+
+	// every change made after the sequence, oldest first. empty when the log doesn't reach back that far
+	std::optional<std::vector<Change>> changes_since(std::int64_t epoch, std::int64_t sequence) const;
+
+	void load(Bugzilla& bugzilla, MicroTask& app, API& api) override;
+
+	std::vector<TaskTimes> load_sessions(TaskID task, const TimeCategories& timeCategories) override;
+	std::vector<TaskID> find_tasks_with_sessions(std::chrono::milliseconds start, std::chrono::milliseconds end) override;
+	void evicting_sessions(const Task& task, PacketSender& sender) override;
+	bool has_uncommitted_writes(TaskID task) const override;
+
+	// write task
+	void write_task(const Task& task, PacketSender& sender) override;
+	void write_next_task_id(TaskID nextID, PacketSender& sender) override;
+	void write_event(const TaskEvent& event, const Task& task, PacketSender& sender) override;
+
+	// write bugzilla config
+	void write_bugzilla_instance(const BugzillaInstance& instance, PacketSender& sender) override;
+	void write_next_bugzilla_instance_id(BugzillaInstanceID nextID, PacketSender& sender) override;
+	void remove_bugzilla_instance(int ID) override;
+	void bugzilla_refreshed(int ID) override;
+
+	// write time entry configuration
+	// write sessions
+	void write_session(TaskID task, const TaskTimes& session, PacketSender& sender) override;
+	void remove_sessions(TaskID task, PacketSender& sender) override;
+
+	// write time entries
+	void write_time_entry(TaskID task, PacketSender& sender) override;
+	void remove_time_entry() override;
+
+	void write_time_entry_config(const TimeCategory& entry, PacketSender& sender) override;
+	void write_next_time_category_id(TimeCategoryID nextID, PacketSender& sender) override;
+	void write_next_time_code_id(TimeCodeID nextID, PacketSender& sender) override;
+
+	void remove_time_category(const TimeCategory& entry, PacketSender& sender) override;
+	void remove_time_code(const TimeCategory& entry, const TimeCode& code, PacketSender& sender) override;
+
+	void write_backup_configuration(const BackupConfiguration& configuration, PacketSender& sender) override;
+
+	void archive_tasks(const std::vector<Task>& tasks, PacketSender& sender) override;
+	std::vector<Task> load_archived_tasks(TaskID parent, const TimeCategories& timeCategories, PacketSender& sender) override;
+
+	void start_transaction(PacketSender& sender) override;
+	void finish_transaction(PacketSender& sender) override;
+
+	bool transaction_in_progress() const override;
+
+	void flush(PacketSender& sender) override;
+
+	void write_snapshot(MicroTask& app, const Bugzilla& bugzilla, PacketSender& sender) override;
+
+	std::optional<std::string> backup(const std::filesystem::path& file) override;
+
+private:
+	void record(ChangeType type, TaskID taskID = NO_PARENT);
+
+	Database* m_database;
+
+	std::int64_t m_epoch;
+	std::size_t m_capacity;
+
+	std::int64_t m_sequence = 0;
+	// changes up to this sequence number have been dropped from the log
+	std::int64_t m_dropped = 0;
+
+	std::deque<Change> m_changes;
+};
@@ -1,10 +1,18 @@
 #include "database.hpp"
 #include "api.hpp"
+#include "backup.hpp"
+#include "statistics.hpp"
+#include "trace.hpp"
+#include "snapshot.hpp"
 
 #include <format>
 #include <fstream>
 
+#include <SQLiteCpp/Backup.h>
+
 #include "packets/error.hpp"
+#include "packets/packet_builder.hpp"
+#include "packets/packet_parser.hpp"
 
 #ifdef TG_ENABLE_LOG_STATEMENTS
 extern std::ofstream logfile;
@@ -16,8 +24,18 @@ extern std::ofstream logfile;
 * 1 = 0.3.3
 * 2 = 0.4.0
 * 3 = 0.14.1
+* 4 = after 0.14.1
+* 5 = archived task images with 4 byte string lengths
 */
-static constexpr std::int32_t CURRENT_DATABASE_VERSION = 3;
+static constexpr std::int32_t CURRENT_DATABASE_VERSION = 5;
+
+// ImageFormat of the archived task images written before version 5, their strings have 2 byte lengths
+static constexpr std::int32_t SHORT_STRING_IMAGE_FORMAT = 1;
+static constexpr std::int32_t ARCHIVED_IMAGE_FORMAT = 2;
+
+// without WAL the backup has to wait for commits to finish
+static constexpr int BACKUP_BUSY_TIMEOUT_MS = 5000;
+static constexpr auto BACKUP_RETRY_PAUSE = std::chrono::milliseconds(5);
 
 static std::vector<std::string> split(const std::string& s, char delim) {
 	std::vector<std::string> result;
@@ -31,20 +49,48 @@ static std::vector<std::string> split(const std::string& s, char delim) {
 	return result;
 }
 
-DatabaseImpl::DatabaseImpl(const std::string& file, PacketSender& sender)
+struct DurabilitySettings
+{
+	std::string_view synchronous;
+	// negative sizes are in KiB
+	int cacheSize;
+	std::int64_t mmapSize;
+	std::string_view tempStore;
+	std::chrono::seconds checkpointInterval;
+};
+
+static DurabilitySettings durability_settings(DurabilityProfile durability)
+{
+	switch (durability)
+	{
+	case DurabilityProfile::SAFE:
+		return { "FULL", -8 * 1024, 0, "DEFAULT", std::chrono::seconds(5) };
+	case DurabilityProfile::BALANCED:
+		return { "NORMAL", -32 * 1024, 256ll * 1024 * 1024, "MEMORY", std::chrono::seconds(30) };
+	case DurabilityProfile::FAST:
+		break;
+	}
+	return { "OFF", -64 * 1024, 1024ll * 1024 * 1024, "MEMORY", std::chrono::seconds(60) };
+}
+
+DatabaseImpl::DatabaseImpl(const std::string& file, PacketSender& sender, DurabilityProfile durability)
 	: m_database(file, SQLite::OPEN_READWRITE | SQLite::OPEN_CREATE)
 {
 	try
 	{
-		m_database.exec("create table if not exists tasks (TaskID integer PRIMARY KEY, Name text, ParentID integer, State integer, CreateTime bigint, FinishTime bigint, Locked integer, ServerControlled integer, IndexInParent integer)");
+		configure(durability);
+
+		m_database.exec("create table if not exists tasks (TaskID integer PRIMARY KEY, Name text, ParentID integer, State integer, CreateTime bigint, FinishTime bigint, Locked integer, ServerControlled integer, IndexInParent integer, ChangeSeq integer default 0)");
 		m_database.exec("create table if not exists timeEntryCategory (TimeCategoryID integer PRIMARY KEY, TimeCategoryName text)");
 		m_database.exec("create table if not exists timeEntryCode (TimeCategoryID integer, TimeCodeID integer, TimeCodeName text, Archived integer, PRIMARY KEY (TimeCategoryID, TimeCodeID))");
 		m_database.exec("create table if not exists timeEntryTask (TaskID integer, TimeCategoryID integer, TimeCodeID integer, PRIMARY KEY (TaskID, TimeCategoryID))");
 		m_database.exec("create table if not exists timeEntrySession (TaskID integer, SessionIndex integer, TimeCategoryID integer, TimeCodeID integer, StartTime bigint, StopTime bigint, PRIMARY KEY (TaskID, SessionIndex, TimeCategoryID))");
-		m_database.exec("create table if not exists bugzilla (BugzillaInstanceID integer PRIMARY KEY, Name text, URL text, APIKey text, UserName text, RootTaskID integer, LastRefresh bigint)");
+		m_database.exec("create table if not exists bugzilla (BugzillaInstanceID integer PRIMARY KEY, Name text, URL text, APIKey text, UserName text, RootTaskID integer, LastRefresh bigint, ChangeSeq integer default 0)");
 		m_database.exec("create table if not exists bugzillaGroupBy (BugzillaInstanceID integer PRIMARY KEY, Field text)");
 		m_database.exec("create table if not exists bugzillaBugToTask (BugzillaInstanceID integer, BugID integer, TaskID integer, PRIMARY KEY (BugzillaInstanceID, BugID))");
 		m_database.exec("create table if not exists nextIDs (Name text PRIMARY KEY, ID integer)");
+		m_database.exec("create table if not exists backup (ID integer PRIMARY KEY, Location text, Frequency integer, Keep integer)");
+		m_database.exec("create table if not exists archivedTasks (TaskID integer PRIMARY KEY, ParentID integer, FinishTime bigint, Image blob, ChangeSeq integer, ImageFormat integer default 1)");
 
 		SQLite::Statement get_version(m_database, "PRAGMA user_version;");
 		get_version.executeStep();
@@ -83,8 +129,29 @@ DatabaseImpl::DatabaseImpl(const std::string& file, PacketSender& sender)
 			break;
 		}
 		}
+
+		// versions before 4 have all been through the cases above, each of which only handles the next version
+		if (version != 0 && version < 4)
+		{
+			// introduced a ChangeSeq column to the tasks and bugzilla tables so that loading a snapshot only reads newer rows
+			m_database.exec("alter table tasks add column ChangeSeq integer default 0");
+			m_database.exec("alter table bugzilla add column ChangeSeq integer default 0");
+		}
+
+		// the archive table is created above with the column when it didn't exist yet
+		if (version != 0 && version < 5 && m_database.execAndGet("select count(*) from pragma_table_info('archivedTasks') where name == 'ImageFormat'").getInt() == 0)
+		{
+			// introduced an ImageFormat column to the archived tasks. the images already there keep 2 byte string lengths
+			m_database.exec(std::format("alter table archivedTasks add column ImageFormat integer default {}", SHORT_STRING_IMAGE_FORMAT));
+		}
+
 		SQLite::Statement set_version(m_database, std::format("PRAGMA user_version={};", CURRENT_DATABASE_VERSION));
 		set_version.executeStep();
+
+		SQLite::Statement get_sequence(m_database, "select max(ChangeSeq) from (select ChangeSeq from tasks union all select ChangeSeq from bugzilla union all select ChangeSeq from archivedTasks)");
+		get_sequence.executeStep();
+
+		m_changeSequence = get_sequence.getColumn(0).getInt64();
 	}
 	catch (const std::exception& e)
 	{
@@ -92,16 +159,177 @@ DatabaseImpl::DatabaseImpl(const std::string& file, PacketSender& sender)
 	}
 }
 
+DatabaseImpl::~DatabaseImpl()
+{
+	if (m_checkpointThread.joinable())
+	{
+		{
+			std::lock_guard lock(m_checkpointMutex);
+			m_stopCheckpoints = true;
+		}
+		m_checkpointStop.notify_one();
+
+		m_checkpointThread.join();
+	}
+}
+
+void DatabaseImpl::configure(DurabilityProfile durability)
+{
+	const auto settings = durability_settings(durability);
+
+	// in-memory databases can't use WAL and stay on their memory journal
+	const bool wal = m_database.execAndGet("PRAGMA journal_mode=WAL;").getString() == "wal";
+
+	m_database.exec(std::format("PRAGMA synchronous={};", settings.synchronous));
+	m_database.exec(std::format("PRAGMA cache_size={};", settings.cacheSize));
+	m_database.exec(std::format("PRAGMA mmap_size={};", settings.mmapSize));
+	m_database.exec(std::format("PRAGMA temp_store={};", settings.tempStore));
+
+	if (wal)
+	{
+		// replaces the automatic checkpoint that would otherwise run as part of a commit
+		m_database.exec("PRAGMA wal_autocheckpoint=0;");
+
+		m_checkpointConnection = std::make_unique<SQLite::Database>(m_database.getFilename(), SQLite::OPEN_READWRITE);
+		m_checkpointThread = std::thread([this, interval = settings.checkpointInterval]() { run_checkpoints(interval); });
+	}
+}
+
+void DatabaseImpl::run_checkpoints(std::chrono::seconds interval)
+{
+	std::unique_lock lock(m_checkpointMutex);
+
+	while (!m_checkpointStop.wait_for(lock, interval, [this]() { return m_stopCheckpoints; }))
+	{
+		TG_TRACE_SPAN("checkpoint", "database");
+
+		// PASSIVE copies what it can without waiting on the writer. there's nowhere to report an error from this thread,
+		// the next checkpoint will try again
+		try
+		{
+			m_checkpointConnection->exec("PRAGMA wal_checkpoint(PASSIVE);");
+		}
+		catch (const std::exception&)
+		{
+		}
+	}
+}
+
 void DatabaseImpl::load(Bugzilla& bugzilla, MicroTask& app, API& api)
 {
+	DatabaseTimer timer;
+	TG_TRACE_SPAN("load", "database");
+
 	load_time_entry(app);
-	load_tasks(app);
-	load_bugzilla_instances(bugzilla, app);
+
+	std::map<TaskID, Task> tasks;
+	std::map<BugzillaInstanceID, BugzillaInstance> instances;
+
+	// everything is read from the database unless there's a snapshot
+	std::int64_t sequence = -1;
+
+	if (!m_snapshotFile.empty())
+	{
+		auto snapshot = load_snapshot(m_snapshotFile, app.timeCategories());
+
+		// a snapshot newer than the database belongs to a different copy of it, e.g. one restored from a backup
+		if (snapshot && snapshot->sequence <= m_changeSequence)
+		{
+			sequence = snapshot->sequence;
+
+			for (auto&& task : snapshot->tasks)
+			{
+				tasks.emplace(task.taskID(), std::move(task));
+			}
+
+			for (auto&& instance : snapshot->instances)
+			{
+				instances.emplace(instance.instanceID, std::move(instance));
+			}
+
+			// tasks archived after the snapshot was written are still in it
+			SQLite::Statement query_archived(m_database, "SELECT TaskID FROM archivedTasks WHERE ChangeSeq > ?");
+			query_archived.bind(1, sequence);
+
+			while (query_archived.executeStep())
+			{
+				tasks.erase(TaskID(query_archived.getColumn(0).getInt()));
+			}
+		}
+	}
+
+	const auto sessionCutoff = app.session_cutoff();
+
+	load_tasks(app, tasks, sequence, sessionCutoff);
+	load_bugzilla_instances(instances, sequence);
+
+	for (auto&& [id, task] : tasks)
+	{
+		// the snapshot has whatever sessions were in memory when it was written
+		if (sessionCutoff && MicroTask::sessions_are_cold(task, sessionCutoff.value()))
+		{
+			task.m_times.clear();
+			task.sessionsLoaded = false;
+		}
+		else if (!task.sessionsLoaded)
+		{
+			task.m_times = query_sessions(id, app.timeCategories());
+			task.sessionsLoaded = true;
+		}
+
+		app.load_task(task);
+	}
+
+	for (auto&& [id, instance] : instances)
+	{
+		bugzilla.load_instance(instance);
+	}
+
 	load_next_ids(bugzilla, app);
+	load_backup_configuration(api);
 }
 
 void DatabaseImpl::write_task(const Task& task, PacketSender& sender)
 {
+	DatabaseTimer timer;
+	TG_TRACE_SPAN("write_task", "database");
+
+	bool using_transaction = false;
+
+	if (!m_transaction_in_progress)
+	{
+		start_transaction(sender);
+		using_transaction = true;
+	}
+
+	write_task_row(task, sender);
+	write_task_time_entry(task, sender);
+	write_sessions(task, sender);
+
+	if (using_transaction)
+	{
+		finish_transaction(sender);
+	}
+}
+
+void DatabaseImpl::write_event(const TaskEvent& event, const Task& task, PacketSender& sender)
+{
+	if (event.type == TaskEventType::UPDATED)
+	{
+		write_task(task, sender);
+		return;
+	}
+
+	const bool hasSession = event.session >= 0 && static_cast<std::size_t>(event.session) < task.m_times.size();
+
+	write_task_change(task, event.session, hasSession ? &task.m_times[event.session] : nullptr, sender);
+}
+
+void DatabaseImpl::write_task_change(const Task& task, std::int32_t sessionIndex, const TaskTimes* session, PacketSender& sender)
+{
+	DatabaseTimer timer;
+	TG_TRACE_SPAN("write_task_change", "database");
+
 	bool using_transaction = false;
 
 	if (!m_transaction_in_progress)
@@ -110,9 +338,25 @@ void DatabaseImpl::write_task(const Task& task, PacketSender& sender)
 		using_transaction = true;
 	}
 
-	SQLite::Statement insert(m_database, "insert or replace into tasks values(?, ?, ?, ?, ?, ?, ?, ?, ?)");
+	write_task_row(task, sender);
+	write_task_time_entry(task, sender);
+
+	if (session)
+	{
+		write_session_row(task.taskID(), sessionIndex, *session, sender);
+	}
+
+	if (using_transaction)
+	{
+		finish_transaction(sender);
+	}
+}
+
+void DatabaseImpl::write_task_row(const Task& task, PacketSender& sender)
+{
+	SQLite::Statement insert(m_database, "insert or replace into tasks values(?, ?, ?, ?, ?, ?, ?, ?, ?, ?)");
 	insert.bind(1, task.taskID()._val);
-	insert.bind(2, task.m_name);
+	insert.bind(2, task.m_name.str());
 	insert.bind(3, task.parentID()._val);
 	insert.bind(4, static_cast<int>(task.state));
 	insert.bind(5, task.createTime().count());
@@ -120,6 +364,7 @@ void DatabaseImpl::write_task(const Task& task, PacketSender& sender)
 	insert.bind(7, task.locked);
 	insert.bind(8, task.serverControlled);
 	insert.bind(9, task.indexInParent);
+	insert.bind(10, ++m_changeSequence);
 
 	try
 	{
@@ -129,18 +374,12 @@ void DatabaseImpl::write_task(const Task& task, PacketSender& sender)
 	{
 		sender.send(std::make_unique<ErrorMessage>(e.what()));
 	}
-
-	write_task_time_entry(task, sender);
-	write_sessions(task, sender);
-
-	if (using_transaction)
-	{
-		finish_transaction(sender);
-	}
 }
 
 void DatabaseImpl::write_next_task_id(TaskID nextID, PacketSender& sender)
 {
+	DatabaseTimer timer;
+
 	SQLite::Statement insert(m_database, "insert or replace into nextIDs values ('task', ?)");
 	insert.bind(1, nextID._val);
 
@@ -156,7 +395,9 @@ void DatabaseImpl::write_next_task_id(TaskID nextID, PacketSender& sender)
 
 void DatabaseImpl::write_bugzilla_instance(const BugzillaInstance& instance, PacketSender& sender)
 {
-	SQLite::Statement insert(m_database, "insert or replace into bugzilla values(?, ?, ?, ?, ?, ?, ?)");
+	DatabaseTimer timer;
+
+	SQLite::Statement insert(m_database, "insert or replace into bugzilla values(?, ?, ?, ?, ?, ?, ?, ?)");
 	insert.bind(1, instance.instanceID._val);
 	insert.bind(2, instance.bugzillaName);
 	insert.bind(3, instance.bugzillaURL);
@@ -164,6 +405,7 @@ void DatabaseImpl::write_bugzilla_instance(const BugzillaInstance& instance, Pac
 	insert.bind(5, instance.bugzillaUsername);
 	insert.bind(6, instance.bugzillaRootTaskID._val);
 	insert.bind(7, instance.lastBugzillaRefresh.value_or(std::chrono::milliseconds(0)).count());
+	insert.bind(8, ++m_changeSequence);
 
 	try
 	{
@@ -180,6 +422,8 @@ void DatabaseImpl::write_bugzilla_instance(const BugzillaInstance& instance, Pac
 
 void DatabaseImpl::write_next_bugzilla_instance_id(BugzillaInstanceID nextID, PacketSender& sender)
 {
+	DatabaseTimer timer;
+
 	SQLite::Statement insert(m_database, "insert or replace into nextIDs values ('bugzilla', ?)");
 	insert.bind(1, nextID._val);
 
@@ -236,9 +480,36 @@ void DatabaseImpl::load_time_entry(MicroTask& app)
 	app.load_time_entry(timeCategories);
 }
 
-void DatabaseImpl::load_tasks(MicroTask& app)
+std::vector<TaskTimes> DatabaseImpl::load_sessions(TaskID task, const TimeCategories& timeCategories)
+{
+	DatabaseTimer timer;
+	TG_TRACE_SPAN("load_sessions", "database");
+
+	return query_sessions(task, timeCategories);
+}
+
+std::vector<TaskID> DatabaseImpl::find_tasks_with_sessions(std::chrono::milliseconds start, std::chrono::milliseconds end)
+{
+	DatabaseTimer timer;
+
+	// sessions without a stop time are still running
+	SQLite::Statement query(m_database, "SELECT DISTINCT TaskID FROM timeEntrySession WHERE StartTime < ? AND (StopTime >= ? OR StopTime == 0)");
+	query.bind(1, end.count());
+	query.bind(2, start.count());
+
+	std::vector<TaskID> tasks;
+
+	while (query.executeStep())
+	{
+		tasks.emplace_back(query.getColumn(0).getInt());
+	}
+	return tasks;
+}
+
+void DatabaseImpl::load_tasks(MicroTask& app, std::map<TaskID, Task>& tasks, std::int64_t afterSequence, std::optional<std::chrono::milliseconds> sessionCutoff)
 {
-	SQLite::Statement query(m_database, "SELECT * FROM tasks");
+	SQLite::Statement query(m_database, "SELECT * FROM tasks WHERE ChangeSeq > ?");
+	query.bind(1, afterSequence);
 	query.executeStep();
 
 	while (query.hasRow())
@@ -269,51 +540,67 @@ void DatabaseImpl::load_tasks(MicroTask& app)
 			int catID = query_time_entry.getColumn(1);
 			int codeID = query_time_entry.getColumn(2);
 
-			auto pair = app.timeCategories().find(TimeCategoryID(catID), TimeCodeID(codeID));
-			task.timeEntry.emplace_back(pair.first, pair.second);
+			task.timeEntry.push_back(app.timeCategories().find(TimeCategoryID(catID), TimeCodeID(codeID)));
 
 			query_time_entry.executeStep();
 		}
 
-		SQLite::Statement query_sessions(m_database, "SELECT * FROM timeEntrySession WHERE TaskID == ?; ORDER BY Index ASC;");
-		query_sessions.bind(1, taskID);
-		query_sessions.executeStep();
-
-		while (query_sessions.hasRow())
+		// old sessions are left in the database until they're needed
+		if (sessionCutoff && MicroTask::sessions_are_cold(task, sessionCutoff.value()))
 		{
-			int index = query_sessions.getColumn(1);
-			int catID = query_sessions.getColumn(2);
-			int codeID = query_sessions.getColumn(3);
-			std::int64_t start_time = query_sessions.getColumn(4);
-			std::int64_t stop_time = query_sessions.getColumn(5);
+			task.sessionsLoaded = false;
+		}
+		else
+		{
+			task.m_times = query_sessions(task.taskID(), app.timeCategories());
+		}
 
-			auto pair = app.timeCategories().find(TimeCategoryID(catID), TimeCodeID(codeID));
+		tasks.insert_or_assign(task.taskID(), std::move(task));
 
-			if (task.m_times.size() > index)
-			{
-				task.m_times.back().timeEntry.emplace_back(pair.first, pair.second);
-			}
-			else
-			{
-				TaskTimes times{ std::chrono::milliseconds(start_time) };
-				times.stop = stop_time == 0 ? std::nullopt : std::optional(std::chrono::milliseconds(stop_time));
-				times.timeEntry.emplace_back(pair.first, pair.second);
+		query.executeStep();
+	}
+}
 
-				task.m_times.push_back(times);
-			}
+std::vector<TaskTimes> DatabaseImpl::query_sessions(TaskID task, const TimeCategories& timeCategories)
+{
+	std::vector<TaskTimes> sessions;
+
+	SQLite::Statement query_sessions(m_database, "SELECT * FROM timeEntrySession WHERE TaskID == ?; ORDER BY Index ASC;");
+	query_sessions.bind(1, task._val);
+	query_sessions.executeStep();
+
+	while (query_sessions.hasRow())
+	{
+		int index = query_sessions.getColumn(1);
+		int catID = query_sessions.getColumn(2);
+		int codeID = query_sessions.getColumn(3);
+		std::int64_t start_time = query_sessions.getColumn(4);
+		std::int64_t stop_time = query_sessions.getColumn(5);
+
+		const TimeEntry entry = timeCategories.find(TimeCategoryID(catID), TimeCodeID(codeID));
 
-			query_sessions.executeStep();
+		if (sessions.size() > index)
+		{
+			sessions.back().timeEntry.push_back(entry);
 		}
+		else
+		{
+			TaskTimes times{ std::chrono::milliseconds(start_time) };
+			times.stop = stop_time == 0 ? std::nullopt : std::optional(std::chrono::milliseconds(stop_time));
+			times.timeEntry.push_back(entry);
 
-		app.load_task(task);
+			sessions.push_back(times);
+		}
 
-		query.executeStep();
+		query_sessions.executeStep();
 	}
+	return sessions;
 }
 
-void DatabaseImpl::load_bugzilla_instances(Bugzilla& bugzilla, MicroTask& app)
+void DatabaseImpl::load_bugzilla_instances(std::map<BugzillaInstanceID, BugzillaInstance>& instances, std::int64_t afterSequence)
 {
-	SQLite::Statement query_instances(m_database, "SELECT * FROM bugzilla");
+	SQLite::Statement query_instances(m_database, "SELECT * FROM bugzilla WHERE ChangeSeq > ?");
+	query_instances.bind(1, afterSequence);
 	query_instances.executeStep();
 
 	while (query_instances.hasRow())
@@ -362,7 +649,7 @@ void DatabaseImpl::load_bugzilla_instances(Bugzilla& bugzilla, MicroTask& app)
 			query_bug_to_task.executeStep();
 		}
 
-		bugzilla.load_instance(instance);
+		instances.insert_or_assign(instance.instanceID, std::move(instance));
 	}
 }
 
@@ -394,14 +681,29 @@ void DatabaseImpl::load_next_ids(Bugzilla& bugzilla, MicroTask& app)
 	}
 }
 
+void DatabaseImpl::load_backup_configuration(API& api)
+{
+	SQLite::Statement query(m_database, "SELECT * FROM backup");
+
+	if (query.executeStep())
+	{
+		BackupConfiguration configuration;
+		configuration.location = query.getColumn(1).getString();
+		configuration.frequency = std::chrono::minutes(query.getColumn(2).getInt());
+		configuration.keep = query.getColumn(3).getInt();
+
+		api.m_backup.configure(configuration);
+	}
+}
+
 void DatabaseImpl::write_task_time_entry(const Task& task, PacketSender& sender)
 {
 	for (const TimeEntry& entry : task.timeEntry)
 	{
 		SQLite::Statement insert(m_database, "insert or replace into timeEntryTask values(?, ?, ?)");
 		insert.bind(1, task.taskID()._val);
-		insert.bind(2, entry.category.id._val);
-		insert.bind(3, entry.code.id._val);
+		insert.bind(2, entry.categoryID._val);
+		insert.bind(3, entry.codeID._val);
 
 		execute_statement(insert, sender);
 	}
@@ -413,38 +715,46 @@ void DatabaseImpl::write_sessions(const Task& task, PacketSender& sender)
 
 	for (const TaskTimes& times : task.m_times)
 	{
-		if (times.timeEntry.empty())
-		{
-			SQLite::Statement insert(m_database, "insert or replace into timeEntrySession values(?, ?, ?, ?, ?, ?)");
-			insert.bind(1, task.taskID()._val);
-			insert.bind(2, index);
-			insert.bind(3, 0);
-			insert.bind(4, 0);
-			insert.bind(5, times.start.count());
-			insert.bind(6, times.stop.value_or(std::chrono::milliseconds(0)).count());
-
-			execute_statement(insert, sender);
-		}
-
-		for (const TimeEntry& entry : times.timeEntry)
-		{
-			SQLite::Statement insert(m_database, "insert or replace into timeEntrySession values(?, ?, ?, ?, ?, ?)");
-			insert.bind(1, task.taskID()._val);
-			insert.bind(2, index);
-			insert.bind(3, entry.category.id._val);
-			insert.bind(4, entry.code.id._val);
-			insert.bind(5, times.start.count());
-			insert.bind(6, times.stop.value_or(std::chrono::milliseconds(0)).count());
-			
-			execute_statement(insert, sender);
-		}
+		write_session_row(task.taskID(), index, times, sender);
 
 		index++;
 	}
 }
 
+void DatabaseImpl::write_session_row(TaskID task, std::int32_t index, const TaskTimes& times, PacketSender& sender)
+{
+	if (times.timeEntry.empty())
+	{
+		SQLite::Statement insert(m_database, "insert or replace into timeEntrySession values(?, ?, ?, ?, ?, ?)");
+		insert.bind(1, task._val);
+		insert.bind(2, index);
+		insert.bind(3, 0);
+		insert.bind(4, 0);
+		insert.bind(5, times.start.count());
+		insert.bind(6, times.stop.value_or(std::chrono::milliseconds(0)).count());
+
+		execute_statement(insert, sender);
+	}
+
+	for (const TimeEntry& entry : times.timeEntry)
+	{
+		SQLite::Statement insert(m_database, "insert or replace into timeEntrySession values(?, ?, ?, ?, ?, ?)");
+		insert.bind(1, task._val);
+		insert.bind(2, index);
+		insert.bind(3, entry.categoryID._val);
+		insert.bind(4, entry.codeID._val);
+		insert.bind(5, times.start.count());
+		insert.bind(6, times.stop.value_or(std::chrono::milliseconds(0)).count());
+
+		execute_statement(insert, sender);
+	}
+}
+
 void DatabaseImpl::remove_sessions(TaskID task, PacketSender& sender)
 {
+	DatabaseTimer timer;
+	TG_TRACE_SPAN("remove_sessions", "database");
+
 	SQLite::Statement remove(m_database, "delete from timeEntrySession where TaskID == ?");
 	remove.bind(1, task._val);
 
@@ -453,6 +763,8 @@ void DatabaseImpl::remove_sessions(TaskID task, PacketSender& sender)
 
 void DatabaseImpl::write_time_entry_config(const TimeCategory& entry, PacketSender& sender)
 {
+	DatabaseTimer timer;
+
 	SQLite::Statement insert_cat(m_database, "insert or replace into timeEntryCategory values (?, ?)");
 	insert_cat.bind(1, entry.id._val);
 	insert_cat.bind(2, entry.name);
@@ -474,6 +786,8 @@ void DatabaseImpl::write_time_entry_config(const TimeCategory& entry, PacketSend
 
 void DatabaseImpl::write_next_time_category_id(TimeCategoryID nextID, PacketSender& sender)
 {
+	DatabaseTimer timer;
+
 	SQLite::Statement insert(m_database, "insert or replace into nextIDs values ('category', ?)");
 	insert.bind(1, nextID._val);
 
@@ -482,6 +796,8 @@ void DatabaseImpl::write_next_time_category_id(TimeCategoryID nextID, PacketSend
 
 void DatabaseImpl::write_next_time_code_id(TimeCodeID nextID, PacketSender& sender)
 {
+	DatabaseTimer timer;
+
 	SQLite::Statement insert(m_database, "insert or replace into nextIDs values ('code', ?)");
 	insert.bind(1, nextID._val);
 
@@ -490,6 +806,8 @@ void DatabaseImpl::write_next_time_code_id(TimeCodeID nextID, PacketSender& send
 
 void DatabaseImpl::remove_time_category(const TimeCategory& entry, PacketSender& sender)
 {
+	DatabaseTimer timer;
+
 	SQLite::Statement remove_cat(m_database, "delete from timeEntryCategory where TimeCategoryID == ?");
 	remove_cat.bind(1, entry.id._val);
 
@@ -503,14 +821,113 @@ void DatabaseImpl::remove_time_category(const TimeCategory& entry, PacketSender&
 
 void DatabaseImpl::remove_time_code(const TimeCategory& entry, const TimeCode& code, PacketSender& sender)
 {
+	DatabaseTimer timer;
+
 	SQLite::Statement remove_code(m_database, "delete from timeEntryCode where TimeCodeID == ?");
 	remove_code.bind(1, code.id._val);
 
 	execute_statement(remove_code, sender);
 }
 
+void DatabaseImpl::write_backup_configuration(const BackupConfiguration& configuration, PacketSender& sender)
+{
+	DatabaseTimer timer;
+
+	SQLite::Statement insert(m_database, "insert or replace into backup values (0, ?, ?, ?)");
+	insert.bind(1, configuration.location);
+	insert.bind(2, static_cast<int>(configuration.frequency.count()));
+	insert.bind(3, configuration.keep);
+
+	execute_statement(insert, sender);
+}
+
+void DatabaseImpl::archive_tasks(const std::vector<Task>& tasks, PacketSender& sender)
+{
+	DatabaseTimer timer;
+	TG_TRACE_SPAN("archive_tasks", "database");
+
+	bool using_transaction = false;
+
+	if (!m_transaction_in_progress)
+	{
+		start_transaction(sender);
+		using_transaction = true;
+	}
+
+	const StringLengthScope strings(PERSISTED_STRING_LENGTH);
+
+	for (const Task& task : tasks)
+	{
+		PacketBuilder image;
+		add_task_image(image, task);
+
+		SQLite::Statement insert(m_database, "insert or replace into archivedTasks values(?, ?, ?, ?, ?, ?)");
+		insert.bind(1, task.taskID()._val);
+		insert.bind(2, task.parentID()._val);
+		insert.bind(3, task.m_finishTime.value_or(std::chrono::milliseconds(0)).count());
+		insert.bind(4, image.bytes().data(), static_cast<int>(image.bytes().size()));
+		insert.bind(5, ++m_changeSequence);
+		insert.bind(6, ARCHIVED_IMAGE_FORMAT);
+
+		execute_statement(insert, sender);
+
+		for (std::string_view table : { "tasks", "timeEntryTask", "timeEntrySession" })
+		{
+			SQLite::Statement remove(m_database, std::format("delete from {} where TaskID == ?", table));
+			remove.bind(1, task.taskID()._val);
+
+			execute_statement(remove, sender);
+		}
+	}
+
+	if (using_transaction)
+	{
+		finish_transaction(sender);
+	}
+}
+
+std::vector<Task> DatabaseImpl::load_archived_tasks(TaskID parent, const TimeCategories& timeCategories, PacketSender& sender)
+{
+	DatabaseTimer timer;
+	TG_TRACE_SPAN("load_archived_tasks", "database");
+
+	// a subtree can be archived before its parent is, follow the parent IDs through the archive
+	SQLite::Statement query(m_database,
+		"WITH RECURSIVE below(TaskID, Depth) AS ("
+		"SELECT TaskID, 0 FROM archivedTasks WHERE ParentID == ? "
+		"UNION ALL SELECT archivedTasks.TaskID, below.Depth + 1 FROM archivedTasks JOIN below ON archivedTasks.ParentID == below.TaskID) "
+		"SELECT TaskID, Image, ImageFormat FROM archivedTasks JOIN below USING (TaskID) ORDER BY Depth, TaskID");
+	query.bind(1, parent._val);
+
+	std::vector<Task> tasks;
+
+	while (query.executeStep())
+	{
+		const auto image = query.getColumn(1);
+
+		const StringLengthScope strings(query.getColumn(2).getInt() == SHORT_STRING_IMAGE_FORMAT ? StringLength::SHORT : PERSISTED_STRING_LENGTH);
+
+		auto parser = PacketParser(std::span(static_cast<const std::byte*>(image.getBlob()), image.getBytes()));
+
+		Task task = parse_task_image(parser, timeCategories);
+
+		if (parser.error())
+		{
+			sender.send(std::make_unique<ErrorMessage>(std::format("Failed to read archived task {}", query.getColumn(0).getInt())));
+		}
+		else
+		{
+			tasks.push_back(std::move(task));
+		}
+	}
+	return tasks;
+}
+
 void DatabaseImpl::start_transaction(PacketSender& sender)
 {
+	DatabaseTimer timer;
+	TG_TRACE_SPAN("start_transaction", "database");
+
 	SQLite::Statement start(m_database, "BEGIN TRANSACTION;");
 
 	if (execute_statement(start, sender))
@@ -521,6 +938,9 @@ void DatabaseImpl::start_transaction(PacketSender& sender)
 
 void DatabaseImpl::finish_transaction(PacketSender& sender)
 {
+	DatabaseTimer timer;
+	TG_TRACE_SPAN("commit", "database");
+
 	SQLite::Statement finish(m_database, "COMMIT;");
 
 	if (execute_statement(finish, sender))
@@ -529,6 +949,73 @@ void DatabaseImpl::finish_transaction(PacketSender& sender)
 	}
 }
 
+void DatabaseImpl::write_snapshot(MicroTask& app, const Bugzilla& bugzilla, PacketSender& sender)
+{
+	if (m_snapshotFile.empty())
+	{
+		return;
+	}
+
+	TG_TRACE_SPAN("write_snapshot", "database");
+
+	const auto bytes = build_snapshot(m_changeSequence, app, bugzilla);
+
+	if (!save_snapshot(m_snapshotFile, bytes))
+	{
+		sender.send(std::make_unique<ErrorMessage>("Failed to write snapshot to " + m_snapshotFile));
+	}
+}
+
+std::optional<std::string> DatabaseImpl::backup(const std::filesystem::path& file)
+{
+	TG_TRACE_SPAN("backup", "database");
+
+	const std::string source = m_database.getFilename();
+
+	// another connection to an in-memory database opens a new, empty database
+	if (source.empty() || source == ":memory:")
+	{
+		return "In-memory databases can't be backed up.";
+	}
+
+	// the backup only appears under its real name once it's complete
+	auto temp = file;
+	temp += ".tmp";
+
+	try
+	{
+		{
+			// the copy is made from a connection of its own in a single step. with WAL that's one read transaction that
+			// never waits for the main connection or makes it wait
+			SQLite::Database reader(source, SQLite::OPEN_READONLY, BACKUP_BUSY_TIMEOUT_MS);
+			SQLite::Database destination(temp.string(), SQLite::OPEN_READWRITE | SQLite::OPEN_CREATE);
+			SQLite::Backup backup(destination, reader);
+
+			// a busy step copies nothing and is tried again
+			while (true)
+			{
+				backup.executeStep();
+
+				if (backup.getTotalPageCount() > 0 && backup.getRemainingPageCount() == 0)
+				{
+					break;
+				}
+				std::this_thread::sleep_for(BACKUP_RETRY_PAUSE);
+			}
+		}
+
+		std::filesystem::rename(temp, file);
+	}
+	catch (const std::exception& e)
+	{
+		std::error_code error;
+		std::filesystem::remove(temp, error);
+
+		return e.what();
+	}
+	return std::nullopt;
+}
+
 bool DatabaseImpl::transaction_in_progress() const
 {
 	return m_transaction_in_progress;
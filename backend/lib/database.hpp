@@ -9,11 +9,24 @@
 #include <SQLiteCpp/Database.h>
 
 #include "packet_sender.hpp"
-
-
+#include "task_event.hpp"
+
+#include <chrono>
+#include <condition_variable>
+#include <filesystem>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+
+struct BackupConfiguration;
 struct BugzillaInstance;
 struct TaskTimes;
 struct TimeCategory;
+struct TimeCategories;
 
 class Task;
 class Bugzilla;
@@ -26,10 +39,28 @@ struct Database
 
 	virtual void load(Bugzilla& bugzilla, MicroTask& app, API& api) = 0;
 
+	// sessions of tasks loaded without them, see SessionHistory
+	virtual std::vector<TaskTimes> load_sessions(TaskID task, const TimeCategories& timeCategories) = 0;
+	virtual std::vector<TaskID> find_tasks_with_sessions(std::chrono::milliseconds start, std::chrono::milliseconds end) = 0;
+
+	// the sessions of the task are about to be dropped from memory and will be loaded from here when they're needed
+	// again. changes to them that are only held somewhere else have to be written now
+	virtual void evicting_sessions(const Task& task, PacketSender& sender) {}
+	// the task has writes that reads can't see yet, like the ones held back by a transaction. its sessions have to stay
+	// in memory until they're committed
+	virtual bool has_uncommitted_writes(TaskID task) const { return false; }
+
 	// write task
 	virtual void write_task(const Task& task, PacketSender& sender) = 0;
 	virtual void write_next_task_id(TaskID nextID, PacketSender& sender) = 0;
 
+	// task has already been changed by the event. by default the whole task is written
+	virtual void write_event(const TaskEvent& event, const Task& task, PacketSender& sender) { write_task(task, sender); }
+
+	// the task without its sessions and the one session an event changed, nullptr when it didn't change one. lets a
+	// writer that has to copy the task leave the other sessions behind
+	virtual void write_task_change(const Task& task, std::int32_t sessionIndex, const TaskTimes* session, PacketSender& sender) { write_task(task, sender); }
+
 	// write bugzilla config
 	virtual void write_bugzilla_instance(const BugzillaInstance& instance, PacketSender& sender) = 0;
 	virtual void write_next_bugzilla_instance_id(BugzillaInstanceID nextID, PacketSender& sender) = 0;
@@ -52,24 +83,68 @@ struct Database
 	virtual void remove_time_category(const TimeCategory& entry, PacketSender& sender) = 0;
 	virtual void remove_time_code(const TimeCategory& entry, const TimeCode& code, PacketSender& sender) = 0;
 
+	virtual void write_backup_configuration(const BackupConfiguration& configuration, PacketSender& sender) = 0;
+
+	// move finished subtrees out of the task tables, parents first. the tasks must have their sessions loaded
+	virtual void archive_tasks(const std::vector<Task>& tasks, PacketSender& sender) = 0;
+	// every archived task below the parent, parents first
+	virtual std::vector<Task> load_archived_tasks(TaskID parent, const TimeCategories& timeCategories, PacketSender& sender) = 0;
+
 	virtual void start_transaction(PacketSender& sender) = 0;
 	virtual void finish_transaction(PacketSender& sender) = 0;
 
 	virtual bool transaction_in_progress() const = 0;
+
+	// block until every write made so far has been committed
+	virtual void flush(PacketSender& sender) = 0;
+
+	// save the in-memory state so that the next load can skip most of the queries
+	virtual void write_snapshot(MicroTask& app, const Bugzilla& bugzilla, PacketSender& sender) = 0;
+
+	// copy the database to the file while it's still in use. called from the backup thread, returns the error if the backup failed
+	virtual std::optional<std::string> backup(const std::filesystem::path& file) = 0;
+};
+
+// how much recent work can be lost to a power failure in exchange for faster commits. every profile uses WAL,
+// a crash never corrupts the database, at worst the most recent commits are lost
+enum class DurabilityProfile
+{
+	SAFE, // every commit is synced to disk
+	BALANCED, // commits are synced at checkpoints
+	FAST, // syncing is left to the OS
 };
 
+// used by the server unless --durability picks another
+inline constexpr DurabilityProfile DEFAULT_DURABILITY = DurabilityProfile::BALANCED;
+
 struct DatabaseImpl : Database
 {
-	DatabaseImpl(const std::string& file, PacketSender& sender);
+	DatabaseImpl(const std::string& file, PacketSender& sender, DurabilityProfile durability = DEFAULT_DURABILITY);
+	~DatabaseImpl() override;
+
+	DatabaseImpl(const DatabaseImpl&) = delete;
+	DatabaseImpl& operator=(const DatabaseImpl&) = delete;
 
 	SQLite::Database& database() { return m_database; }
 
+	// load from and write snapshots to this file. must be set before loading
+	void snapshot_file(const std::string& file) { m_snapshotFile = file; }
+
+	std::int64_t change_sequence() const { return m_changeSequence; }
+
 	void load(Bugzilla& bugzilla, MicroTask& app, API& api) override;
 
+	std::vector<TaskTimes> load_sessions(TaskID task, const TimeCategories& timeCategories) override;
+	std::vector<TaskID> find_tasks_with_sessions(std::chrono::milliseconds start, std::chrono::milliseconds end) override;
+
 	// write task
 	void write_task(const Task& task, PacketSender& sender) override;
 	void write_next_task_id(TaskID nextID, PacketSender& sender) override;
 
+	// only the task row and the session the event changed, everything but UPDATED leaves the other sessions alone
+	void write_event(const TaskEvent& event, const Task& task, PacketSender& sender) override;
+	void write_task_change(const Task& task, std::int32_t sessionIndex, const TaskTimes* session, PacketSender& sender) override;
+
 	// write bugzilla config
 	void write_bugzilla_instance(const BugzillaInstance& instance, PacketSender& sender) override;
 	void write_next_bugzilla_instance_id(BugzillaInstanceID nextID, PacketSender& sender) override;
@@ -92,25 +167,58 @@ struct DatabaseImpl : Database
 	void remove_time_category(const TimeCategory& entry, PacketSender& sender) override;
 	void remove_time_code(const TimeCategory& entry, const TimeCode& code, PacketSender& sender) override;
 
+	void write_backup_configuration(const BackupConfiguration& configuration, PacketSender& sender) override;
+
+	// archived tasks are stored as task images, they're never loaded with the rest of the tasks
+	void archive_tasks(const std::vector<Task>& tasks, PacketSender& sender) override;
+	std::vector<Task> load_archived_tasks(TaskID parent, const TimeCategories& timeCategories, PacketSender& sender) override;
+
 	void start_transaction(PacketSender& sender) override;
 	void finish_transaction(PacketSender& sender) override;
 
 	bool transaction_in_progress() const override;
 
+	// every write is committed before returning
+	void flush(PacketSender& sender) override {}
+
+	void write_snapshot(MicroTask& app, const Bugzilla& bugzilla, PacketSender& sender) override;
+
+	// uses the online backup API from a read-only connection of its own, the main connection isn't touched and can keep
+	// being used while the backup runs. in-memory databases can't be backed up
+	std::optional<std::string> backup(const std::filesystem::path& file) override;
+
 private:
 	void load_time_entry(MicroTask& app);
-	void load_tasks(MicroTask& app);
-	void load_bugzilla_instances(Bugzilla& bugzilla, MicroTask& app);
+	void load_backup_configuration(API& api);
+	void load_tasks(MicroTask& app, std::map<TaskID, Task>& tasks, std::int64_t afterSequence, std::optional<std::chrono::milliseconds> sessionCutoff);
+	std::vector<TaskTimes> query_sessions(TaskID task, const TimeCategories& timeCategories);
+	void load_bugzilla_instances(std::map<BugzillaInstanceID, BugzillaInstance>& instances, std::int64_t afterSequence);
 	void load_next_ids(Bugzilla& bugzilla, MicroTask& app);
 
+	void write_task_row(const Task& task, PacketSender& sender);
 	void write_task_time_entry(const Task& task, PacketSender& sender);
 	void write_sessions(const Task& task, PacketSender& sender);
+	void write_session_row(TaskID task, std::int32_t index, const TaskTimes& times, PacketSender& sender);
 
 	void write_bugzilla_group_by(const BugzillaInstance& instance, PacketSender& sender);
 	void write_bugzilla_bug_to_task(const BugzillaInstance& instance, PacketSender& sender);
 
 	bool execute_statement(SQLite::Statement& statement, PacketSender& sender);
 
+	void configure(DurabilityProfile durability);
+	void run_checkpoints(std::chrono::seconds interval);
+
 	SQLite::Database m_database;
 	bool m_transaction_in_progress = false;
+
+	// every task and bugzilla instance row is stamped with the sequence number of the write that changed it last
+	std::int64_t m_changeSequence = 0;
+	std::string m_snapshotFile;
+
+	// checkpoints run on their own connection so that commits never wait for the WAL to be copied back
+	std::unique_ptr<SQLite::Database> m_checkpointConnection;
+	std::thread m_checkpointThread;
+	std::mutex m_checkpointMutex;
+	std::condition_variable m_checkpointStop;
+	bool m_stopCheckpoints = false;
 };
\ No newline at end of file
@@ -0,0 +1,404 @@
+#include "database_writer.hpp"
+#include "api.hpp"
+#include "backup.hpp"
+#include "statistics.hpp"
+#include "trace.hpp"
+
+#include "packets/error.hpp"
+
+DatabaseWriter::DatabaseWriter(Database& database, CommitWindow window)
+	: m_database(&database),
+	m_window(window)
+{
+	m_thread = std::thread([this]() { run(); });
+}
+
+DatabaseWriter::~DatabaseWriter()
+{
+	{
+		std::lock_guard lock(m_mutex);
+
+		// anything held back by an unfinished transaction is still written
+		for (auto&& record : m_transactionRecords)
+		{
+			m_queue.push_back(std::move(record));
+		}
+		m_stop = true;
+	}
+	m_recordQueued.notify_one();
+
+	m_thread.join();
+}
+
+void DatabaseWriter::load(Bugzilla& bugzilla, MicroTask& app, API& api)
+{
+	std::lock_guard lock(m_databaseMutex);
+
+	m_database->load(bugzilla, app, api);
+}
+
+std::vector<TaskTimes> DatabaseWriter::load_sessions(TaskID task, const TimeCategories& timeCategories)
+{
+	wait_for_writes();
+
+	std::lock_guard lock(m_databaseMutex);
+
+	return m_database->load_sessions(task, timeCategories);
+}
+
+std::vector<TaskID> DatabaseWriter::find_tasks_with_sessions(std::chrono::milliseconds start, std::chrono::milliseconds end)
+{
+	wait_for_writes();
+
+	std::lock_guard lock(m_databaseMutex);
+
+	return m_database->find_tasks_with_sessions(start, end);
+}
+
+void DatabaseWriter::write_task(const Task& task, PacketSender& sender)
+{
+	m_errors.forward(sender);
+
+	// the task can change before the writer gets to it, write the state it was in when this was called
+	queue([task](Database& database, PacketSender& errors) { database.write_task(task, errors); }, task.taskID());
+}
+
+void DatabaseWriter::write_event(const TaskEvent& event, const Task& task, PacketSender& sender)
+{
+	if (event.type == TaskEventType::UPDATED)
+	{
+		write_task(task, sender);
+		return;
+	}
+
+	const bool hasSession = event.session >= 0 && static_cast<std::size_t>(event.session) < task.m_times.size();
+
+	write_task_change(task, event.session, hasSession ? &task.m_times[event.session] : nullptr, sender);
+}
+
+void DatabaseWriter::write_task_change(const Task& task, std::int32_t sessionIndex, const TaskTimes* session, PacketSender& sender)
+{
+	m_errors.forward(sender);
+
+	// starting and stopping shouldn't copy every session the task has
+	std::optional<TaskTimes> changed;
+
+	if (session)
+	{
+		changed = *session;
+	}
+
+	queue([task = task.without_sessions(), sessionIndex, changed](Database& database, PacketSender& errors)
+	{
+		database.write_task_change(task, sessionIndex, changed ? &*changed : nullptr, errors);
+	}, task.taskID());
+}
+
+void DatabaseWriter::write_next_task_id(TaskID nextID, PacketSender& sender)
+{
+	m_errors.forward(sender);
+
+	queue([nextID](Database& database, PacketSender& errors) { database.write_next_task_id(nextID, errors); });
+}
+
+void DatabaseWriter::write_bugzilla_instance(const BugzillaInstance& instance, PacketSender& sender)
+{
+	m_errors.forward(sender);
+
+	queue([instance](Database& database, PacketSender& errors) { database.write_bugzilla_instance(instance, errors); });
+}
+
+void DatabaseWriter::write_next_bugzilla_instance_id(BugzillaInstanceID nextID, PacketSender& sender)
+{
+	m_errors.forward(sender);
+
+	queue([nextID](Database& database, PacketSender& errors) { database.write_next_bugzilla_instance_id(nextID, errors); });
+}
+
+void DatabaseWriter::remove_bugzilla_instance(int ID)
+{
+	queue([ID](Database& database, PacketSender&) { database.remove_bugzilla_instance(ID); });
+}
+
+void DatabaseWriter::bugzilla_refreshed(int ID)
+{
+	queue([ID](Database& database, PacketSender&) { database.bugzilla_refreshed(ID); });
+}
+
+void DatabaseWriter::write_session(TaskID task, const TaskTimes& session, PacketSender& sender)
+{
+	m_errors.forward(sender);
+
+	queue([task, session](Database& database, PacketSender& errors) { database.write_session(task, session, errors); }, task);
+}
+
+void DatabaseWriter::remove_sessions(TaskID task, PacketSender& sender)
+{
+	m_errors.forward(sender);
+
+	queue([task](Database& database, PacketSender& errors) { database.remove_sessions(task, errors); }, task);
+}
+
+void DatabaseWriter::write_time_entry(TaskID task, PacketSender& sender)
+{
+	m_errors.forward(sender);
+
+	queue([task](Database& database, PacketSender& errors) { database.write_time_entry(task, errors); });
+}
+
+void DatabaseWriter::remove_time_entry()
+{
+	queue([](Database& database, PacketSender&) { database.remove_time_entry(); });
+}
+
+void DatabaseWriter::write_time_entry_config(const TimeCategory& entry, PacketSender& sender)
+{
+	m_errors.forward(sender);
+
+	queue([entry](Database& database, PacketSender& errors) { database.write_time_entry_config(entry, errors); });
+}
+
+void DatabaseWriter::write_next_time_category_id(TimeCategoryID nextID, PacketSender& sender)
+{
+	m_errors.forward(sender);
+
+	queue([nextID](Database& database, PacketSender& errors) { database.write_next_time_category_id(nextID, errors); });
+}
+
+void DatabaseWriter::write_next_time_code_id(TimeCodeID nextID, PacketSender& sender)
+{
+	m_errors.forward(sender);
+
+	queue([nextID](Database& database, PacketSender& errors) { database.write_next_time_code_id(nextID, errors); });
+}
+
+void DatabaseWriter::remove_time_category(const TimeCategory& entry, PacketSender& sender)
+{
+	m_errors.forward(sender);
+
+	queue([entry](Database& database, PacketSender& errors) { database.remove_time_category(entry, errors); });
+}
+
+void DatabaseWriter::remove_time_code(const TimeCategory& entry, const TimeCode& code, PacketSender& sender)
+{
+	m_errors.forward(sender);
+
+	queue([entry, code](Database& database, PacketSender& errors) { database.remove_time_code(entry, code, errors); });
+}
+
+void DatabaseWriter::write_backup_configuration(const BackupConfiguration& configuration, PacketSender& sender)
+{
+	m_errors.forward(sender);
+
+	queue([configuration](Database& database, PacketSender& errors) { database.write_backup_configuration(configuration, errors); });
+}
+
+void DatabaseWriter::archive_tasks(const std::vector<Task>& tasks, PacketSender& sender)
+{
+	m_errors.forward(sender);
+
+	queue([tasks](Database& database, PacketSender& errors) { database.archive_tasks(tasks, errors); });
+}
+
+std::vector<Task> DatabaseWriter::load_archived_tasks(TaskID parent, const TimeCategories& timeCategories, PacketSender& sender)
+{
+	flush(sender);
+
+	std::lock_guard lock(m_databaseMutex);
+
+	return m_database->load_archived_tasks(parent, timeCategories, sender);
+}
+
+void DatabaseWriter::start_transaction(PacketSender& sender)
+{
+	m_errors.forward(sender);
+
+	m_transaction = true;
+}
+
+void DatabaseWriter::finish_transaction(PacketSender& sender)
+{
+	m_errors.forward(sender);
+
+	m_transaction = false;
+	m_transactionTasks.clear();
+
+	// queued together so that the writer commits them in the same transaction
+	queue(m_transactionRecords);
+}
+
+bool DatabaseWriter::has_uncommitted_writes(TaskID task) const
+{
+	return m_transactionTasks.contains(task);
+}
+
+bool DatabaseWriter::transaction_in_progress() const
+{
+	return m_transaction;
+}
+
+void DatabaseWriter::flush(PacketSender& sender)
+{
+	wait_for_writes();
+
+	m_errors.forward(sender);
+}
+
+void DatabaseWriter::wait_for_writes()
+{
+	std::unique_lock lock(m_mutex);
+
+	const std::size_t target = m_queuedCount;
+
+	m_flushRequested = true;
+	m_recordQueued.notify_one();
+
+	m_recordsCommitted.wait(lock, [&]() { return m_committedCount >= target; });
+}
+
+void DatabaseWriter::write_snapshot(MicroTask& app, const Bugzilla& bugzilla, PacketSender& sender)
+{
+	flush(sender);
+
+	std::lock_guard lock(m_databaseMutex);
+
+	m_database->write_snapshot(app, bugzilla, sender);
+}
+
+std::optional<std::string> DatabaseWriter::backup(const std::filesystem::path& file)
+{
+	// the backup reads through its own connection, the writer thread and requests keep using this one
+	wait_for_writes();
+
+	return m_database->backup(file);
+}
+
+void DatabaseWriter::queue(Write write)
+{
+	Record record{ statistics().active_request(), std::move(write) };
+
+	if (m_transaction)
+	{
+		m_transactionRecords.push_back(std::move(record));
+		return;
+	}
+
+	{
+		std::lock_guard lock(m_mutex);
+
+		m_queue.push_back(std::move(record));
+		++m_queuedCount;
+	}
+	m_recordQueued.notify_one();
+}
+
+void DatabaseWriter::queue(Write write, TaskID task)
+{
+	if (m_transaction)
+	{
+		m_transactionTasks.insert(task);
+	}
+
+	queue(std::move(write));
+}
+
+void DatabaseWriter::queue(std::vector<Record>& records)
+{
+	if (records.empty())
+	{
+		return;
+	}
+
+	{
+		std::lock_guard lock(m_mutex);
+
+		for (auto&& record : records)
+		{
+			m_queue.push_back(std::move(record));
+		}
+		m_queuedCount += records.size();
+	}
+	m_recordQueued.notify_one();
+
+	records.clear();
+}
+
+void DatabaseWriter::run()
+{
+	std::unique_lock lock(m_mutex);
+
+	while (true)
+	{
+		m_recordQueued.wait(lock, [&]() { return m_stop || !m_queue.empty(); });
+
+		if (m_queue.empty())
+		{
+			break;
+		}
+
+		// give other writes a chance to join this transaction
+		m_recordQueued.wait_for(lock, m_window.time, [&]() { return m_stop || m_flushRequested || m_queue.size() >= m_window.records; });
+
+		std::vector<Record> records = std::move(m_queue);
+		m_queue.clear();
+		m_flushRequested = false;
+
+		lock.unlock();
+
+		commit(records);
+
+		lock.lock();
+
+		m_committedCount += records.size();
+		m_recordsCommitted.notify_all();
+	}
+}
+
+void DatabaseWriter::commit(std::vector<Record>& records)
+{
+	TG_TRACE_SPAN("group_commit", "database");
+
+	std::lock_guard lock(m_databaseMutex);
+
+	m_database->start_transaction(m_errors);
+
+	for (auto&& record : records)
+	{
+		// an exception here would take down the writer thread and every write after it
+		try
+		{
+			DatabaseTimer timer(record.request);
+
+			record.write(*m_database, m_errors);
+		}
+		catch (const std::exception& e)
+		{
+			m_errors.send(std::make_unique<ErrorMessage>(e.what()));
+		}
+	}
+
+	m_database->finish_transaction(m_errors);
+}
+
+void DatabaseWriter::ErrorCollector::send(std::unique_ptr<Message> message)
+{
+	std::lock_guard lock(mutex);
+
+	messages.push_back(std::move(message));
+}
+
+void DatabaseWriter::ErrorCollector::forward(PacketSender& sender)
+{
+	std::vector<std::unique_ptr<Message>> pending;
+
+	{
+		std::lock_guard lock(mutex);
+
+		pending.swap(messages);
+	}
+
+	for (auto&& message : pending)
+	{
+		sender.send(std::move(message));
+	}
+}
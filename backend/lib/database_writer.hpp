@@ -0,0 +1,153 @@
+#pragma once
+
+#include "database.hpp"
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <thread>
+#include <vector>
+
+// how long the writer waits for more writes to join a transaction before committing
+struct CommitWindow
+{
+	std::chrono::milliseconds time = std::chrono::milliseconds(5);
+
+	// commit early once this many writes are waiting
+	std::size_t records = 100;
+};
+
+// write-behind wrapper around another database. writes are copied into records and handed to a writer thread,
+// which commits everything that arrives within the commit window as a single transaction
+//
+// errors from the writer thread are sent to the sender of the next call made on this database
+struct DatabaseWriter : Database
+{
+	DatabaseWriter(Database& database, CommitWindow window = {});
+	~DatabaseWriter() override;
+
+	DatabaseWriter(const DatabaseWriter&) = delete;
+	DatabaseWriter& operator=(const DatabaseWriter&) = delete;
+
+	void load(Bugzilla& bugzilla, MicroTask& app, API& api) override;
+
+	// both wait for the writes already queued, the sessions might have been changed and dropped from memory since.
+	// writes held by a transaction aren't waited for, the tasks they change keep their sessions in memory instead
+	std::vector<TaskTimes> load_sessions(TaskID task, const TimeCategories& timeCategories) override;
+	std::vector<TaskID> find_tasks_with_sessions(std::chrono::milliseconds start, std::chrono::milliseconds end) override;
+
+	// write task
+	// tasks written during a transaction until it finishes
+	bool has_uncommitted_writes(TaskID task) const override;
+
+	void write_task(const Task& task, PacketSender& sender) override;
+	void write_next_task_id(TaskID nextID, PacketSender& sender) override;
+
+	// the task is copied without its sessions, only the session the event changed goes with it. UPDATED can change
+	// any of them and copies the whole task
+	void write_event(const TaskEvent& event, const Task& task, PacketSender& sender) override;
+	void write_task_change(const Task& task, std::int32_t sessionIndex, const TaskTimes* session, PacketSender& sender) override;
+
+	// write bugzilla config
+	void write_bugzilla_instance(const BugzillaInstance& instance, PacketSender& sender) override;
+	void write_next_bugzilla_instance_id(BugzillaInstanceID nextID, PacketSender& sender) override;
+	void remove_bugzilla_instance(int ID) override;
+	void bugzilla_refreshed(int ID) override;
+
+	// write time entry configuration
+	// write sessions
+	void write_session(TaskID task, const TaskTimes& session, PacketSender& sender) override;
+	void remove_sessions(TaskID task, PacketSender& sender) override;
+
+	// write time entries
+	void write_time_entry(TaskID task, PacketSender& sender) override;
+	void remove_time_entry() override;
+
+	void write_time_entry_config(const TimeCategory& entry, PacketSender& sender) override;
+	void write_next_time_category_id(TimeCategoryID nextID, PacketSender& sender) override;
+	void write_next_time_code_id(TimeCodeID nextID, PacketSender& sender) override;
+
+	void remove_time_category(const TimeCategory& entry, PacketSender& sender) override;
+	void remove_time_code(const TimeCategory& entry, const TimeCode& code, PacketSender& sender) override;
+
+	void write_backup_configuration(const BackupConfiguration& configuration, PacketSender& sender) override;
+
+	void archive_tasks(const std::vector<Task>& tasks, PacketSender& sender) override;
+	// flushes first, tasks that have just been archived might still be waiting to be written
+	std::vector<Task> load_archived_tasks(TaskID parent, const TimeCategories& timeCategories, PacketSender& sender) override;
+
+	// writes between start and finish are held back and committed together
+	void start_transaction(PacketSender& sender) override;
+	void finish_transaction(PacketSender& sender) override;
+
+	bool transaction_in_progress() const override;
+
+	void flush(PacketSender& sender) override;
+
+	// flushes first so that the snapshot matches the database
+	void write_snapshot(MicroTask& app, const Bugzilla& bugzilla, PacketSender& sender) override;
+
+	// called from the backup thread. waits for the writes queued so far, then backs up without holding the inner
+	// database, which makes its copy from a connection of its own
+	std::optional<std::string> backup(const std::filesystem::path& file) override;
+
+private:
+	using Write = std::function<void(Database&, PacketSender&)>;
+
+	// the request that queued the write is kept so that the time the writer thread spends on it is recorded for it
+	struct Record
+	{
+		std::optional<PacketType> request;
+		Write write;
+	};
+
+	// collects errors on the writer thread until they can be sent from the main thread
+	struct ErrorCollector : PacketSender
+	{
+		void send(std::unique_ptr<Message> message) override;
+
+		void forward(PacketSender& sender);
+
+		std::mutex mutex;
+		std::vector<std::unique_ptr<Message>> messages;
+	};
+
+	void queue(Write write);
+	// remembers the task when the write is held by a transaction
+	void queue(Write write, TaskID task);
+	void queue(std::vector<Record>& records);
+
+	void run();
+	void commit(std::vector<Record>& records);
+
+	// blocks until everything queued so far has been committed. errors stay collected for the next call
+	void wait_for_writes();
+
+	Database* m_database;
+	CommitWindow m_window;
+
+	// held while the inner database is in use
+	std::mutex m_databaseMutex;
+
+	std::mutex m_mutex;
+	std::condition_variable m_recordQueued;
+	std::condition_variable m_recordsCommitted;
+	std::vector<Record> m_queue;
+	std::size_t m_queuedCount = 0;
+	std::size_t m_committedCount = 0;
+	bool m_flushRequested = false;
+	bool m_stop = false;
+
+	// only used by the main thread
+	bool m_transaction = false;
+	std::vector<Record> m_transactionRecords;
+	std::set<TaskID> m_transactionTasks;
+
+	ErrorCollector m_errors;
+
+	std::thread m_thread;
+};
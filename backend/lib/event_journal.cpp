@@ -0,0 +1,617 @@
+#include "event_journal.hpp"
+#include "api.hpp"
+#include "backup.hpp"
+#include "packets.hpp"
+#include "snapshot.hpp"
+#include "trace.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <format>
+
+namespace
+{
+	// segments are named journal-<number>.log, replayed in order of their number
+	std::optional<std::int32_t> segment_number(const std::filesystem::path& path)
+	{
+		const std::string name = path.filename().string();
+
+		if (!name.starts_with("journal-") || !name.ends_with(".log"))
+		{
+			return std::nullopt;
+		}
+
+		try
+		{
+			return std::stoi(name.substr(8, name.size() - 12));
+		}
+		catch (const std::exception&)
+		{
+			return std::nullopt;
+		}
+	}
+
+	const Task* find_task(MicroTask& app, TaskID id)
+	{
+		// find_task only returns the unspecified task while it's active
+		return id == UNSPECIFIED_TASK ? &app.unspecified_task() : app.find_task(id);
+	}
+}
+
+EventJournal::EventJournal(Database& database, const std::filesystem::path& directory, std::size_t compactEvents)
+	: m_database(&database),
+	m_directory(directory),
+	m_compactEvents(compactEvents)
+{
+	std::filesystem::create_directories(m_directory);
+
+	std::vector<std::pair<std::int32_t, std::filesystem::path>> segments;
+
+	for (auto&& entry : std::filesystem::directory_iterator(m_directory))
+	{
+		if (auto number = segment_number(entry.path()))
+		{
+			segments.emplace_back(number.value(), entry.path());
+		}
+	}
+
+	std::sort(segments.begin(), segments.end());
+
+	for (auto&& [number, path] : segments)
+	{
+		m_replayedSegments.push_back(path);
+		m_nextSegment = number + 1;
+	}
+
+	// never append to a segment from the last run, it might end with a partially written event
+	open_segment();
+}
+
+void EventJournal::load(Bugzilla& bugzilla, MicroTask& app, API& api)
+{
+	m_app = &app;
+
+	m_database->load(bugzilla, app, api);
+
+	for (auto&& segment : m_replayedSegments)
+	{
+		replay(segment, app);
+	}
+}
+
+std::vector<TaskTimes> EventJournal::load_sessions(TaskID task, const TimeCategories& timeCategories)
+{
+	return m_database->load_sessions(task, timeCategories);
+}
+
+std::vector<TaskID> EventJournal::find_tasks_with_sessions(std::chrono::milliseconds start, std::chrono::milliseconds end)
+{
+	return m_database->find_tasks_with_sessions(start, end);
+}
+
+bool EventJournal::has_uncommitted_writes(TaskID task) const
+{
+	return m_database->has_uncommitted_writes(task);
+}
+
+void EventJournal::evicting_sessions(const Task& task, PacketSender& sender)
+{
+	// still dirty, the compaction writes it again without the sessions, which leaves the ones written here alone
+	if (m_dirtyTasks.contains(task.taskID()))
+	{
+		m_database->write_task(task, sender);
+	}
+}
+
+void EventJournal::write_task(const Task& task, PacketSender& sender)
+{
+	write_event(TaskEvent{ TaskEventType::UPDATED }, task, sender);
+}
+
+void EventJournal::write_next_task_id(TaskID nextID, PacketSender& sender)
+{
+	m_database->write_next_task_id(nextID, sender);
+}
+
+void EventJournal::write_event(const TaskEvent& event, const Task& task, PacketSender& sender)
+{
+	append(event, task);
+
+	m_dirtyTasks.insert(task.taskID());
+
+	if (!m_transaction && m_segmentEvents >= m_compactEvents)
+	{
+		compact(sender);
+	}
+}
+
+void EventJournal::write_bugzilla_instance(const BugzillaInstance& instance, PacketSender& sender)
+{
+	m_database->write_bugzilla_instance(instance, sender);
+}
+
+void EventJournal::write_next_bugzilla_instance_id(BugzillaInstanceID nextID, PacketSender& sender)
+{
+	m_database->write_next_bugzilla_instance_id(nextID, sender);
+}
+
+void EventJournal::remove_bugzilla_instance(int ID)
+{
+	m_database->remove_bugzilla_instance(ID);
+}
+
+void EventJournal::bugzilla_refreshed(int ID)
+{
+	m_database->bugzilla_refreshed(ID);
+}
+
+void EventJournal::write_session(TaskID task, const TaskTimes& session, PacketSender& sender)
+{
+	m_database->write_session(task, session, sender);
+}
+
+void EventJournal::remove_sessions(TaskID task, PacketSender& sender)
+{
+	m_database->remove_sessions(task, sender);
+}
+
+void EventJournal::write_time_entry(TaskID task, PacketSender& sender)
+{
+	m_database->write_time_entry(task, sender);
+}
+
+void EventJournal::remove_time_entry()
+{
+	m_database->remove_time_entry();
+}
+
+void EventJournal::write_time_entry_config(const TimeCategory& entry, PacketSender& sender)
+{
+	m_database->write_time_entry_config(entry, sender);
+}
+
+void EventJournal::write_next_time_category_id(TimeCategoryID nextID, PacketSender& sender)
+{
+	m_database->write_next_time_category_id(nextID, sender);
+}
+
+void EventJournal::write_next_time_code_id(TimeCodeID nextID, PacketSender& sender)
+{
+	m_database->write_next_time_code_id(nextID, sender);
+}
+
+void EventJournal::remove_time_category(const TimeCategory& entry, PacketSender& sender)
+{
+	m_database->remove_time_category(entry, sender);
+}
+
+void EventJournal::remove_time_code(const TimeCategory& entry, const TimeCode& code, PacketSender& sender)
+{
+	m_database->remove_time_code(entry, code, sender);
+}
+
+void EventJournal::write_backup_configuration(const BackupConfiguration& configuration, PacketSender& sender)
+{
+	m_database->write_backup_configuration(configuration, sender);
+}
+
+void EventJournal::archive_tasks(const std::vector<Task>& tasks, PacketSender& sender)
+{
+	// the first compaction writes every other changed task to the inner database, the second deletes the segments once
+	// that has been flushed
+	compact(sender);
+	compact(sender);
+
+	m_database->archive_tasks(tasks, sender);
+}
+
+std::vector<Task> EventJournal::load_archived_tasks(TaskID parent, const TimeCategories& timeCategories, PacketSender& sender)
+{
+	return m_database->load_archived_tasks(parent, timeCategories, sender);
+}
+
+void EventJournal::start_transaction(PacketSender& sender)
+{
+	m_transaction = true;
+
+	m_database->start_transaction(sender);
+}
+
+void EventJournal::finish_transaction(PacketSender& sender)
+{
+	m_database->finish_transaction(sender);
+
+	m_transaction = false;
+
+	// compaction was held back until the transaction finished
+	if (m_segmentEvents >= m_compactEvents)
+	{
+		compact(sender);
+	}
+}
+
+bool EventJournal::transaction_in_progress() const
+{
+	return m_transaction;
+}
+
+void EventJournal::flush(PacketSender& sender)
+{
+	m_segment.flush();
+
+	m_database->flush(sender);
+}
+
+void EventJournal::write_snapshot(MicroTask& app, const Bugzilla& bugzilla, PacketSender& sender)
+{
+	// events in the journal are replayed on top of the snapshot, the same as they are on top of the database
+	m_database->write_snapshot(app, bugzilla, sender);
+}
+
+std::optional<std::string> EventJournal::backup(const std::filesystem::path& file)
+{
+	const auto directory = backup_journal_directory(file);
+
+	auto temp = directory;
+	temp += ".tmp";
+
+	const auto failed = [&](const std::string& error)
+		{
+			std::error_code ignored;
+			std::filesystem::remove_all(temp, ignored);
+
+			return error;
+		};
+
+	std::error_code error;
+	std::filesystem::remove_all(temp, error);
+	std::filesystem::create_directories(temp, error);
+
+	if (error)
+	{
+		return failed(error.message());
+	}
+
+	// copied first, anything compacted after this is in the database by the time it's backed up. a segment that's
+	// still being written might end part way through an event, which replay stops at
+	for (auto&& entry : std::filesystem::directory_iterator(m_directory, error))
+	{
+		if (!segment_number(entry.path()))
+		{
+			continue;
+		}
+
+		std::filesystem::copy_file(entry.path(), temp / entry.path().filename(), error);
+
+		if (error && error != std::errc::no_such_file_or_directory)
+		{
+			return failed(error.message());
+		}
+		error.clear();
+	}
+
+	if (error)
+	{
+		return failed(error.message());
+	}
+
+	if (auto databaseError = m_database->backup(file))
+	{
+		return failed(*databaseError);
+	}
+
+	std::filesystem::remove_all(directory, error);
+	std::filesystem::rename(temp, directory, error);
+
+	if (error)
+	{
+		// a backup without its segments is missing the latest changes
+		const auto message = error.message();
+
+		std::filesystem::remove(file, error);
+
+		return failed(message);
+	}
+	return std::nullopt;
+}
+
+void EventJournal::compact(PacketSender& sender)
+{
+	TG_TRACE_SPAN("compact_journal", "database");
+
+	// the tasks written by the previous compaction were committed long ago, this rarely has to wait
+	m_database->flush(sender);
+
+	for (auto&& segment : m_compactedSegments)
+	{
+		std::error_code error;
+		std::filesystem::remove(segment, error);
+	}
+
+	m_compactedSegments = std::move(m_replayedSegments);
+	m_replayedSegments.clear();
+
+	m_compactedSegments.push_back(m_segmentPath);
+
+	open_segment();
+
+	if (m_dirtyTasks.empty() || !m_app)
+	{
+		return;
+	}
+
+	m_database->start_transaction(sender);
+
+	for (TaskID id : m_dirtyTasks)
+	{
+		if (const Task* task = find_task(*m_app, id))
+		{
+			m_database->write_task(*task, sender);
+		}
+	}
+
+	m_database->finish_transaction(sender);
+
+	m_dirtyTasks.clear();
+}
+
+void EventJournal::append(const TaskEvent& event, const Task& task)
+{
+	const StringLengthScope strings(PERSISTED_STRING_LENGTH);
+
+	PacketBuilder builder;
+
+	builder.add(event.type);
+	builder.add(task.taskID());
+
+	switch (event.type)
+	{
+	case TaskEventType::CREATED:
+		builder.add(task.parentID());
+		builder.add(task.m_name.str());
+		builder.add(task.createTime());
+		builder.add(task.serverControlled);
+		builder.add(task.indexInParent);
+		break;
+	case TaskEventType::SESSION_STARTED:
+	{
+		const TaskTimes& times = task.m_times[event.session];
+
+		builder.add(event.session);
+		builder.add(times.start);
+		add_time_entry(builder, times.timeEntry);
+		break;
+	}
+	case TaskEventType::SESSION_STOPPED:
+		builder.add(event.session);
+		builder.add(task.m_times[event.session].stop.value_or(std::chrono::milliseconds(0)));
+		break;
+	case TaskEventType::FINISHED:
+		builder.add(task.m_finishTime.value_or(std::chrono::milliseconds(0)));
+		builder.add(event.session);
+		break;
+	case TaskEventType::RENAMED:
+		builder.add(task.m_name.str());
+		break;
+	case TaskEventType::REPARENTED:
+		builder.add(task.parentID());
+		break;
+	case TaskEventType::TIME_ENTRY_CHANGED:
+		add_time_entry(builder, task.timeEntry);
+		break;
+	case TaskEventType::UPDATED:
+		add_task_image(builder, task);
+		break;
+	}
+
+	const auto bytes = builder.build();
+
+	m_segment.write(reinterpret_cast<const char*>(bytes.data()), bytes.size());
+
+	// handed to the OS after every event, a crash of the server loses nothing
+	m_segment.flush();
+
+	++m_segmentEvents;
+}
+
+void EventJournal::replay(const std::filesystem::path& segment, MicroTask& app)
+{
+	TG_TRACE_SPAN("replay_journal", "database");
+
+	std::ifstream input(segment, std::ios::binary);
+
+	const std::vector<char> contents((std::istreambuf_iterator<char>(input)), std::istreambuf_iterator<char>());
+	const auto bytes = std::as_bytes(std::span(contents));
+
+	std::size_t position = 0;
+
+	const auto read_int = [&](std::size_t offset)
+		{
+			std::int32_t value;
+			std::memcpy(&value, bytes.data() + offset, sizeof(value));
+			return std::byteswap(value);
+		};
+
+	// no segment has ever had an event this long, without the header it's a segment with 2 byte string lengths
+	const bool versioned = bytes.size() >= 2 * sizeof(std::int32_t) && read_int(0) == SEGMENT_MAGIC && read_int(sizeof(std::int32_t)) == SEGMENT_VERSION;
+
+	const StringLengthScope strings(versioned ? PERSISTED_STRING_LENGTH : StringLength::SHORT);
+
+	if (versioned)
+	{
+		position = 2 * sizeof(std::int32_t);
+	}
+
+	while (bytes.size() - position >= sizeof(std::int32_t))
+	{
+		const std::int32_t length = read_int(position);
+
+		// the server stopped part way through writing the last event
+		if (length < static_cast<std::int32_t>(sizeof(length)) || static_cast<std::size_t>(length) > bytes.size() - position)
+		{
+			break;
+		}
+
+		auto parser = PacketParser(bytes.subspan(position + sizeof(length), length - sizeof(length)));
+
+		replay_event(parser, app);
+
+		if (parser.error())
+		{
+			break;
+		}
+
+		position += length;
+	}
+}
+
+void EventJournal::replay_event(PacketParser& parser, MicroTask& app)
+{
+	const auto type = parser.read<TaskEventType>("eventType");
+	const auto taskID = parser.read<TaskID>("taskID");
+
+	if (parser.error())
+	{
+		return;
+	}
+
+	m_dirtyTasks.insert(taskID);
+
+	if (type == TaskEventType::UPDATED)
+	{
+		Task task = parse_task_image(parser, app.timeCategories());
+
+		if (!parser.error())
+		{
+			app.load_task(task);
+		}
+		return;
+	}
+
+	if (type == TaskEventType::CREATED)
+	{
+		const auto parentID = parser.read<TaskID>("parentID");
+		auto name = parser.read<std::string>("name");
+		const auto createTime = parser.read<std::chrono::milliseconds>("createTime");
+		const auto serverControlled = parser.read<bool>("serverControlled");
+		const auto indexInParent = parser.read<std::int32_t>("indexInParent");
+
+		if (parser.error())
+		{
+			return;
+		}
+
+		// the task might already be in the database from an earlier compaction, keep everything but what the creation set
+		const Task* existing = find_task(app, taskID);
+
+		Task task = existing ? *existing : Task(name, taskID, parentID, createTime);
+		task.m_name = std::move(name);
+		task.m_parentID = parentID;
+		task.m_createTime = createTime;
+		task.serverControlled = serverControlled;
+		task.indexInParent = indexInParent;
+
+		app.load_task(task);
+
+		if (app.m_nextTaskID <= taskID)
+		{
+			app.m_nextTaskID = TaskID(taskID._val + 1);
+		}
+		return;
+	}
+
+	const Task* existing = find_task(app, taskID);
+
+	if (!existing)
+	{
+		return;
+	}
+
+	// session events are replayed by index, every earlier session has to be there
+	if (!existing->sessionsLoaded)
+	{
+		app.load_sessions(*app.find_task(taskID));
+	}
+
+	Task task = *existing;
+
+	switch (type)
+	{
+	case TaskEventType::SESSION_STARTED:
+	{
+		const auto index = parser.read<std::int32_t>("index");
+
+		TaskTimes times{ parser.read<std::chrono::milliseconds>("start") };
+		times.timeEntry = parse_time_entry(parser, app.timeCategories());
+
+		// anything after the session is from an earlier run of these events and will be replayed again
+		task.m_times.resize(std::min<std::size_t>(task.m_times.size(), index));
+		task.m_times.push_back(std::move(times));
+
+		task.state = TaskState::ACTIVE;
+		break;
+	}
+	case TaskEventType::SESSION_STOPPED:
+	{
+		const auto index = parser.read<std::int32_t>("index");
+		const auto stop = parser.read<std::chrono::milliseconds>("stop");
+
+		if (index >= 0 && static_cast<std::size_t>(index) < task.m_times.size())
+		{
+			task.m_times[index].stop = stop;
+		}
+
+		task.state = TaskState::PENDING;
+		break;
+	}
+	case TaskEventType::FINISHED:
+	{
+		const auto finish = parser.read<std::chrono::milliseconds>("finish");
+		const auto index = parser.read<std::int32_t>("index");
+
+		if (index >= 0 && static_cast<std::size_t>(index) < task.m_times.size())
+		{
+			task.m_times[index].stop = finish;
+		}
+
+		task.m_finishTime = finish;
+		task.state = TaskState::FINISHED;
+		break;
+	}
+	case TaskEventType::RENAMED:
+		task.m_name = parser.read<std::string>("name");
+		break;
+	case TaskEventType::REPARENTED:
+		task.m_parentID = parser.read<TaskID>("parentID");
+		break;
+	case TaskEventType::TIME_ENTRY_CHANGED:
+		task.timeEntry = parse_time_entry(parser, app.timeCategories());
+		break;
+	case TaskEventType::CREATED:
+	case TaskEventType::UPDATED:
+		break;
+	}
+
+	if (!parser.error())
+	{
+		app.load_task(task);
+	}
+}
+
+void EventJournal::open_segment()
+{
+	m_segment.close();
+
+	m_segmentPath = m_directory / std::format("journal-{:06}.log", m_nextSegment++);
+	m_segment = std::ofstream(m_segmentPath, std::ios::binary | std::ios::trunc);
+
+	PacketBuilder header;
+	header.add(SEGMENT_MAGIC);
+	header.add(SEGMENT_VERSION);
+
+	m_segment.write(reinterpret_cast<const char*>(header.bytes().data()), header.bytes().size());
+	m_segment.flush();
+
+	m_segmentEvents = 0;
+}
@@ -0,0 +1,115 @@
+#pragma once
+
+#include "database.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <set>
+#include <vector>
+
+class PacketParser;
+
+// event-sourced storage in front of another database. task events are appended to a log file in the journal
+// directory instead of rewriting the whole task. every other write goes straight to the inner database
+//
+// once a segment of the log holds enough events it's compacted: the tasks it changed are written to the inner
+// database in a single transaction and a new segment is started. a compacted segment is deleted at the next compaction,
+// after the inner database has flushed. at load, any segments left behind are replayed on top of the inner database
+//
+// events only store the fields they change and replaying them more than once gives the same result. segments start with
+// a magic and version, segments from before the version was added have 2 byte string lengths and are still replayed
+struct EventJournal : Database
+{
+	static constexpr std::int32_t SEGMENT_MAGIC = 0x54474A4C; // TGJL
+	static constexpr std::int32_t SEGMENT_VERSION = 2;
+
+	EventJournal(Database& database, const std::filesystem::path& directory, std::size_t compactEvents = 1000);
+
+	void load(Bugzilla& bugzilla, MicroTask& app, API& api) override;
+
+	std::vector<TaskTimes> load_sessions(TaskID task, const TimeCategories& timeCategories) override;
+	std::vector<TaskID> find_tasks_with_sessions(std::chrono::milliseconds start, std::chrono::milliseconds end) override;
+	// a task with events that haven't been compacted yet is written to the inner database while it still has its sessions
+	void evicting_sessions(const Task& task, PacketSender& sender) override;
+	// events are replayed from the segments, only writes the inner database hasn't committed count
+	bool has_uncommitted_writes(TaskID task) const override;
+
+	// write task
+	void write_task(const Task& task, PacketSender& sender) override;
+	void write_next_task_id(TaskID nextID, PacketSender& sender) override;
+	void write_event(const TaskEvent& event, const Task& task, PacketSender& sender) override;
+
+	// write bugzilla config
+	void write_bugzilla_instance(const BugzillaInstance& instance, PacketSender& sender) override;
+	void write_next_bugzilla_instance_id(BugzillaInstanceID nextID, PacketSender& sender) override;
+	void remove_bugzilla_instance(int ID) override;
+	void bugzilla_refreshed(int ID) override;
+
+	// write time entry configuration
+	// write sessions
+	void write_session(TaskID task, const TaskTimes& session, PacketSender& sender) override;
+	void remove_sessions(TaskID task, PacketSender& sender) override;
+
+	// write time entries
+	void write_time_entry(TaskID task, PacketSender& sender) override;
+	void remove_time_entry() override;
+
+	void write_time_entry_config(const TimeCategory& entry, PacketSender& sender) override;
+	void write_next_time_category_id(TimeCategoryID nextID, PacketSender& sender) override;
+	void write_next_time_code_id(TimeCodeID nextID, PacketSender& sender) override;
+
+	void remove_time_category(const TimeCategory& entry, PacketSender& sender) override;
+	void remove_time_code(const TimeCategory& entry, const TimeCode& code, PacketSender& sender) override;
+
+	void write_backup_configuration(const BackupConfiguration& configuration, PacketSender& sender) override;
+
+	// compacts first so that no segment left behind replays events for the archived tasks
+	void archive_tasks(const std::vector<Task>& tasks, PacketSender& sender) override;
+	std::vector<Task> load_archived_tasks(TaskID parent, const TimeCategories& timeCategories, PacketSender& sender) override;
+
+	void start_transaction(PacketSender& sender) override;
+	void finish_transaction(PacketSender& sender) override;
+
+	bool transaction_in_progress() const override;
+
+	void flush(PacketSender& sender) override;
+
+	void write_snapshot(MicroTask& app, const Bugzilla& bugzilla, PacketSender& sender) override;
+
+	// the segments that haven't been compacted are copied next to the backup before the inner database is backed up.
+	// a segment that's deleted while copying was already compacted into the database. called from the backup thread
+	std::optional<std::string> backup(const std::filesystem::path& file) override;
+
+	// fold the current segment into the inner database
+	void compact(PacketSender& sender);
+
+private:
+	void append(const TaskEvent& event, const Task& task);
+	void replay(const std::filesystem::path& segment, MicroTask& app);
+	void replay_event(PacketParser& parser, MicroTask& app);
+	void open_segment();
+
+	Database* m_database;
+	MicroTask* m_app = nullptr;
+
+	std::filesystem::path m_directory;
+	std::size_t m_compactEvents;
+
+	std::ofstream m_segment;
+	std::filesystem::path m_segmentPath;
+	std::int32_t m_nextSegment = 1;
+	std::size_t m_segmentEvents = 0;
+
+	// left behind by the last run, replayed at load and compacted with the current segment
+	std::vector<std::filesystem::path> m_replayedSegments;
+
+	// segments that have been compacted, but might not have been flushed by the inner database yet
+	std::vector<std::filesystem::path> m_compactedSegments;
+
+	// tasks changed since the last compaction
+	std::set<TaskID> m_dirtyTasks;
+
+	bool m_transaction = false;
+};
@@ -0,0 +1,116 @@
+#include "interned_string.hpp"
+
+#include <mutex>
+#include <unordered_set>
+
+struct StringPool
+{
+	using Entry = InternedString::Entry;
+
+	struct Hash
+	{
+		using is_transparent = void;
+
+		std::size_t operator()(std::string_view value) const { return std::hash<std::string_view>{}(value); }
+		std::size_t operator()(const Entry& entry) const { return (*this)(entry.value); }
+	};
+
+	struct Equal
+	{
+		using is_transparent = void;
+
+		bool operator()(const Entry& a, const Entry& b) const { return a.value == b.value; }
+		bool operator()(std::string_view a, const Entry& b) const { return a == b.value; }
+		bool operator()(const Entry& a, std::string_view b) const { return a.value == b; }
+	};
+
+	// the nodes of an unordered_set don't move, the strings stay where they are as the pool grows
+	std::unordered_set<Entry, Hash, Equal> strings;
+	std::mutex mutex;
+};
+
+static StringPool& pool()
+{
+	static StringPool pool;
+	return pool;
+}
+
+std::optional<InternedString> InternedString::find(std::string_view value)
+{
+	if (value.empty())
+	{
+		return InternedString();
+	}
+
+	StringPool& strings = pool();
+
+	std::lock_guard lock(strings.mutex);
+
+	const auto result = strings.strings.find(value);
+
+	if (result == strings.strings.end())
+	{
+		return std::nullopt;
+	}
+
+	acquire(&*result);
+
+	InternedString string;
+	string.m_entry = &*result;
+	return string;
+}
+
+std::size_t InternedString::pool_size()
+{
+	StringPool& strings = pool();
+
+	std::lock_guard lock(strings.mutex);
+
+	return strings.strings.size();
+}
+
+const InternedString::Entry* InternedString::intern(std::string_view value)
+{
+	if (value.empty())
+	{
+		return nullptr;
+	}
+
+	StringPool& strings = pool();
+
+	std::lock_guard lock(strings.mutex);
+
+	if (const auto result = strings.strings.find(value); result != strings.strings.end())
+	{
+		acquire(&*result);
+		return &*result;
+	}
+	return &*strings.strings.emplace(value).first;
+}
+
+void InternedString::release(const Entry* entry)
+{
+	if (!entry)
+	{
+		return;
+	}
+
+	// dropping a reference that isn't the last one doesn't need the pool. the last one is dropped under the lock so
+	// that the pool can't hand out the string while it's being removed
+	for (auto references = entry->references.load(std::memory_order_relaxed); references > 1;)
+	{
+		if (entry->references.compare_exchange_weak(references, references - 1, std::memory_order_acq_rel))
+		{
+			return;
+		}
+	}
+
+	StringPool& strings = pool();
+
+	std::lock_guard lock(strings.mutex);
+
+	if (entry->references.fetch_sub(1, std::memory_order_acq_rel) == 1)
+	{
+		strings.strings.erase(strings.strings.find(std::string_view(entry->value)));
+	}
+}
@@ -0,0 +1,132 @@
+#pragma once
+
+#include <atomic>
+#include <compare>
+#include <cstddef>
+#include <format>
+#include <functional>
+#include <optional>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <utility>
+
+// a string that's stored once for the whole server no matter how many tasks use it. bugzilla creates the same product,
+// component and version names under many parents and labels repeat across most tasks
+//
+// the handle is a pointer to the stored string, so copies are cheap and two interned strings are equal only when they
+// are the same string. the stored strings count their handles and leave the pool with the last one, renamed tasks
+// and deleted labels don't stay behind. the empty string isn't stored
+class InternedString
+{
+public:
+	InternedString() = default;
+
+	// interning looks the string up in the pool, it's explicit so that comparisons with strings don't do it
+	explicit InternedString(std::string_view value) : m_entry(intern(value)) {}
+
+	InternedString(const InternedString& other) : m_entry(other.m_entry)
+	{
+		acquire(m_entry);
+	}
+
+	InternedString(InternedString&& other) noexcept : m_entry(std::exchange(other.m_entry, nullptr)) {}
+
+	~InternedString()
+	{
+		release(m_entry);
+	}
+
+	InternedString& operator=(const InternedString& other)
+	{
+		acquire(other.m_entry);
+		release(std::exchange(m_entry, other.m_entry));
+		return *this;
+	}
+
+	InternedString& operator=(InternedString&& other) noexcept
+	{
+		std::swap(m_entry, other.m_entry);
+		return *this;
+	}
+
+	InternedString& operator=(std::string_view value)
+	{
+		release(std::exchange(m_entry, intern(value)));
+		return *this;
+	}
+
+	// the interned string if it has been stored before, without storing it
+	static std::optional<InternedString> find(std::string_view value);
+
+	// number of distinct strings that are stored
+	static std::size_t pool_size();
+
+	const std::string& str() const { return m_entry ? m_entry->value : empty_string(); }
+	operator const std::string&() const { return str(); }
+
+	std::size_t size() const { return str().size(); }
+	bool empty() const { return !m_entry; }
+
+	friend bool operator==(const InternedString& a, const InternedString& b) { return a.m_entry == b.m_entry; }
+	friend bool operator==(const InternedString& a, std::string_view b) { return a.str() == b; }
+
+	// the order of the strings, not of the handles
+	friend std::strong_ordering operator<=>(const InternedString& a, const InternedString& b) { return a.str() <=> b.str(); }
+	friend std::strong_ordering operator<=>(const InternedString& a, std::string_view b) { return std::string_view(a.str()) <=> b; }
+
+	friend std::ostream& operator<<(std::ostream& out, const InternedString& string)
+	{
+		out << string.str();
+		return out;
+	}
+
+private:
+	friend struct std::hash<InternedString>;
+	friend struct StringPool;
+
+	struct Entry
+	{
+		explicit Entry(std::string_view value) : value(value) {}
+
+		std::string value;
+		// handles to the string, including the ones being handed out by the pool
+		mutable std::atomic<std::size_t> references = 1;
+	};
+
+	// nullptr for the empty string
+	static const Entry* intern(std::string_view value);
+
+	static void acquire(const Entry* entry)
+	{
+		if (entry)
+		{
+			entry->references.fetch_add(1, std::memory_order_relaxed);
+		}
+	}
+
+	static void release(const Entry* entry);
+
+	static const std::string& empty_string()
+	{
+		static const std::string empty;
+		return empty;
+	}
+
+	const Entry* m_entry = nullptr;
+};
+
+template<>
+struct std::hash<InternedString>
+{
+	std::size_t operator()(const InternedString& string) const { return std::hash<const InternedString::Entry*>{}(string.m_entry); }
+};
+
+template<>
+struct std::formatter<InternedString> : std::formatter<std::string_view>
+{
+	auto format(const InternedString& string, std::format_context& ctx) const
+	{
+		return std::formatter<std::string_view>::format(string.str(), ctx);
+	}
+};
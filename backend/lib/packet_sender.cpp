@@ -0,0 +1,367 @@
+#include "packet_sender.hpp"
+#include "statistics.hpp"
+#include "packets/protocol_version.hpp"
+
+#include <algorithm>
+#include <optional>
+
+void ClientQueue::push(Frame frame)
+{
+	{
+		std::lock_guard lock(m_mutex);
+
+		if (m_closed)
+		{
+			return;
+		}
+
+		m_bytes += frame.size();
+
+		if (m_bytes > m_limit)
+		{
+			m_frames.clear();
+			m_bytes = 0;
+			m_closed = true;
+			m_overflowed = true;
+		}
+		else
+		{
+			m_frames.push_back(std::move(frame));
+		}
+	}
+	m_ready.notify_one();
+}
+
+Frame ClientQueue::pop()
+{
+	std::unique_lock lock(m_mutex);
+
+	m_ready.wait(lock, [&] { return m_closed || !m_frames.empty(); });
+
+	if (m_frames.empty())
+	{
+		return {};
+	}
+
+	auto frame = std::move(m_frames.front());
+	m_frames.pop_front();
+
+	m_bytes -= frame.size();
+
+	return frame;
+}
+
+void ClientQueue::close()
+{
+	{
+		std::lock_guard lock(m_mutex);
+
+		m_closed = true;
+	}
+	m_ready.notify_all();
+}
+
+std::size_t ClientQueue::size() const
+{
+	std::lock_guard lock(m_mutex);
+
+	return m_frames.size();
+}
+
+std::size_t ClientQueue::bytes() const
+{
+	std::lock_guard lock(m_mutex);
+
+	return m_bytes;
+}
+
+bool ClientQueue::overflowed() const
+{
+	std::lock_guard lock(m_mutex);
+
+	return m_overflowed;
+}
+
+void Broadcaster::add_client(ClientQueue& client)
+{
+	std::lock_guard lock(m_mutex);
+
+	m_clients.push_back(Client{ &client });
+}
+
+void Broadcaster::remove_client(ClientQueue& client)
+{
+	std::lock_guard lock(m_mutex);
+
+	std::erase_if(m_clients, [&](const Client& c) { return c.queue == &client; });
+
+	if (m_current == &client)
+	{
+		m_current = nullptr;
+	}
+}
+
+void Broadcaster::set_current(ClientQueue* client)
+{
+	std::lock_guard lock(m_mutex);
+
+	m_current = client;
+}
+
+void Broadcaster::send(std::unique_ptr<Message> message)
+{
+	send_message(*message, nullptr);
+}
+
+void Broadcaster::send_message(const Message& message, MessageCopy copy)
+{
+	// packed before returning, the message is never kept
+	PackedMessage packed{ message };
+
+	std::lock_guard lock(m_mutex);
+
+	for (const Client& client : m_clients)
+	{
+		if (!m_current || client.queue == m_current)
+		{
+			push(packed, client);
+		}
+	}
+
+	record(packed);
+}
+
+void Broadcaster::send_to_all(std::unique_ptr<Message> message)
+{
+	PackedMessage packed{ *message };
+
+	std::lock_guard lock(m_mutex);
+
+	for (const Client& client : m_clients)
+	{
+		push(packed, client);
+	}
+
+	record(packed);
+}
+
+void Broadcaster::broadcast(std::unique_ptr<Message> message, std::span<const TaskID> taskPath)
+{
+	PackedMessage packed{ *message };
+
+	std::lock_guard lock(m_mutex);
+
+	for (const Client& client : m_clients)
+	{
+		if (receives(client, taskPath))
+		{
+			push(packed, client);
+		}
+	}
+
+	record(packed);
+}
+
+void Broadcaster::broadcast_task(std::unique_ptr<Message> message, std::uint64_t version, std::span<const TaskID> taskPath)
+{
+	PackedMessage packed{ *message };
+
+	std::lock_guard lock(m_mutex);
+
+	for (Client& client : m_clients)
+	{
+		if (receives(client, taskPath))
+		{
+			push(packed, client);
+
+			client.versions[taskPath.front()] = version;
+		}
+	}
+
+	record(packed);
+}
+
+void Broadcaster::broadcast_delta(std::unique_ptr<Message> delta, std::uint64_t base, std::uint64_t version, const std::function<std::unique_ptr<Message>()>& full, std::span<const TaskID> taskPath)
+{
+	PackedMessage packedDelta{ *delta };
+
+	// built the first time a client without deltas needs it
+	std::unique_ptr<Message> fullMessage;
+	std::optional<PackedMessage> packedFull;
+
+	std::lock_guard lock(m_mutex);
+
+	for (Client& client : m_clients)
+	{
+		if (!receives(client, taskPath))
+		{
+			continue;
+		}
+
+		std::uint64_t& received = client.versions[taskPath.front()];
+
+		// the delta is only good for clients that have the version it's against
+		const bool applies = client.deltas && received == base;
+
+		received = version;
+
+		if (applies)
+		{
+			push(packedDelta, client);
+			continue;
+		}
+
+		if (!fullMessage)
+		{
+			fullMessage = full();
+			packedFull.emplace(*fullMessage);
+		}
+		push(*packedFull, client);
+	}
+
+	record(packedDelta);
+
+	if (packedFull)
+	{
+		record(*packedFull);
+	}
+}
+
+void Broadcaster::enable_deltas()
+{
+	std::lock_guard lock(m_mutex);
+
+	for (Client& client : m_clients)
+	{
+		if (client.queue == m_current)
+		{
+			client.deltas = true;
+		}
+	}
+}
+
+void Broadcaster::set_protocol_version(std::int32_t version)
+{
+	std::lock_guard lock(m_mutex);
+
+	for (Client& client : m_clients)
+	{
+		if (client.queue == m_current)
+		{
+			client.protocolVersion = version;
+		}
+	}
+}
+
+std::int32_t Broadcaster::protocol_version() const
+{
+	std::lock_guard lock(m_mutex);
+
+	// without a current client the message goes to every client, use what all of them understand
+	for (const Client& client : m_clients)
+	{
+		if (client.queue == m_current && m_current)
+		{
+			return client.protocolVersion;
+		}
+	}
+	return 1;
+}
+
+void Broadcaster::subscribe(TaskID root)
+{
+	std::lock_guard lock(m_mutex);
+
+	for (Client& client : m_clients)
+	{
+		if (client.queue == m_current)
+		{
+			client.subtrees.insert(root);
+		}
+	}
+}
+
+void Broadcaster::unsubscribe(TaskID root)
+{
+	std::lock_guard lock(m_mutex);
+
+	for (Client& client : m_clients)
+	{
+		if (client.queue == m_current)
+		{
+			client.subtrees.erase(root);
+		}
+	}
+}
+
+void Broadcaster::push(PackedMessage& message, const Client& client)
+{
+	const bool compact = client.protocolVersion >= COMPACT_WIRE_FORMAT_PROTOCOL_VERSION;
+	const bool longStrings = client.protocolVersion >= LONG_STRING_PROTOCOL_VERSION;
+
+	std::vector<Frame>& frames = message.frames[longStrings ? 2 : compact ? 1 : 0];
+
+	if (frames.empty())
+	{
+		const auto start = std::chrono::steady_clock::now();
+
+		const StringLengthScope scope(string_length(client.protocolVersion));
+
+		auto packet = std::make_shared<const std::vector<std::byte>>(compact ? message.message.pack_compact() : message.message.pack());
+
+		packed(message.message, packet);
+
+		// clients that understand CHUNK are never sent one frame with more than MAX_CHUNK_SIZE bytes of the packet
+		if (longStrings && packet->size() > MAX_CHUNK_SIZE)
+		{
+			for (const ChunkFrame& chunk : split_into_chunks(packet->size()))
+			{
+				frames.push_back(Frame{ packet, chunk });
+			}
+		}
+		else
+		{
+			frames.push_back(Frame{ std::move(packet) });
+		}
+
+		message.packTime += std::chrono::steady_clock::now() - start;
+	}
+
+	for (const Frame& frame : frames)
+	{
+		message.bytes += frame.size();
+
+		client.queue->push(frame);
+	}
+}
+
+void Broadcaster::record(const PackedMessage& message)
+{
+	// nothing was packed when no client received the message
+	if (message.bytes != 0)
+	{
+		statistics().record_send(message.packTime, message.bytes);
+	}
+}
+
+bool Broadcaster::receives(const Client& client, std::span<const TaskID> taskPath) const
+{
+	// the client that made the change always hears about it
+	return client.queue == m_current || subscribed(client, taskPath);
+}
+
+bool Broadcaster::subscribed(const Client& client, std::span<const TaskID> taskPath) const
+{
+	if (client.subtrees.contains(NO_PARENT))
+	{
+		return true;
+	}
+
+	// messages that aren't about a single task go to every client with a subscription
+	if (taskPath.empty())
+	{
+		return !client.subtrees.empty();
+	}
+
+	return std::ranges::any_of(taskPath, [&](TaskID id) { return client.subtrees.contains(id); });
+}
@@ -1,11 +1,218 @@
 #pragma once
 
+#include "packets/chunk.hpp"
 #include "packets/message.hpp"
+#include "packets/task_id.hpp"
 
+#include <array>
+#include <chrono>
+#include <concepts>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <set>
+#include <span>
+#include <unordered_map>
+#include <vector>
+
+// a packed message. shared by every client it's sent to so that it only has to be packed once
+using SharedPacket = std::shared_ptr<const std::vector<std::byte>>;
+
+// a frame queued for a client, either a whole packet or one CHUNK of it. a chunk is written as its header and then its
+// part of the packet, so every chunk of a packet shares the one buffer with the others and with every client
+struct Frame
+{
+	SharedPacket packet;
+	std::optional<ChunkFrame> chunk;
+
+	// empty for a whole packet
+	std::span<const std::byte> header() const
+	{
+		return chunk ? std::span<const std::byte>(chunk->header) : std::span<const std::byte>();
+	}
+
+	std::span<const std::byte> payload() const
+	{
+		return chunk ? std::span(*packet).subspan(chunk->offset, chunk->size) : std::span<const std::byte>(*packet);
+	}
+
+	std::size_t size() const { return header().size() + payload().size(); }
+
+	explicit operator bool() const { return packet != nullptr; }
+};
 
 struct PacketSender
 {
 	virtual ~PacketSender() = default;
 
 	virtual void send(std::unique_ptr<Message> message) = 0;
+
+	// a message that only has to live for the call, like a response built on the stack. senders that pack it right
+	// away don't allocate, the others are given a copy
+	template<typename T>
+		requires std::derived_from<T, Message>
+	void send(const T& message)
+	{
+		send_message(message, [](const Message& original) -> std::unique_ptr<Message> { return std::make_unique<T>(static_cast<const T&>(original)); });
+	}
+
+	using MessageCopy = std::unique_ptr<Message>(*)(const Message&);
+
+	virtual void send_message(const Message& message, MessageCopy copy) { send(copy(message)); }
+
+	// messages that aren't a response to any request, like the results of scheduled backups. they go to every client,
+	// even when they're sent from another thread while a request is being handled
+	virtual void send_to_all(std::unique_ptr<Message> message) { send(std::move(message)); }
+
+	// change notifications that every client looking at the task should see. the path is the task followed by its
+	// parents, empty when the message isn't about one task. with a single client this is the same as send
+	virtual void broadcast(std::unique_ptr<Message> message, std::span<const TaskID> taskPath) { send(std::move(message)); }
+
+	// the TASK_INFO of a task, which is the version of the task that later deltas can be based on
+	virtual void broadcast_task(std::unique_ptr<Message> message, std::uint64_t version, std::span<const TaskID> taskPath)
+	{
+		broadcast(std::move(message), taskPath);
+	}
+
+	// a change that can be sent as a TASK_INFO_DELTA to clients that have enabled them and received the base version of
+	// the task. the full message is only built when a client needs it. with a single client every broadcast is received
+	virtual void broadcast_delta(std::unique_ptr<Message> delta, std::uint64_t base, std::uint64_t version, const std::function<std::unique_ptr<Message>()>& full, std::span<const TaskID> taskPath)
+	{
+		broadcast(m_deltas ? std::move(delta) : full(), taskPath);
+	}
+
+	// the client whose request is being handled understands TASK_INFO_DELTA
+	virtual void enable_deltas() { m_deltas = true; }
+
+	// the protocol version negotiated with the client whose request is being handled, 1 until it asks for another
+	virtual void set_protocol_version(std::int32_t version) { m_protocolVersion = version; }
+	virtual std::int32_t protocol_version() const { return m_protocolVersion; }
+
+	// change notifications for the subtree are broadcast to the client whose request is being handled. NO_PARENT for
+	// every task, which is what clients start with
+	virtual void subscribe(TaskID root) {}
+	virtual void unsubscribe(TaskID root) {}
+
+protected:
+	bool m_deltas = false;
+	std::int32_t m_protocolVersion = 1;
+};
+
+// packets waiting to be written to one client. filled by whichever thread handles a request and emptied by the thread
+// that writes to the client's socket
+//
+// a client that stops reading would have every broadcast pile up for it. once more than the limit is waiting the
+// queue drops it all and closes, and the client is disconnected
+class ClientQueue
+{
+public:
+	static constexpr std::size_t DEFAULT_LIMIT = 64 * 1024 * 1024;
+
+	explicit ClientQueue(std::size_t limit = DEFAULT_LIMIT) : m_limit(limit) {}
+
+	void push(Frame frame);
+
+	// blocks until there's a frame. returns an empty frame once the queue has been closed and everything in it was popped
+	Frame pop();
+
+	void close();
+
+	std::size_t size() const;
+
+	// bytes waiting to be written
+	std::size_t bytes() const;
+
+	// the queue was closed because the client fell too far behind
+	bool overflowed() const;
+
+private:
+	mutable std::mutex m_mutex;
+	std::condition_variable m_ready;
+	std::deque<Frame> m_frames;
+	std::size_t m_limit;
+	std::size_t m_bytes = 0;
+	bool m_closed = false;
+	bool m_overflowed = false;
+};
+
+// sender for several connected clients. sent messages are responses and only go to the client whose request is being
+// handled, or to every client when there isn't one. broadcasts go to that client and to every other client subscribed
+// to the task or one of its parents. send_to_all always goes to every client
+//
+// each client remembers the version of the last broadcast it received for every task. a client that missed the
+// broadcast a delta is based on, because it wasn't subscribed or connected yet, is sent the full TASK_INFO instead
+//
+// either way a message is packed once per protocol version that changes its bytes, and the same buffers are queued for
+// each client that receives it. the time spent packing and the bytes queued are recorded for the request being
+// handled on the calling thread
+class Broadcaster : public PacketSender
+{
+public:
+	void add_client(ClientQueue& client);
+	void remove_client(ClientQueue& client);
+
+	// the client whose request is being handled, nullptr between requests
+	void set_current(ClientQueue* client);
+
+	using PacketSender::send;
+
+	void send(std::unique_ptr<Message> message) override;
+	void send_message(const Message& message, MessageCopy copy) override;
+	void send_to_all(std::unique_ptr<Message> message) override;
+	void broadcast(std::unique_ptr<Message> message, std::span<const TaskID> taskPath) override;
+	void broadcast_task(std::unique_ptr<Message> message, std::uint64_t version, std::span<const TaskID> taskPath) override;
+	void broadcast_delta(std::unique_ptr<Message> delta, std::uint64_t base, std::uint64_t version, const std::function<std::unique_ptr<Message>()>& full, std::span<const TaskID> taskPath) override;
+
+	void enable_deltas() override;
+
+	void set_protocol_version(std::int32_t version) override;
+	std::int32_t protocol_version() const override;
+
+	void subscribe(TaskID root) override;
+	void unsubscribe(TaskID root) override;
+
+protected:
+	// called once for every message, before it's queued
+	virtual void packed(const Message& message, const SharedPacket& packet) {}
+
+private:
+	struct Client
+	{
+		ClientQueue* queue;
+		std::set<TaskID> subtrees{ NO_PARENT };
+		bool deltas = false;
+		std::int32_t protocolVersion = 1;
+
+		// version of the last broadcast of each task that was queued for the client
+		std::unordered_map<TaskID, std::uint64_t> versions;
+	};
+
+	// a message and the frames it has been packed into so far, one list for each wire format and string length that
+	// clients have negotiated. the list has several CHUNK frames when the packet was too large to send at once
+	struct PackedMessage
+	{
+		const Message& message;
+		std::array<std::vector<Frame>, 3> frames{};
+
+		std::chrono::steady_clock::duration packTime{};
+		std::size_t bytes = 0;
+	};
+
+	// queue the message for the client, packing it for the client's protocol version if it hasn't been already
+	void push(PackedMessage& message, const Client& client);
+
+	// records the packing and bytes queued for a message once it has been pushed to every client
+	static void record(const PackedMessage& message);
+
+	bool subscribed(const Client& client, std::span<const TaskID> taskPath) const;
+	bool receives(const Client& client, std::span<const TaskID> taskPath) const;
+
+	mutable std::mutex m_mutex;
+	std::vector<Client> m_clients;
+	ClientQueue* m_current = nullptr;
 };
@@ -1,5 +1,84 @@
 #include "packets.hpp"
 
+#include <algorithm>
+#include <string_view>
+#include <unordered_map>
+
+template<typename F, typename T>
+static std::size_t field_size(const T& message)
+{
+	using traits = field_traits<F>;
+
+	if constexpr (std::same_as<typename traits::wire_type, typename traits::member_type>)
+	{
+		return wire_size(message.*traits::member);
+	}
+	else
+	{
+		return sizeof(typename traits::wire_type);
+	}
+}
+
+// the fields of T::schema(). the size is known before anything is written, so the packet is allocated once and the
+// length goes in first instead of being inserted in front of everything else
+template<typename T>
+static std::vector<std::byte> pack_schema(const T& message)
+{
+	const std::size_t size = std::apply([&]<typename... F>(F...)
+		{
+			return sizeof(std::int32_t) + sizeof(PacketType) + (std::size_t(0) + ... + field_size<F>(message));
+		}, T::schema());
+
+	PacketBuilder builder;
+	builder.reserve(size);
+
+	builder.add(static_cast<std::int32_t>(size));
+	builder.add(message.packetType());
+
+	std::apply([&]<typename... F>(F...)
+		{
+			(builder.add(static_cast<typename field_traits<F>::wire_type>(message.*field_traits<F>::member)), ...);
+		}, T::schema());
+
+	return builder.release();
+}
+
+template<typename T, typename Tuple>
+constexpr bool constructible_with_packet_type = false;
+
+template<typename T, typename... Values>
+constexpr bool constructible_with_packet_type<T, std::tuple<Values...>> = std::is_constructible_v<T, PacketType, Values...>;
+
+// the fields of T::schema(), passed to the constructor of T in the same order. messages that can be more than one
+// packet type take the type as their first constructor argument
+template<typename T>
+static std::expected<T, UnpackError> unpack_schema(std::span<const std::byte> data)
+{
+	auto parser = PacketParser(data);
+
+	const auto packetType = parser.read<PacketType>("packetType");
+
+	// braces so the fields are read in order
+	auto values = std::apply([&]<typename... F>(F... fields)
+		{
+			return std::tuple{ static_cast<typename field_traits<F>::member_type>(parser.read<typename field_traits<F>::wire_type>(fields.name))... };
+		}, T::schema());
+
+	if (const auto& error = parser.error())
+	{
+		return std::unexpected(*error);
+	}
+
+	if constexpr (constructible_with_packet_type<T, decltype(values)>)
+	{
+		return std::make_from_tuple<T>(std::tuple_cat(std::tuple{ packetType }, std::move(values)));
+	}
+	else
+	{
+		return std::make_from_tuple<T>(std::move(values));
+	}
+}
+
 std::vector<std::byte> RequestMessage::pack() const
 {
 	PacketBuilder builder;
@@ -14,20 +93,18 @@ std::expected<RequestMessage, UnpackError> RequestMessage::unpack(std::span<cons
 {
 	auto parser = PacketParser(data);
 
-	const auto packetType = parser.parse_next<PacketType>();
-	const auto requestID = parser.parse_next<RequestID>();
+	const auto packetType = parser.read<PacketType>("packetType");
+	const auto requestID = parser.read<RequestID>("requestID");
 
-	try
+	if (const auto& error = parser.error())
 	{
-		return RequestMessage(packetType.value(), requestID.value());
-	}
-	catch (const std::bad_expected_access<UnpackError>& e)
-	{
-		return std::unexpected(e.error());
+		return std::unexpected(*error);
 	}
+	return RequestMessage(packetType, requestID);
 }
 
-std::vector<std::byte> CreateTaskMessage::pack() const
+template<typename String>
+std::vector<std::byte> BasicCreateTaskMessage<String>::pack() const
 {
 	PacketBuilder builder;
 
@@ -44,53 +121,53 @@ std::vector<std::byte> CreateTaskMessage::pack() const
 
 	for (auto&& time : timeEntry)
 	{
-		builder.add(time.category.id);
-		builder.add(time.code.id);
+		builder.add(time.categoryID);
+		builder.add(time.codeID);
 	}
 	
 	return builder.build();
 }
 
-std::expected<CreateTaskMessage, UnpackError> CreateTaskMessage::unpack(std::span<const std::byte> data, const TimeCategories& time_categories)
+template<typename String>
+std::expected<BasicCreateTaskMessage<String>, UnpackError> BasicCreateTaskMessage<String>::unpack(std::span<const std::byte> data, const TimeCategories& time_categories)
 {
 	auto parser = PacketParser(data);
 	
-	const auto packetType = parser.parse_next<PacketType>();
-	const auto requestID = parser.parse_next<RequestID>();
-	const auto parentID = parser.parse_next<TaskID>();
-	const auto name = parser.parse_next<std::string>();
-
-	try
-	{
-		auto task = CreateTaskMessage(parentID.value(), requestID.value(), name.value());
+	parser.skip<PacketType>("packetType");
+	const auto requestID = parser.read<RequestID>("requestID");
+	const auto parentID = parser.read<TaskID>("parentID");
 
-		const auto labelCount = parser.parse_next_immediate<std::int32_t>();
+	auto task = BasicCreateTaskMessage(parentID, requestID, parser.read<String>("name"));
 
-		for (std::int32_t i = 0; i < labelCount; i++)
-		{
-			task.labels.push_back(parser.parse_next<std::string>().value());
-		}
+	const auto labelCount = parser.read<std::int32_t>("labelCount");
 
-		const auto timeCodeCount = parser.parse_next_immediate<std::int32_t>();
+	for (std::int32_t i = 0; i < labelCount && !parser.error(); i++)
+	{
+		task.labels.push_back(parser.read<String>("labels"));
+	}
 
-		for (int i = 0; i < timeCodeCount; i++)
-		{
-			auto category = parser.parse_next_immediate<TimeCategoryID>();
-			auto code = parser.parse_next_immediate<TimeCodeID>();
+	const auto timeCodeCount = parser.read<std::int32_t>("timeCodeCount");
 
-			auto entry = time_categories.find(category, code);
-			task.timeEntry.push_back(TimeEntry{ entry.first, entry.second });
-		}
+	for (int i = 0; i < timeCodeCount && !parser.error(); i++)
+	{
+		auto category = parser.read<TimeCategoryID>("timeCategoryID");
+		auto code = parser.read<TimeCodeID>("timeCodeID");
 
-		return task;
+		task.timeEntry.push_back(time_categories.find(category, code));
 	}
-	catch (const std::bad_expected_access<UnpackError>& e)
+
+	if (const auto& error = parser.error())
 	{
-		return std::unexpected(e.error());
+		return std::unexpected(*error);
 	}
+	return task;
 }
 
-std::vector<std::byte> UpdateTaskMessage::pack() const
+template struct BasicCreateTaskMessage<std::string>;
+template struct BasicCreateTaskMessage<std::string_view>;
+
+template<typename String>
+std::vector<std::byte> BasicUpdateTaskMessage<String>::pack() const
 {
 	PacketBuilder builder;
 
@@ -112,60 +189,59 @@ std::vector<std::byte> UpdateTaskMessage::pack() const
 	builder.add(static_cast<std::int32_t>(timeEntry.size()));
 	for (auto&& time : timeEntry)
 	{
-		builder.add(time.category.id);
-		builder.add(time.code.id);
+		builder.add(time.categoryID);
+		builder.add(time.codeID);
 	}
 	return builder.build();
 }
 
-std::expected<UpdateTaskMessage, UnpackError> UpdateTaskMessage::unpack(std::span<const std::byte> data, const TimeCategories& time_categories)
+template<typename String>
+std::expected<BasicUpdateTaskMessage<String>, UnpackError> BasicUpdateTaskMessage<String>::unpack(std::span<const std::byte> data, const TimeCategories& time_categories)
 {
 	auto parser = PacketParser(data);
 
-	const auto packetType = parser.parse_next<PacketType>();
-	const auto requestID = parser.parse_next<RequestID>();
-	const auto taskID = parser.parse_next<TaskID>();
-	const auto parentID = parser.parse_next<TaskID>();
-	const auto state = parser.parse_next<TaskState>();
-	const auto indexInParent = parser.parse_next<std::int32_t>();
-	const auto serverControlled = parser.parse_next<bool>();
-	const auto locked = parser.parse_next<bool>();
-	const auto name = parser.parse_next<std::string>();
-
-	try
-	{
-		auto update = UpdateTaskMessage(requestID.value(), taskID.value(), parentID.value(), name.value());
-		update.state = state.value();
-		update.indexInParent = indexInParent.value();
-		update.serverControlled = serverControlled.value();
-		update.locked = locked.value();
+	parser.skip<PacketType>("packetType");
+	const auto requestID = parser.read<RequestID>("requestID");
+	const auto taskID = parser.read<TaskID>("taskID");
+	const auto parentID = parser.read<TaskID>("parentID");
+	const auto state = parser.read<TaskState>("state");
+	const auto indexInParent = parser.read<std::int32_t>("indexInParent");
+	const auto serverControlled = parser.read<bool>("serverControlled");
+	const auto locked = parser.read<bool>("locked");
 
-		const auto labelCount = parser.parse_next_immediate<std::int32_t>();
+	auto update = BasicUpdateTaskMessage(requestID, taskID, parentID, parser.read<String>("name"));
+	update.state = state;
+	update.indexInParent = indexInParent;
+	update.serverControlled = serverControlled;
+	update.locked = locked;
 
-		for (std::int32_t i = 0; i < labelCount; i++)
-		{
-			update.labels.push_back(parser.parse_next<std::string>().value());
-		}
+	const auto labelCount = parser.read<std::int32_t>("labelCount");
 
-		const auto timeCodeCount = parser.parse_next_immediate<std::int32_t>();
+	for (std::int32_t i = 0; i < labelCount && !parser.error(); i++)
+	{
+		update.labels.push_back(parser.read<String>("labels"));
+	}
 
-		for (int i = 0; i < timeCodeCount; i++)
-		{
-			auto category = parser.parse_next_immediate<TimeCategoryID>();
-			auto code = parser.parse_next_immediate<TimeCodeID>();
+	const auto timeCodeCount = parser.read<std::int32_t>("timeCodeCount");
 
-			auto entry = time_categories.find(category, code);
-			update.timeEntry.push_back(TimeEntry{ entry.first, entry.second });
-		}
+	for (int i = 0; i < timeCodeCount && !parser.error(); i++)
+	{
+		auto category = parser.read<TimeCategoryID>("timeCategoryID");
+		auto code = parser.read<TimeCodeID>("timeCodeID");
 
-		return update;
+		update.timeEntry.push_back(time_categories.find(category, code));
 	}
-	catch (const std::bad_expected_access<UnpackError>& e)
+
+	if (const auto& error = parser.error())
 	{
-		return std::unexpected(e.error());
+		return std::unexpected(*error);
 	}
+	return update;
 }
 
+template struct BasicUpdateTaskMessage<std::string>;
+template struct BasicUpdateTaskMessage<std::string_view>;
+
 std::vector<std::byte> UpdateTaskTimesMessage::pack() const
 {
 	PacketBuilder builder;
@@ -186,91 +262,45 @@ std::expected<UpdateTaskTimesMessage, UnpackError> UpdateTaskTimesMessage::unpac
 {
 	auto parser = PacketParser(data);
 
-	const auto packetType = parser.parse_next<PacketType>();
-	const auto requestID = parser.parse_next<RequestID>();
-	const auto taskID = parser.parse_next<TaskID>();
-	const auto sessionIndex = parser.parse_next<std::int32_t>();
-	const auto start = parser.parse_next<std::chrono::milliseconds>();
-	const auto stopPresent = parser.parse_next<bool>();
-	const auto stop = parser.parse_next<std::chrono::milliseconds>();
-	const auto checkForOverlaps = parser.parse_next<bool>();
+	const auto packetType = parser.read<PacketType>("packetType");
+	const auto requestID = parser.read<RequestID>("requestID");
+	const auto taskID = parser.read<TaskID>("taskID");
+	const auto sessionIndex = parser.read<std::int32_t>("sessionIndex");
+	const auto start = parser.read<std::chrono::milliseconds>("start");
+	const auto stopPresent = parser.read<bool>("stopPresent");
+	const auto stop = parser.read<std::chrono::milliseconds>("stop");
+	const auto checkForOverlaps = parser.read<bool>("checkForOverlaps");
 
-	try
+	if (const auto& error = parser.error())
 	{
-		auto stopOpt = stopPresent.value() ? std::optional(stop.value()) : std::nullopt;
+		return std::unexpected(*error);
+	}
 
-		auto update = UpdateTaskTimesMessage(packetType.value(), requestID.value(), taskID.value(), start.value(), stopOpt);
-		update.sessionIndex = sessionIndex.value();
-		update.checkForOverlaps = checkForOverlaps.value();
+	auto update = UpdateTaskTimesMessage(packetType, requestID, taskID, start, stopPresent ? std::optional(stop) : std::nullopt);
+	update.sessionIndex = sessionIndex;
+	update.checkForOverlaps = checkForOverlaps;
 
-		return update;
-	}
-	catch (const std::bad_expected_access<UnpackError>& e)
-	{
-		return std::unexpected(e.error());
-	}
+	return update;
 }
 
 std::vector<std::byte> TaskMessage::pack() const
 {
-	PacketBuilder builder;
-
-	builder.add(static_cast<std::int32_t>(packetType()));
-	builder.add(requestID);
-	builder.add(taskID);
-
-	return builder.build();
+	return pack_schema(*this);
 }
 
 std::expected<TaskMessage, UnpackError> TaskMessage::unpack(std::span<const std::byte> data)
 {
-	auto parser = PacketParser(data);
-
-	const auto packetType = parser.parse_next<PacketType>();
-	const auto requestID = parser.parse_next<RequestID>();
-	const auto taskID = parser.parse_next<TaskID>();
-
-	try
-	{
-		return TaskMessage(packetType.value(), requestID.value(), taskID.value());
-	}
-	catch (const std::bad_expected_access<UnpackError>& e)
-	{
-		return std::unexpected(e.error());
-	}
+	return unpack_schema<TaskMessage>(data);
 }
 
 std::vector<std::byte> TaskStateChange::pack() const
 {
-	PacketBuilder builder;
-
-	builder.add(static_cast<std::int32_t>(packetType()));
-	builder.add(requestID);
-	builder.add(taskID);
-	builder.add(state);
-
-	return builder.build();
+	return pack_schema(*this);
 }
 
 std::expected<TaskStateChange, UnpackError> TaskStateChange::unpack(std::span<const std::byte> data)
 {
-	auto parser = PacketParser(data);
-
-	const auto packetType = parser.parse_next<PacketType>();
-	const auto requestID = parser.parse_next<RequestID>();
-	const auto taskID = parser.parse_next<TaskID>();
-	const auto state = parser.parse_next<TaskState>();
-
-	try
-	{
-		(void)packetType.value();
-
-		return TaskStateChange(requestID.value(), taskID.value(), state.value());
-	}
-	catch (const std::bad_expected_access<UnpackError>& e)
-	{
-		return std::unexpected(e.error());
-	}
+	return unpack_schema<TaskStateChange>(data);
 }
 
 std::vector<std::byte> TimeEntryDataPacket::pack() const
@@ -301,43 +331,41 @@ std::expected<TimeEntryDataPacket, UnpackError> TimeEntryDataPacket::unpack(std:
 {
 	auto parser = PacketParser(data);
 
-	const auto packetType = parser.parse_next<PacketType>();
-	
-	try
-	{
-		TimeEntryDataPacket data({});
+	parser.skip<PacketType>("packetType");
 
-		const std::int32_t timeCategoryCount = parser.parse_next<std::int32_t>().value();
+	TimeEntryDataPacket packet({});
 
-		for (int i = 0; i < timeCategoryCount; i++)
-		{
-			auto id = parser.parse_next_immediate<TimeCategoryID>();
-			auto name = parser.parse_next_immediate<std::string>();
-			TimeCategory timeCategory(id, name);
+	const auto timeCategoryCount = parser.read<std::int32_t>("timeCategoryCount");
 
-			const std::int32_t timeCodeCount = parser.parse_next_immediate<std::int32_t>();
+	for (int i = 0; i < timeCategoryCount && !parser.error(); i++)
+	{
+		const auto id = parser.read<TimeCategoryID>("timeCategoryID");
+		const auto name = parser.read<std::string>("timeCategoryName");
+		TimeCategory timeCategory(id, name);
 
-			for (int j = 0; j < timeCodeCount; j++)
-			{
-				auto codeID = parser.parse_next_immediate<TimeCodeID>();
-				auto codeName = parser.parse_next_immediate<std::string>();
-				TimeCode timeCode(codeID, codeName);
-				timeCode.archived = parser.parse_next_immediate<bool>();
+		const auto timeCodeCount = parser.read<std::int32_t>("timeCodeCount");
 
-				timeCategory.codes.push_back(timeCode);
-			}
-			data.timeCategories.push_back(timeCategory);
+		for (int j = 0; j < timeCodeCount && !parser.error(); j++)
+		{
+			const auto codeID = parser.read<TimeCodeID>("timeCodeID");
+			const auto codeName = parser.read<std::string>("timeCodeName");
+			TimeCode timeCode(codeID, codeName);
+			timeCode.archived = parser.read<bool>("archived");
+
+			timeCategory.codes.push_back(timeCode);
 		}
-		
-		return data;
+		packet.timeCategories.push_back(timeCategory);
 	}
-	catch (const std::bad_expected_access<UnpackError>& e)
+
+	if (const auto& error = parser.error())
 	{
-		return std::unexpected(e.error());
+		return std::unexpected(*error);
 	}
+	return packet;
 }
 
-std::vector<std::byte> TimeEntryModifyPacket::pack() const
+template<typename String>
+std::vector<std::byte> BasicTimeEntryModifyPacket<String>::pack() const
 {
 	PacketBuilder builder;
 
@@ -365,49 +393,49 @@ std::vector<std::byte> TimeEntryModifyPacket::pack() const
 	return builder.build();
 }
 
-std::expected<TimeEntryModifyPacket, UnpackError> TimeEntryModifyPacket::unpack(std::span<const std::byte> data)
+template<typename String>
+std::expected<BasicTimeEntryModifyPacket<String>, UnpackError> BasicTimeEntryModifyPacket<String>::unpack(std::span<const std::byte> data)
 {
 	auto parser = PacketParser(data);
 
-	const auto packetType = parser.parse_next<PacketType>();
-	const auto requestID = parser.parse_next<RequestID>();
+	parser.skip<PacketType>("packetType");
 
-	const auto categoryCount = parser.parse_next<std::int32_t>();
+	BasicTimeEntryModifyPacket packet(parser.read<RequestID>("requestID"));
 
-	try
-	{
-		TimeEntryModifyPacket packet(requestID.value());
+	const auto categoryCount = parser.read<std::int32_t>("categoryCount");
 
-		for (int i = 0; i < categoryCount.value(); i++)
-		{
-			const auto type = parser.parse_next_immediate<TimeCategoryModType>();
-			const auto id = parser.parse_next_immediate<TimeCategoryID>();
-			const auto name = parser.parse_next_immediate<std::string>();
+	for (int i = 0; i < categoryCount && !parser.error(); i++)
+	{
+		const auto type = parser.read<TimeCategoryModType>("categoryModType");
+		const auto id = parser.read<TimeCategoryID>("timeCategoryID");
+		const auto name = parser.read<String>("categoryName");
 
-			packet.categories.emplace_back(type, id, name);
-		}
+		packet.categories.emplace_back(type, id, name);
+	}
 
-		const auto codeCount = parser.parse_next_immediate<std::int32_t>();
+	const auto codeCount = parser.read<std::int32_t>("codeCount");
 
-		for (int i = 0; i < codeCount; i++)
-		{
-			const auto type = parser.parse_next_immediate<TimeCategoryModType>();
-			const auto categoryIndex = parser.parse_next_immediate<std::int32_t>();
-			const auto id = parser.parse_next_immediate<TimeCodeID>();
-			const auto name = parser.parse_next_immediate<std::string>();
-			const auto archive = parser.parse_next_immediate<bool>();
+	for (int i = 0; i < codeCount && !parser.error(); i++)
+	{
+		const auto type = parser.read<TimeCategoryModType>("codeModType");
+		const auto categoryIndex = parser.read<std::int32_t>("categoryIndex");
+		const auto id = parser.read<TimeCodeID>("timeCodeID");
+		const auto name = parser.read<String>("codeName");
+		const auto archive = parser.read<bool>("archive");
 
-			packet.codes.emplace_back(type, categoryIndex, id, name, archive);
-		}
-		
-		return packet;
+		packet.codes.emplace_back(type, categoryIndex, id, name, archive);
 	}
-	catch (const std::bad_expected_access<UnpackError>& e)
+
+	if (const auto& error = parser.error())
 	{
-		return std::unexpected(e.error());
+		return std::unexpected(*error);
 	}
+	return packet;
 }
 
+template struct BasicTimeEntryModifyPacket<std::string>;
+template struct BasicTimeEntryModifyPacket<std::string_view>;
+
 std::vector<std::byte> SuccessResponse::pack() const
 {
 	PacketBuilder builder;
@@ -422,14 +450,15 @@ std::expected<SuccessResponse, UnpackError> SuccessResponse::unpack(std::span<co
 {
 	auto parser = PacketParser(data);
 
-	const auto packetType = parser.parse_next<PacketType>();
-	const auto requestID = parser.parse_next<RequestID>();
+	parser.skip<PacketType>("packetType");
+
+	const auto requestID = parser.read<RequestID>("requestID");
 
-	if (requestID)
+	if (const auto& error = parser.error())
 	{
-		return SuccessResponse(RequestOrigin{ static_cast<PacketType>(0), requestID.value() });
+		return std::unexpected(*error);
 	}
-	return std::unexpected(requestID.error());
+	return SuccessResponse(RequestOrigin{ static_cast<PacketType>(0), requestID });
 }
 
 std::vector<std::byte> FailureResponse::pack() const
@@ -447,40 +476,26 @@ std::expected<FailureResponse, UnpackError> FailureResponse::unpack(std::span<co
 {
 	auto parser = PacketParser(data);
 
-	const auto packetType = parser.parse_next<PacketType>();
-	const auto requestID = parser.parse_next<RequestID>();
-	const auto name = parser.parse_next<std::string>();
+	parser.skip<PacketType>("packetType");
 
-	try
-	{
-		return FailureResponse(RequestOrigin{ static_cast<PacketType>(0), requestID.value() }, name.value());
-	}
-	catch (const std::bad_expected_access<UnpackError>& e)
+	const auto requestID = parser.read<RequestID>("requestID");
+	const auto message = parser.read<std::string>("message");
+
+	if (const auto& error = parser.error())
 	{
-		return std::unexpected(e.error());
+		return std::unexpected(*error);
 	}
+	return FailureResponse(RequestOrigin{ static_cast<PacketType>(0), requestID }, message);
 }
 
 std::vector<std::byte> BasicMessage::pack() const
 {
-	PacketBuilder builder;
-
-	builder.add(packetType());
-
-	return builder.build();
+	return pack_schema(*this);
 }
 
 std::expected<BasicMessage, UnpackError> BasicMessage::unpack(std::span<const std::byte> data)
 {
-	auto parser = PacketParser(data);
-
-	const auto packetType = parser.parse_next<PacketType>();
-
-	if (packetType)
-	{
-		return BasicMessage(packetType.value());
-	}
-	return std::unexpected(packetType.error());
+	return unpack_schema<BasicMessage>(data);
 }
 
 std::vector<std::byte> TaskInfoMessage::pack() const
@@ -512,8 +527,8 @@ std::vector<std::byte> TaskInfoMessage::pack() const
 
 		for (auto&& entry : time.timeEntry)
 		{
-			builder.add(entry.category.id);
-			builder.add(entry.code.id);
+			builder.add(entry.categoryID);
+			builder.add(entry.codeID);
 		}
 	}
 
@@ -528,8 +543,8 @@ std::vector<std::byte> TaskInfoMessage::pack() const
 
 	for (auto&& time : timeEntry)
 	{
-		builder.add(time.category.id);
-		builder.add(time.code.id);
+		builder.add(time.categoryID);
+		builder.add(time.codeID);
 	}
 
 	return builder.build();
@@ -539,301 +554,568 @@ std::expected<TaskInfoMessage, UnpackError> TaskInfoMessage::unpack(std::span<co
 {
 	auto parser = PacketParser(data);
 
-	const auto packetType = parser.parse_next<PacketType>();
-	const auto taskID = parser.parse_next<TaskID>();
-	const auto parentID = parser.parse_next<TaskID>();
-	const auto state = parser.parse_next<TaskState>();
-	const auto newTask = parser.parse_next<bool>();
-	const auto indexInParent = parser.parse_next<std::int32_t>();
-	const auto serverControlled = parser.parse_next<bool>();
-	const auto locked = parser.parse_next<bool>();
-	const auto name = parser.parse_next<std::string>();
-
-	try
-	{
-		auto info = TaskInfoMessage(taskID.value(), parentID.value(), name.value());
-		info.state = state.value();
-		info.newTask = newTask.value();
-		info.indexInParent = indexInParent.value();
-		info.serverControlled = serverControlled.value();
-		info.locked = locked.value();
-
-		info.createTime = parser.parse_next_immediate<std::chrono::milliseconds>();
-
-		const bool finishTimePresent = parser.parse_next_immediate<bool>();
-
-		if (finishTimePresent)
-		{
-			info.finishTime = parser.parse_next_immediate<std::chrono::milliseconds>();
-		}
+	parser.skip<PacketType>("packetType");
 
-		const auto startStopCount = parser.parse_next_immediate<std::int32_t>();
+	const auto taskID = parser.read<TaskID>("taskID");
+	const auto parentID = parser.read<TaskID>("parentID");
+	const auto state = parser.read<TaskState>("state");
+	const auto newTask = parser.read<bool>("newTask");
+	const auto indexInParent = parser.read<std::int32_t>("indexInParent");
+	const auto serverControlled = parser.read<bool>("serverControlled");
+	const auto locked = parser.read<bool>("locked");
+	auto name = parser.read<std::string>("name");
 
-		for (std::int32_t i = 0; i < startStopCount; i++)
-		{
-			TaskTimes times;
+	auto info = TaskInfoMessage(taskID, parentID, std::move(name));
+	info.state = state;
+	info.newTask = newTask;
+	info.indexInParent = indexInParent;
+	info.serverControlled = serverControlled;
+	info.locked = locked;
 
-			times.start = parser.parse_next_immediate<std::chrono::milliseconds>();
+	info.createTime = parser.read<std::chrono::milliseconds>("createTime");
 
-			const bool stopPresent = parser.parse_next_immediate<bool>();
+	// the finish time is always packed, 0 when there isn't one
+	const bool finishTimePresent = parser.read<bool>("finishTimePresent");
+	const auto finishTime = parser.read<std::chrono::milliseconds>("finishTime");
 
-			if (stopPresent)
-			{
-				times.stop = parser.parse_next_immediate<std::chrono::milliseconds>();
-			}
+	if (finishTimePresent)
+	{
+		info.finishTime = finishTime;
+	}
 
-			const auto entryCount = parser.parse_next_immediate<std::int32_t>();
+	const auto startStopCount = parser.read<std::int32_t>("sessionCount");
 
-			for (std::int32_t j = 0; j < entryCount; j++)
-			{
-				auto category = parser.parse_next_immediate<TimeCategoryID>();
-				auto code = parser.parse_next_immediate<TimeCodeID>();
+	for (std::int32_t i = 0; i < startStopCount && !parser.error(); i++)
+	{
+		TaskTimes times;
 
-				auto entry = time_categories.find(category, code);
-				times.timeEntry.push_back(TimeEntry{ entry.first, entry.second });
-			}
-			info.times.push_back(times);
-		}
+		times.start = parser.read<std::chrono::milliseconds>("start");
 
-		const auto labelCount = parser.parse_next_immediate<std::int32_t>();
+		const bool stopPresent = parser.read<bool>("stopPresent");
+		const auto stop = parser.read<std::chrono::milliseconds>("stop");
 
-		for (std::int32_t i = 0; i < labelCount; i++)
+		if (stopPresent)
 		{
-			info.labels.push_back(parser.parse_next_immediate<std::string>());
+			times.stop = stop;
 		}
 
-		const auto codeCount = parser.parse_next_immediate<std::int32_t>();
+		const auto entryCount = parser.read<std::int32_t>("sessionTimeEntryCount");
 
-		for (std::int32_t i = 0; i < codeCount; i++)
+		for (std::int32_t j = 0; j < entryCount && !parser.error(); j++)
 		{
-			auto category = parser.parse_next_immediate<TimeCategoryID>();
-			auto code = parser.parse_next_immediate<TimeCodeID>();
+			const auto category = parser.read<TimeCategoryID>("timeCategoryID");
+			const auto code = parser.read<TimeCodeID>("timeCodeID");
 
-			auto entry = time_categories.find(category, code);
-			info.timeEntry.push_back(TimeEntry{ entry.first, entry.second });
+			times.timeEntry.push_back(time_categories.find(category, code));
 		}
-		return info;
-	}
-	catch (const std::bad_expected_access<UnpackError>& e)
-	{
-		return std::unexpected(e.error());
+		info.times.push_back(times);
 	}
-}
 
-std::vector<std::byte> BugzillaInfoMessage::pack() const
-{
-	PacketBuilder builder;
+	const auto labelCount = parser.read<std::int32_t>("labelCount");
 
-	builder.add(PacketType::BUGZILLA_INFO);
-	builder.add(instanceID);
-	builder.add(name);
-	builder.add(URL);
-	builder.add(apiKey);
-	builder.add(username);
-	builder.add(rootTaskID);
+	for (std::int32_t i = 0; i < labelCount && !parser.error(); i++)
+	{
+		info.labels.push_back(parser.read<std::string>("label"));
+	}
 
-	builder.add<std::int32_t>(groupTasksBy.size());
+	const auto codeCount = parser.read<std::int32_t>("timeEntryCount");
 
-	for (auto&& value : groupTasksBy)
+	for (std::int32_t i = 0; i < codeCount && !parser.error(); i++)
 	{
-		builder.add(value);
+		const auto category = parser.read<TimeCategoryID>("timeCategoryID");
+		const auto code = parser.read<TimeCodeID>("timeCodeID");
+
+		info.timeEntry.push_back(time_categories.find(category, code));
 	}
-	
-	builder.add<std::int32_t>(labelToField.size());
 
-	for (auto&& value : labelToField)
+	if (const auto& error = parser.error())
 	{
-		builder.add(value.first);
-		builder.add(value.second);
+		return std::unexpected(*error);
 	}
-	return builder.build();
+	return info;
 }
 
-std::expected<BugzillaInfoMessage, UnpackError> BugzillaInfoMessage::unpack(std::span<const std::byte> data)
+// flags byte of the compact TASK_INFO
+enum CompactTaskFlags : std::uint8_t
 {
-	auto parser = PacketParser(data);
-
-	const auto packetType = parser.parse_next<PacketType>();
-	const auto id = parser.parse_next<BugzillaInstanceID>();
-	const auto name = parser.parse_next<std::string>();
-	const auto URL = parser.parse_next<std::string>();
-	const auto apiKey = parser.parse_next<std::string>();
-	const auto username = parser.parse_next<std::string>();
-	const auto rootTaskID = parser.parse_next<TaskID>();
+	COMPACT_NEW_TASK = 1 << 0,
+	COMPACT_SERVER_CONTROLLED = 1 << 1,
+	COMPACT_LOCKED = 1 << 2,
+	COMPACT_FINISHED = 1 << 3,
+};
+
+// IDs are written as their 32-bit pattern so that the rare negative one doesn't take 10 bytes
+static void add_compact_id(PacketBuilder& builder, std::int32_t id)
+{
+	builder.add_varint(static_cast<std::uint32_t>(id));
+}
 
-	try
-	{
-		auto info = BugzillaInfoMessage(id.value(), name.value(), URL.value(), apiKey.value());
-		info.username = username.value();
-		info.rootTaskID = rootTaskID.value();
+static std::int32_t read_compact_id(PacketParser& parser, std::string_view field)
+{
+	return static_cast<std::int32_t>(static_cast<std::uint32_t>(parser.read_varint(field)));
+}
 
-		const std::int32_t groupByCount = parser.parse_next_immediate<std::int32_t>();
+// the start of each session is relative to the end of the one before it, starting from the create time. the stop is
+// the length of the session + 1, 0 while it's running
+static void add_compact_sessions(PacketBuilder& builder, const std::vector<TaskTimes>& times, std::chrono::milliseconds previous)
+{
+	builder.add_varint(times.size());
 
-		for (int i = 0; i < groupByCount; i++)
-		{
-			info.groupTasksBy.push_back(parser.parse_next_immediate<std::string>());
-		}
+	for (auto&& time : times)
+	{
+		builder.add_zigzag((time.start - previous).count());
+		builder.add_varint(time.stop ? (time.stop.value() - time.start).count() + 1 : 0);
 
-		const std::int32_t count = parser.parse_next_immediate<std::int32_t>();
+		builder.add_varint(time.timeEntry.size());
 
-		for (int i = 0; i < count; i++)
+		for (auto&& entry : time.timeEntry)
 		{
-			const auto label = parser.parse_next_immediate<std::string>();
-			const auto field = parser.parse_next_immediate<std::string>();
-
-			info.labelToField.emplace(label, field);
+			add_compact_id(builder, entry.categoryID._val);
+			add_compact_id(builder, entry.codeID._val);
 		}
-
-		return info;
-	}
-	catch (const std::bad_expected_access<UnpackError>& e)
-	{
-		return std::unexpected(e.error());
+		previous = time.stop.value_or(time.start);
 	}
 }
 
-std::vector<std::byte> RequestDailyReportMessage::pack() const
+std::vector<std::byte> TaskInfoMessage::pack_compact() const
 {
 	PacketBuilder builder;
 
-	builder.add(PacketType::REQUEST_DAILY_REPORT);
-	builder.add(requestID);
-	builder.add<std::int8_t>(month);
-	builder.add<std::int8_t>(day);
-	builder.add<std::int16_t>(year);
-
-	return builder.build();
-}
+	builder.add(PacketType::TASK_INFO);
+	add_compact_id(builder, taskID._val);
+	add_compact_id(builder, parentID._val);
+	builder.add<std::uint8_t>((newTask ? COMPACT_NEW_TASK : 0) | (serverControlled ? COMPACT_SERVER_CONTROLLED : 0) | (locked ? COMPACT_LOCKED : 0) | (finishTime ? COMPACT_FINISHED : 0));
+	builder.add_varint(static_cast<std::uint32_t>(state));
+	builder.add_varint(static_cast<std::uint32_t>(indexInParent));
+	builder.add_compact(name);
+	builder.add_zigzag(createTime.count());
+
+	if (finishTime)
+	{
+		builder.add_zigzag((finishTime.value() - createTime).count());
+	}
 
-std::expected<RequestDailyReportMessage, UnpackError> RequestDailyReportMessage::unpack(std::span<const std::byte> data)
-{
-	auto parser = PacketParser(data);
+	add_compact_sessions(builder, times, createTime);
 
-	const auto packetType = parser.parse_next<PacketType>();
-	const auto requestID = parser.parse_next<RequestID>();
-	const auto month = parser.parse_next<std::int8_t>();
-	const auto day = parser.parse_next<std::int8_t>();
-	const auto year = parser.parse_next<std::int16_t>();
+	builder.add_varint(labels.size());
 
-	try
-	{
-		return RequestDailyReportMessage(requestID.value(), month.value(), day.value(), year.value());
-	}
-	catch (const std::bad_expected_access<UnpackError>& e)
+	for (const std::string& label : labels)
 	{
-		return std::unexpected(e.error());
+		builder.add_compact(label);
 	}
-}
 
-std::vector<std::byte> RequestWeeklyReportMessage::pack() const
-{
-	PacketBuilder builder;
+	builder.add_varint(timeEntry.size());
 
-	builder.add(PacketType::REQUEST_WEEKLY_REPORT);
-	builder.add(requestID);
-	builder.add<std::int8_t>(month);
-	builder.add<std::int8_t>(day);
-	builder.add<std::int16_t>(year);
+	for (auto&& entry : timeEntry)
+	{
+		add_compact_id(builder, entry.categoryID._val);
+		add_compact_id(builder, entry.codeID._val);
+	}
 
 	return builder.build();
 }
 
-std::expected<RequestWeeklyReportMessage, UnpackError> RequestWeeklyReportMessage::unpack(std::span<const std::byte> data)
+std::expected<TaskInfoMessage, UnpackError> TaskInfoMessage::unpack_compact(std::span<const std::byte> data, const TimeCategories& time_categories)
 {
 	auto parser = PacketParser(data);
 
-	const auto packetType = parser.parse_next<PacketType>();
-	const auto requestID = parser.parse_next<RequestID>();
-	const auto month = parser.parse_next<std::int8_t>();
-	const auto day = parser.parse_next<std::int8_t>();
-	const auto year = parser.parse_next<std::int16_t>();
+	parser.skip<PacketType>("packetType");
 
-	try
-	{
-		return RequestWeeklyReportMessage(requestID.value(), month.value(), day.value(), year.value());
-	}
-	catch (const std::bad_expected_access<UnpackError>& e)
+	const auto taskID = TaskID(read_compact_id(parser, "taskID"));
+	const auto parentID = TaskID(read_compact_id(parser, "parentID"));
+	const auto flags = parser.read<std::uint8_t>("flags");
+	const auto state = static_cast<TaskState>(parser.read_varint("state"));
+	const auto indexInParent = static_cast<std::int32_t>(parser.read_varint("indexInParent"));
+	auto name = parser.read_compact_string("name");
+	const auto createTime = std::chrono::milliseconds(parser.read_zigzag("createTime"));
+
+	auto info = TaskInfoMessage(taskID, parentID, std::move(name), createTime);
+	info.state = state;
+	info.indexInParent = indexInParent;
+	info.newTask = (flags & COMPACT_NEW_TASK) != 0;
+	info.serverControlled = (flags & COMPACT_SERVER_CONTROLLED) != 0;
+	info.locked = (flags & COMPACT_LOCKED) != 0;
+
+	if (flags & COMPACT_FINISHED)
 	{
-		return std::unexpected(e.error());
+		info.finishTime = info.createTime + std::chrono::milliseconds(parser.read_zigzag("finishTime"));
 	}
-}
 
-std::vector<std::byte> DailyReportMessage::pack() const
-{
-	PacketBuilder builder;
+	auto previous = info.createTime;
 
-	builder.add(PacketType::DAILY_REPORT);
-	builder.add(request.id);
-	builder.add(reportTime);
-	builder.add(report.found);
-	builder.add<std::int8_t>(report.month);
-	builder.add<std::int8_t>(report.day);
-	builder.add<std::int16_t>(report.year);
-	
-	if (report.found)
+	const auto sessionCount = parser.read_varint("sessionCount");
+
+	for (std::uint64_t i = 0; i < sessionCount && !parser.error(); i++)
 	{
-		builder.add(report.startTime);
-		builder.add(report.endTime);
-		builder.add(report.totalTime);
+		TaskTimes times;
 
-		builder.add<std::int32_t>(report.timePerTimeEntry.size());
+		times.start = previous + std::chrono::milliseconds(parser.read_zigzag("start"));
 
-		for (auto&& timeEntry : report.timePerTimeEntry)
+		const auto length = parser.read_varint("length");
+
+		if (length > 0)
 		{
-			builder.add(timeEntry.first.category.id);
-			builder.add(timeEntry.first.code.id);
-			builder.add(timeEntry.second);
+			times.stop = times.start + std::chrono::milliseconds(length - 1);
 		}
 
-		builder.add<std::int32_t>(report.times.size());
+		const auto entryCount = parser.read_varint("sessionTimeEntryCount");
 
-		for (auto&& pair : report.times)
+		for (std::uint64_t j = 0; j < entryCount && !parser.error(); j++)
 		{
-			builder.add(pair.taskID);
-			builder.add(pair.startStopIndex);
-		}
-	}
+			const auto category = TimeCategoryID(read_compact_id(parser, "timeCategoryID"));
+			const auto code = TimeCodeID(read_compact_id(parser, "timeCodeID"));
 
-	return builder.build();
-}
+			times.timeEntry.push_back(time_categories.find(category, code));
+		}
+		previous = times.stop.value_or(times.start);
 
-std::expected<DailyReportMessage, UnpackError> DailyReportMessage::unpack(std::span<const std::byte> data)
-{
-	auto parser = PacketParser(data);
+		info.times.push_back(times);
+	}
 
-	const auto packetType = parser.parse_next<PacketType>();
-	const auto requestID = parser.parse_next<RequestID>();
-	const auto reportTime = parser.parse_next<std::chrono::milliseconds>();
-	const auto reportFound = parser.parse_next<bool>();
-	
+	const auto labelCount = parser.read_varint("labelCount");
 
-	try
+	for (std::uint64_t i = 0; i < labelCount && !parser.error(); i++)
 	{
-		if (!reportFound.value())
-		{
-			return DailyReportMessage(RequestOrigin{ static_cast<PacketType>(0), requestID.value() }, reportTime.value());
-		}
+		info.labels.push_back(parser.read_compact_string("label"));
+	}
 
-		auto report = DailyReportMessage(RequestOrigin{ static_cast<PacketType>(0), requestID.value() }, reportTime.value());
+	const auto codeCount = parser.read_varint("timeEntryCount");
 
-		report.report.found = true;
-		report.report.month = parser.parse_next_immediate<std::int8_t>();
-		report.report.day = parser.parse_next_immediate<std::int8_t>();
-		report.report.year = parser.parse_next_immediate<std::int16_t>();
+	for (std::uint64_t i = 0; i < codeCount && !parser.error(); i++)
+	{
+		const auto category = TimeCategoryID(read_compact_id(parser, "timeCategoryID"));
+		const auto code = TimeCodeID(read_compact_id(parser, "timeCodeID"));
 
-		return report;
+		info.timeEntry.push_back(time_categories.find(category, code));
 	}
-	catch (const std::bad_expected_access<UnpackError>& e)
+
+	if (const auto& error = parser.error())
 	{
-		return std::unexpected(e.error());
+		return std::unexpected(*error);
 	}
+	return info;
 }
 
-std::vector<std::byte> WeeklyReportMessage::pack() const
+std::vector<std::byte> TaskInfoDeltaMessage::pack() const
 {
 	PacketBuilder builder;
 
-	builder.add(PacketType::WEEKLY_REPORT);
+	builder.add(PacketType::TASK_INFO_DELTA);
+	builder.add(taskID);
+	builder.add(changed);
+
+	if (has(PARENT)) builder.add(parentID);
+	if (has(NAME)) builder.add(name);
+	if (has(STATE)) builder.add(state);
+	if (has(INDEX_IN_PARENT)) builder.add(indexInParent);
+	if (has(SERVER_CONTROLLED)) builder.add(serverControlled);
+	if (has(LOCKED)) builder.add(locked);
+
+	if (has(FINISH_TIME))
+	{
+		builder.add(finishTime.has_value());
+		builder.add(finishTime.value_or(std::chrono::milliseconds(0)));
+	}
+
+	if (has(SESSIONS))
+	{
+		builder.add(sessionCount);
+		builder.add(firstSession);
+		builder.add(static_cast<std::int32_t>(sessions.size()));
+
+		for (auto&& time : sessions)
+		{
+			builder.add(time.start);
+			builder.add(time.stop.has_value());
+			builder.add(time.stop.value_or(std::chrono::milliseconds(0)));
+
+			builder.add(static_cast<std::int32_t>(time.timeEntry.size()));
+
+			for (auto&& entry : time.timeEntry)
+			{
+				builder.add(entry.categoryID);
+				builder.add(entry.codeID);
+			}
+		}
+	}
+
+	if (has(LABELS))
+	{
+		builder.add(static_cast<std::int32_t>(labels.size()));
+
+		for (const std::string& label : labels)
+		{
+			builder.add(label);
+		}
+	}
+
+	if (has(TIME_ENTRY))
+	{
+		builder.add(static_cast<std::int32_t>(timeEntry.size()));
+
+		for (auto&& time : timeEntry)
+		{
+			builder.add(time.categoryID);
+			builder.add(time.codeID);
+		}
+	}
+
+	return builder.build();
+}
+
+std::expected<TaskInfoDeltaMessage, UnpackError> TaskInfoDeltaMessage::unpack(std::span<const std::byte> data, const TimeCategories& time_categories)
+{
+	auto parser = PacketParser(data);
+
+	parser.skip<PacketType>("packetType");
+
+	auto delta = TaskInfoDeltaMessage(parser.read<TaskID>("taskID"));
+	delta.changed = parser.read<std::uint32_t>("changed");
+
+	if (delta.has(PARENT)) delta.parentID = parser.read<TaskID>("parentID");
+	if (delta.has(NAME)) delta.name = parser.read<std::string>("name");
+	if (delta.has(STATE)) delta.state = parser.read<TaskState>("state");
+	if (delta.has(INDEX_IN_PARENT)) delta.indexInParent = parser.read<std::int32_t>("indexInParent");
+	if (delta.has(SERVER_CONTROLLED)) delta.serverControlled = parser.read<bool>("serverControlled");
+	if (delta.has(LOCKED)) delta.locked = parser.read<bool>("locked");
+
+	if (delta.has(FINISH_TIME))
+	{
+		const bool finishTimePresent = parser.read<bool>("finishTimePresent");
+		const auto finishTime = parser.read<std::chrono::milliseconds>("finishTime");
+
+		if (finishTimePresent)
+		{
+			delta.finishTime = finishTime;
+		}
+	}
+
+	if (delta.has(SESSIONS))
+	{
+		delta.sessionCount = parser.read<std::int32_t>("sessionCount");
+		delta.firstSession = parser.read<std::int32_t>("firstSession");
+
+		const auto count = parser.read<std::int32_t>("changedSessionCount");
+
+		for (std::int32_t i = 0; i < count && !parser.error(); i++)
+		{
+			TaskTimes times;
+
+			times.start = parser.read<std::chrono::milliseconds>("start");
+
+			const bool stopPresent = parser.read<bool>("stopPresent");
+			const auto stop = parser.read<std::chrono::milliseconds>("stop");
+
+			if (stopPresent)
+			{
+				times.stop = stop;
+			}
+
+			const auto entryCount = parser.read<std::int32_t>("sessionTimeEntryCount");
+
+			for (std::int32_t j = 0; j < entryCount && !parser.error(); j++)
+			{
+				const auto category = parser.read<TimeCategoryID>("timeCategoryID");
+				const auto code = parser.read<TimeCodeID>("timeCodeID");
+
+				times.timeEntry.push_back(time_categories.find(category, code));
+			}
+			delta.sessions.push_back(times);
+		}
+	}
+
+	if (delta.has(LABELS))
+	{
+		const auto labelCount = parser.read<std::int32_t>("labelCount");
+
+		for (std::int32_t i = 0; i < labelCount && !parser.error(); i++)
+		{
+			delta.labels.push_back(parser.read<std::string>("label"));
+		}
+	}
+
+	if (delta.has(TIME_ENTRY))
+	{
+		const auto codeCount = parser.read<std::int32_t>("timeEntryCount");
+
+		for (std::int32_t i = 0; i < codeCount && !parser.error(); i++)
+		{
+			const auto category = parser.read<TimeCategoryID>("timeCategoryID");
+			const auto code = parser.read<TimeCodeID>("timeCodeID");
+
+			delta.timeEntry.push_back(time_categories.find(category, code));
+		}
+	}
+
+	if (const auto& error = parser.error())
+	{
+		return std::unexpected(*error);
+	}
+	return delta;
+}
+
+template<typename String>
+std::vector<std::byte> BasicBugzillaInfoMessage<String>::pack() const
+{
+	PacketBuilder builder;
+
+	builder.add(PacketType::BUGZILLA_INFO);
+	builder.add(instanceID);
+	builder.add(name);
+	builder.add(URL);
+	builder.add(apiKey);
+	builder.add(username);
+	builder.add(rootTaskID);
+
+	builder.add<std::int32_t>(groupTasksBy.size());
+
+	for (auto&& value : groupTasksBy)
+	{
+		builder.add(value);
+	}
+	
+	builder.add<std::int32_t>(labelToField.size());
+
+	for (auto&& value : labelToField)
+	{
+		builder.add(value.first);
+		builder.add(value.second);
+	}
+	return builder.build();
+}
+
+template<typename String>
+std::expected<BasicBugzillaInfoMessage<String>, UnpackError> BasicBugzillaInfoMessage<String>::unpack(std::span<const std::byte> data)
+{
+	auto parser = PacketParser(data);
+
+	parser.skip<PacketType>("packetType");
+	const auto id = parser.read<BugzillaInstanceID>("instanceID");
+	auto name = parser.read<String>("name");
+	auto URL = parser.read<String>("URL");
+	auto apiKey = parser.read<String>("apiKey");
+
+	auto info = BasicBugzillaInfoMessage(id, std::move(name), std::move(URL), std::move(apiKey));
+	info.username = parser.read<String>("username");
+	info.rootTaskID = parser.read<TaskID>("rootTaskID");
+
+	const std::int32_t groupByCount = parser.read<std::int32_t>("groupByCount");
+
+	for (int i = 0; i < groupByCount && !parser.error(); i++)
+	{
+		info.groupTasksBy.push_back(parser.read<String>("groupTasksBy"));
+	}
+
+	const std::int32_t count = parser.read<std::int32_t>("labelToFieldCount");
+
+	for (int i = 0; i < count && !parser.error(); i++)
+	{
+		const auto label = parser.read<String>("label");
+		const auto field = parser.read<String>("field");
+
+		info.labelToField.emplace(label, field);
+	}
+
+	if (const auto& error = parser.error())
+	{
+		return std::unexpected(*error);
+	}
+	return info;
+}
+
+template struct BasicBugzillaInfoMessage<std::string>;
+template struct BasicBugzillaInfoMessage<std::string_view>;
+
+std::vector<std::byte> RequestDailyReportMessage::pack() const
+{
+	return pack_schema(*this);
+}
+
+std::expected<RequestDailyReportMessage, UnpackError> RequestDailyReportMessage::unpack(std::span<const std::byte> data)
+{
+	return unpack_schema<RequestDailyReportMessage>(data);
+}
+
+std::vector<std::byte> RequestWeeklyReportMessage::pack() const
+{
+	return pack_schema(*this);
+}
+
+std::expected<RequestWeeklyReportMessage, UnpackError> RequestWeeklyReportMessage::unpack(std::span<const std::byte> data)
+{
+	return unpack_schema<RequestWeeklyReportMessage>(data);
+}
+
+std::vector<std::byte> DailyReportMessage::pack() const
+{
+	PacketBuilder builder;
+
+	builder.add(PacketType::DAILY_REPORT);
+	builder.add(request.id);
+	builder.add(reportTime);
+	builder.add(report.found);
+	builder.add<std::int8_t>(report.month);
+	builder.add<std::int8_t>(report.day);
+	builder.add<std::int16_t>(report.year);
+	
+	if (report.found)
+	{
+		builder.add(report.startTime);
+		builder.add(report.endTime);
+		builder.add(report.totalTime);
+
+		builder.add<std::int32_t>(report.timePerTimeEntry.size());
+
+		for (auto&& timeEntry : report.timePerTimeEntry)
+		{
+			builder.add(timeEntry.first.categoryID);
+			builder.add(timeEntry.first.codeID);
+			builder.add(timeEntry.second);
+		}
+
+		builder.add<std::int32_t>(report.times.size());
+
+		for (auto&& pair : report.times)
+		{
+			builder.add(pair.taskID);
+			builder.add(pair.startStopIndex);
+		}
+	}
+
+	return builder.build();
+}
+
+std::expected<DailyReportMessage, UnpackError> DailyReportMessage::unpack(std::span<const std::byte> data)
+{
+	auto parser = PacketParser(data);
+
+	parser.skip<PacketType>("packetType");
+
+	const auto requestID = parser.read<RequestID>("requestID");
+	const auto reportTime = parser.read<std::chrono::milliseconds>("reportTime");
+
+	auto report = DailyReportMessage(RequestOrigin{ static_cast<PacketType>(0), requestID }, reportTime);
+
+	if (parser.read<bool>("reportFound"))
+	{
+		report.report.found = true;
+		report.report.month = parser.read<std::int8_t>("month");
+		report.report.day = parser.read<std::int8_t>("day");
+		report.report.year = parser.read<std::int16_t>("year");
+	}
+
+	if (const auto& error = parser.error())
+	{
+		return std::unexpected(*error);
+	}
+	return report;
+}
+
+std::vector<std::byte> WeeklyReportMessage::pack() const
+{
+	PacketBuilder builder;
+
+	builder.add(PacketType::WEEKLY_REPORT);
 	builder.add(request.id);
 	builder.add(reportTime);
 
@@ -854,8 +1136,8 @@ std::vector<std::byte> WeeklyReportMessage::pack() const
 
 			for (auto&& timeEntry : report.timePerTimeEntry)
 			{
-				builder.add(timeEntry.first.category.id);
-				builder.add(timeEntry.first.code.id);
+				builder.add(timeEntry.first.categoryID);
+				builder.add(timeEntry.first.codeID);
 				builder.add(timeEntry.second);
 			}
 
@@ -876,69 +1158,785 @@ std::expected<WeeklyReportMessage, UnpackError> WeeklyReportMessage::unpack(std:
 {
 	auto parser = PacketParser(data);
 
-	const auto packetType = parser.parse_next<PacketType>();
-	const auto requestID = parser.parse_next<RequestID>();
-	const auto reportTime = parser.parse_next<std::chrono::milliseconds>();
+	parser.skip<PacketType>("packetType");
 
-	try
-	{
-		return WeeklyReportMessage(RequestOrigin{ static_cast<PacketType>(0), requestID.value() }, reportTime.value());
-	}
-	catch (const std::bad_expected_access<UnpackError>& e)
+	const auto requestID = parser.read<RequestID>("requestID");
+	const auto reportTime = parser.read<std::chrono::milliseconds>("reportTime");
+
+	if (const auto& error = parser.error())
 	{
-		return std::unexpected(e.error());
+		return std::unexpected(*error);
 	}
+	return WeeklyReportMessage(RequestOrigin{ static_cast<PacketType>(0), requestID }, reportTime);
 }
 
 std::vector<std::byte> VersionMessage::pack() const
+{
+	return pack_schema(*this);
+}
+
+std::expected<VersionMessage, UnpackError> VersionMessage::unpack(std::span<const std::byte> data)
+{
+	return unpack_schema<VersionMessage>(data);
+}
+
+std::vector<std::byte> ErrorMessage::pack() const
+{
+	return pack_schema(*this);
+}
+
+std::expected<ErrorMessage, UnpackError> ErrorMessage::unpack(std::span<const std::byte> data)
+{
+	return unpack_schema<ErrorMessage>(data);
+}
+
+std::vector<std::byte> BackupConfigurationMessage::pack() const
+{
+	return pack_schema(*this);
+}
+
+std::expected<BackupConfigurationMessage, UnpackError> BackupConfigurationMessage::unpack(std::span<const std::byte> data)
+{
+	return unpack_schema<BackupConfigurationMessage>(data);
+}
+
+std::vector<std::byte> BackupPerformedMessage::pack() const
+{
+	return pack_schema(*this);
+}
+
+std::expected<BackupPerformedMessage, UnpackError> BackupPerformedMessage::unpack(std::span<const std::byte> data)
+{
+	return unpack_schema<BackupPerformedMessage>(data);
+}
+
+std::vector<std::byte> BackupFailedMessage::pack() const
+{
+	return pack_schema(*this);
+}
+
+std::expected<BackupFailedMessage, UnpackError> BackupFailedMessage::unpack(std::span<const std::byte> data)
+{
+	return unpack_schema<BackupFailedMessage>(data);
+}
+
+std::vector<std::byte> RequestTasksMessage::pack() const
 {
 	PacketBuilder builder;
 
-	builder.add(PacketType::VERSION);
-	builder.add(version);
+	builder.add(PacketType::REQUEST_TASKS);
+	builder.add(requestID);
+	builder.add(parentID);
+	builder.add(subtree);
+	builder.add(unfinishedOnly);
+	builder.add(offset);
+	builder.add(limit);
 
 	return builder.build();
 }
 
-std::expected<VersionMessage, UnpackError> VersionMessage::unpack(std::span<const std::byte> data)
+std::expected<RequestTasksMessage, UnpackError> RequestTasksMessage::unpack(std::span<const std::byte> data)
 {
 	auto parser = PacketParser(data);
 
-	const auto version = parser.parse_next<std::string>();
+	parser.skip<PacketType>("packetType");
+	const auto requestID = parser.read<RequestID>("requestID");
 
-	try
-	{
-		return VersionMessage(version.value());
-	}
-	catch (const std::bad_expected_access<UnpackError>& e)
+	auto request = RequestTasksMessage(requestID, parser.read<TaskID>("parentID"));
+	request.subtree = parser.read<bool>("subtree");
+	request.unfinishedOnly = parser.read<bool>("unfinishedOnly");
+	request.offset = parser.read<std::int32_t>("offset");
+	request.limit = parser.read<std::int32_t>("limit");
+
+	if (const auto& error = parser.error())
 	{
-		return std::unexpected(e.error());
+		return std::unexpected(*error);
 	}
+	return request;
 }
 
-std::vector<std::byte> ErrorMessage::pack() const
+std::vector<std::byte> TaskPageMessage::pack() const
 {
 	PacketBuilder builder;
 
-	builder.add(PacketType::ERROR_MESSAGE);
-	builder.add(message);
+	builder.add(PacketType::TASK_PAGE);
+	builder.add(requestID);
+	builder.add(parentID);
+	builder.add(offset);
+	builder.add(total);
+
+	builder.add(static_cast<std::int32_t>(tasks.size()));
+
+	for (auto&& entry : tasks)
+	{
+		builder.add(entry.taskID);
+		builder.add(entry.childCount);
+	}
 
 	return builder.build();
 }
 
-std::expected<ErrorMessage, UnpackError> ErrorMessage::unpack(std::span<const std::byte> data)
+std::expected<TaskPageMessage, UnpackError> TaskPageMessage::unpack(std::span<const std::byte> data)
 {
 	auto parser = PacketParser(data);
 
-	const auto packetType = parser.parse_next<PacketType>();
-	const auto message = parser.parse_next<std::string>();
+	parser.skip<PacketType>("packetType");
+
+	const auto requestID = parser.read<RequestID>("requestID");
+	const auto parentID = parser.read<TaskID>("parentID");
 
-	try
+	auto page = TaskPageMessage(requestID, parentID);
+	page.offset = parser.read<std::int32_t>("offset");
+	page.total = parser.read<std::int32_t>("total");
+
+	const auto count = parser.read<std::int32_t>("count");
+
+	for (std::int32_t i = 0; i < count && !parser.error(); i++)
 	{
-		return ErrorMessage(message.value());
+		TaskPageEntry entry;
+		entry.taskID = parser.read<TaskID>("taskID");
+		entry.childCount = parser.read<std::int32_t>("childCount");
+
+		page.tasks.push_back(entry);
 	}
-	catch (const std::bad_expected_access<UnpackError>& e)
+
+	if (const auto& error = parser.error())
+	{
+		return std::unexpected(*error);
+	}
+	return page;
+}
+
+std::vector<std::byte> RequestResyncMessage::pack() const
+{
+	return pack_schema(*this);
+}
+
+std::expected<RequestResyncMessage, UnpackError> RequestResyncMessage::unpack(std::span<const std::byte> data)
+{
+	return unpack_schema<RequestResyncMessage>(data);
+}
+
+std::vector<std::byte> SyncPositionMessage::pack() const
+{
+	return pack_schema(*this);
+}
+
+std::expected<SyncPositionMessage, UnpackError> SyncPositionMessage::unpack(std::span<const std::byte> data)
+{
+	return unpack_schema<SyncPositionMessage>(data);
+}
+
+std::vector<std::byte> RequestProtocolVersionMessage::pack() const
+{
+	return pack_schema(*this);
+}
+
+std::expected<RequestProtocolVersionMessage, UnpackError> RequestProtocolVersionMessage::unpack(std::span<const std::byte> data)
+{
+	return unpack_schema<RequestProtocolVersionMessage>(data);
+}
+
+std::vector<std::byte> ProtocolVersionMessage::pack() const
+{
+	return pack_schema(*this);
+}
+
+std::expected<ProtocolVersionMessage, UnpackError> ProtocolVersionMessage::unpack(std::span<const std::byte> data)
+{
+	return unpack_schema<ProtocolVersionMessage>(data);
+}
+
+static std::array<std::byte, CHUNK_HEADER_SIZE> chunk_header(bool last, std::size_t payloadSize)
+{
+	PacketBuilder builder;
+	builder.reserve(CHUNK_HEADER_SIZE);
+
+	builder.add(static_cast<std::int32_t>(CHUNK_HEADER_SIZE + payloadSize));
+	builder.add(PacketType::CHUNK);
+	builder.add(last);
+
+	std::array<std::byte, CHUNK_HEADER_SIZE> header;
+	std::ranges::copy(builder.bytes(), header.begin());
+
+	return header;
+}
+
+// length, packet type, last and then the payload, which runs to the end of the frame
+std::vector<std::byte> ChunkMessage::pack() const
+{
+	const auto header = chunk_header(last, payload.size());
+
+	std::vector<std::byte> bytes;
+	bytes.reserve(header.size() + payload.size());
+
+	bytes.insert(bytes.end(), header.begin(), header.end());
+	bytes.insert(bytes.end(), payload.begin(), payload.end());
+
+	return bytes;
+}
+
+std::expected<ChunkMessage, UnpackError> ChunkMessage::unpack(std::span<const std::byte> data)
+{
+	auto parser = PacketParser(data);
+
+	parser.skip<PacketType>("packetType");
+	const auto last = parser.read<bool>("last");
+
+	if (const auto& error = parser.error())
+	{
+		return std::unexpected(*error);
+	}
+
+	const auto payload = data.subspan(parser.offset());
+
+	return ChunkMessage(last, std::vector<std::byte>(payload.begin(), payload.end()));
+}
+
+std::vector<ChunkFrame> split_into_chunks(std::size_t packetSize, std::size_t chunkSize)
+{
+	std::vector<ChunkFrame> chunks;
+	chunks.reserve((packetSize + chunkSize - 1) / chunkSize);
+
+	std::size_t offset = 0;
+
+	while (packetSize - offset > chunkSize)
+	{
+		chunks.push_back(ChunkFrame{ chunk_header(false, chunkSize), offset, chunkSize });
+
+		offset += chunkSize;
+	}
+	chunks.push_back(ChunkFrame{ chunk_header(true, packetSize - offset), offset, packetSize - offset });
+
+	return chunks;
+}
+
+void BulkTaskInfoMessage::add(const TaskInfoMessage& info)
+{
+	taskIDs.push_back(info.taskID._val);
+	parentIDs.push_back(info.parentID._val);
+	states.push_back(static_cast<std::uint8_t>(info.state));
+	flags.push_back((info.serverControlled ? SERVER_CONTROLLED : 0) | (info.locked ? LOCKED : 0) | (info.finishTime ? FINISHED : 0));
+	indexInParent.push_back(info.indexInParent);
+	createTimes.push_back(info.createTime.count());
+	finishTimes.push_back(info.finishTime.value_or(std::chrono::milliseconds(0)).count());
+
+	names += info.name;
+	nameOffsets.push_back(static_cast<std::int32_t>(names.size()));
+
+	for (const std::string& label : info.labels)
+	{
+		labelText += label;
+		labelTextOffsets.push_back(static_cast<std::int32_t>(labelText.size()));
+	}
+	labelOffsets.push_back(static_cast<std::int32_t>(labelTextOffsets.size() - 1));
+
+	for (auto&& time : info.times)
+	{
+		sessionStarts.push_back(time.start.count());
+		sessionStops.push_back(time.stop.value_or(std::chrono::milliseconds(0)).count());
+		sessionStopped.push_back(time.stop.has_value());
+
+		for (auto&& entry : time.timeEntry)
+		{
+			sessionCategories.push_back(entry.categoryID._val);
+			sessionCodes.push_back(entry.codeID._val);
+		}
+		sessionEntryOffsets.push_back(static_cast<std::int32_t>(sessionCategories.size()));
+	}
+	sessionOffsets.push_back(static_cast<std::int32_t>(sessionStarts.size()));
+
+	for (auto&& entry : info.timeEntry)
+	{
+		timeEntryCategories.push_back(entry.categoryID._val);
+		timeEntryCodes.push_back(entry.codeID._val);
+	}
+	timeEntryOffsets.push_back(static_cast<std::int32_t>(timeEntryCategories.size()));
+}
+
+TaskInfoMessage BulkTaskInfoMessage::task(std::size_t index, const TimeCategories& time_categories) const
+{
+	auto info = TaskInfoMessage(TaskID(taskIDs[index]), TaskID(parentIDs[index]), names.substr(nameOffsets[index], nameOffsets[index + 1] - nameOffsets[index]), std::chrono::milliseconds(createTimes[index]));
+
+	info.state = static_cast<TaskState>(states[index]);
+	info.indexInParent = indexInParent[index];
+	info.serverControlled = (flags[index] & SERVER_CONTROLLED) != 0;
+	info.locked = (flags[index] & LOCKED) != 0;
+
+	if (flags[index] & FINISHED)
+	{
+		info.finishTime = std::chrono::milliseconds(finishTimes[index]);
+	}
+
+	for (std::int32_t label = labelOffsets[index]; label < labelOffsets[index + 1]; label++)
+	{
+		info.labels.push_back(labelText.substr(labelTextOffsets[label], labelTextOffsets[label + 1] - labelTextOffsets[label]));
+	}
+
+	for (std::int32_t session = sessionOffsets[index]; session < sessionOffsets[index + 1]; session++)
+	{
+		TaskTimes times;
+
+		times.start = std::chrono::milliseconds(sessionStarts[session]);
+
+		if (sessionStopped[session])
+		{
+			times.stop = std::chrono::milliseconds(sessionStops[session]);
+		}
+
+		for (std::int32_t entry = sessionEntryOffsets[session]; entry < sessionEntryOffsets[session + 1]; entry++)
+		{
+			times.timeEntry.push_back(time_categories.find(TimeCategoryID(sessionCategories[entry]), TimeCodeID(sessionCodes[entry])));
+		}
+		info.times.push_back(times);
+	}
+
+	for (std::int32_t entry = timeEntryOffsets[index]; entry < timeEntryOffsets[index + 1]; entry++)
+	{
+		info.timeEntry.push_back(time_categories.find(TimeCategoryID(timeEntryCategories[entry]), TimeCodeID(timeEntryCodes[entry])));
+	}
+	return info;
+}
+
+std::vector<std::byte> BulkTaskInfoMessage::pack() const
+{
+	PacketBuilder builder;
+
+	builder.add(PacketType::BULK_TASK_INFO);
+	builder.add(static_cast<std::int32_t>(size()));
+
+	builder.add_array(taskIDs);
+	builder.add_array(parentIDs);
+	builder.add_array(states);
+	builder.add_array(flags);
+	builder.add_array(indexInParent);
+	builder.add_array(createTimes);
+	builder.add_array(finishTimes);
+
+	builder.add_array(nameOffsets);
+	builder.add_bytes(names);
+
+	builder.add_array(labelOffsets);
+	builder.add_array(labelTextOffsets);
+	builder.add_bytes(labelText);
+
+	builder.add_array(sessionOffsets);
+	builder.add_array(sessionStarts);
+	builder.add_array(sessionStops);
+	builder.add_array(sessionStopped);
+	builder.add_array(sessionEntryOffsets);
+	builder.add_array(sessionCategories);
+	builder.add_array(sessionCodes);
+
+	builder.add_array(timeEntryOffsets);
+	builder.add_array(timeEntryCategories);
+	builder.add_array(timeEntryCodes);
+
+	return builder.build();
+}
+
+// count + 1 offsets into the next column. they have to start at 0 and can't go backwards, so the last one is the
+// length of the column. a single 0 once the parser has failed, so the columns after it are read as empty
+static std::vector<std::int32_t> read_offsets(PacketParser& parser, std::size_t count, std::string_view field)
+{
+	auto offsets = parser.read_array<std::int32_t>(count + 1, field);
+
+	if (!parser.error() && (offsets.front() != 0 || !std::ranges::is_sorted(offsets)))
+	{
+		parser.reject(UnpackError::INVALID_OFFSETS, field);
+	}
+
+	if (parser.error())
+	{
+		return { 0 };
+	}
+	return offsets;
+}
+
+std::expected<BulkTaskInfoMessage, UnpackError> BulkTaskInfoMessage::unpack(std::span<const std::byte> data)
+{
+	auto parser = PacketParser(data);
+
+	parser.skip<PacketType>("packetType");
+
+	const auto count = parser.read<std::int32_t>("count");
+
+	if (count < 0)
+	{
+		parser.reject(UnpackError::INVALID_OFFSETS, "count");
+	}
+
+	const std::size_t tasks = parser.error() ? 0 : count;
+
+	BulkTaskInfoMessage bulk;
+
+	bulk.taskIDs = parser.read_array<std::int32_t>(tasks, "taskIDs");
+	bulk.parentIDs = parser.read_array<std::int32_t>(tasks, "parentIDs");
+	bulk.states = parser.read_array<std::uint8_t>(tasks, "states");
+	bulk.flags = parser.read_array<std::uint8_t>(tasks, "flags");
+	bulk.indexInParent = parser.read_array<std::int32_t>(tasks, "indexInParent");
+	bulk.createTimes = parser.read_array<std::int64_t>(tasks, "createTimes");
+	bulk.finishTimes = parser.read_array<std::int64_t>(tasks, "finishTimes");
+
+	bulk.nameOffsets = read_offsets(parser, tasks, "nameOffsets");
+	bulk.names = parser.read_bytes(bulk.nameOffsets.back(), "names");
+
+	bulk.labelOffsets = read_offsets(parser, tasks, "labelOffsets");
+	bulk.labelTextOffsets = read_offsets(parser, bulk.labelOffsets.back(), "labelTextOffsets");
+	bulk.labelText = parser.read_bytes(bulk.labelTextOffsets.back(), "labelText");
+
+	bulk.sessionOffsets = read_offsets(parser, tasks, "sessionOffsets");
+
+	const std::size_t sessions = bulk.sessionOffsets.back();
+
+	bulk.sessionStarts = parser.read_array<std::int64_t>(sessions, "sessionStarts");
+	bulk.sessionStops = parser.read_array<std::int64_t>(sessions, "sessionStops");
+	bulk.sessionStopped = parser.read_array<std::uint8_t>(sessions, "sessionStopped");
+	bulk.sessionEntryOffsets = read_offsets(parser, sessions, "sessionEntryOffsets");
+	bulk.sessionCategories = parser.read_array<std::int32_t>(bulk.sessionEntryOffsets.back(), "sessionCategories");
+	bulk.sessionCodes = parser.read_array<std::int32_t>(bulk.sessionEntryOffsets.back(), "sessionCodes");
+
+	bulk.timeEntryOffsets = read_offsets(parser, tasks, "timeEntryOffsets");
+	bulk.timeEntryCategories = parser.read_array<std::int32_t>(bulk.timeEntryOffsets.back(), "timeEntryCategories");
+	bulk.timeEntryCodes = parser.read_array<std::int32_t>(bulk.timeEntryOffsets.back(), "timeEntryCodes");
+
+	if (const auto& error = parser.error())
+	{
+		return std::unexpected(*error);
+	}
+	return bulk;
+}
+
+std::vector<std::byte> BulkTaskInfoMessage::pack_compact() const
+{
+	PacketBuilder builder;
+
+	builder.add(PacketType::BULK_TASK_INFO);
+	builder.add_varint(size());
+
+	// tasks are sent parents first, so neighbouring IDs are close together and siblings share a parent
+	std::int64_t previousID = 0;
+	std::int64_t previousParent = 0;
+
+	for (std::size_t i = 0; i < size(); i++)
+	{
+		builder.add_zigzag(taskIDs[i] - previousID);
+		builder.add_zigzag(parentIDs[i] - previousParent);
+
+		previousID = taskIDs[i];
+		previousParent = parentIDs[i];
+	}
+
+	builder.add_array(states);
+	builder.add_array(flags);
+
+	for (std::int32_t index : indexInParent)
+	{
+		builder.add_varint(static_cast<std::uint32_t>(index));
+	}
+
+	std::int64_t previousCreate = 0;
+
+	for (std::int64_t create : createTimes)
+	{
+		builder.add_zigzag(create - previousCreate);
+		previousCreate = create;
+	}
+
+	for (std::size_t i = 0; i < size(); i++)
+	{
+		if (flags[i] & FINISHED)
+		{
+			builder.add_zigzag(finishTimes[i] - createTimes[i]);
+		}
+	}
+
+	for (std::size_t i = 0; i < size(); i++)
+	{
+		builder.add_varint(nameOffsets[i + 1] - nameOffsets[i]);
+	}
+	builder.add_bytes(names);
+
+	// each distinct label once, in the order they're first used, then the labels of each task as indexes into it
+	const auto label = [&](std::size_t index) { return std::string_view(labelText).substr(labelTextOffsets[index], labelTextOffsets[index + 1] - labelTextOffsets[index]); };
+
+	std::unordered_map<std::string_view, std::uint32_t> labelIndexes;
+	std::vector<std::string_view> labelTable;
+
+	for (std::size_t i = 0; i + 1 < labelTextOffsets.size(); i++)
+	{
+		if (labelIndexes.try_emplace(label(i), static_cast<std::uint32_t>(labelTable.size())).second)
+		{
+			labelTable.push_back(label(i));
+		}
+	}
+
+	builder.add_varint(labelTable.size());
+
+	for (std::string_view text : labelTable)
+	{
+		builder.add_compact(text);
+	}
+
+	for (std::size_t i = 0; i < size(); i++)
+	{
+		builder.add_varint(labelOffsets[i + 1] - labelOffsets[i]);
+
+		for (std::int32_t l = labelOffsets[i]; l < labelOffsets[i + 1]; l++)
+		{
+			builder.add_varint(labelIndexes.at(label(l)));
+		}
+	}
+
+	// the same encoding as the sessions of a compact TASK_INFO
+	for (std::size_t i = 0; i < size(); i++)
+	{
+		builder.add_varint(sessionOffsets[i + 1] - sessionOffsets[i]);
+
+		std::int64_t previous = createTimes[i];
+
+		for (std::int32_t session = sessionOffsets[i]; session < sessionOffsets[i + 1]; session++)
+		{
+			builder.add_zigzag(sessionStarts[session] - previous);
+			builder.add_varint(sessionStopped[session] ? sessionStops[session] - sessionStarts[session] + 1 : 0);
+			builder.add_varint(sessionEntryOffsets[session + 1] - sessionEntryOffsets[session]);
+
+			for (std::int32_t entry = sessionEntryOffsets[session]; entry < sessionEntryOffsets[session + 1]; entry++)
+			{
+				add_compact_id(builder, sessionCategories[entry]);
+				add_compact_id(builder, sessionCodes[entry]);
+			}
+			previous = sessionStopped[session] ? sessionStops[session] : sessionStarts[session];
+		}
+	}
+
+	for (std::size_t i = 0; i < size(); i++)
+	{
+		builder.add_varint(timeEntryOffsets[i + 1] - timeEntryOffsets[i]);
+
+		for (std::int32_t entry = timeEntryOffsets[i]; entry < timeEntryOffsets[i + 1]; entry++)
+		{
+			add_compact_id(builder, timeEntryCategories[entry]);
+			add_compact_id(builder, timeEntryCodes[entry]);
+		}
+	}
+
+	return builder.build();
+}
+
+std::expected<BulkTaskInfoMessage, UnpackError> BulkTaskInfoMessage::unpack_compact(std::span<const std::byte> data)
+{
+	auto parser = PacketParser(data);
+
+	parser.skip<PacketType>("packetType");
+
+	const auto count = parser.read_varint("count");
+
+	// every task takes at least a byte, don't trust a count that can't fit
+	if (count > data.size())
+	{
+		parser.reject(UnpackError::NOT_ENOUGH_BYTES, "count");
+	}
+
+	const std::size_t tasks = parser.error() ? 0 : count;
+
+	BulkTaskInfoMessage bulk;
+
+	std::int64_t previousID = 0;
+	std::int64_t previousParent = 0;
+
+	for (std::size_t i = 0; i < tasks && !parser.error(); i++)
+	{
+		previousID += parser.read_zigzag("taskID");
+		previousParent += parser.read_zigzag("parentID");
+
+		bulk.taskIDs.push_back(static_cast<std::int32_t>(previousID));
+		bulk.parentIDs.push_back(static_cast<std::int32_t>(previousParent));
+	}
+
+	bulk.states = parser.read_array<std::uint8_t>(tasks, "states");
+	bulk.flags = parser.read_array<std::uint8_t>(tasks, "flags");
+
+	for (std::size_t i = 0; i < tasks && !parser.error(); i++)
+	{
+		bulk.indexInParent.push_back(static_cast<std::int32_t>(parser.read_varint("indexInParent")));
+	}
+
+	std::int64_t previousCreate = 0;
+
+	for (std::size_t i = 0; i < tasks && !parser.error(); i++)
+	{
+		previousCreate += parser.read_zigzag("createTime");
+		bulk.createTimes.push_back(previousCreate);
+	}
+
+	for (std::size_t i = 0; i < tasks && !parser.error(); i++)
+	{
+		bulk.finishTimes.push_back(bulk.flags[i] & FINISHED ? bulk.createTimes[i] + parser.read_zigzag("finishTime") : 0);
+	}
+
+	for (std::size_t i = 0; i < tasks && !parser.error(); i++)
+	{
+		bulk.nameOffsets.push_back(static_cast<std::int32_t>(bulk.nameOffsets.back() + parser.read_varint("nameLength")));
+	}
+	bulk.names = parser.read_bytes(bulk.nameOffsets.back(), "names");
+
+	const auto labelTableSize = parser.read_varint("labelTableSize");
+
+	if (labelTableSize > data.size())
+	{
+		parser.reject(UnpackError::NOT_ENOUGH_BYTES, "labelTableSize");
+	}
+
+	std::vector<std::string> labelTable(parser.error() ? 0 : labelTableSize);
+
+	for (std::string& text : labelTable)
+	{
+		text = parser.read_compact_string("label");
+	}
+
+	for (std::size_t i = 0; i < tasks && !parser.error(); i++)
+	{
+		const auto labelCount = parser.read_varint("labelCount");
+
+		for (std::uint64_t l = 0; l < labelCount && !parser.error(); l++)
+		{
+			const auto index = parser.read_varint("labelIndex");
+
+			if (index >= labelTable.size())
+			{
+				parser.reject(UnpackError::INVALID_OFFSETS, "labelIndex");
+				break;
+			}
+
+			bulk.labelText += labelTable[index];
+			bulk.labelTextOffsets.push_back(static_cast<std::int32_t>(bulk.labelText.size()));
+		}
+		bulk.labelOffsets.push_back(static_cast<std::int32_t>(bulk.labelTextOffsets.size() - 1));
+	}
+
+	for (std::size_t i = 0; i < tasks && !parser.error(); i++)
+	{
+		const auto sessionCount = parser.read_varint("sessionCount");
+
+		std::int64_t previous = bulk.createTimes[i];
+
+		for (std::uint64_t session = 0; session < sessionCount && !parser.error(); session++)
+		{
+			const std::int64_t start = previous + parser.read_zigzag("start");
+			const auto length = parser.read_varint("length");
+
+			bulk.sessionStarts.push_back(start);
+			bulk.sessionStops.push_back(length > 0 ? start + static_cast<std::int64_t>(length) - 1 : 0);
+			bulk.sessionStopped.push_back(length > 0);
+
+			const auto entryCount = parser.read_varint("sessionTimeEntryCount");
+
+			for (std::uint64_t entry = 0; entry < entryCount && !parser.error(); entry++)
+			{
+				bulk.sessionCategories.push_back(read_compact_id(parser, "timeCategoryID"));
+				bulk.sessionCodes.push_back(read_compact_id(parser, "timeCodeID"));
+			}
+			bulk.sessionEntryOffsets.push_back(static_cast<std::int32_t>(bulk.sessionCategories.size()));
+
+			previous = length > 0 ? bulk.sessionStops.back() : start;
+		}
+		bulk.sessionOffsets.push_back(static_cast<std::int32_t>(bulk.sessionStarts.size()));
+	}
+
+	for (std::size_t i = 0; i < tasks && !parser.error(); i++)
+	{
+		const auto entryCount = parser.read_varint("timeEntryCount");
+
+		for (std::uint64_t entry = 0; entry < entryCount && !parser.error(); entry++)
+		{
+			bulk.timeEntryCategories.push_back(read_compact_id(parser, "timeCategoryID"));
+			bulk.timeEntryCodes.push_back(read_compact_id(parser, "timeCodeID"));
+		}
+		bulk.timeEntryOffsets.push_back(static_cast<std::int32_t>(bulk.timeEntryCategories.size()));
+	}
+
+	if (const auto& error = parser.error())
+	{
+		return std::unexpected(*error);
+	}
+	return bulk;
+}
+
+static void add_histogram(PacketBuilder& builder, const HistogramData& histogram)
+{
+	builder.add(histogram.count);
+	builder.add(histogram.sum);
+	builder.add<std::int32_t>(histogram.buckets.size());
+
+	for (std::uint64_t bucket : histogram.buckets)
+	{
+		builder.add(bucket);
+	}
+}
+
+static HistogramData read_histogram(PacketParser& parser)
+{
+	HistogramData histogram;
+	histogram.count = parser.read<std::uint64_t>("count");
+	histogram.sum = parser.read<std::uint64_t>("sum");
+
+	const auto bucketCount = parser.read<std::int32_t>("bucketCount");
+
+	for (std::int32_t i = 0; i < bucketCount && !parser.error(); i++)
+	{
+		histogram.buckets.push_back(parser.read<std::uint64_t>("bucket"));
+	}
+	return histogram;
+}
+
+std::vector<std::byte> StatsMessage::pack() const
+{
+	PacketBuilder builder;
+
+	builder.add(PacketType::STATS);
+	builder.add(request.id);
+	builder.add<std::int32_t>(packets.size());
+
+	for (auto&& stats : packets)
+	{
+		builder.add(stats.packetType);
+		add_histogram(builder, stats.requestTime);
+		add_histogram(builder, stats.databaseTime);
+		add_histogram(builder, stats.sendTime);
+		add_histogram(builder, stats.bytesIn);
+		add_histogram(builder, stats.bytesOut);
+	}
+
+	return builder.build();
+}
+
+std::expected<StatsMessage, UnpackError> StatsMessage::unpack(std::span<const std::byte> data)
+{
+	auto parser = PacketParser(data);
+
+	parser.skip<PacketType>("packetType");
+
+	auto message = StatsMessage(RequestOrigin{ static_cast<PacketType>(0), parser.read<RequestID>("requestID") });
+
+	const auto count = parser.read<std::int32_t>("count");
+
+	for (std::int32_t i = 0; i < count && !parser.error(); i++)
+	{
+		PacketStats stats;
+		stats.packetType = parser.read<PacketType>("statsPacketType");
+		stats.requestTime = read_histogram(parser);
+		stats.databaseTime = read_histogram(parser);
+		stats.sendTime = read_histogram(parser);
+		stats.bytesIn = read_histogram(parser);
+		stats.bytesOut = read_histogram(parser);
+
+		message.packets.push_back(stats);
+	}
+
+	if (const auto& error = parser.error())
 	{
-		return std::unexpected(e.error());
+		return std::unexpected(*error);
 	}
+	return message;
 }
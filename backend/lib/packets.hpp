@@ -16,9 +16,14 @@
 
 #include <strong_type/strong_type.hpp>
 
+#include "packets/backup_configuration.hpp"
+#include "packets/backup_failed.hpp"
+#include "packets/backup_performed.hpp"
 #include "packets/basic.hpp"
 #include "packets/bugzilla_info.hpp"
 #include "packets/bugzilla_instance_id.hpp"
+#include "packets/bulk_task_info.hpp"
+#include "packets/chunk.hpp"
 #include "packets/create_task.hpp"
 #include "packets/daily_report.hpp"
 #include "packets/error.hpp"
@@ -26,14 +31,23 @@
 #include "packets/message.hpp"
 #include "packets/packet_builder.hpp"
 #include "packets/packet_parser.hpp"
+#include "packets/protocol_version.hpp"
 #include "packets/request.hpp"
 #include "packets/request_daily_report.hpp"
 #include "packets/request_id.hpp"
+#include "packets/request_resync.hpp"
+#include "packets/request_tasks.hpp"
 #include "packets/request_weekly_report.hpp"
+#include "packets/small_vector.hpp"
+#include "packets/stats.hpp"
+#include "packets/string_length.hpp"
 #include "packets/success_response.hpp"
+#include "packets/sync_position.hpp"
 #include "packets/task.hpp"
 #include "packets/task_id.hpp"
 #include "packets/task_info.hpp"
+#include "packets/task_info_delta.hpp"
+#include "packets/task_page.hpp"
 #include "packets/task_state.hpp"
 #include "packets/task_state_change.hpp"
 #include "packets/task_times.hpp"
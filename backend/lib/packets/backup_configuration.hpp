@@ -0,0 +1,51 @@
+#pragma once
+
+#include "request.hpp"
+#include "schema.hpp"
+
+#include "request_id.hpp"
+#include "unpack_error.hpp"
+
+#include <expected>
+#include <ostream>
+#include <string>
+#include <vector>
+
+struct BackupConfigurationMessage : RequestMessage
+{
+	std::string backupLocation;
+	int backupFrequencyMinutes = 0;
+	int numberOfBackupsToKeep = 0;
+
+	BackupConfigurationMessage(RequestID requestID, std::string backupLocation, int backupFrequencyMinutes, int numberOfBackupsToKeep)
+		: RequestMessage(PacketType::BACKUP_CONFIGURATION, requestID),
+		backupLocation(std::move(backupLocation)),
+		backupFrequencyMinutes(backupFrequencyMinutes),
+		numberOfBackupsToKeep(numberOfBackupsToKeep)
+	{
+	}
+
+	static constexpr auto schema()
+	{
+		return std::tuple{
+			field<&BackupConfigurationMessage::requestID>("requestID"),
+			field<&BackupConfigurationMessage::backupLocation>("backupLocation"),
+			field<&BackupConfigurationMessage::backupFrequencyMinutes, std::int32_t>("backupFrequencyMinutes"),
+			field<&BackupConfigurationMessage::numberOfBackupsToKeep, std::int32_t>("numberOfBackupsToKeep")
+		};
+	}
+
+	std::vector<std::byte> pack() const override;
+	static std::expected<BackupConfigurationMessage, UnpackError> unpack(std::span<const std::byte> data);
+
+	std::ostream& print(std::ostream& out) const override
+	{
+		return print_schema(out, "BackupConfigurationMessage", *this);
+	}
+
+	friend std::ostream& operator<<(std::ostream& out, const BackupConfigurationMessage& message)
+	{
+		message.print(out);
+		return out;
+	}
+};
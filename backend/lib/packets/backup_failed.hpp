@@ -0,0 +1,45 @@
+#pragma once
+
+#include "message.hpp"
+#include "schema.hpp"
+#include "unpack_error.hpp"
+
+#include <chrono>
+#include <expected>
+#include <ostream>
+#include <string>
+#include <vector>
+
+struct BackupFailedMessage : Message
+{
+	std::string errorMessage;
+	// 0 if there hasn't been a successful backup
+	std::chrono::milliseconds previousBackupTime;
+
+	BackupFailedMessage(std::string errorMessage, std::chrono::milliseconds previousBackupTime)
+		: Message(PacketType::BACKUP_FAILED), errorMessage(std::move(errorMessage)), previousBackupTime(previousBackupTime)
+	{
+	}
+
+	static constexpr auto schema()
+	{
+		return std::tuple{
+			field<&BackupFailedMessage::errorMessage>("errorMessage"),
+			field<&BackupFailedMessage::previousBackupTime>("previousBackupTime")
+		};
+	}
+
+	std::vector<std::byte> pack() const override;
+	static std::expected<BackupFailedMessage, UnpackError> unpack(std::span<const std::byte> data);
+
+	std::ostream& print(std::ostream& out) const override
+	{
+		return print_schema(out, "BackupFailedMessage", *this);
+	}
+
+	friend std::ostream& operator<<(std::ostream& out, const BackupFailedMessage& message)
+	{
+		message.print(out);
+		return out;
+	}
+};
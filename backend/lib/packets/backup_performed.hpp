@@ -0,0 +1,38 @@
+#pragma once
+
+#include "message.hpp"
+#include "schema.hpp"
+#include "unpack_error.hpp"
+
+#include <chrono>
+#include <expected>
+#include <ostream>
+#include <vector>
+
+struct BackupPerformedMessage : Message
+{
+	std::chrono::milliseconds backupTime;
+
+	BackupPerformedMessage(std::chrono::milliseconds backupTime) : Message(PacketType::BACKUP_PERFORMED), backupTime(backupTime) {}
+
+	static constexpr auto schema()
+	{
+		return std::tuple{
+			field<&BackupPerformedMessage::backupTime>("backupTime")
+		};
+	}
+
+	std::vector<std::byte> pack() const override;
+	static std::expected<BackupPerformedMessage, UnpackError> unpack(std::span<const std::byte> data);
+
+	std::ostream& print(std::ostream& out) const override
+	{
+		return print_schema(out, "BackupPerformedMessage", *this);
+	}
+
+	friend std::ostream& operator<<(std::ostream& out, const BackupPerformedMessage& message)
+	{
+		message.print(out);
+		return out;
+	}
+};
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "message.hpp"
+#include "schema.hpp"
 #include "unpack_error.hpp"
 
 #include <expected>
@@ -9,15 +10,17 @@ struct BasicMessage : Message
 {
 	BasicMessage(PacketType type) : Message(type) {}
 
+	static constexpr auto schema()
+	{
+		return std::tuple{};
+	}
+
 	std::vector<std::byte> pack() const override;
 	static std::expected<BasicMessage, UnpackError> unpack(std::span<const std::byte> data);
 
 	std::ostream& print(std::ostream& out) const override
 	{
-		out << "BasicMessage { ";
-		Message::print(out);
-		out << " }";
-		return out;
+		return print_schema(out, "BasicMessage", *this);
 	}
 
 	friend std::ostream& operator<<(std::ostream& out, const BasicMessage& message)
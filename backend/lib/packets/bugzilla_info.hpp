@@ -7,26 +7,39 @@
 #include "unpack_error.hpp"
 
 #include <string>
+#include <string_view>
 #include <ostream>
 #include <vector>
 #include <map>
 #include <expected>
 #include <span>
-struct BugzillaInfoMessage : Message
+
+// String is std::string, or std::string_view for BugzillaInfoView
+template<typename String>
+struct BasicBugzillaInfoMessage : Message
 {
 	BugzillaInstanceID instanceID;
-	std::string name;
-	std::string URL;
-	std::string apiKey;
-	std::string username;
+	String name;
+	String URL;
+	String apiKey;
+	String username;
 	TaskID rootTaskID = NO_PARENT;
-	std::vector<std::string> groupTasksBy;
-	std::map<std::string, std::string> labelToField;
+	std::vector<String> groupTasksBy;
+	std::map<String, String> labelToField;
+
+	BasicBugzillaInfoMessage(BugzillaInstanceID instanceID, String name, String URL, String apiKey) : Message(PacketType::BUGZILLA_INFO), instanceID(instanceID), name(std::move(name)), URL(std::move(URL)), apiKey(std::move(apiKey)) {}
 
-	BugzillaInfoMessage(BugzillaInstanceID instanceID, std::string name, std::string URL, std::string apiKey) : Message(PacketType::BUGZILLA_INFO), instanceID(instanceID), name(std::move(name)), URL(std::move(URL)), apiKey(std::move(apiKey)) {}
+	// a view of a BugzillaInfoMessage, valid as long as the message is
+	template<typename Owner>
+		requires std::same_as<String, std::string_view> && std::same_as<Owner, std::string>
+	explicit BasicBugzillaInfoMessage(const BasicBugzillaInfoMessage<Owner>& message)
+		: Message(PacketType::BUGZILLA_INFO), instanceID(message.instanceID), name(message.name), URL(message.URL), apiKey(message.apiKey), username(message.username), rootTaskID(message.rootTaskID),
+		  groupTasksBy(message.groupTasksBy.begin(), message.groupTasksBy.end()), labelToField(message.labelToField.begin(), message.labelToField.end())
+	{
+	}
 
 	std::vector<std::byte> pack() const override;
-	static std::expected<BugzillaInfoMessage, UnpackError> unpack(std::span<const std::byte> data);
+	static std::expected<BasicBugzillaInfoMessage, UnpackError> unpack(std::span<const std::byte> data);
 
 	std::ostream& print(std::ostream& out) const override
 	{
@@ -48,8 +61,13 @@ struct BugzillaInfoMessage : Message
 		return out;
 	}
 
-	friend std::ostream& operator<<(std::ostream& out, const BugzillaInfoMessage& message)
+	friend std::ostream& operator<<(std::ostream& out, const BasicBugzillaInfoMessage& message)
 	{
 		return message.print(out);
 	}
 };
+
+using BugzillaInfoMessage = BasicBugzillaInfoMessage<std::string>;
+
+// the strings point into the bytes it was unpacked from
+using BugzillaInfoView = BasicBugzillaInfoMessage<std::string_view>;
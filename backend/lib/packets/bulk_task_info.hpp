@@ -0,0 +1,92 @@
+#pragma once
+
+#include "message.hpp"
+#include "task_info.hpp"
+#include "unpack_error.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <expected>
+#include <ostream>
+#include <span>
+#include <string>
+#include <vector>
+
+// the TASK_INFO of many tasks, stored and packed a column at a time. every column is a plain array so packing and
+// unpacking are a loop over each one, and the arrays of similar values compress better than interleaved messages
+//
+// variable length fields are flattened: each task has a range [offsets[i], offsets[i + 1]) into a shared array. the
+// offset arrays have one more entry than the arrays they index and always start at 0
+struct BulkTaskInfoMessage : Message
+{
+	enum Flags : std::uint8_t
+	{
+		SERVER_CONTROLLED = 1 << 0,
+		LOCKED = 1 << 1,
+		FINISHED = 1 << 2, // finishTimes holds the finish time
+	};
+
+	// one entry per task
+	std::vector<std::int32_t> taskIDs;
+	std::vector<std::int32_t> parentIDs;
+	std::vector<std::uint8_t> states;
+	std::vector<std::uint8_t> flags;
+	std::vector<std::int32_t> indexInParent;
+	std::vector<std::int64_t> createTimes;
+	std::vector<std::int64_t> finishTimes;
+
+	// string table of the task names
+	std::vector<std::int32_t> nameOffsets{ 0 };
+	std::string names;
+
+	// each task has a range of labels, each label is a range of labelText
+	std::vector<std::int32_t> labelOffsets{ 0 };
+	std::vector<std::int32_t> labelTextOffsets{ 0 };
+	std::string labelText;
+
+	// each task has a range of sessions, each session has a range of time entries
+	std::vector<std::int32_t> sessionOffsets{ 0 };
+	std::vector<std::int64_t> sessionStarts;
+	std::vector<std::int64_t> sessionStops;
+	std::vector<std::uint8_t> sessionStopped;
+	std::vector<std::int32_t> sessionEntryOffsets{ 0 };
+	std::vector<std::int32_t> sessionCategories;
+	std::vector<std::int32_t> sessionCodes;
+
+	std::vector<std::int32_t> timeEntryOffsets{ 0 };
+	std::vector<std::int32_t> timeEntryCategories;
+	std::vector<std::int32_t> timeEntryCodes;
+
+	BulkTaskInfoMessage() : Message(PacketType::BULK_TASK_INFO) {}
+
+	std::size_t size() const { return taskIDs.size(); }
+
+	void add(const TaskInfoMessage& info);
+
+	// rebuild the TASK_INFO of one task
+	TaskInfoMessage task(std::size_t index, const TimeCategories& time_categories) const;
+
+	std::vector<std::byte> pack() const override;
+
+	// the columns as varints and deltas from the previous value, with each distinct label only sent once
+	std::vector<std::byte> pack_compact() const override;
+
+	static std::expected<BulkTaskInfoMessage, UnpackError> unpack(std::span<const std::byte> data);
+	static std::expected<BulkTaskInfoMessage, UnpackError> unpack_compact(std::span<const std::byte> data);
+
+	std::ostream& print(std::ostream& out) const override
+	{
+		out << "BulkTaskInfoMessage { tasks: " << size() << ", taskIDs: [ ";
+		for (std::int32_t id : taskIDs)
+		{
+			out << id << ", ";
+		}
+		out << "], sessions: " << sessionStarts.size() << ", labels: " << labelTextOffsets.size() - 1 << " }";
+		return out;
+	}
+
+	friend std::ostream& operator<<(std::ostream& out, const BulkTaskInfoMessage& message)
+	{
+		return message.print(out);
+	}
+};
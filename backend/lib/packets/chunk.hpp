@@ -0,0 +1,81 @@
+#pragma once
+
+#include "message.hpp"
+#include "unpack_error.hpp"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <expected>
+#include <optional>
+#include <ostream>
+#include <span>
+#include <utility>
+#include <vector>
+
+// the most bytes of the original packet carried by one CHUNK
+inline constexpr std::size_t MAX_CHUNK_SIZE = 64 * 1024;
+
+struct ChunkMessage : Message
+{
+	// the chunk that finishes the packet
+	bool last = false;
+
+	// the next bytes of the original packet, length included. the rest of the frame after last
+	std::vector<std::byte> payload;
+
+	ChunkMessage() : Message(PacketType::CHUNK) {}
+	ChunkMessage(bool last, std::vector<std::byte> payload) : Message(PacketType::CHUNK), last(last), payload(std::move(payload)) {}
+
+	std::vector<std::byte> pack() const override;
+	static std::expected<ChunkMessage, UnpackError> unpack(std::span<const std::byte> data);
+
+	std::ostream& print(std::ostream& out) const override
+	{
+		out << "ChunkMessage { ";
+		Message::print(out);
+		out << ", last: " << last << ", payload: " << payload.size() << " bytes }";
+		return out;
+	}
+
+	friend std::ostream& operator<<(std::ostream& out, const ChunkMessage& message)
+	{
+		message.print(out);
+		return out;
+	}
+};
+
+// bytes in front of the payload of a CHUNK frame: the length, packet type and last
+inline constexpr std::size_t CHUNK_HEADER_SIZE = sizeof(std::int32_t) + sizeof(PacketType) + sizeof(std::int8_t);
+
+// one CHUNK frame of a packet. the frame is its header followed by size bytes of the packet from offset, the payload
+// is written from the packet itself instead of being copied into the frame
+struct ChunkFrame
+{
+	std::array<std::byte, CHUNK_HEADER_SIZE> header;
+	std::size_t offset;
+	std::size_t size;
+};
+
+// the CHUNK frames for a packed packet of the given size, each carrying at most chunkSize bytes of it
+std::vector<ChunkFrame> split_into_chunks(std::size_t packetSize, std::size_t chunkSize = MAX_CHUNK_SIZE);
+
+// joins the chunks of a packet back together on the receiving side
+class ChunkAssembler
+{
+public:
+	// the original packet once the last chunk has been added
+	std::optional<std::vector<std::byte>> add(const ChunkMessage& chunk)
+	{
+		m_packet.insert(m_packet.end(), chunk.payload.begin(), chunk.payload.end());
+
+		if (!chunk.last)
+		{
+			return std::nullopt;
+		}
+		return std::exchange(m_packet, {});
+	}
+
+private:
+	std::vector<std::byte> m_packet;
+};
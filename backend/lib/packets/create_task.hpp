@@ -4,22 +4,34 @@
 
 #include "request_id.hpp"
 #include "task_id.hpp"
+#include "time_category.hpp"
 #include "time_entry.hpp"
 
 #include <string>
+#include <string_view>
 #include <expected>
 
-struct CreateTaskMessage : RequestMessage
+// String is std::string, or std::string_view for CreateTaskView
+template<typename String>
+struct BasicCreateTaskMessage : RequestMessage
 {
 	TaskID parentID;
-	std::string name;
-	std::vector<std::string> labels;
+	String name;
+	std::vector<String> labels;
 	std::vector<TimeEntry> timeEntry;
 
-	CreateTaskMessage(TaskID parentID, RequestID requestID, std::string name) : RequestMessage(PacketType::CREATE_TASK, requestID), parentID(parentID), name(std::move(name)) {}
+	BasicCreateTaskMessage(TaskID parentID, RequestID requestID, String name) : RequestMessage(PacketType::CREATE_TASK, requestID), parentID(parentID), name(std::move(name)) {}
+
+	// a view of a CreateTaskMessage, valid as long as the message is
+	template<typename Owner>
+		requires std::same_as<String, std::string_view> && std::same_as<Owner, std::string>
+	explicit BasicCreateTaskMessage(const BasicCreateTaskMessage<Owner>& message)
+		: RequestMessage(PacketType::CREATE_TASK, message.requestID), parentID(message.parentID), name(message.name), labels(message.labels.begin(), message.labels.end()), timeEntry(message.timeEntry)
+	{
+	}
 
 	std::vector<std::byte> pack() const override;
-	static std::expected<CreateTaskMessage, UnpackError> unpack(std::span<const std::byte> data, const TimeCategories& time_categories);
+	static std::expected<BasicCreateTaskMessage, UnpackError> unpack(std::span<const std::byte> data, const TimeCategories& time_categories);
 
 	std::ostream& print(std::ostream& out) const override
 	{
@@ -35,15 +47,20 @@ struct CreateTaskMessage : RequestMessage
 		out << ", timeCodes: [ ";
 		for (auto time : timeEntry)
 		{
-			out << std::format("[ {} ({}) {} ({}) ]", time.category.name, time.category.id._val, time.code.name, time.code.id._val) << ", ";
+			out << std::format("[ {} {} ]", time.categoryID._val, time.codeID._val) << ", ";
 		}
 		out << "] }";
 
 		return out;
 	}
 
-	friend std::ostream& operator<<(std::ostream& out, const CreateTaskMessage& message)
+	friend std::ostream& operator<<(std::ostream& out, const BasicCreateTaskMessage& message)
 	{
 		return message.print(out);
 	}
-};
\ No newline at end of file
+};
+
+using CreateTaskMessage = BasicCreateTaskMessage<std::string>;
+
+// the strings point into the bytes it was unpacked from
+using CreateTaskView = BasicCreateTaskMessage<std::string_view>;
\ No newline at end of file
@@ -77,6 +77,61 @@ enum class PacketType : std::int32_t
 	BULK_TASK_ADD_FINISH = 40,
 
 	ERROR_MESSAGE = 41,
+
+	// request handling, database, send time and packet size histograms per packet type
+	REQUEST_STATS = 46,
+	STATS = 47,
+
+	// wait for all pending database writes to be committed. response is SUCCESS_RESPONSE once they are on disk
+	DATABASE_FLUSH = 48,
+
+	// finished subtrees that have been moved out of the working set are left out of the bulk task info. request the archived
+	// subtrees below a task (0 for the top level). the response is SUCCESS_RESPONSE followed by their TASK_INFO messages,
+	// parents first, between ARCHIVED_TASK_INFO_START and ARCHIVED_TASK_INFO_FINISH
+	REQUEST_ARCHIVED_TASKS = 49,
+	ARCHIVED_TASK_INFO_START = 50,
+	ARCHIVED_TASK_INFO_FINISH = 51,
+
+	// fetch the task tree a piece at a time instead of all at once. the response is SUCCESS_RESPONSE and a TASK_PAGE
+	// followed by the TASK_INFO messages of the page
+	REQUEST_TASKS = 52,
+	TASK_PAGE = 53,
+	// the same as REQUEST_CONFIGURATION without the bulk task info, for clients that request the tasks as they're needed
+	REQUEST_CONFIGURATION_WITHOUT_TASKS = 54,
+
+	// catch up after a reconnect. the client sends the sync position it was last given (0 for none) and the response
+	// is SUCCESS_RESPONSE and a SYNC_POSITION followed by either the TASK_INFO of every task that changed since then and
+	// TASKS_ARCHIVED for the subtrees archived since then or, when the server can't tell what changed, the same messages
+	// as REQUEST_CONFIGURATION. REQUEST_CONFIGURATION starts with a SYNC_POSITION as well
+	REQUEST_RESYNC = 55,
+	SYNC_POSITION = 56,
+
+	// with several clients connected, changes to tasks are sent to every client subscribed to a subtree they're in.
+	// clients start subscribed to every task (0). both are answered with a SUCCESS_RESPONSE
+	SUBSCRIBE_TASKS = 57,
+	UNSUBSCRIBE_TASKS = 58,
+
+	// sent instead of TASK_INFO when a task changes, to clients that have sent ENABLE_TASK_INFO_DELTA. it only carries
+	// the fields that changed since the task was last sent. TASK_INFO is still used for new tasks and requests
+	TASK_INFO_DELTA = 59,
+	ENABLE_TASK_INFO_DELTA = 60,
+
+	// the bulk task info packed into columns instead of one TASK_INFO per task. only sent between BULK_TASK_INFO_START and
+	// BULK_TASK_INFO_FINISH, to clients that negotiated protocol version 2 or later
+	BULK_TASK_INFO = 61,
+
+	// the client sends the highest protocol version it understands. the response is SUCCESS_RESPONSE and a
+	// PROTOCOL_VERSION with the version both sides will use. clients that never ask get version 1
+	REQUEST_PROTOCOL_VERSION = 62,
+	PROTOCOL_VERSION = 63,
+
+	// a piece of a packet larger than MAX_CHUNK_SIZE, sent to clients that negotiated protocol version 4 or later. the
+	// payloads of the chunks up to and including the last one are the bytes of the original packet
+	CHUNK = 64,
+
+	// a TaskMessage telling subscribed clients that the task and everything below it was moved to the archive. they're
+	// removed from the client until REQUEST_ARCHIVED_TASKS asks for them
+	TASKS_ARCHIVED = 65,
 };
 
 struct RequestOrigin
@@ -106,6 +161,13 @@ struct RequestOrigin
 	}
 };
 
+// how the fields of a message are encoded. COMPACT is only used with clients that negotiated protocol version 3 or later
+enum class WireFormat
+{
+	FIXED,
+	COMPACT,
+};
+
 struct Message
 {
 public:
@@ -115,6 +177,10 @@ public:
 
 	virtual std::vector<std::byte> pack() const = 0;
 
+	// varints and deltas instead of fixed size values. the length and packet type are the same as pack(). messages
+	// without a compact encoding are packed the same way in both formats
+	virtual std::vector<std::byte> pack_compact() const { return pack(); }
+
 	virtual std::ostream& print(std::ostream& out) const = 0;
 
 	friend std::ostream& operator<<(std::ostream& out, const Message& message)
@@ -1,7 +1,11 @@
 #pragma once
 
+#include "string_length.hpp"
+
 #include <chrono>
 #include <cstdint>
+#include <cstring>
+#include <string_view>
 #include <vector>
 
 #include <strong_type/strong_type.hpp>
@@ -13,6 +17,14 @@ private:
 
 public:
 
+	// the bytes added so far, without the length that build() adds
+	const std::vector<std::byte>& bytes() const { return m_bytes; }
+
+	void reserve(std::size_t size) { m_bytes.reserve(size); }
+
+	// the bytes as they are, for a caller that added the length itself
+	std::vector<std::byte> release() { return std::move(m_bytes); }
+
 	std::vector<std::byte> build() const
 	{
 		std::vector<std::byte> bytes = m_bytes;
@@ -76,13 +88,68 @@ public:
 
 	void add(std::string_view str)
 	{
-		std::int16_t size = str.size();
+		if (StringLengthScope::current() == StringLength::LONG)
+		{
+			add(static_cast<std::int32_t>(str.size()));
+		}
+		else
+		{
+			str = str.substr(0, MAX_SHORT_STRING_LENGTH);
 
-		add(size);
+			add(static_cast<std::int16_t>(str.size()));
+		}
+		add_bytes(str);
+	}
+
+	// a column of values without a count in front of it. the reader has to know how many values there are
+	template<typename T>
+		requires std::integral<T> && (!std::same_as<T, bool>)
+	void add_array(const std::vector<T>& values)
+	{
+		const std::size_t start = m_bytes.size();
 
-		for (auto ch : str)
+		m_bytes.resize(start + values.size() * sizeof(T));
+
+		std::byte* out = m_bytes.data() + start;
+
+		for (T value : values)
 		{
-			m_bytes.push_back(static_cast<std::byte>(ch));
+			const T swapped = std::byteswap(value);
+			std::memcpy(out, &swapped, sizeof(T));
+			out += sizeof(T);
 		}
 	}
+
+	// raw bytes without a length
+	void add_bytes(std::string_view bytes)
+	{
+		const auto* begin = reinterpret_cast<const std::byte*>(bytes.data());
+
+		m_bytes.insert(m_bytes.end(), begin, begin + bytes.size());
+	}
+
+	// LEB128. 7 bits at a time, low bits first, with the high bit set on every byte but the last
+	void add_varint(std::uint64_t value)
+	{
+		while (value >= 0x80)
+		{
+			m_bytes.push_back(static_cast<std::byte>((value & 0x7F) | 0x80));
+			value >>= 7;
+		}
+		m_bytes.push_back(static_cast<std::byte>(value));
+	}
+
+	// signed values that are usually close to 0, like the difference between two times. zigzag encoding keeps small
+	// negative values small
+	void add_zigzag(std::int64_t value)
+	{
+		add_varint((static_cast<std::uint64_t>(value) << 1) ^ static_cast<std::uint64_t>(value >> 63));
+	}
+
+	// a string with a varint length
+	void add_compact(std::string_view str)
+	{
+		add_varint(str.size());
+		add_bytes(str);
+	}
 };
@@ -1,5 +1,9 @@
 #pragma once
 
+#include "backup_configuration.hpp"
+#include "basic.hpp"
+#include "bugzilla_info.hpp"
+#include "create_task.hpp"
 #include "task.hpp"
 #include "update_task.hpp"
 #include "success_response.hpp"
@@ -10,8 +14,20 @@
 #include "time_entry_modify_packet.hpp"
 #include "task_state_change.hpp"
 #include "update_task_times.hpp"
+#include "stats.hpp"
+#include "request_tasks.hpp"
+#include "task_page.hpp"
+#include "request_resync.hpp"
+#include "sync_position.hpp"
+#include "task_info_delta.hpp"
+#include "bulk_task_info.hpp"
+#include "chunk.hpp"
+#include "protocol_version.hpp"
+#include "string_length.hpp"
 
 #include <memory>
+#include <optional>
+#include <variant>
 
 class PacketParser
 {
@@ -19,6 +35,61 @@ private:
 	std::span<const std::byte> data;
 	std::size_t position;
 
+	// the first error seen by read()
+	std::optional<UnpackError> failure;
+
+	std::unexpected<UnpackError> fail(UnpackError::Code code, std::size_t at) const
+	{
+		return std::unexpected(UnpackError(code, at));
+	}
+
+	template<typename T>
+	static T empty_value()
+	{
+		if constexpr (strong::is_strong_type<T>::value)
+		{
+			return T(strong::underlying_type_t<T>{});
+		}
+		else
+		{
+			return T{};
+		}
+	}
+
+	template<typename T, typename Parse>
+	T read_with(std::string_view field, Parse&& parse)
+	{
+		if (!failure)
+		{
+			auto result = parse();
+
+			if (result)
+			{
+				return *std::move(result);
+			}
+
+			failure = result.error();
+			failure->field = field;
+		}
+		return empty_value<T>();
+	}
+
+	std::expected<std::int32_t, UnpackError> parse_string_length()
+	{
+		if (StringLengthScope::current() == StringLength::LONG)
+		{
+			return parse_next<std::int32_t>();
+		}
+
+		auto length = parse_next<std::int16_t>();
+
+		if (length)
+		{
+			return length.value();
+		}
+		return std::unexpected(length.error());
+	}
+
 public:
 	PacketParser(std::span<const std::byte> data) : data(data), position(0)
 	{
@@ -33,7 +104,7 @@ public:
 	{
 		if (std::distance(data.begin() + position, data.end()) < sizeof(T))
 		{
-			return std::unexpected(UnpackError::NOT_ENOUGH_BYTES);
+			return fail(UnpackError::NOT_ENOUGH_BYTES, position);
 		}
 
 		T value;
@@ -88,16 +159,16 @@ public:
 		requires std::same_as<T, std::string>
 	std::expected<T, UnpackError> parse_next()
 	{
-		auto length = parse_next<std::int16_t>();
+		auto length = parse_string_length();
 
 		if (!length)
 		{
 			return std::unexpected(length.error());
 		}
 
-		if (std::distance(data.begin() + position, data.end()) < length.value())
+		if (length.value() < 0 || std::distance(data.begin() + position, data.end()) < length.value())
 		{
-			return std::unexpected(UnpackError::NOT_ENOUGH_BYTES);
+			return fail(UnpackError::NOT_ENOUGH_BYTES, position);
 		}
 
 		std::string name;
@@ -108,6 +179,29 @@ public:
 		return name;
 	}
 
+	// the same as std::string, but points into the bytes instead of copying them
+	template<typename T>
+		requires std::same_as<T, std::string_view>
+	std::expected<T, UnpackError> parse_next()
+	{
+		auto length = parse_string_length();
+
+		if (!length)
+		{
+			return std::unexpected(length.error());
+		}
+
+		if (length.value() < 0 || std::distance(data.begin() + position, data.end()) < length.value())
+		{
+			return fail(UnpackError::NOT_ENOUGH_BYTES, position);
+		}
+
+		const auto name = std::string_view(reinterpret_cast<const char*>(data.data() + position), length.value());
+		position += length.value();
+
+		return name;
+	}
+
 	template<typename T>
 		requires std::same_as<T, std::chrono::milliseconds>
 	std::expected<T, UnpackError> parse_next()
@@ -121,10 +215,153 @@ public:
 		return std::unexpected(result.error());
 	}
 
+	// a column of count values, written by PacketBuilder::add_array
+	template<typename T>
+		requires std::integral<T> && (!std::same_as<T, bool>)
+	std::expected<std::vector<T>, UnpackError> parse_array(std::size_t count)
+	{
+		if (static_cast<std::size_t>(std::distance(data.begin() + position, data.end())) / sizeof(T) < count)
+		{
+			return fail(UnpackError::NOT_ENOUGH_BYTES, position);
+		}
+
+		std::vector<T> values(count);
+		std::memcpy(values.data(), data.data() + position, count * sizeof(T));
+
+		for (T& value : values)
+		{
+			value = std::byteswap(value);
+		}
+
+		position += count * sizeof(T);
+
+		return values;
+	}
+
+	// count raw bytes, written by PacketBuilder::add_bytes
+	std::expected<std::string, UnpackError> parse_bytes(std::size_t count)
+	{
+		if (static_cast<std::size_t>(std::distance(data.begin() + position, data.end())) < count)
+		{
+			return fail(UnpackError::NOT_ENOUGH_BYTES, position);
+		}
+
+		std::string bytes;
+		bytes.resize(count);
+		std::memcpy(bytes.data(), data.data() + position, count);
+		position += count;
+
+		return bytes;
+	}
+
+	// written by PacketBuilder::add_varint
+	std::expected<std::uint64_t, UnpackError> parse_varint()
+	{
+		const std::size_t start = position;
+		std::uint64_t value = 0;
+
+		for (int shift = 0; shift < 64; shift += 7)
+		{
+			if (position >= data.size())
+			{
+				return fail(UnpackError::NOT_ENOUGH_BYTES, start);
+			}
+
+			const auto byte = std::to_integer<std::uint64_t>(data[position++]);
+
+			value |= (byte & 0x7F) << shift;
+
+			if ((byte & 0x80) == 0)
+			{
+				return value;
+			}
+		}
+		return fail(UnpackError::VARINT_TOO_LONG, start);
+	}
+
+	// written by PacketBuilder::add_zigzag
+	std::expected<std::int64_t, UnpackError> parse_zigzag()
+	{
+		auto result = parse_varint();
+
+		if (result)
+		{
+			return static_cast<std::int64_t>((result.value() >> 1) ^ (0 - (result.value() & 1)));
+		}
+		return std::unexpected(result.error());
+	}
+
+	// written by PacketBuilder::add_compact
+	std::expected<std::string, UnpackError> parse_compact_string()
+	{
+		auto length = parse_varint();
+
+		if (length)
+		{
+			return parse_bytes(length.value());
+		}
+		return std::unexpected(length.error());
+	}
+
+	// reads the next field. the first failure is kept along with the name of the field, after which nothing else is
+	// read and every call returns an empty value. unpack functions read all of their fields and then check error() once
+	template<typename T>
+	T read(std::string_view field)
+	{
+		return read_with<T>(field, [this]() { return parse_next<T>(); });
+	}
+
+	// the same for the variable length encodings and columns
+	std::uint64_t read_varint(std::string_view field)
+	{
+		return read_with<std::uint64_t>(field, [this]() { return parse_varint(); });
+	}
+
+	std::int64_t read_zigzag(std::string_view field)
+	{
+		return read_with<std::int64_t>(field, [this]() { return parse_zigzag(); });
+	}
+
+	std::string read_compact_string(std::string_view field)
+	{
+		return read_with<std::string>(field, [this]() { return parse_compact_string(); });
+	}
+
 	template<typename T>
-	auto parse_next_immediate()
+	std::vector<T> read_array(std::size_t count, std::string_view field)
 	{
-		return parse_next<T>().value();
+		return read_with<std::vector<T>>(field, [this, count]() { return parse_array<T>(count); });
+	}
+
+	std::string read_bytes(std::size_t count, std::string_view field)
+	{
+		return read_with<std::string>(field, [this, count]() { return parse_bytes(count); });
+	}
+
+	// for a value that was read but isn't valid. kept like a failed read when it's the first failure
+	void reject(UnpackError::Code code, std::string_view field)
+	{
+		if (!failure)
+		{
+			failure = UnpackError(code, position, field);
+		}
+	}
+
+	// reads a field that isn't needed, like the packet type when the message type already decides it
+	template<typename T>
+	void skip(std::string_view field)
+	{
+		read<T>(field);
+	}
+
+	const std::optional<UnpackError>& error() const
+	{
+		return failure;
+	}
+
+	std::size_t offset() const
+	{
+		return position;
 	}
 };
 
@@ -132,6 +369,9 @@ struct ParseResult
 {
 	std::unique_ptr<Message> packet;
 	std::int32_t bytes_read = 0;
+
+	// why packet is empty when the bytes held a known packet type that couldn't be decoded
+	std::optional<UnpackError> error;
 };
 
 inline ParseResult parse_packet(std::span<const std::byte> bytes, const TimeCategories& time_categories)
@@ -153,14 +393,25 @@ inline ParseResult parse_packet(std::span<const std::byte> bytes, const TimeCate
 
 		result.bytes_read += sizeof(PacketType);
 
+		const auto store = [&]<typename T>(std::expected<T, UnpackError>&& message)
+		{
+			if (message)
+			{
+				result.packet = std::make_unique<T>(*std::move(message));
+			}
+			else
+			{
+				result.error = message.error();
+			}
+			result.bytes_read = raw_length;
+		};
+
 		switch (type)
 		{
 			using enum PacketType;
 
 		case CREATE_TASK:
-			result.packet = std::make_unique<CreateTaskMessage>(CreateTaskMessage::unpack(bytes.subspan(4), time_categories).value());
-			result.bytes_read = raw_length;
-
+			store(CreateTaskMessage::unpack(bytes.subspan(4), time_categories));
 			break;
 		case START_TASK:
 		case START_UNSPECIFIED_TASK:
@@ -168,76 +419,109 @@ inline ParseResult parse_packet(std::span<const std::byte> bytes, const TimeCate
 		case STOP_UNSPECIFIED_TASK:
 		case FINISH_TASK:
 		case REQUEST_TASK:
-			result.packet = std::make_unique<TaskMessage>(TaskMessage::unpack(bytes.subspan(4)).value());
-			result.bytes_read = raw_length;
+		case REQUEST_ARCHIVED_TASKS:
+		case TASKS_ARCHIVED:
+		case SUBSCRIBE_TASKS:
+		case UNSUBSCRIBE_TASKS:
+			store(TaskMessage::unpack(bytes.subspan(4)));
 			break;
 		case UPDATE_TASK:
-			result.packet = std::make_unique<UpdateTaskMessage>(UpdateTaskMessage::unpack(bytes.subspan(4), time_categories).value());
-			result.bytes_read = raw_length;
+			store(UpdateTaskMessage::unpack(bytes.subspan(4), time_categories));
 			break;
 		case TASK_STATE_CHANGE:
-			result.packet = std::make_unique<TaskStateChange>(TaskStateChange::unpack(bytes.subspan(4)).value());
-			result.bytes_read = raw_length;
+			store(TaskStateChange::unpack(bytes.subspan(4)));
 			break;
 		case EDIT_TASK_SESSION:
 		case ADD_TASK_SESSION:
 		case REMOVE_TASK_SESSION:
-			result.packet = std::make_unique<UpdateTaskTimesMessage>(UpdateTaskTimesMessage::unpack(bytes.subspan(4)).value());
-			result.bytes_read = raw_length;
+			store(UpdateTaskTimesMessage::unpack(bytes.subspan(4)));
 			break;
 		case SUCCESS_RESPONSE:
-			result.packet = std::make_unique<SuccessResponse>(SuccessResponse::unpack(bytes.subspan(4)).value());
-			result.bytes_read = raw_length;
+			store(SuccessResponse::unpack(bytes.subspan(4)));
 			break;
 		case FAILURE_RESPONSE:
-			result.packet = std::make_unique<FailureResponse>(FailureResponse::unpack(bytes.subspan(4)).value());
-			result.bytes_read = raw_length;
+			store(FailureResponse::unpack(bytes.subspan(4)));
 			break;
 		case VERSION_REQUEST:
 		case REQUEST_CONFIGURATION:
+		case REQUEST_CONFIGURATION_WITHOUT_TASKS:
 		case REQUEST_CONFIGURATION_COMPLETE:
 		case BULK_TASK_UPDATE_START:
 		case BULK_TASK_UPDATE_FINISH:
 		case BULK_TASK_INFO_START:
 		case BULK_TASK_INFO_FINISH:
+		case ARCHIVED_TASK_INFO_START:
+		case ARCHIVED_TASK_INFO_FINISH:
 		{
-			result.packet = std::make_unique<BasicMessage>(BasicMessage::unpack(bytes.subspan(4)).value());
-			result.bytes_read = raw_length;
-
+			store(BasicMessage::unpack(bytes.subspan(4)));
 			break;
 		}
 		case BUGZILLA_REFRESH:
+		case REQUEST_STATS:
+		case DATABASE_FLUSH:
+		case ENABLE_TASK_INFO_DELTA:
 		{
-			result.packet = std::make_unique<RequestMessage>(RequestMessage::unpack(bytes.subspan(4)).value());
-			result.bytes_read = raw_length;
+			store(RequestMessage::unpack(bytes.subspan(4)));
 			break;
 		}
 		case BUGZILLA_INFO:
 		{
-			result.packet = std::make_unique<BugzillaInfoMessage>(BugzillaInfoMessage::unpack(bytes.subspan(4)).value());
-			result.bytes_read = raw_length;
-
+			store(BugzillaInfoMessage::unpack(bytes.subspan(4)));
 			break;
 		}
 		case REQUEST_DAILY_REPORT:
-			result.packet = std::make_unique<RequestDailyReportMessage>(RequestDailyReportMessage::unpack(bytes.subspan(4)).value());
-			result.bytes_read = raw_length;
+			store(RequestDailyReportMessage::unpack(bytes.subspan(4)));
 			break;
 		case DAILY_REPORT:
-			result.packet = std::make_unique<DailyReportMessage>(DailyReportMessage::unpack(bytes.subspan(4)).value());
-			result.bytes_read = raw_length;
+			store(DailyReportMessage::unpack(bytes.subspan(4)));
 			break;
 		case REQUEST_WEEKLY_REPORT:
-			result.packet = std::make_unique<RequestWeeklyReportMessage>(RequestWeeklyReportMessage::unpack(bytes.subspan(4)).value());
-			result.bytes_read = raw_length;
+			store(RequestWeeklyReportMessage::unpack(bytes.subspan(4)));
 			break;
 		case TIME_ENTRY_DATA:
-			result.packet = std::make_unique<TimeEntryDataPacket>(TimeEntryDataPacket::unpack(bytes.subspan(4)).value());
-			result.bytes_read = raw_length;
+			store(TimeEntryDataPacket::unpack(bytes.subspan(4)));
 			break;
 		case TIME_ENTRY_MODIFY:
-			result.packet = std::make_unique<TimeEntryModifyPacket>(TimeEntryModifyPacket::unpack(bytes.subspan(4)).value());
-			result.bytes_read = raw_length;
+			store(TimeEntryModifyPacket::unpack(bytes.subspan(4)));
+			break;
+		case STATS:
+			store(StatsMessage::unpack(bytes.subspan(4)));
+			break;
+		case BACKUP_CONFIGURATION:
+			store(BackupConfigurationMessage::unpack(bytes.subspan(4)));
+			break;
+		case BACKUP_PERFORMED:
+			store(BackupPerformedMessage::unpack(bytes.subspan(4)));
+			break;
+		case BACKUP_FAILED:
+			store(BackupFailedMessage::unpack(bytes.subspan(4)));
+			break;
+		case REQUEST_TASKS:
+			store(RequestTasksMessage::unpack(bytes.subspan(4)));
+			break;
+		case TASK_PAGE:
+			store(TaskPageMessage::unpack(bytes.subspan(4)));
+			break;
+		case TASK_INFO_DELTA:
+			store(TaskInfoDeltaMessage::unpack(bytes.subspan(4), time_categories));
+			break;
+		case REQUEST_RESYNC:
+			store(RequestResyncMessage::unpack(bytes.subspan(4)));
+			break;
+		case SYNC_POSITION:
+			store(SyncPositionMessage::unpack(bytes.subspan(4)));
+			break;
+		case BULK_TASK_INFO:
+			store(BulkTaskInfoMessage::unpack(bytes.subspan(4)));
+			break;
+		case REQUEST_PROTOCOL_VERSION:
+			store(RequestProtocolVersionMessage::unpack(bytes.subspan(4)));
+			break;
+		case PROTOCOL_VERSION:
+			store(ProtocolVersionMessage::unpack(bytes.subspan(4)));
+			break;
+		case CHUNK:
+			store(ChunkMessage::unpack(bytes.subspan(4, raw_length - 4)));
 			break;
 		default:
 			break;
@@ -245,3 +529,137 @@ inline ParseResult parse_packet(std::span<const std::byte> bytes, const TimeCate
 	}
 	return result;
 }
+
+// every request the API handles. decoded in place by parse_request instead of allocating a message for each packet.
+// the views point into the bytes they were decoded from, which have to outlive their use
+using RequestPacket = std::variant<
+	std::monostate,
+	BasicMessage,
+	RequestMessage,
+	CreateTaskView,
+	TaskMessage,
+	UpdateTaskView,
+	UpdateTaskTimesMessage,
+	RequestDailyReportMessage,
+	RequestWeeklyReportMessage,
+	TimeEntryModifyView,
+	BackupConfigurationMessage,
+	BugzillaInfoView,
+	RequestTasksMessage,
+	RequestResyncMessage,
+	RequestProtocolVersionMessage
+>;
+
+// decode a request into storage, which the caller can reuse from one packet to the next. returns the number of bytes
+// read, or where and why the bytes aren't a valid request. storage is left as std::monostate on failure. never throws
+inline std::expected<std::int32_t, UnpackError> parse_request(std::span<const std::byte> bytes, const TimeCategories& time_categories, RequestPacket& storage)
+{
+	storage.emplace<std::monostate>();
+
+	if (bytes.size() < 8)
+	{
+		return std::unexpected(UnpackError(UnpackError::NOT_ENOUGH_BYTES, bytes.size() < 4 ? 0 : bytes.size() - 4, "packetType"));
+	}
+
+	std::int32_t raw_length;
+	std::memcpy(&raw_length, bytes.data(), sizeof(raw_length));
+	raw_length = std::byteswap(raw_length);
+
+	std::int32_t raw_type;
+	std::memcpy(&raw_type, bytes.data() + sizeof(raw_length), sizeof(PacketType));
+	const PacketType type = static_cast<PacketType>(std::byteswap(raw_type));
+
+	const auto data = bytes.subspan(4);
+
+	const auto store = [&]<typename T>(std::expected<T, UnpackError>&& message) -> std::expected<std::int32_t, UnpackError>
+	{
+		if (!message)
+		{
+			return std::unexpected(message.error());
+		}
+		storage.emplace<T>(*std::move(message));
+		return raw_length;
+	};
+
+	switch (type)
+	{
+		using enum PacketType;
+
+	case VERSION_REQUEST:
+	case REQUEST_CONFIGURATION:
+	case REQUEST_CONFIGURATION_WITHOUT_TASKS:
+	case REQUEST_TIME_ENTRY:
+	case BULK_TASK_UPDATE_START:
+	case BULK_TASK_UPDATE_FINISH:
+		return store(BasicMessage::unpack(data));
+	case BUGZILLA_REFRESH:
+	case REQUEST_STATS:
+	case DATABASE_FLUSH:
+	case ENABLE_TASK_INFO_DELTA:
+		return store(RequestMessage::unpack(data));
+	case CREATE_TASK:
+		return store(CreateTaskView::unpack(data, time_categories));
+	case START_TASK:
+	case START_UNSPECIFIED_TASK:
+	case STOP_TASK:
+	case STOP_UNSPECIFIED_TASK:
+	case FINISH_TASK:
+	case REQUEST_TASK:
+	case REQUEST_ARCHIVED_TASKS:
+	case SUBSCRIBE_TASKS:
+	case UNSUBSCRIBE_TASKS:
+		return store(TaskMessage::unpack(data));
+	case UPDATE_TASK:
+		return store(UpdateTaskView::unpack(data, time_categories));
+	case EDIT_TASK_SESSION:
+	case ADD_TASK_SESSION:
+	case REMOVE_TASK_SESSION:
+		return store(UpdateTaskTimesMessage::unpack(data));
+	case REQUEST_DAILY_REPORT:
+		return store(RequestDailyReportMessage::unpack(data));
+	case REQUEST_WEEKLY_REPORT:
+		return store(RequestWeeklyReportMessage::unpack(data));
+	case TIME_ENTRY_MODIFY:
+		return store(TimeEntryModifyView::unpack(data));
+	case BACKUP_CONFIGURATION:
+		return store(BackupConfigurationMessage::unpack(data));
+	case BUGZILLA_INFO:
+		return store(BugzillaInfoView::unpack(data));
+	case REQUEST_TASKS:
+		return store(RequestTasksMessage::unpack(data));
+	case REQUEST_RESYNC:
+		return store(RequestResyncMessage::unpack(data));
+	case REQUEST_PROTOCOL_VERSION:
+		return store(RequestProtocolVersionMessage::unpack(data));
+	default:
+		return std::unexpected(UnpackError(UnpackError::UNKNOWN_PACKET_TYPE, 0, "packetType"));
+	}
+}
+
+// the reply to bytes that parse_request couldn't decode. the packet type and request ID are filled in when the bytes
+// are long enough to hold them, so the client can match the failure to the request it sent
+inline FailureResponse unpack_failure(std::span<const std::byte> bytes, const UnpackError& error)
+{
+	auto parser = PacketParser(bytes.size() < 4 ? bytes.subspan(0, 0) : bytes.subspan(4));
+
+	const auto packetType = parser.read<PacketType>("packetType");
+	const auto requestID = parser.read<RequestID>("requestID");
+
+	return FailureResponse(RequestOrigin{ packetType, requestID }, error.message());
+}
+
+// the request in storage, nullptr when there isn't one
+inline const Message* request_message(const RequestPacket& storage)
+{
+	return std::visit([]<typename T>(const T& message) -> const Message*
+		{
+			if constexpr (std::same_as<T, std::monostate>)
+			{
+				return nullptr;
+			}
+			else
+			{
+				return &message;
+			}
+		}, storage);
+}
@@ -0,0 +1,90 @@
+#pragma once
+
+#include "request.hpp"
+#include "schema.hpp"
+#include "string_length.hpp"
+#include "unpack_error.hpp"
+
+#include <cstdint>
+#include <expected>
+#include <ostream>
+#include <span>
+#include <vector>
+
+// 1: one TASK_INFO per task in the bulk task info
+// 2: BULK_TASK_INFO
+// 3: TASK_INFO and BULK_TASK_INFO use WireFormat::COMPACT
+// 4: strings have a 4 byte length and packets over MAX_CHUNK_SIZE are sent as CHUNK frames
+inline constexpr std::int32_t CURRENT_PROTOCOL_VERSION = 4;
+inline constexpr std::int32_t BULK_TASK_INFO_PROTOCOL_VERSION = 2;
+inline constexpr std::int32_t COMPACT_WIRE_FORMAT_PROTOCOL_VERSION = 3;
+inline constexpr std::int32_t LONG_STRING_PROTOCOL_VERSION = 4;
+
+// the string length used in both directions with a client on the version
+inline StringLength string_length(std::int32_t version)
+{
+	return version >= LONG_STRING_PROTOCOL_VERSION ? StringLength::LONG : StringLength::SHORT;
+}
+
+struct RequestProtocolVersionMessage : RequestMessage
+{
+	// the highest version the client understands
+	std::int32_t version = 1;
+
+	RequestProtocolVersionMessage(RequestID requestID, std::int32_t version) : RequestMessage(PacketType::REQUEST_PROTOCOL_VERSION, requestID), version(version)
+	{
+	}
+
+	static constexpr auto schema()
+	{
+		return std::tuple{
+			field<&RequestProtocolVersionMessage::requestID>("requestID"),
+			field<&RequestProtocolVersionMessage::version>("version")
+		};
+	}
+
+	std::vector<std::byte> pack() const override;
+	static std::expected<RequestProtocolVersionMessage, UnpackError> unpack(std::span<const std::byte> data);
+
+	std::ostream& print(std::ostream& out) const override
+	{
+		return print_schema(out, "RequestProtocolVersionMessage", *this);
+	}
+
+	friend std::ostream& operator<<(std::ostream& out, const RequestProtocolVersionMessage& message)
+	{
+		message.print(out);
+		return out;
+	}
+};
+
+// the version the server will use with the client from now on
+struct ProtocolVersionMessage : Message
+{
+	std::int32_t version = 1;
+
+	ProtocolVersionMessage(std::int32_t version) : Message(PacketType::PROTOCOL_VERSION), version(version)
+	{
+	}
+
+	static constexpr auto schema()
+	{
+		return std::tuple{
+			field<&ProtocolVersionMessage::version>("version")
+		};
+	}
+
+	std::vector<std::byte> pack() const override;
+	static std::expected<ProtocolVersionMessage, UnpackError> unpack(std::span<const std::byte> data);
+
+	std::ostream& print(std::ostream& out) const override
+	{
+		return print_schema(out, "ProtocolVersionMessage", *this);
+	}
+
+	friend std::ostream& operator<<(std::ostream& out, const ProtocolVersionMessage& message)
+	{
+		message.print(out);
+		return out;
+	}
+};
@@ -1,5 +1,7 @@
 #pragma once
 
+#include "schema.hpp"
+
 struct RequestDailyReportMessage : RequestMessage
 {
 	int month;
@@ -10,15 +12,22 @@ struct RequestDailyReportMessage : RequestMessage
 	{
 	}
 
+	static constexpr auto schema()
+	{
+		return std::tuple{
+			field<&RequestDailyReportMessage::requestID>("requestID"),
+			field<&RequestDailyReportMessage::month, std::int8_t>("month"),
+			field<&RequestDailyReportMessage::day, std::int8_t>("day"),
+			field<&RequestDailyReportMessage::year, std::int16_t>("year")
+		};
+	}
+
 	std::vector<std::byte> pack() const override;
 	static std::expected<RequestDailyReportMessage, UnpackError> unpack(std::span<const std::byte> data);
 
 	std::ostream& print(std::ostream& out) const override
 	{
-		out << "RequestDailyReportMessage { ";
-		RequestMessage::print(out);
-		out << ", month: " << month << ", day: " << day << ", year: " << year << " }";
-		return out;
+		return print_schema(out, "RequestDailyReportMessage", *this);
 	}
 
 	friend std::ostream& operator<<(std::ostream& out, const RequestDailyReportMessage& message)
@@ -0,0 +1,46 @@
+#pragma once
+
+#include "request.hpp"
+#include "schema.hpp"
+#include "unpack_error.hpp"
+
+#include <cstdint>
+#include <expected>
+#include <ostream>
+#include <span>
+#include <vector>
+
+// sent by a client after reconnecting with the last SYNC_POSITION it was given
+struct RequestResyncMessage : RequestMessage
+{
+	// identifies the server run the sequence came from. 0 when the client has never synced
+	std::int64_t epoch = 0;
+	std::int64_t sequence = 0;
+
+	RequestResyncMessage(RequestID requestID, std::int64_t epoch, std::int64_t sequence) : RequestMessage(PacketType::REQUEST_RESYNC, requestID), epoch(epoch), sequence(sequence)
+	{
+	}
+
+	static constexpr auto schema()
+	{
+		return std::tuple{
+			field<&RequestResyncMessage::requestID>("requestID"),
+			field<&RequestResyncMessage::epoch>("epoch"),
+			field<&RequestResyncMessage::sequence>("sequence")
+		};
+	}
+
+	std::vector<std::byte> pack() const override;
+	static std::expected<RequestResyncMessage, UnpackError> unpack(std::span<const std::byte> data);
+
+	std::ostream& print(std::ostream& out) const override
+	{
+		return print_schema(out, "RequestResyncMessage", *this);
+	}
+
+	friend std::ostream& operator<<(std::ostream& out, const RequestResyncMessage& message)
+	{
+		message.print(out);
+		return out;
+	}
+};
@@ -0,0 +1,47 @@
+#pragma once
+
+#include "request.hpp"
+#include "task_id.hpp"
+#include "unpack_error.hpp"
+
+#include <cstdint>
+#include <expected>
+#include <ostream>
+#include <span>
+#include <vector>
+
+// a page of the children of a task, or of every task below it. children are in ID order and come after their parent
+struct RequestTasksMessage : RequestMessage
+{
+	TaskID parentID;
+
+	// every task below the parent instead of only its children
+	bool subtree = false;
+	// finished tasks are left out along with everything below them
+	bool unfinishedOnly = false;
+
+	std::int32_t offset = 0;
+	// 0 for no limit
+	std::int32_t limit = 0;
+
+	RequestTasksMessage(RequestID requestID, TaskID parentID) : RequestMessage(PacketType::REQUEST_TASKS, requestID), parentID(parentID)
+	{
+	}
+
+	std::vector<std::byte> pack() const override;
+	static std::expected<RequestTasksMessage, UnpackError> unpack(std::span<const std::byte> data);
+
+	std::ostream& print(std::ostream& out) const override
+	{
+		out << "RequestTasksMessage { ";
+		RequestMessage::print(out);
+		out << ", parentID: " << parentID._val << ", subtree: " << subtree << ", unfinishedOnly: " << unfinishedOnly << ", offset: " << offset << ", limit: " << limit << " }";
+		return out;
+	}
+
+	friend std::ostream& operator<<(std::ostream& out, const RequestTasksMessage& message)
+	{
+		message.print(out);
+		return out;
+	}
+};
@@ -1,5 +1,7 @@
 #pragma once
 
+#include "schema.hpp"
+
 struct RequestWeeklyReportMessage : RequestMessage
 {
 	int month;
@@ -10,15 +12,22 @@ struct RequestWeeklyReportMessage : RequestMessage
 	{
 	}
 
+	static constexpr auto schema()
+	{
+		return std::tuple{
+			field<&RequestWeeklyReportMessage::requestID>("requestID"),
+			field<&RequestWeeklyReportMessage::month, std::int8_t>("month"),
+			field<&RequestWeeklyReportMessage::day, std::int8_t>("day"),
+			field<&RequestWeeklyReportMessage::year, std::int16_t>("year")
+		};
+	}
+
 	std::vector<std::byte> pack() const override;
 	static std::expected<RequestWeeklyReportMessage, UnpackError> unpack(std::span<const std::byte> data);
 
 	std::ostream& print(std::ostream& out) const override
 	{
-		out << "RequestWeeklyReportMessage { ";
-		RequestMessage::print(out);
-		out << ", month: " << month << ", day: " << day << ", year: " << year << " }";
-		return out;
+		return print_schema(out, "RequestWeeklyReportMessage", *this);
 	}
 
 	friend std::ostream& operator<<(std::ostream& out, const RequestWeeklyReportMessage& message)
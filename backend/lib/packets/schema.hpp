@@ -0,0 +1,126 @@
+#pragma once
+
+#include "message.hpp"
+#include "string_length.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+
+#include <strong_type/strong_type.hpp>
+
+// the fields of a message in the order they're packed, after the packet type. messages list them once in a static
+// constexpr schema(). print_schema below is generated from the list, pack_schema and unpack_schema are in packets.cpp
+// because they need the PacketBuilder and PacketParser, which include the messages
+//
+// Wire is the type written to the packet when it's smaller than the member, like the int8 month of a report request
+template<auto Member, typename Wire = void>
+struct Field
+{
+	std::string_view name;
+};
+
+template<auto Member, typename Wire = void>
+constexpr Field<Member, Wire> field(std::string_view name)
+{
+	return { name };
+}
+
+template<typename T>
+struct member_pointer;
+
+template<typename Class, typename T>
+struct member_pointer<T Class::*>
+{
+	using type = T;
+};
+
+template<typename F>
+struct field_traits;
+
+template<auto Member, typename Wire>
+struct field_traits<Field<Member, Wire>>
+{
+	using member_type = typename member_pointer<decltype(Member)>::type;
+	using wire_type = std::conditional_t<std::same_as<Wire, void>, member_type, Wire>;
+
+	static constexpr auto member = Member;
+};
+
+// bytes the value takes in a packet. strings are a 2 or 4 byte length followed by the characters
+template<typename T>
+constexpr std::size_t wire_size(const T& value)
+{
+	if constexpr (std::same_as<T, std::string> || std::same_as<T, std::string_view>)
+	{
+		if (StringLengthScope::current() == StringLength::LONG)
+		{
+			return StringLengthScope::prefix_size() + value.size();
+		}
+		return StringLengthScope::prefix_size() + std::min(value.size(), MAX_SHORT_STRING_LENGTH);
+	}
+	else if constexpr (std::same_as<T, std::chrono::milliseconds>)
+	{
+		return sizeof(std::int64_t);
+	}
+	else if constexpr (std::same_as<T, bool>)
+	{
+		return sizeof(std::int8_t);
+	}
+	else if constexpr (strong::is_strong_type<T>::value)
+	{
+		return sizeof(strong::underlying_type_t<T>);
+	}
+	else
+	{
+		return sizeof(T);
+	}
+}
+
+template<typename T>
+void print_value(std::ostream& out, const T& value)
+{
+	if constexpr (std::same_as<T, std::string> || std::same_as<T, std::string_view>)
+	{
+		out << '"' << value << '"';
+	}
+	else if constexpr (std::same_as<T, std::chrono::milliseconds>)
+	{
+		out << value.count();
+	}
+	else if constexpr (strong::is_strong_type<T>::value)
+	{
+		out << value._val;
+	}
+	else if constexpr (std::is_enum_v<T>)
+	{
+		out << static_cast<std::underlying_type_t<T>>(value);
+	}
+	else
+	{
+		out << value;
+	}
+}
+
+// Name { packetType: ..., field: value, ... }
+template<typename T>
+std::ostream& print_schema(std::ostream& out, std::string_view name, const T& message)
+{
+	out << name << " { ";
+	message.Message::print(out);
+
+	std::apply([&](auto... fields)
+		{
+			((out << ", " << fields.name << ": ", print_value(out, message.*field_traits<decltype(fields)>::member)), ...);
+		}, T::schema());
+
+	out << " }";
+	return out;
+}
@@ -0,0 +1,279 @@
+#pragma once
+
+#include <algorithm>
+#include <compare>
+#include <cstddef>
+#include <initializer_list>
+#include <iterator>
+#include <memory>
+#include <type_traits>
+#include <utility>
+
+// a vector that keeps up to N values inside of itself and only allocates when it grows past that. for the short lists
+// that are stored many times over, like the time entry of every session, where most lists have one or two values
+//
+// the interface is the part of std::vector that's used with these lists. iterators are pointers
+template<typename T, std::size_t N>
+class SmallVector
+{
+	static_assert(N > 0);
+
+public:
+	using value_type = T;
+	using size_type = std::size_t;
+	using difference_type = std::ptrdiff_t;
+	using reference = T&;
+	using const_reference = const T&;
+	using pointer = T*;
+	using const_pointer = const T*;
+	using iterator = T*;
+	using const_iterator = const T*;
+
+	SmallVector() = default;
+
+	SmallVector(std::initializer_list<T> values)
+	{
+		assign(values.begin(), values.end());
+	}
+
+	template<std::input_iterator It, std::sentinel_for<It> End>
+	SmallVector(It first, End last)
+	{
+		assign(first, last);
+	}
+
+	SmallVector(const SmallVector& other)
+	{
+		assign(other.begin(), other.end());
+	}
+
+	SmallVector(SmallVector&& other) noexcept(std::is_nothrow_move_constructible_v<T>)
+	{
+		take(other);
+	}
+
+	~SmallVector()
+	{
+		clear();
+		free_heap();
+	}
+
+	SmallVector& operator=(const SmallVector& other)
+	{
+		if (this != &other)
+		{
+			assign(other.begin(), other.end());
+		}
+		return *this;
+	}
+
+	SmallVector& operator=(SmallVector&& other) noexcept(std::is_nothrow_move_constructible_v<T>)
+	{
+		if (this != &other)
+		{
+			clear();
+			free_heap();
+			take(other);
+		}
+		return *this;
+	}
+
+	SmallVector& operator=(std::initializer_list<T> values)
+	{
+		assign(values.begin(), values.end());
+		return *this;
+	}
+
+	template<std::input_iterator It, std::sentinel_for<It> End>
+	void assign(It first, End last)
+	{
+		clear();
+
+		if constexpr (std::forward_iterator<It>)
+		{
+			reserve(static_cast<size_type>(std::ranges::distance(first, last)));
+		}
+
+		for (; first != last; ++first)
+		{
+			emplace_back(*first);
+		}
+	}
+
+	iterator begin() { return m_data; }
+	iterator end() { return m_data + m_size; }
+	const_iterator begin() const { return m_data; }
+	const_iterator end() const { return m_data + m_size; }
+	const_iterator cbegin() const { return m_data; }
+	const_iterator cend() const { return m_data + m_size; }
+
+	T* data() { return m_data; }
+	const T* data() const { return m_data; }
+
+	size_type size() const { return m_size; }
+	bool empty() const { return m_size == 0; }
+	size_type capacity() const { return m_capacity; }
+
+	// the values are stored inside of the vector, nothing has been allocated
+	bool is_inline() const { return m_data == inline_data(); }
+
+	T& operator[](size_type index) { return m_data[index]; }
+	const T& operator[](size_type index) const { return m_data[index]; }
+
+	T& front() { return m_data[0]; }
+	const T& front() const { return m_data[0]; }
+	T& back() { return m_data[m_size - 1]; }
+	const T& back() const { return m_data[m_size - 1]; }
+
+	void reserve(size_type capacity)
+	{
+		if (capacity <= m_capacity)
+		{
+			return;
+		}
+
+		T* values = std::allocator<T>().allocate(capacity);
+
+		std::uninitialized_move(m_data, m_data + m_size, values);
+		std::destroy(m_data, m_data + m_size);
+
+		free_heap();
+
+		m_data = values;
+		m_capacity = capacity;
+	}
+
+	template<typename... Args>
+	T& emplace_back(Args&&... args)
+	{
+		if (m_size == m_capacity)
+		{
+			// the arguments might refer to a value in the vector, build the new value before moving them
+			T value(std::forward<Args>(args)...);
+
+			reserve(m_capacity * 2);
+
+			std::construct_at(m_data + m_size, std::move(value));
+		}
+		else
+		{
+			std::construct_at(m_data + m_size, std::forward<Args>(args)...);
+		}
+		return m_data[m_size++];
+	}
+
+	void push_back(const T& value) { emplace_back(value); }
+	void push_back(T&& value) { emplace_back(std::move(value)); }
+
+	void pop_back()
+	{
+		std::destroy_at(m_data + --m_size);
+	}
+
+	iterator insert(const_iterator position, T value)
+	{
+		const auto index = position - m_data;
+
+		emplace_back(std::move(value));
+		std::rotate(m_data + index, m_data + m_size - 1, m_data + m_size);
+
+		return m_data + index;
+	}
+
+	iterator erase(const_iterator position)
+	{
+		return erase(position, position + 1);
+	}
+
+	iterator erase(const_iterator first, const_iterator last)
+	{
+		T* const begin = m_data + (first - m_data);
+		T* const end = m_data + (last - m_data);
+
+		T* const newEnd = std::move(end, m_data + m_size, begin);
+
+		std::destroy(newEnd, m_data + m_size);
+		m_size = newEnd - m_data;
+
+		return begin;
+	}
+
+	void resize(size_type size)
+	{
+		reserve(size);
+
+		while (m_size < size)
+		{
+			std::construct_at(m_data + m_size++);
+		}
+		while (m_size > size)
+		{
+			pop_back();
+		}
+	}
+
+	void clear()
+	{
+		std::destroy(m_data, m_data + m_size);
+		m_size = 0;
+	}
+
+	friend bool operator==(const SmallVector& a, const SmallVector& b)
+	{
+		return std::equal(a.begin(), a.end(), b.begin(), b.end());
+	}
+
+	// the same ordering as std::vector, which falls back to < for values without <=>
+	friend auto operator<=>(const SmallVector& a, const SmallVector& b)
+	{
+		return std::lexicographical_compare_three_way(a.begin(), a.end(), b.begin(), b.end(), [](const T& x, const T& y)
+			{
+				if constexpr (std::three_way_comparable<T>)
+				{
+					return x <=> y;
+				}
+				else
+				{
+					return x < y ? std::weak_ordering::less : y < x ? std::weak_ordering::greater : std::weak_ordering::equivalent;
+				}
+			});
+	}
+
+private:
+	T* inline_data() { return reinterpret_cast<T*>(m_inline); }
+	const T* inline_data() const { return reinterpret_cast<const T*>(m_inline); }
+
+	void free_heap()
+	{
+		if (!is_inline())
+		{
+			std::allocator<T>().deallocate(m_data, m_capacity);
+
+			m_data = inline_data();
+			m_capacity = N;
+		}
+	}
+
+	// move the values of the other vector into this empty one, leaving the other one empty
+	void take(SmallVector& other)
+	{
+		if (other.is_inline())
+		{
+			std::uninitialized_move(other.m_data, other.m_data + other.m_size, m_data);
+			m_size = other.m_size;
+
+			other.clear();
+		}
+		else
+		{
+			m_data = std::exchange(other.m_data, other.inline_data());
+			m_size = std::exchange(other.m_size, 0);
+			m_capacity = std::exchange(other.m_capacity, N);
+		}
+	}
+
+	alignas(T) std::byte m_inline[N * sizeof(T)];
+	T* m_data = inline_data();
+	size_type m_size = 0;
+	size_type m_capacity = N;
+};
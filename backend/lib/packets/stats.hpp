@@ -0,0 +1,105 @@
+#pragma once
+
+#include "message.hpp"
+#include "unpack_error.hpp"
+
+#include <cstdint>
+#include <expected>
+#include <span>
+#include <vector>
+
+// snapshot of a fixed bucket histogram. bucket N counts values in [2^(N-1), 2^N), bucket 0 counts zeros
+struct HistogramData
+{
+	std::uint64_t count = 0;
+	std::uint64_t sum = 0;
+	std::vector<std::uint64_t> buckets;
+
+	// upper bound of the bucket holding the given percentile (0 to 100)
+	std::uint64_t percentile(double percent) const
+	{
+		const auto target = static_cast<std::uint64_t>(count * percent / 100.0);
+
+		std::uint64_t seen = 0;
+
+		for (std::size_t i = 0; i < buckets.size(); i++)
+		{
+			seen += buckets[i];
+
+			if (seen > target || seen == count)
+			{
+				return i == 0 ? 0 : (std::uint64_t(1) << i) - 1;
+			}
+		}
+		return 0;
+	}
+
+	constexpr auto operator<=>(const HistogramData&) const = default;
+
+	friend std::ostream& operator<<(std::ostream& out, const HistogramData& histogram)
+	{
+		out << "{ count: " << histogram.count;
+
+		if (histogram.count > 0)
+		{
+			out << ", avg: " << histogram.sum / histogram.count << ", p50: " << histogram.percentile(50) << ", p99: " << histogram.percentile(99);
+		}
+		out << " }";
+		return out;
+	}
+};
+
+struct PacketStats
+{
+	PacketType packetType;
+
+	// microseconds
+	HistogramData requestTime;
+	HistogramData databaseTime;
+	HistogramData sendTime;
+
+	// bytes
+	HistogramData bytesIn;
+	HistogramData bytesOut;
+
+	constexpr auto operator<=>(const PacketStats&) const = default;
+
+	friend std::ostream& operator<<(std::ostream& out, const PacketStats& stats)
+	{
+		out << magic_enum::enum_name(stats.packetType) << " (" << static_cast<std::int32_t>(stats.packetType) << ")";
+		out << " request: " << stats.requestTime << ", database: " << stats.databaseTime << ", send: " << stats.sendTime;
+		out << ", bytes in: " << stats.bytesIn << ", bytes out: " << stats.bytesOut;
+		return out;
+	}
+};
+
+struct StatsMessage : Message
+{
+	RequestOrigin request;
+
+	std::vector<PacketStats> packets;
+
+	StatsMessage(RequestOrigin request) : Message(PacketType::STATS), request(request) {}
+
+	std::vector<std::byte> pack() const override;
+	static std::expected<StatsMessage, UnpackError> unpack(std::span<const std::byte> data);
+
+	std::ostream& print(std::ostream& out) const override
+	{
+		out << "StatsMessage { ";
+		Message::print(out);
+		out << ", request: " << request;
+		for (auto&& stats : packets)
+		{
+			out << "\n" << stats;
+		}
+		out << " }";
+		return out;
+	}
+
+	friend std::ostream& operator<<(std::ostream& out, const StatsMessage& message)
+	{
+		message.print(out);
+		return out;
+	}
+};
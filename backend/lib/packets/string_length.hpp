@@ -0,0 +1,45 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// strings are packed with a 2 byte length until the client negotiates LONG_STRING_PROTOCOL_VERSION, then with a 4 byte
+// length. the varint lengths of the compact wire format aren't affected
+enum class StringLength
+{
+	SHORT,
+	LONG
+};
+
+// the longest string a 2 byte length can describe. longer strings are cut off at this length instead of corrupting the
+// rest of the packet
+inline constexpr std::size_t MAX_SHORT_STRING_LENGTH = INT16_MAX;
+
+// the string length used by every PacketBuilder and PacketParser on this thread while the scope is alive. packing and
+// unpacking go through message functions that don't know which client they're for, so the caller sets it around them
+class StringLengthScope
+{
+public:
+	explicit StringLengthScope(StringLength length) : m_previous(s_current)
+	{
+		s_current = length;
+	}
+
+	~StringLengthScope()
+	{
+		s_current = m_previous;
+	}
+
+	StringLengthScope(const StringLengthScope&) = delete;
+	StringLengthScope& operator=(const StringLengthScope&) = delete;
+
+	static StringLength current() { return s_current; }
+
+	// bytes taken by the length in front of a string
+	static std::size_t prefix_size() { return s_current == StringLength::LONG ? sizeof(std::int32_t) : sizeof(std::int16_t); }
+
+private:
+	StringLength m_previous;
+
+	static inline thread_local StringLength s_current = StringLength::SHORT;
+};
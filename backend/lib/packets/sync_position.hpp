@@ -0,0 +1,49 @@
+#pragma once
+
+#include "message.hpp"
+#include "schema.hpp"
+#include "unpack_error.hpp"
+
+#include <cstdint>
+#include <expected>
+#include <ostream>
+#include <span>
+#include <vector>
+
+// sent first in the response to REQUEST_RESYNC and REQUEST_CONFIGURATION. the client keeps the epoch and sequence for its
+// next resync
+struct SyncPositionMessage : Message
+{
+	std::int64_t epoch = 0;
+	std::int64_t sequence = 0;
+
+	// the client's tasks are replaced by the configuration that follows instead of being updated
+	bool fullSync = false;
+
+	SyncPositionMessage(std::int64_t epoch, std::int64_t sequence, bool fullSync) : Message(PacketType::SYNC_POSITION), epoch(epoch), sequence(sequence), fullSync(fullSync)
+	{
+	}
+
+	static constexpr auto schema()
+	{
+		return std::tuple{
+			field<&SyncPositionMessage::epoch>("epoch"),
+			field<&SyncPositionMessage::sequence>("sequence"),
+			field<&SyncPositionMessage::fullSync>("fullSync")
+		};
+	}
+
+	std::vector<std::byte> pack() const override;
+	static std::expected<SyncPositionMessage, UnpackError> unpack(std::span<const std::byte> data);
+
+	std::ostream& print(std::ostream& out) const override
+	{
+		return print_schema(out, "SyncPositionMessage", *this);
+	}
+
+	friend std::ostream& operator<<(std::ostream& out, const SyncPositionMessage& message)
+	{
+		message.print(out);
+		return out;
+	}
+};
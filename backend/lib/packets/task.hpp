@@ -1,6 +1,7 @@
 #pragma once
 
 #include "request.hpp"
+#include "schema.hpp"
 #include "task_id.hpp"
 
 #include <cassert>
@@ -15,19 +16,28 @@ struct TaskMessage : RequestMessage
 			   type == PacketType::STOP_TASK || 
 			   type == PacketType::FINISH_TASK || 
 			   type == PacketType::REQUEST_TASK ||
+			   type == PacketType::REQUEST_ARCHIVED_TASKS ||
+			   type == PacketType::TASKS_ARCHIVED ||
+			   type == PacketType::SUBSCRIBE_TASKS ||
+			   type == PacketType::UNSUBSCRIBE_TASKS ||
 			   type == PacketType::START_UNSPECIFIED_TASK ||
 			   type == PacketType::STOP_UNSPECIFIED_TASK);
 	}
 
+	static constexpr auto schema()
+	{
+		return std::tuple{
+			field<&TaskMessage::requestID>("requestID"),
+			field<&TaskMessage::taskID>("taskID")
+		};
+	}
+
 	std::vector<std::byte> pack() const override;
 	static std::expected<TaskMessage, UnpackError> unpack(std::span<const std::byte> data);
 
 	std::ostream& print(std::ostream& out) const override
 	{
-		out << "TaskMessage { ";
-		RequestMessage::print(out);
-		out << ", taskID: " << taskID._val << " }";
-		return out;
+		return print_schema(out, "TaskMessage", *this);
 	}
 
 	friend std::ostream& operator<<(std::ostream& out, const TaskMessage& message)
@@ -1,9 +1,11 @@
 #pragma once
 
 #include "message.hpp"
+#include "small_vector.hpp"
 #include "task_id.hpp"
 #include "task_state.hpp"
 #include "task_times.hpp"
+#include "time_category.hpp"
 #include "unpack_error.hpp"
 
 #include <cstdint>
@@ -29,8 +31,9 @@ struct TaskInfoMessage : Message
 	std::optional<std::chrono::milliseconds> finishTime;
 	std::vector<TaskTimes> times;
 
-	std::vector<std::string> labels;
-	std::vector<TimeEntry> timeEntry;
+	// the same types as the task, so copying them doesn't allocate
+	SmallVector<std::string, 2> labels;
+	SmallVector<TimeEntry, 2> timeEntry;
 
 	TaskInfoMessage(TaskID taskID, TaskID parentID, std::string name, std::chrono::milliseconds createTime = std::chrono::milliseconds(0)) : Message(PacketType::TASK_INFO), taskID(taskID), parentID(parentID), name(std::move(name)), createTime(createTime) {}
 
@@ -48,7 +51,9 @@ struct TaskInfoMessage : Message
 	}*/
 
 	std::vector<std::byte> pack() const override;
+	std::vector<std::byte> pack_compact() const override;
 	static std::expected<TaskInfoMessage, UnpackError> unpack(std::span<const std::byte> data, const TimeCategories& time_categories);
+	static std::expected<TaskInfoMessage, UnpackError> unpack_compact(std::span<const std::byte> data, const TimeCategories& time_categories);
 
 	std::ostream& print(std::ostream& out) const override
 	{
@@ -59,7 +64,7 @@ struct TaskInfoMessage : Message
 			out << ", time codes: [ ";
 			for (auto&& code : time.timeEntry)
 			{
-				out << std::format("[ {} ({}) {} ({}) ]", code.category.name, code.category.id._val, code.code.name, code.code.id._val);
+				out << std::format("[ {} {} ]", code.categoryID._val, code.codeID._val);
 				out << ", ";
 			}
 			out << "]";
@@ -76,7 +81,7 @@ struct TaskInfoMessage : Message
 		out << "time codes: [ ";
 		for (auto&& code : timeEntry)
 		{
-			out << std::format("[ {} ({}) {} ({}) ]", code.category.name, code.category.id, code.code.name, code.code.id);
+			out << std::format("[ {} {} ]", code.categoryID._val, code.codeID._val);
 			out << ", ";
 		}
 		out << "]";
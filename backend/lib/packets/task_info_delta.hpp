@@ -0,0 +1,112 @@
+#pragma once
+
+#include "message.hpp"
+#include "small_vector.hpp"
+#include "task_id.hpp"
+#include "task_state.hpp"
+#include "task_times.hpp"
+#include "time_category.hpp"
+#include "unpack_error.hpp"
+
+#include <cstdint>
+#include <string>
+#include <optional>
+#include <vector>
+#include <expected>
+#include <span>
+
+// the fields of a task that changed since the last TASK_INFO or TASK_INFO_DELTA for it. only the changed fields are
+// packed, the rest of the message is left at its defaults
+struct TaskInfoDeltaMessage : Message
+{
+	enum Field : std::uint32_t
+	{
+		PARENT = 1 << 0,
+		NAME = 1 << 1,
+		STATE = 1 << 2,
+		INDEX_IN_PARENT = 1 << 3,
+		SERVER_CONTROLLED = 1 << 4,
+		LOCKED = 1 << 5,
+		FINISH_TIME = 1 << 6,
+		SESSIONS = 1 << 7,
+		LABELS = 1 << 8,
+		TIME_ENTRY = 1 << 9,
+	};
+
+	TaskID taskID;
+	std::uint32_t changed = 0;
+
+	TaskID parentID;
+	std::string name;
+	TaskState state = TaskState::PENDING;
+	std::int32_t indexInParent = 0;
+	bool serverControlled = false;
+	bool locked = false;
+	std::optional<std::chrono::milliseconds> finishTime;
+
+	// the task now has sessionCount sessions. the ones from firstSession on replace what the client has
+	std::int32_t sessionCount = 0;
+	std::int32_t firstSession = 0;
+	std::vector<TaskTimes> sessions;
+
+	// the same types as the task, so copying them doesn't allocate
+	SmallVector<std::string, 2> labels;
+	SmallVector<TimeEntry, 2> timeEntry;
+
+	TaskInfoDeltaMessage(TaskID taskID) : Message(PacketType::TASK_INFO_DELTA), taskID(taskID) {}
+
+	bool has(Field field) const { return (changed & field) != 0; }
+
+	std::vector<std::byte> pack() const override;
+	static std::expected<TaskInfoDeltaMessage, UnpackError> unpack(std::span<const std::byte> data, const TimeCategories& time_categories);
+
+	std::ostream& print(std::ostream& out) const override
+	{
+		out << "TaskInfoDeltaMessage { taskID: " << taskID._val << ", changed: " << changed;
+
+		if (has(PARENT)) out << ", parentID: " << parentID._val;
+		if (has(NAME)) out << ", name: \"" << name << '"';
+		if (has(STATE)) out << ", state: " << static_cast<std::int32_t>(state);
+		if (has(INDEX_IN_PARENT)) out << ", indexInParent: " << indexInParent;
+		if (has(SERVER_CONTROLLED)) out << ", serverControlled: " << serverControlled;
+		if (has(LOCKED)) out << ", locked: " << locked;
+		if (has(FINISH_TIME)) out << ", finishTime: " << (finishTime.has_value() ? std::to_string(finishTime.value().count()) : "nullopt");
+
+		if (has(SESSIONS))
+		{
+			out << ", sessionCount: " << sessionCount << ", firstSession: " << firstSession << ", sessions: [ ";
+			for (auto&& session : sessions)
+			{
+				out << session << ", ";
+			}
+			out << "]";
+		}
+
+		if (has(LABELS))
+		{
+			out << ", labels: [ ";
+			for (auto&& label : labels)
+			{
+				out << label << ", ";
+			}
+			out << "]";
+		}
+
+		if (has(TIME_ENTRY))
+		{
+			out << ", time codes: [ ";
+			for (auto&& entry : timeEntry)
+			{
+				out << entry << ", ";
+			}
+			out << "]";
+		}
+		out << " }";
+		return out;
+	}
+
+	friend std::ostream& operator<<(std::ostream& out, const TaskInfoDeltaMessage& message)
+	{
+		return message.print(out);
+	}
+};
@@ -0,0 +1,67 @@
+#pragma once
+
+#include "message.hpp"
+#include "request_id.hpp"
+#include "task_id.hpp"
+#include "unpack_error.hpp"
+
+#include <cstdint>
+#include <expected>
+#include <ostream>
+#include <span>
+#include <vector>
+
+struct TaskPageEntry
+{
+	TaskID taskID;
+	// children that pass the filter of the request. lets the client show the task as expandable before requesting them
+	std::int32_t childCount = 0;
+
+	constexpr auto operator<=>(const TaskPageEntry&) const = default;
+
+	friend std::ostream& operator<<(std::ostream& out, const TaskPageEntry& entry)
+	{
+		out << "{ taskID: " << entry.taskID._val << ", childCount: " << entry.childCount << " }";
+		return out;
+	}
+};
+
+// response to REQUEST_TASKS. followed by a TASK_INFO message for each of the tasks, in the same order
+struct TaskPageMessage : Message
+{
+	RequestID requestID;
+	TaskID parentID;
+
+	std::int32_t offset = 0;
+	// every task that passed the filter, including the ones outside of this page
+	std::int32_t total = 0;
+
+	std::vector<TaskPageEntry> tasks;
+
+	TaskPageMessage(RequestID requestID, TaskID parentID) : Message(PacketType::TASK_PAGE), requestID(requestID), parentID(parentID)
+	{
+	}
+
+	std::vector<std::byte> pack() const override;
+	static std::expected<TaskPageMessage, UnpackError> unpack(std::span<const std::byte> data);
+
+	std::ostream& print(std::ostream& out) const override
+	{
+		out << "TaskPageMessage { ";
+		Message::print(out);
+		out << ", requestID: " << requestID._val << ", parentID: " << parentID._val << ", offset: " << offset << ", total: " << total << ", tasks: [ ";
+
+		for (auto&& entry : tasks)
+		{
+			out << entry << ", ";
+		}
+		out << "] }";
+		return out;
+	}
+
+	friend std::ostream& operator<<(std::ostream& out, const TaskPageMessage& message)
+	{
+		message.print(out);
+		return out;
+	}
+};
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "request.hpp"
+#include "schema.hpp"
 #include "task_id.hpp"
 #include "task_state.hpp"
 
@@ -13,6 +14,20 @@ struct TaskStateChange : RequestMessage
 	{
 	}
 
+	static constexpr auto schema()
+	{
+		return std::tuple{
+			field<&TaskStateChange::requestID>("requestID"),
+			field<&TaskStateChange::taskID>("taskID"),
+			field<&TaskStateChange::state>("state")
+		};
+	}
+
 	std::vector<std::byte> pack() const;
 	static std::expected<TaskStateChange, UnpackError> unpack(std::span<const std::byte> data);
+
+	std::ostream& print(std::ostream& out) const override
+	{
+		return print_schema(out, "TaskStateChange", *this);
+	}
 };
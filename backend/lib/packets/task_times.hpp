@@ -1,5 +1,6 @@
 #pragma once
 
+#include "small_vector.hpp"
 #include "time_entry.hpp"
 
 #include <chrono>
@@ -11,7 +12,8 @@ struct TaskTimes
 {
 	std::chrono::milliseconds start = std::chrono::milliseconds(0);
 	std::optional<std::chrono::milliseconds> stop;
-	std::vector<TimeEntry> timeEntry;
+	// one for each time category. they're only IDs, so the usual one or two are kept inline without allocating
+	SmallVector<TimeEntry, 2> timeEntry;
 
 	constexpr auto operator<=>(const TaskTimes&) const = default;
 
@@ -41,8 +43,5 @@ struct TaskTimes
 
 inline TaskTimes create_times_with_unknown_time_entry(std::chrono::milliseconds start, std::optional<std::chrono::milliseconds> stop)
 {
-	TimeCategory unknownCategory{ TimeCategoryID(0), "Unknown" };
-	TimeCode unknownCode{ TimeCodeID(0), "Unknown" };
-
-	return TaskTimes(start, stop, std::vector{ TimeEntry{ unknownCategory, unknownCode } });
+	return TaskTimes(start, stop, { TimeEntry{ TimeCategoryID(0), TimeCodeID(0) } });
 }
@@ -2,6 +2,7 @@
 
 #include "time_code.hpp"
 #include "time_category_id.hpp"
+#include "time_entry.hpp"
 
 #include <string>
 #include <ostream>
@@ -47,11 +48,10 @@ struct TimeCategories
 {
 	std::vector<TimeCategory> categories;
 
-	std::pair<TimeCategory, TimeCode> find(TimeCategoryID categoryID, TimeCodeID codeID) const
+	// the time entry for the IDs. a category that doesn't exist becomes the unknown category and a code that doesn't
+	// exist in its category becomes the unknown code
+	TimeEntry find(TimeCategoryID categoryID, TimeCodeID codeID) const
 	{
-		TimeCategory unknownCategory{ TimeCategoryID(0), "Unknown" };
-		TimeCode unknownCode{ TimeCodeID(0), "Unknown" };
-
 		for (auto&& category : categories)
 		{
 			if (category.id == categoryID)
@@ -60,14 +60,14 @@ struct TimeCategories
 				{
 					if (code.id == codeID)
 					{
-						return { category, code };
+						return { categoryID, codeID };
 					}
 				}
 
-				return { category, unknownCode };
+				return { categoryID, TimeCodeID(0) };
 			}
 		}
 
-		return { unknownCategory, unknownCode };
+		return { TimeCategoryID(0), TimeCodeID(0) };
 	}
 };
\ No newline at end of file
@@ -1,25 +1,30 @@
 #pragma once
 
-#include "time_category.hpp"
-#include "time_code.hpp"
+#include "time_category_id.hpp"
+#include "time_code_id.hpp"
 
+#include <compare>
 #include <ostream>
 
+// the time code picked for one time category. only the IDs are kept, the names are in the time categories
 struct TimeEntry
 {
-	TimeCategory category;
-	TimeCode code;
+	TimeCategoryID categoryID;
+	TimeCodeID codeID;
 
 	constexpr bool operator==(const TimeEntry&) const = default;
-	constexpr bool operator!=(const TimeEntry&) const = default;
-	constexpr bool operator<(const TimeEntry& other) const
+	constexpr std::strong_ordering operator<=>(const TimeEntry& other) const
 	{
-		return std::tie(category.id, code.id) < std::tie(other.category.id, other.code.id);
+		if (const auto result = categoryID._val <=> other.categoryID._val; result != 0)
+		{
+			return result;
+		}
+		return codeID._val <=> other.codeID._val;
 	}
 
 	friend std::ostream& operator<<(std::ostream& out, const TimeEntry& entry)
 	{
-		out << "TimeEntry { cat: " << entry.category.name << " (" << entry.category.id._val << "), code: " << entry.code.name << " (" << entry.code.id._val << ")";
+		out << "TimeEntry { cat: " << entry.categoryID._val << ", code: " << entry.codeID._val;
 		out << " }";
 
 		return out;
@@ -5,34 +5,55 @@
 #include "time_category.hpp"
 
 #include <ostream>
+#include <string>
+#include <string_view>
 #include <vector>
 
-struct TimeEntryModifyPacket : RequestMessage
+// String is std::string, or std::string_view for TimeEntryModifyView
+template<typename String>
+struct BasicTimeEntryModifyPacket : RequestMessage
 {
 	struct Category
 	{
 		TimeCategoryModType type;
 		TimeCategoryID id;
-		std::string name;
+		String name;
 	};
 	struct Code
 	{
 		TimeCategoryModType type;
 		std::int32_t categoryIndex;
 		TimeCodeID codeID;
-		std::string name;
+		String name;
 		bool archived;
 	};
 
 	std::vector<Category> categories;
 	std::vector<Code> codes;
 
-	TimeEntryModifyPacket(RequestID requestID) : RequestMessage(PacketType::TIME_ENTRY_MODIFY, requestID)
+	BasicTimeEntryModifyPacket(RequestID requestID) : RequestMessage(PacketType::TIME_ENTRY_MODIFY, requestID)
 	{
 	}
 
+	// a view of a TimeEntryModifyPacket, valid as long as the packet is
+	template<typename Owner>
+		requires std::same_as<String, std::string_view> && std::same_as<Owner, std::string>
+	explicit BasicTimeEntryModifyPacket(const BasicTimeEntryModifyPacket<Owner>& packet)
+		: RequestMessage(PacketType::TIME_ENTRY_MODIFY, packet.requestID)
+	{
+		for (auto&& category : packet.categories)
+		{
+			categories.emplace_back(category.type, category.id, category.name);
+		}
+
+		for (auto&& code : packet.codes)
+		{
+			codes.emplace_back(code.type, code.categoryIndex, code.codeID, code.name, code.archived);
+		}
+	}
+
 	std::vector<std::byte> pack() const override;
-	static std::expected<TimeEntryModifyPacket, UnpackError> unpack(std::span<const std::byte> data);
+	static std::expected<BasicTimeEntryModifyPacket, UnpackError> unpack(std::span<const std::byte> data);
 
 	std::ostream& print(std::ostream& out) const override
 	{
@@ -64,9 +85,14 @@ struct TimeEntryModifyPacket : RequestMessage
 		return out;
 	}
 
-	friend std::ostream& operator<<(std::ostream& out, const TimeEntryModifyPacket& message)
+	friend std::ostream& operator<<(std::ostream& out, const BasicTimeEntryModifyPacket& message)
 	{
 		message.print(out);
 		return out;
 	}
 };
+
+using TimeEntryModifyPacket = BasicTimeEntryModifyPacket<std::string>;
+
+// the names point into the bytes it was unpacked from
+using TimeEntryModifyView = BasicTimeEntryModifyPacket<std::string_view>;
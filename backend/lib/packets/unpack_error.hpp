@@ -1,6 +1,64 @@
 #pragma once
 
-enum class UnpackError
+#include <cstddef>
+#include <format>
+#include <string>
+#include <string_view>
+
+struct UnpackError
 {
-	NOT_ENOUGH_BYTES
+	enum Code
+	{
+		NOT_ENOUGH_BYTES,
+		// offsets into a column that go backwards or past its end
+		INVALID_OFFSETS,
+		// more than 10 bytes with the continuation bit set
+		VARINT_TOO_LONG,
+		// a packet type the receiver doesn't handle
+		UNKNOWN_PACKET_TYPE
+	};
+
+	Code code = NOT_ENOUGH_BYTES;
+
+	// bytes from the start of the packet type to the value that couldn't be read
+	std::size_t offset = 0;
+
+	// the field being read. always a string literal, empty when the caller didn't name it
+	std::string_view field;
+
+	UnpackError(Code code, std::size_t offset = 0, std::string_view field = {}) : code(code), offset(offset), field(field)
+	{
+	}
+
+	friend bool operator==(const UnpackError& error, Code code)
+	{
+		return error.code == code;
+	}
+
+	std::string message() const
+	{
+		std::string_view reason;
+
+		switch (code)
+		{
+		case NOT_ENOUGH_BYTES:
+			reason = "not enough bytes";
+			break;
+		case INVALID_OFFSETS:
+			reason = "invalid offsets";
+			break;
+		case VARINT_TOO_LONG:
+			reason = "varint too long";
+			break;
+		case UNKNOWN_PACKET_TYPE:
+			reason = "unknown packet type";
+			break;
+		}
+
+		if (field.empty())
+		{
+			return std::format("Failed to unpack packet at offset {}: {}.", offset, reason);
+		}
+		return std::format("Failed to unpack '{}' at offset {}: {}.", field, offset, reason);
+	}
 };
@@ -3,15 +3,20 @@
 #include "request.hpp"
 #include "task_id.hpp"
 #include "task_times.hpp"
+#include "time_category.hpp"
 #include "time_entry.hpp"
 #include "task_state.hpp"
 
 #include <expected>
 #include <format>
 #include <ostream>
+#include <string>
+#include <string_view>
 #include <vector>
 
-struct UpdateTaskMessage : RequestMessage
+// String is std::string, or std::string_view for UpdateTaskView
+template<typename String>
+struct BasicUpdateTaskMessage : RequestMessage
 {
 	TaskID taskID;
 	TaskID parentID;
@@ -19,19 +24,28 @@ struct UpdateTaskMessage : RequestMessage
 	std::int32_t indexInParent = 0;
 	bool serverControlled = false;
 	bool locked = false;
-	std::string name;
-	std::vector<std::string> labels;
+	String name;
+	std::vector<String> labels;
 	std::vector<TimeEntry> timeEntry;
 
-	UpdateTaskMessage(RequestID requestID, TaskID taskID, TaskID parentID, std::string name) : RequestMessage(PacketType::UPDATE_TASK, requestID), taskID(taskID), parentID(parentID), name(std::move(name)) {}
+	BasicUpdateTaskMessage(RequestID requestID, TaskID taskID, TaskID parentID, String name) : RequestMessage(PacketType::UPDATE_TASK, requestID), taskID(taskID), parentID(parentID), name(std::move(name)) {}
 
-	bool operator==(const UpdateTaskMessage& message) const
+	// a view of an UpdateTaskMessage, valid as long as the message is
+	template<typename Owner>
+		requires std::same_as<String, std::string_view> && std::same_as<Owner, std::string>
+	explicit BasicUpdateTaskMessage(const BasicUpdateTaskMessage<Owner>& message)
+		: RequestMessage(PacketType::UPDATE_TASK, message.requestID), taskID(message.taskID), parentID(message.parentID), state(message.state), indexInParent(message.indexInParent),
+		  serverControlled(message.serverControlled), locked(message.locked), name(message.name), labels(message.labels.begin(), message.labels.end()), timeEntry(message.timeEntry)
+	{
+	}
+
+	bool operator==(const BasicUpdateTaskMessage& message) const
 	{
 		return requestID == message.requestID && taskID == message.taskID && parentID == message.parentID && state == message.state && indexInParent == message.indexInParent && name == message.name && labels == message.labels && timeEntry == message.timeEntry;
 	}
 
 	std::vector<std::byte> pack() const override;
-	static std::expected<UpdateTaskMessage, UnpackError> unpack(std::span<const std::byte> data, const TimeCategories& time_categories);
+	static std::expected<BasicUpdateTaskMessage, UnpackError> unpack(std::span<const std::byte> data, const TimeCategories& time_categories);
 
 	std::ostream& print(std::ostream& out) const override
 	{
@@ -47,14 +61,19 @@ struct UpdateTaskMessage : RequestMessage
 		out << ", timeCodes: [ ";
 		for (auto&& time : timeEntry)
 		{
-			out << std::format("[ {} ({}) {} ({}) ]", time.category.name, time.category.id, time.code.name, time.code.id) << ", ";
+			out << std::format("[ {} {} ]", time.categoryID._val, time.codeID._val) << ", ";
 		}
 		out << "] }";
 		return out;
 	}
 
-	friend std::ostream& operator<<(std::ostream& out, const UpdateTaskMessage& message)
+	friend std::ostream& operator<<(std::ostream& out, const BasicUpdateTaskMessage& message)
 	{
 		return message.print(out);
 	}
 };
+
+using UpdateTaskMessage = BasicUpdateTaskMessage<std::string>;
+
+// the strings point into the bytes it was unpacked from
+using UpdateTaskView = BasicUpdateTaskMessage<std::string_view>;
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "message.hpp"
+#include "schema.hpp"
 #include "unpack_error.hpp"
 
 #include <string>
@@ -12,14 +13,19 @@ struct VersionMessage : Message
 	std::string version;
 	VersionMessage(std::string version) : Message(PacketType::VERSION), version(version) {}
 
+	static constexpr auto schema()
+	{
+		return std::tuple{
+			field<&VersionMessage::version>("version")
+		};
+	}
+
 	std::vector<std::byte> pack() const override;
 	static std::expected<VersionMessage, UnpackError> unpack(std::span<const std::byte> data);
 
 	std::ostream& print(std::ostream& out) const override
 	{
-		out << "VersionMessage { " << version << " } ";
-
-		return out;
+		return print_schema(out, "VersionMessage", *this);
 	}
 
 	friend std::ostream& operator<<(std::ostream& out, const VersionMessage& message)
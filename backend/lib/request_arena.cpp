@@ -0,0 +1,41 @@
+#include "request_arena.hpp"
+
+#include <algorithm>
+#include <utility>
+
+RequestArena::RequestArena(std::size_t size)
+	: m_buffer(std::make_unique_for_overwrite<std::byte[]>(size)),
+	m_size(size)
+{
+	m_resource.emplace(m_buffer.get(), m_size, &m_overflow);
+}
+
+void RequestArena::release()
+{
+	m_resource->release();
+
+	const std::size_t overflow = std::exchange(m_overflow.bytes, 0);
+
+	if (overflow > 0 && m_size < MAX_SIZE)
+	{
+		// the resource keeps a pointer to the buffer, it has to go first
+		m_resource.reset();
+
+		m_size = std::min(m_size + overflow, MAX_SIZE);
+		m_buffer = std::make_unique_for_overwrite<std::byte[]>(m_size);
+
+		m_resource.emplace(m_buffer.get(), m_size, &m_overflow);
+	}
+}
+
+void* RequestArena::Overflow::do_allocate(std::size_t size, std::size_t alignment)
+{
+	bytes += size;
+
+	return std::pmr::new_delete_resource()->allocate(size, alignment);
+}
+
+void RequestArena::Overflow::do_deallocate(void* pointer, std::size_t size, std::size_t alignment)
+{
+	std::pmr::new_delete_resource()->deallocate(pointer, size, alignment);
+}
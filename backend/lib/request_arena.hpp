@@ -0,0 +1,74 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <memory_resource>
+#include <optional>
+
+// scratch memory for the request being handled. the vectors and sets that only live until the request has been
+// answered allocate from it with std::pmr instead of the heap, and all of it is released at once when the request is done
+//
+// a request that needs more than the buffer gets the rest from the heap, and the buffer grows to fit it for next time, up
+// to MAX_SIZE
+class RequestArena
+{
+public:
+	static constexpr std::size_t DEFAULT_SIZE = 64 * 1024;
+	static constexpr std::size_t MAX_SIZE = 4 * 1024 * 1024;
+
+	explicit RequestArena(std::size_t size = DEFAULT_SIZE);
+
+	RequestArena(const RequestArena&) = delete;
+	RequestArena& operator=(const RequestArena&) = delete;
+
+	std::pmr::memory_resource* resource() { return &*m_resource; }
+
+	// bytes that can be allocated before going to the heap
+	std::size_t capacity() const { return m_size; }
+
+	// everything allocated while a scope is alive is released when the outermost one ends. allocations made outside of
+	// a scope are kept until the end of the next one
+	class Scope
+	{
+	public:
+		explicit Scope(RequestArena& arena) : m_arena(arena)
+		{
+			m_arena.m_depth++;
+		}
+
+		~Scope()
+		{
+			if (--m_arena.m_depth == 0)
+			{
+				m_arena.release();
+			}
+		}
+
+		Scope(const Scope&) = delete;
+		Scope& operator=(const Scope&) = delete;
+
+	private:
+		RequestArena& m_arena;
+	};
+
+private:
+	// the heap, counting what was taken from it since the last release
+	class Overflow : public std::pmr::memory_resource
+	{
+	public:
+		std::size_t bytes = 0;
+
+	private:
+		void* do_allocate(std::size_t size, std::size_t alignment) override;
+		void do_deallocate(void* pointer, std::size_t size, std::size_t alignment) override;
+		bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override { return this == &other; }
+	};
+
+	void release();
+
+	Overflow m_overflow;
+	std::unique_ptr<std::byte[]> m_buffer;
+	std::size_t m_size = 0;
+	std::optional<std::pmr::monotonic_buffer_resource> m_resource;
+	int m_depth = 0;
+};
@@ -5,10 +5,26 @@
 #include <format>
 #include <iostream>
 
-Task::Task(std::string name, TaskID id, TaskID parentID, std::chrono::milliseconds createTime) : m_name(std::move(name)), m_taskID(id), m_parentID(parentID), m_createTime(createTime) {}
+Task::Task(std::string name, TaskID id, TaskID parentID, std::chrono::milliseconds createTime) : m_name(name), m_taskID(id), m_parentID(parentID), m_createTime(createTime) {}
 
-std::expected<TaskID, std::string> MicroTask::create_task(const std::string& name, TaskID parentID, bool serverControlled)
+Task Task::without_sessions() const
 {
+	Task task(m_name, m_taskID, m_parentID, m_createTime);
+	task.serverControlled = serverControlled;
+	task.locked = locked;
+	task.indexInParent = indexInParent;
+	task.timeEntry = timeEntry;
+	task.sessionsLoaded = sessionsLoaded;
+	task.m_finishTime = m_finishTime;
+	task.labels = labels;
+	task.state = state;
+	return task;
+}
+
+std::expected<TaskID, std::string> MicroTask::create_task(std::string_view name, TaskID parentID, bool serverControlled)
+{
+	TG_TRACE_SPAN("create_task", "task");
+
 	auto* parent_task = find_task(parentID);
 
 	if (parentID._val != 0 && !parent_task)
@@ -22,15 +38,16 @@ std::expected<TaskID, std::string> MicroTask::create_task(const std::string& nam
 
 	auto id = m_nextTaskID;
 
-	Task task = Task(name, id, parentID, m_clock->now());
-	task.serverControlled = serverControlled;
-	task.indexInParent = find_tasks_with_parent(parentID).size();
+	const auto indexInParent = children(parentID).size();
 
-	m_tasks.emplace(id, task);
+	// the only copy of the name
+	Task& task = m_tasks.insert(Task(std::string(name), id, parentID, m_clock->now()));
+	task.serverControlled = serverControlled;
+	task.indexInParent = indexInParent;
 	
 	m_nextTaskID._val++;
 
-	m_database->write_task(task, *m_sender);
+	m_database->write_event(TaskEvent{ TaskEventType::CREATED }, task, *m_sender);
 	m_database->write_next_task_id(m_nextTaskID, *m_sender);
 
 	return std::expected<TaskID, std::string>(id);
@@ -42,9 +59,9 @@ std::optional<std::string> MicroTask::configure_task_time_entry(TaskID taskID, s
 
 	if (task)
 	{
-		task->timeEntry = std::vector<TimeEntry>(timeEntry.begin(), timeEntry.end());
+		task->timeEntry.assign(timeEntry.begin(), timeEntry.end());
 
-		m_database->write_task(*task, *m_sender);
+		m_database->write_event(TaskEvent{ TaskEventType::TIME_ENTRY_CHANGED }, *task, *m_sender);
 	}
 
 	return std::nullopt;
@@ -53,26 +70,21 @@ std::optional<std::string> MicroTask::configure_task_time_entry(TaskID taskID, s
 Task* MicroTask::find_task(TaskID taskID)
 {
 	// only allow the unspecified task to be found while it is active
-	if (m_activeTask == &m_unspecifiedTask && taskID == UNSPECIFIED_TASK)
+	if (m_unspecifiedTaskActive && taskID == UNSPECIFIED_TASK)
 	{
 		return &m_unspecifiedTask;
 	}
 
-	auto result = m_tasks.find(taskID);
-
-	return result != m_tasks.end() ? &result->second : nullptr;
+	return m_tasks.find(taskID);
 }
 
-std::vector<Task*> MicroTask::find_tasks_with_parent(TaskID parentID)
+std::pmr::vector<Task*> MicroTask::find_tasks_with_parent(TaskID parentID)
 {
-	std::vector<Task*> tasks;
+	std::pmr::vector<Task*> tasks(m_scratch.resource());
 
-	for (auto&& [taskID, task] : m_tasks)
+	for (TaskID child : children(parentID))
 	{
-		if (task.parentID() == parentID)
-		{
-			tasks.push_back(&task);
-		}
+		tasks.push_back(m_tasks.find(child));
 	}
 
 	return tasks;
@@ -80,9 +92,19 @@ std::vector<Task*> MicroTask::find_tasks_with_parent(TaskID parentID)
 
 Task* MicroTask::find_task_with_parent_and_name(const std::string& name, TaskID parentID)
 {
-	for (auto&& [taskID, task] : m_tasks)
+	// a name that was never interned isn't the name of any task
+	const auto interned = InternedString::find(name);
+
+	if (!interned)
+	{
+		return nullptr;
+	}
+
+	for (TaskID child : children(parentID))
 	{
-		if (task.parentID() == parentID && task.m_name == name)
+		Task& task = *m_tasks.find(child);
+
+		if (task.m_name == interned.value())
 		{
 			return &task;
 		}
@@ -92,49 +114,71 @@ Task* MicroTask::find_task_with_parent_and_name(const std::string& name, TaskID
 
 void MicroTask::find_bugzilla_helper_tasks(TaskID bugzillaParentTaskID, const std::vector<TaskID>& bugTasks, std::map<TaskID, TaskState>& helperTasks)
 {
-	for (auto&& [taskID, task] : m_tasks)
+	for (TaskID child : children(bugzillaParentTaskID))
 	{
-		if (task.parentID() == bugzillaParentTaskID && std::find(bugTasks.begin(), bugTasks.end(), task.taskID()) == bugTasks.end())
+		if (std::find(bugTasks.begin(), bugTasks.end(), child) == bugTasks.end())
 		{
-			helperTasks[task.taskID()] = task.state;
+			helperTasks[child] = m_tasks.find(child)->state;
 
-			find_bugzilla_helper_tasks(task.taskID(), bugTasks, helperTasks);
+			find_bugzilla_helper_tasks(child, bugTasks, helperTasks);
 		}
 	}
 }
 
 bool MicroTask::task_has_children(TaskID id) const
 {
-	for (auto&& [taskID, task] : m_tasks)
+	return !children(id).empty();
+}
+
+void MicroTask::broadcast_task_info(const Task& task, bool newTask)
+{
+	TG_TRACE_SPAN("broadcast_task_info", "task");
+
+	auto change = m_deltas.update(task, sessions(task));
+
+	if (!change.delta || newTask)
+	{
+		m_sender->broadcast_task(task_info(task, newTask), change.version, task_path(task));
+		return;
+	}
+
+	m_sender->broadcast_delta(std::move(change.delta), change.base, change.version, [&] { return task_info(task, false); }, task_path(task));
+}
+
+std::pmr::vector<TaskID> MicroTask::task_path(const Task& task)
+{
+	std::pmr::vector<TaskID> path({ task.taskID() }, m_scratch.resource());
+
+	for (TaskID parent = task.parentID(); parent != NO_PARENT; )
 	{
-		if (task.parentID() == id)
+		path.push_back(parent);
+
+		const Task* next = m_tasks.find(parent);
+
+		if (!next)
 		{
-			return true;
+			break;
 		}
+		parent = next->parentID();
 	}
-	return false;
+	return path;
 }
 
 bool MicroTask::task_has_active_bug_tasks(TaskID id, const std::vector<TaskID>& bugTasks) const
 {
-	for (auto&& [taskID, task] : m_tasks)
+	for (TaskID child : children(id))
 	{
-		const bool isBug = std::find(bugTasks.begin(), bugTasks.end(), taskID) != bugTasks.end();
+		const bool isBug = std::find(bugTasks.begin(), bugTasks.end(), child) != bugTasks.end();
 		
 		// return true if:
-		//  - parent matches and this is a bug
+		//  - this is a bug
 		//  - or, task_has_bug_tasks is true for any children
-		if (task.parentID() == id && isBug && task.state != TaskState::FINISHED)
+		if (isBug && m_tasks.record(child)->state != TaskState::FINISHED)
 		{
 			return true;
 		}
 
-		if (task.parentID() != id)
-		{
-			continue;
-		}
-
-		if (task_has_active_bug_tasks(taskID, bugTasks))
+		if (task_has_active_bug_tasks(child, bugTasks))
 		{
 			return true;
 		}
@@ -142,32 +186,48 @@ bool MicroTask::task_has_active_bug_tasks(TaskID id, const std::vector<TaskID>&
 	return false;
 }
 
-std::vector<MicroTask::FindTasksOnDay> MicroTask::find_tasks_on_day(int month, int year, int day)
+std::pmr::vector<MicroTask::FindTasksOnDay> MicroTask::find_tasks_on_day(int month, int year, int day)
 {
-	std::vector<FindTasksOnDay> tasks;
+	TG_TRACE_SPAN("find_tasks_on_day", "task");
+
+	std::pmr::vector<FindTasksOnDay> tasks(m_scratch.resource());
 
 	auto range = range_for_date(month, year, day);
 
-	for (auto&& task : m_tasks)
+	load_sessions_between(range.start, range.end);
+
+	const SessionColumns& columns = session_columns();
+
+	std::pmr::vector<std::uint32_t> rows(m_scratch.resource());
+
+	columns.find_starting_or_stopping(range.start, range.end, rows);
+
+	tasks.reserve(rows.size());
+
+	for (std::uint32_t row : rows)
 	{
-		int index = 0;
-		for (auto&& times : task.second.m_times)
-		{
-			if (times.start >= range.start && times.start < range.end)
-			{
-				tasks.emplace_back(&task.second, DailyReport::TimePair{ task.first, index });
-			}
-			else if (times.stop >= range.start && times.stop < range.end)
-			{
-				tasks.emplace_back(&task.second, DailyReport::TimePair{ task.first, index });
-			}
-			index++;
-		}
+		tasks.emplace_back(m_tasks.find(columns.task(row)), DailyReport::TimePair{ columns.task(row), columns.session(row) });
 	}
 
 	return tasks;
 }
 
+const Task* MicroTask::find_overlapping_session(std::chrono::milliseconds start, std::chrono::milliseconds stop, const Task* ignore)
+{
+	const SessionColumns& columns = session_columns();
+
+	for (std::size_t row = columns.find_overlap(start, stop); row < columns.size(); row = columns.find_overlap(start, stop, row + 1))
+	{
+		const Task* task = m_tasks.find(columns.task(row));
+
+		if (task != ignore)
+		{
+			return task;
+		}
+	}
+	return nullptr;
+}
+
 std::optional<std::string> MicroTask::start_task(TaskID id)
 {
 	return start_task(id, m_clock->now());
@@ -175,6 +235,8 @@ std::optional<std::string> MicroTask::start_task(TaskID id)
 
 std::optional<std::string> MicroTask::start_task(TaskID id, std::chrono::milliseconds startTime)
 {
+	TG_TRACE_SPAN("start_task", "task");
+
 	auto* task = find_task(id);
 
 	if (id == UNSPECIFIED_TASK)
@@ -200,22 +262,31 @@ std::optional<std::string> MicroTask::start_task(TaskID id, std::chrono::millise
 			return std::format("Task with ID {} is finished.", id);
 		}
 
-		if (m_activeTask)
+		if (Task* active = active_task())
 		{
-			m_activeTask->state = TaskState::PENDING;
-			m_activeTask->m_times.back().stop = startTime;
+			active->state = TaskState::PENDING;
+			active->m_times.back().stop = startTime;
+
+			task_changed(*active);
+			session_changed(*active, active->m_times.size() - 1);
 
-			m_database->write_task(*m_activeTask, *m_sender);
+			m_database->write_event(TaskEvent{ TaskEventType::SESSION_STOPPED, static_cast<std::int32_t>(active->m_times.size() - 1) }, *active, *m_sender);
 		}
 
+		load_sessions(*task);
+
 		task->state = TaskState::ACTIVE;
 		TaskTimes& times = task->m_times.emplace_back(startTime);
 
 		fill_session_time_entry(*task, times);
 
-		m_activeTask = task;
+		task_changed(*task);
+
+		set_active_task(task);
+
+		session_started(*task);
 
-		m_database->write_task(*task, *m_sender);
+		m_database->write_event(TaskEvent{ TaskEventType::SESSION_STARTED, static_cast<std::int32_t>(task->m_times.size() - 1) }, *task, *m_sender);
 
 		return std::nullopt;
 	}
@@ -224,6 +295,8 @@ std::optional<std::string> MicroTask::start_task(TaskID id, std::chrono::millise
 
 std::optional<std::string> MicroTask::stop_task(TaskID id)
 {
+	TG_TRACE_SPAN("stop_task", "task");
+
 	auto* task = find_task(id);
 
 	if (id == UNSPECIFIED_TASK)
@@ -233,13 +306,17 @@ std::optional<std::string> MicroTask::stop_task(TaskID id)
 
 	if (task && task->state == TaskState::ACTIVE)
 	{
-		m_activeTask = nullptr;
+		set_active_task(nullptr);
 
 		task->state = TaskState::PENDING;
 
 		task->m_times.back().stop = m_clock->now();
 
-		m_database->write_task(*task, *m_sender);
+		task_changed(*task);
+
+		session_changed(*task, task->m_times.size() - 1);
+
+		m_database->write_event(TaskEvent{ TaskEventType::SESSION_STOPPED, static_cast<std::int32_t>(task->m_times.size() - 1) }, *task, *m_sender);
 
 		return std::nullopt;
 	}
@@ -252,24 +329,34 @@ std::optional<std::string> MicroTask::stop_task(TaskID id)
 
 std::optional<std::string> MicroTask::finish_task(TaskID id)
 {
+	TG_TRACE_SPAN("finish_task", "task");
+
 	auto* task = find_task(id);
 
 	if (task && task->state != TaskState::FINISHED)
 	{
 		auto finish_time = m_clock->now();
 
-		if (task == m_activeTask)
+		TaskEvent event{ TaskEventType::FINISHED };
+
+		if (task == active_task())
 		{
 			task->m_times.back().stop = finish_time;
 
-			m_activeTask = nullptr;
+			session_changed(*task, task->m_times.size() - 1);
+
+			set_active_task(nullptr);
+
+			event.session = static_cast<std::int32_t>(task->m_times.size() - 1);
 		}
 
 		task->m_finishTime = finish_time;
 
 		task->state = TaskState::FINISHED;
 
-		m_database->write_task(*task, *m_sender);
+		task_changed(*task);
+
+		m_database->write_event(event, *task, *m_sender);
 
 		return std::nullopt;
 	}
@@ -282,6 +369,8 @@ std::optional<std::string> MicroTask::finish_task(TaskID id)
 
 std::optional<std::string> MicroTask::reparent_task(TaskID id, TaskID new_parent_id)
 {
+	TG_TRACE_SPAN("reparent_task", "task");
+
 	if (id == new_parent_id)
 	{
 		return std::format("Cannot reparent Task with ID {} to itself", id);
@@ -309,9 +398,11 @@ std::optional<std::string> MicroTask::reparent_task(TaskID id, TaskID new_parent
 
 	if (task && (parent_task || new_parent_id == NO_PARENT))
 	{
+		m_tasks.set_parent(id, new_parent_id);
+
 		task->m_parentID = new_parent_id;
 
-		m_database->write_task(*task, *m_sender);
+		m_database->write_event(TaskEvent{ TaskEventType::REPARENTED }, *task, *m_sender);
 
 		return std::nullopt;
 	}
@@ -324,13 +415,15 @@ std::optional<std::string> MicroTask::reparent_task(TaskID id, TaskID new_parent
 
 std::optional<std::string> MicroTask::rename_task(TaskID id, std::string_view name)
 {
+	TG_TRACE_SPAN("rename_task", "task");
+
 	auto* task = find_task(id);
 
 	if (task)
 	{
 		task->m_name = name;
 
-		m_database->write_task(*task, *m_sender);
+		m_database->write_event(TaskEvent{ TaskEventType::RENAMED }, *task, *m_sender);
 
 		return std::nullopt;
 	}
@@ -341,14 +434,14 @@ void MicroTask::fill_session_time_entry(const Task& task, TaskTimes& times)
 {
 	if (m_timeCategories.categories.empty())
 	{
-		times.timeEntry.push_back(TimeEntry{ TimeCategory(TimeCategoryID(0), "Unknown"), TimeCode(TimeCodeID(0), "Unknown") });
+		times.timeEntry.push_back(TimeEntry{ TimeCategoryID(0), TimeCodeID(0) });
 	}
 
 	for (const TimeCategory& category : m_timeCategories.categories)
 	{
-		const auto findCategory = [category](const Task* task)
+		const auto findCategory = [&category](const Task* task)
 			{
-				auto result = std::find_if(task->timeEntry.begin(), task->timeEntry.end(), [&](const TimeEntry& entry) { return entry.category.id == category.id; });
+				auto result = std::find_if(task->timeEntry.begin(), task->timeEntry.end(), [&](const TimeEntry& entry) { return entry.categoryID == category.id; });
 
 				return result;
 			};
@@ -383,13 +476,13 @@ void MicroTask::fill_session_time_entry(const Task& task, TaskTimes& times)
 				else
 				{
 					// if we didn't find a parent with the category, use unknown
-					times.timeEntry.emplace_back(category, TimeCode(TimeCodeID(0), "Unknown"));
+					times.timeEntry.push_back(TimeEntry{ category.id, TimeCodeID(0) });
 				}
 			}
 			else
 			{
 				// if we didn't find a parent with the category, use unknown
-				times.timeEntry.emplace_back(category, TimeCode(TimeCodeID(0), "Unknown"));
+				times.timeEntry.push_back(TimeEntry{ category.id, TimeCodeID(0) });
 			}
 		}
 	}
@@ -414,21 +507,345 @@ void MicroTask::load_task(const Task& task)
 
 		if (task.state == TaskState::ACTIVE)
 		{
-			m_activeTask = &m_unspecifiedTask;
+			set_active_task(&m_unspecifiedTask);
+		}
+		else if (m_unspecifiedTaskActive)
+		{
+			set_active_task(nullptr);
 		}
 
 		return;
 	}
 
-	m_tasks.emplace(task.taskID(), task);
+	// tasks can be loaded more than once when the event journal is replayed, the last load wins
+	Task& loaded = m_tasks.insert(task);
+
+	task_sessions_changed(loaded);
+
+	// sessions that come with the task might not be in the database yet and can't be dropped from memory
+	if (auto cached = m_cachedSessionLookup.find(task.taskID()); cached != m_cachedSessionLookup.end())
+	{
+		m_cachedSessions.erase(cached->second);
+		m_cachedSessionLookup.erase(cached);
+	}
 
 	if (task.state == TaskState::ACTIVE)
 	{
-		m_activeTask = find_task(task.taskID());
+		set_active_task(&loaded);
+	}
+	else if (active_task() == &loaded)
+	{
+		set_active_task(nullptr);
 	}
 }
 
+void MicroTask::set_active_task(Task* task)
+{
+	m_unspecifiedTaskActive = task == &m_unspecifiedTask;
+	m_activeTask = task && !m_unspecifiedTaskActive ? m_tasks.handle(task->taskID()) : TaskHandle{};
+}
+
 void MicroTask::load_time_entry(const std::vector<TimeCategory>& timeCategories)
 {
 	m_timeCategories.categories = timeCategories;
 }
+
+std::optional<std::chrono::milliseconds> MicroTask::session_cutoff() const
+{
+	if (m_sessionHistory.horizon.count() == 0)
+	{
+		return std::nullopt;
+	}
+	return m_clock->now() - m_sessionHistory.horizon;
+}
+
+bool MicroTask::sessions_are_cold(const Task& task, std::chrono::milliseconds cutoff)
+{
+	return task.state == TaskState::FINISHED && task.m_finishTime && task.m_finishTime.value() < cutoff;
+}
+
+void MicroTask::load_sessions(Task& task)
+{
+	if (task.sessionsLoaded)
+	{
+		if (auto cached = m_cachedSessionLookup.find(task.taskID()); cached != m_cachedSessionLookup.end())
+		{
+			m_cachedSessions.splice(m_cachedSessions.begin(), m_cachedSessions, cached->second);
+		}
+		return;
+	}
+
+	TG_TRACE_SPAN("load_sessions", "task");
+
+	task.m_times = m_database->load_sessions(task.taskID(), m_timeCategories);
+	task.sessionsLoaded = true;
+
+	task_sessions_changed(task);
+
+	m_cachedSessions.push_front(task.taskID());
+	m_cachedSessionLookup[task.taskID()] = m_cachedSessions.begin();
+}
+
+const std::vector<TaskTimes>& MicroTask::sessions(const Task& task)
+{
+	if (!task.sessionsLoaded)
+	{
+		load_sessions(*m_tasks.find(task.taskID()));
+	}
+	return task.m_times;
+}
+
+void MicroTask::keep_sessions(Task& task)
+{
+	load_sessions(task);
+
+	if (auto cached = m_cachedSessionLookup.find(task.taskID()); cached != m_cachedSessionLookup.end())
+	{
+		m_cachedSessions.erase(cached->second);
+		m_cachedSessionLookup.erase(cached);
+
+		m_keptSessions.push_back(task.taskID());
+	}
+}
+
+void MicroTask::release_kept_sessions()
+{
+	for (TaskID id : m_keptSessions)
+	{
+		// archived while it was kept
+		const Task* task = find_task(id);
+
+		if (!task || !task->sessionsLoaded || m_cachedSessionLookup.contains(id))
+		{
+			continue;
+		}
+
+		m_cachedSessions.push_front(id);
+		m_cachedSessionLookup[id] = m_cachedSessions.begin();
+	}
+	m_keptSessions.clear();
+}
+
+void MicroTask::load_sessions_between(std::chrono::milliseconds start, std::chrono::milliseconds end)
+{
+	// without a horizon every session is already in memory
+	if (m_sessionHistory.horizon.count() == 0)
+	{
+		return;
+	}
+
+	for (TaskID id : m_database->find_tasks_with_sessions(start, end))
+	{
+		if (auto* task = find_task(id); task && !task->sessionsLoaded)
+		{
+			load_sessions(*task);
+		}
+	}
+}
+
+void MicroTask::evict_sessions()
+{
+	if (m_cachedSessions.size() <= m_sessionHistory.cacheSize)
+	{
+		return;
+	}
+
+	const auto cutoff = session_cutoff();
+
+	// tasks with writes that haven't been committed, they're the first to go once they have been
+	std::vector<TaskID> uncommitted;
+
+	while (m_cachedSessions.size() > m_sessionHistory.cacheSize)
+	{
+		const TaskID id = m_cachedSessions.back();
+
+		m_cachedSessions.pop_back();
+		m_cachedSessionLookup.erase(id);
+
+		// a task that has been reopened since its sessions were loaded keeps them
+		auto* task = find_task(id);
+
+		if (task && cutoff && sessions_are_cold(*task, cutoff.value()))
+		{
+			m_database->evicting_sessions(*task, *m_sender);
+
+			// loading them again would read the sessions from before the writes
+			if (m_database->has_uncommitted_writes(id))
+			{
+				uncommitted.push_back(id);
+				continue;
+			}
+
+			task->m_times.clear();
+			task->m_times.shrink_to_fit();
+			task->sessionsLoaded = false;
+
+			task_sessions_changed(*task);
+		}
+	}
+
+	for (TaskID id : uncommitted)
+	{
+		m_cachedSessions.push_back(id);
+		m_cachedSessionLookup[id] = std::prev(m_cachedSessions.end());
+	}
+}
+
+const SessionColumns& MicroTask::session_columns()
+{
+	if (m_sessionColumnsStale)
+	{
+		TG_TRACE_SPAN("build_session_columns", "task");
+
+		m_sessionColumns.clear();
+
+		m_tasks.for_each_sorted([&](const Task& task)
+		{
+			for (std::size_t session = 0; session < task.m_times.size(); session++)
+			{
+				m_sessionColumns.add(task.taskID(), static_cast<std::int32_t>(session), task.m_times[session]);
+			}
+		});
+
+		m_sessionColumnsStale = false;
+	}
+	return m_sessionColumns;
+}
+
+void MicroTask::session_started(const Task& task)
+{
+	// the unspecified task isn't in the store and has no rows
+	if (m_sessionColumnsStale || &task == &m_unspecifiedTask)
+	{
+		return;
+	}
+
+	const std::size_t session = task.m_times.size() - 1;
+
+	m_sessionColumns.append(task.taskID(), static_cast<std::int32_t>(session), task.m_times[session]);
+}
+
+void MicroTask::session_changed(const Task& task, std::size_t session)
+{
+	if (m_sessionColumnsStale || &task == &m_unspecifiedTask)
+	{
+		return;
+	}
+
+	if (!m_sessionColumns.update(task.taskID(), static_cast<std::int32_t>(session), task.m_times[session]))
+	{
+		m_sessionColumns.replace(task.taskID(), task.m_times);
+	}
+}
+
+void MicroTask::task_sessions_changed(const Task& task)
+{
+	if (m_sessionColumnsStale || &task == &m_unspecifiedTask)
+	{
+		return;
+	}
+
+	m_sessionColumns.replace(task.taskID(), task.m_times);
+}
+
+std::size_t MicroTask::archive_tasks(std::chrono::milliseconds cutoff)
+{
+	TG_TRACE_SPAN("archive_tasks", "task");
+
+	// archived tasks are read back from the database, it wouldn't see them until the transaction is finished
+	if (m_database->transaction_in_progress())
+	{
+		return 0;
+	}
+
+	// a task can only be archived along with everything below it
+	std::unordered_map<TaskID, bool> archivable;
+
+	// only the records are read until the tasks to archive are known
+	const auto check = [&](auto& self, TaskID id) -> bool
+	{
+		const TaskStore::Record& record = *m_tasks.record(id);
+
+		bool result = record.state == TaskState::FINISHED && record.finishTime < cutoff.count();
+
+		for (TaskID child : children(id))
+		{
+			result = self(self, child) && result;
+		}
+
+		archivable[id] = result;
+		return result;
+	};
+
+	std::vector<TaskID> roots;
+
+	for (const TaskStore::Record& record : m_tasks.records())
+	{
+		if (record.id != NO_PARENT && !m_tasks.contains(record.parentID))
+		{
+			roots.push_back(record.id);
+		}
+	}
+
+	for (TaskID root : roots)
+	{
+		check(check, root);
+	}
+
+	// the highest task of each archivable subtree, then everything below it
+	std::vector<TaskID> archive;
+
+	for (const TaskStore::Record& record : m_tasks.records())
+	{
+		if (record.id != NO_PARENT && archivable[record.id] && (!m_tasks.contains(record.parentID) || !archivable[record.parentID]))
+		{
+			archive.push_back(record.id);
+		}
+	}
+
+	if (archive.empty())
+	{
+		return 0;
+	}
+
+	std::sort(archive.begin(), archive.end());
+
+	for (TaskID root : archive)
+	{
+		m_sender->broadcast(std::make_unique<TaskMessage>(PacketType::TASKS_ARCHIVED, RequestID(0), root), task_path(*m_tasks.find(root)));
+	}
+
+	for (std::size_t i = 0; i < archive.size(); i++)
+	{
+		const auto below = children(archive[i]);
+
+		archive.insert(archive.end(), below.begin(), below.end());
+	}
+
+	std::vector<Task> tasks;
+	tasks.reserve(archive.size());
+
+	for (TaskID id : archive)
+	{
+		Task& task = *m_tasks.find(id);
+
+		// the archive keeps the sessions with the task
+		keep_sessions(task);
+
+		m_deltas.forget(id);
+
+		tasks.push_back(std::move(task));
+		m_tasks.erase(id);
+	}
+
+	if (!m_sessionColumnsStale)
+	{
+		std::sort(archive.begin(), archive.end());
+
+		m_sessionColumns.remove(archive);
+	}
+
+	m_database->archive_tasks(tasks, *m_sender);
+
+	return tasks.size();
+}
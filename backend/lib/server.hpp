@@ -11,10 +11,19 @@
 #include "packets/daily_report.hpp"
 #include "packets/time_category.hpp"
 #include "packets/basic.hpp"
+#include "packets/bulk_task_info.hpp"
+#include "packets/protocol_version.hpp"
 
+#include "interned_string.hpp"
 #include "packet_sender.hpp"
+#include "request_arena.hpp"
+#include "session_columns.hpp"
+#include "task_deltas.hpp"
+#include "task_store.hpp"
+#include "trace.hpp"
 
 #include <vector>
+#include <memory_resource>
 #include <string>
 #include <optional>
 #include <unordered_map>
@@ -24,6 +33,7 @@
 #include <span>
 #include <bit>
 #include <algorithm>
+#include <list>
 #include <set>
 #include <map>
 
@@ -35,6 +45,7 @@ struct Database;
 class Task
 {
 	friend class MicroTask;
+	friend struct EventJournal;
 
 private:
 	TaskID m_taskID;
@@ -48,11 +59,13 @@ public:
 
 	std::int32_t indexInParent = 0;
 
-	std::vector<TimeEntry> timeEntry;
+	SmallVector<TimeEntry, 2> timeEntry;
 	std::vector<TaskTimes> m_times;
+	// false while the sessions are only in the database, see SessionHistory
+	bool sessionsLoaded = true;
 	std::optional<std::chrono::milliseconds> m_finishTime;
 
-	std::vector<std::string> labels;
+	SmallVector<InternedString, 2> labels;
 
 	Task(std::string name, TaskID id, TaskID parentID, std::chrono::milliseconds createTime);
 
@@ -63,7 +76,10 @@ public:
 
 	std::chrono::milliseconds createTime() const { return m_createTime; }
 
-	std::string m_name;
+	// a copy of everything but the sessions, for writes that only need the task and one of its sessions
+	Task without_sessions() const;
+
+	InternedString m_name;
 	TaskState state = TaskState::PENDING;
 
 	friend std::ostream& operator<<(std::ostream& out, const Task& task)
@@ -88,29 +104,54 @@ public:
 	}
 };
 
+// the sessions of tasks finished before the horizon stay in the database until a report, task request or session edit
+// needs them. the most recently used are kept in memory, up to the cache size
+struct SessionHistory
+{
+	// 0 keeps every session in memory
+	std::chrono::days horizon = std::chrono::days(0);
+
+	std::size_t cacheSize = 100;
+};
+
 class MicroTask
 {
 public:
-	MicroTask(API& api, const Clock& clock, Database& database, PacketSender& sender)
+	MicroTask(API& api, const Clock& clock, Database& database, PacketSender& sender, SessionHistory sessionHistory = {})
 	: m_clock(&clock),
 	m_database(&database),
 	m_sender(&sender),
 	m_api(&api),
-	m_unspecifiedTask("unspecified", UNSPECIFIED_TASK, NO_PARENT, std::chrono::milliseconds(0))
+	m_unspecifiedTask("unspecified", UNSPECIFIED_TASK, NO_PARENT, std::chrono::milliseconds(0)),
+	m_sessionHistory(sessionHistory)
 	{}
 
-	std::expected<TaskID, std::string> create_task(const std::string& name, TaskID parentID = NO_PARENT, bool serverControlled = false);
+	std::expected<TaskID, std::string> create_task(std::string_view name, TaskID parentID = NO_PARENT, bool serverControlled = false);
 
 	std::optional<std::string> configure_task_time_entry(TaskID taskID, std::span<const TimeEntry> timeEntry);
 
-	Task* active_task() const { return m_activeTask; }
+	Task* active_task() { return m_unspecifiedTaskActive ? &m_unspecifiedTask : m_tasks.find(m_activeTask); }
+	const Task& unspecified_task() const { return m_unspecifiedTask; }
+	std::size_t task_count() const { return m_tasks.size(); }
 	Task* find_task(TaskID id);
-	std::vector<Task*> find_tasks_with_parent(TaskID parentID);
+	std::pmr::vector<Task*> find_tasks_with_parent(TaskID parentID);
 	Task* find_task_with_parent_and_name(const std::string& name, TaskID parentID);
 
 	void find_bugzilla_helper_tasks(TaskID bugzillaParentTaskID, const std::vector<TaskID>& bugTasks, std::map<TaskID, TaskState>& helperTasks);
 
 	bool task_has_children(TaskID id) const;
+
+	// children of the task in ID order
+	TaskStore::Children children(TaskID parentID) const { return m_tasks.children(parentID); }
+
+	// a task that can be looked up again in a later request, the task is gone when find_task returns nullptr
+	TaskHandle task_handle(TaskID id) const { return m_tasks.handle(id); }
+	Task* find_task(TaskHandle handle) { return m_tasks.find(handle); }
+
+	// the state, finish time, index and flags of a task without reading the task. nullptr when there's no task
+	const TaskStore::Record* task_record(TaskID id) const { return m_tasks.record(id); }
+	// must be called after changing the state, finish time, index or flags of a task in place
+	void task_changed(const Task& task) { m_tasks.update(task); }
 	bool task_has_active_bug_tasks(TaskID id, const std::vector<TaskID>& bugTasks) const;
 
 	struct FindTasksOnDay
@@ -118,7 +159,10 @@ public:
 		Task* task;
 		DailyReport::TimePair time;
 	};
-	std::vector<FindTasksOnDay> find_tasks_on_day(int month, int year, int day);
+	std::pmr::vector<FindTasksOnDay> find_tasks_on_day(int month, int year, int day);
+
+	// the first task in ID order with a session that overlaps [start, stop], other than the ignored task
+	const Task* find_overlapping_session(std::chrono::milliseconds start, std::chrono::milliseconds stop, const Task* ignore = nullptr);
 
 	std::optional<std::string> start_task(TaskID id);
 	std::optional<std::string> start_task(TaskID id, std::chrono::milliseconds startTime);
@@ -130,6 +174,40 @@ public:
 
 	void fill_session_time_entry(const Task& task, TaskTimes& times);
 
+	// tasks finished before the cutoff don't need their sessions in memory. empty when every session is kept in memory
+	std::optional<std::chrono::milliseconds> session_cutoff() const;
+	static bool sessions_are_cold(const Task& task, std::chrono::milliseconds cutoff);
+
+	// must be called before using the sessions of a task that might not have them loaded
+	void load_sessions(Task& task);
+	const std::vector<TaskTimes>& sessions(const Task& task);
+	// loads the sessions and keeps them in memory until the request is done, even if evict_sessions is called
+	void keep_sessions(Task& task);
+	// called once the request is done. the kept sessions go back in the cache as the most recently used
+	void release_kept_sessions();
+	// loads the sessions of every task that has a session between start and end
+	void load_sessions_between(std::chrono::milliseconds start, std::chrono::milliseconds end);
+	// drops the least recently used cold sessions once there are too many. sessions of a task stay valid until
+	// this is called
+	void evict_sessions();
+
+	// the sessions in memory in columns for range scans. they're kept up to date as sessions change and are only
+	// rebuilt on the next call after sessions_changed
+	const SessionColumns& session_columns();
+	// must be called after starting a new last session of the task
+	void session_started(const Task& task);
+	// must be called after changing the start or stop of a session
+	void session_changed(const Task& task, std::size_t session);
+	// must be called after loading, adding or removing sessions of the task
+	void task_sessions_changed(const Task& task);
+	// for changes that can't be made row by row. the columns are rebuilt on the next call to session_columns
+	void sessions_changed() { m_sessionColumnsStale = true; }
+
+	// moves every subtree that was completely finished before the cutoff out of memory and into the archive. clients
+	// subscribed to a subtree are sent TASKS_ARCHIVED for it. returns the number of tasks archived, nothing is archived
+	// during a transaction
+	std::size_t archive_tasks(std::chrono::milliseconds cutoff);
+
 	std::expected<TaskState, std::string> task_state(TaskID id);
 
 	void load_task(const Task& task);
@@ -138,23 +216,13 @@ public:
 	template<typename Func>
 	void for_each_task_sorted(Func&& func)
 	{
-		std::vector<TaskID> keys;
-		keys.reserve(m_tasks.size());
-
-		for (auto&& task : m_tasks)
-		{
-			keys.push_back(task.first);
-		}
-
-		std::sort(keys.begin(), keys.end());
-
-		for (TaskID key : keys)
-		{
-			func(m_tasks.at(key));
-		}
+		m_tasks.for_each_sorted(func);
 	}
 
-	void send_task_info(const Task& task, bool newTask)
+	// the task followed by its parents
+	std::pmr::vector<TaskID> task_path(const Task& task);
+
+	std::unique_ptr<TaskInfoMessage> task_info(const Task& task, bool newTask)
 	{
 		auto info = std::make_unique<TaskInfoMessage>(task.taskID(), task.parentID(), task.m_name);
 
@@ -165,55 +233,87 @@ public:
 		info->indexInParent = task.indexInParent;
 		info->serverControlled = task.serverControlled;
 		info->locked = task.locked;
-		info->times = task.m_times;
+		info->times = sessions(task);
 		info->timeEntry = task.timeEntry;
-		info->labels = task.labels;
+		info->labels.assign(task.labels.begin(), task.labels.end());
+
+		return info;
+	}
+
+	void send_task_info(const Task& task, bool newTask)
+	{
+		TG_TRACE_SPAN("send_task_info", "task");
 
-		m_sender->send(std::move(info));
+		m_sender->send(task_info(task, newTask));
 	}
 
+	// the task changed, tell every client looking at it. clients that support it are only sent what changed
+	void broadcast_task_info(const Task& task, bool newTask);
+
+	// tasks per BULK_TASK_INFO. keeps the packets a reasonable size for large task trees
+	static constexpr std::size_t BULK_TASK_INFO_CHUNK = 1000;
+
 	void send_all_tasks()
 	{
+		TG_TRACE_SPAN("send_all_tasks", "task");
+
 		m_sender->send(std::make_unique<BasicMessage>(PacketType::BULK_TASK_INFO_START));
 
-		std::vector<TaskID> parents;
+		// clients that negotiated it get the tasks in columns, a chunk at a time, instead of a TASK_INFO for each
+		const bool columnar = m_sender->protocol_version() >= BULK_TASK_INFO_PROTOCOL_VERSION;
+
+		auto bulk = std::make_unique<BulkTaskInfoMessage>();
+
+		std::pmr::vector<TaskID> parents(m_scratch.resource());
 
 		parents.push_back(NO_PARENT);
 
 		while (!parents.empty())
 		{
-			std::vector<TaskID> next;
+			std::pmr::vector<TaskID> next(m_scratch.resource());
 
 			for (TaskID parent : parents)
 			{
 				if (parent != NO_PARENT)
 				{
-					send_task_info(m_tasks.at(parent), false);
-				}
-
-				auto all_tasks = find_tasks_with_parent(parent);
+					if (columnar)
+					{
+						bulk->add(*task_info(*m_tasks.find(parent), false));
 
-				std::sort(all_tasks.begin(), all_tasks.end(),
-					[](Task* a, Task* b)
+						if (bulk->size() == BULK_TASK_INFO_CHUNK)
+						{
+							m_sender->send(std::move(bulk));
+							bulk = std::make_unique<BulkTaskInfoMessage>();
+						}
+					}
+					else
 					{
-						return a->taskID() < b->taskID();
+						send_task_info(*m_tasks.find(parent), false);
 					}
-				);
 
-				for (auto&& task : all_tasks)
+					// the sessions have been copied into the message, old ones don't have to stay loaded
+					evict_sessions();
+				}
+
+				for (TaskID child : children(parent))
 				{
 					// skip the unspecified task
-					if (task->taskID() == UNSPECIFIED_TASK)
+					if (child == UNSPECIFIED_TASK)
 					{
 						continue;
 					}
-					next.push_back(task->taskID());
+					next.push_back(child);
 				}
 			}
-			parents = next;
+			parents = std::move(next);
+		}
+
+		if (bulk->size() > 0)
+		{
+			m_sender->send(std::move(bulk));
 		}
 
-		if (m_activeTask == &m_unspecifiedTask)
+		if (m_unspecifiedTaskActive)
 		{
 			m_sender->send(std::make_unique<BasicMessage>(PacketType::UNSPECIFIED_TASK_ACTIVE));
 		}
@@ -222,6 +322,10 @@ public:
 	}
 
 	TimeCategories& timeCategories() { return m_timeCategories; }
+
+	// temporary containers of the request being handled. the returned vectors of find_tasks_on_day,
+	// find_tasks_with_parent and task_path come from it and are only valid until the request is done
+	RequestArena& scratch() { return m_scratch; }
 	
 	bool is_bulk_update() const { return m_bulk_update; }
 	void add_update_task(TaskID id) { m_changedTasksBulkUpdate.insert(id); }
@@ -230,15 +334,15 @@ public:
 	{
 		m_bulk_update = false;
 
-		m_sender->send(std::make_unique<BasicMessage>(PacketType::BULK_TASK_INFO_START));
+		m_sender->broadcast(std::make_unique<BasicMessage>(PacketType::BULK_TASK_INFO_START), {});
 
 		for (TaskID task : m_changedTasksBulkUpdate)
 		{
-			send_task_info(m_tasks.at(task), false);
+			broadcast_task_info(*m_tasks.find(task), false);
 		}
 		m_changedTasksBulkUpdate.clear();
 
-		m_sender->send(std::make_unique<BasicMessage>(PacketType::BULK_TASK_INFO_FINISH));
+		m_sender->broadcast(std::make_unique<BasicMessage>(PacketType::BULK_TASK_INFO_FINISH), {});
 	}
 
 public:
@@ -247,15 +351,36 @@ public:
 	TaskID m_nextTaskID = TaskID(1);
 
 private:
-	std::unordered_map<TaskID, Task> m_tasks;
+	// nullptr for no active task
+	void set_active_task(Task* task);
+
+	TaskStore m_tasks;
 	Task m_unspecifiedTask;
-	Task* m_activeTask = nullptr;
+
+	// the unspecified task isn't in the store and has no handle
+	TaskHandle m_activeTask;
+	bool m_unspecifiedTaskActive = false;
+
+	SessionColumns m_sessionColumns;
+	bool m_sessionColumnsStale = true;
 
 	bool m_bulk_update = false;
 	std::set<TaskID> m_changedTasksBulkUpdate;
 
+	SessionHistory m_sessionHistory;
+
+	TaskDeltas m_deltas;
+
+	// tasks with sessions loaded on demand, most recently used first
+	std::list<TaskID> m_cachedSessions;
+	std::unordered_map<TaskID, std::list<TaskID>::iterator> m_cachedSessionLookup;
+	// out of the cache until the request is done
+	std::vector<TaskID> m_keptSessions;
+
 	TimeCategories m_timeCategories;
 
+	RequestArena m_scratch;
+
 	const Clock* m_clock;
 	Database* m_database;
 	PacketSender* m_sender;
@@ -0,0 +1,182 @@
+#include "session_columns.hpp"
+
+#include <algorithm>
+#include <bit>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+void SessionColumns::clear()
+{
+	m_start.clear();
+	m_stop.clear();
+	m_task.clear();
+	m_session.clear();
+}
+
+static std::int64_t stop_time(const TaskTimes& times)
+{
+	return times.stop ? times.stop->count() : SessionColumns::NO_STOP;
+}
+
+void SessionColumns::add(TaskID task, std::int32_t session, const TaskTimes& times)
+{
+	m_start.push_back(times.start.count());
+	m_stop.push_back(stop_time(times));
+	m_task.push_back(task);
+	m_session.push_back(session);
+}
+
+void SessionColumns::append(TaskID task, std::int32_t session, const TaskTimes& times)
+{
+	// a new session usually belongs to the newest task, which makes this a push to the back
+	const auto row = std::ranges::upper_bound(m_task, task) - m_task.begin();
+
+	m_start.insert(m_start.begin() + row, times.start.count());
+	m_stop.insert(m_stop.begin() + row, stop_time(times));
+	m_task.insert(m_task.begin() + row, task);
+	m_session.insert(m_session.begin() + row, session);
+}
+
+bool SessionColumns::update(TaskID task, std::int32_t session, const TaskTimes& times)
+{
+	const std::size_t row = (std::ranges::lower_bound(m_task, task) - m_task.begin()) + session;
+
+	if (session < 0 || row >= size() || m_task[row] != task || m_session[row] != session)
+	{
+		return false;
+	}
+
+	m_start[row] = times.start.count();
+	m_stop[row] = stop_time(times);
+
+	return true;
+}
+
+void SessionColumns::replace(TaskID task, const std::vector<TaskTimes>& sessions)
+{
+	const auto [first, last] = std::ranges::equal_range(m_task, task);
+
+	const auto begin = first - m_task.begin();
+	const auto end = last - m_task.begin();
+
+	m_start.erase(m_start.begin() + begin, m_start.begin() + end);
+	m_stop.erase(m_stop.begin() + begin, m_stop.begin() + end);
+	m_task.erase(m_task.begin() + begin, m_task.begin() + end);
+	m_session.erase(m_session.begin() + begin, m_session.begin() + end);
+
+	m_start.insert(m_start.begin() + begin, sessions.size(), 0);
+	m_stop.insert(m_stop.begin() + begin, sessions.size(), 0);
+	m_task.insert(m_task.begin() + begin, sessions.size(), task);
+	m_session.insert(m_session.begin() + begin, sessions.size(), 0);
+
+	for (std::size_t session = 0; session < sessions.size(); session++)
+	{
+		m_start[begin + session] = sessions[session].start.count();
+		m_stop[begin + session] = stop_time(sessions[session]);
+		m_session[begin + session] = static_cast<std::int32_t>(session);
+	}
+}
+
+void SessionColumns::remove(std::span<const TaskID> tasks)
+{
+	std::size_t kept = 0;
+
+	for (std::size_t row = 0; row < size(); row++)
+	{
+		if (std::ranges::binary_search(tasks, m_task[row]))
+		{
+			continue;
+		}
+
+		m_start[kept] = m_start[row];
+		m_stop[kept] = m_stop[row];
+		m_task[kept] = m_task[row];
+		m_session[kept] = m_session[row];
+		kept++;
+	}
+
+	m_start.resize(kept);
+	m_stop.resize(kept);
+	m_task.resize(kept);
+	m_session.resize(kept);
+}
+
+void SessionColumns::find_starting_or_stopping(std::chrono::milliseconds start, std::chrono::milliseconds end, std::pmr::vector<std::uint32_t>& rows) const
+{
+	const std::int64_t* starts = m_start.data();
+	const std::int64_t* stops = m_stop.data();
+
+	const std::int64_t from = start.count();
+	const std::int64_t to = end.count();
+
+	std::size_t row = 0;
+
+	// x is in [from, to) when !(from > x) && to > x
+#if defined(__AVX2__)
+	const __m256i fromLanes = _mm256_set1_epi64x(from);
+	const __m256i toLanes = _mm256_set1_epi64x(to);
+
+	for (; row + 4 <= size(); row += 4)
+	{
+		const __m256i startLanes = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(starts + row));
+		const __m256i stopLanes = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(stops + row));
+
+		const __m256i startIn = _mm256_andnot_si256(_mm256_cmpgt_epi64(fromLanes, startLanes), _mm256_cmpgt_epi64(toLanes, startLanes));
+		const __m256i stopIn = _mm256_andnot_si256(_mm256_cmpgt_epi64(fromLanes, stopLanes), _mm256_cmpgt_epi64(toLanes, stopLanes));
+
+		for (auto mask = static_cast<unsigned>(_mm256_movemask_pd(_mm256_castsi256_pd(_mm256_or_si256(startIn, stopIn)))); mask != 0; mask &= mask - 1)
+		{
+			rows.push_back(static_cast<std::uint32_t>(row + std::countr_zero(mask)));
+		}
+	}
+#endif
+
+	for (; row < size(); row++)
+	{
+		if ((starts[row] >= from && starts[row] < to) || (stops[row] >= from && stops[row] < to))
+		{
+			rows.push_back(static_cast<std::uint32_t>(row));
+		}
+	}
+}
+
+std::size_t SessionColumns::find_overlap(std::chrono::milliseconds start, std::chrono::milliseconds stop, std::size_t from) const
+{
+	const std::int64_t* starts = m_start.data();
+	const std::int64_t* stops = m_stop.data();
+
+	const std::int64_t first = start.count();
+	const std::int64_t last = stop.count();
+
+	std::size_t row = from;
+
+	// the sessions overlap unless one of them starts after the other stops
+#if defined(__AVX2__)
+	const __m256i firstLanes = _mm256_set1_epi64x(first);
+	const __m256i lastLanes = _mm256_set1_epi64x(last);
+
+	for (; row + 4 <= size(); row += 4)
+	{
+		const __m256i startLanes = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(starts + row));
+		const __m256i stopLanes = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(stops + row));
+
+		const __m256i apart = _mm256_or_si256(_mm256_cmpgt_epi64(startLanes, lastLanes), _mm256_cmpgt_epi64(firstLanes, stopLanes));
+
+		if (const auto mask = static_cast<unsigned>(_mm256_movemask_pd(_mm256_castsi256_pd(apart))) ^ 0xFu; mask != 0)
+		{
+			return row + std::countr_zero(mask);
+		}
+	}
+#endif
+
+	for (; row < size(); row++)
+	{
+		if (starts[row] <= last && first <= stops[row])
+		{
+			return row;
+		}
+	}
+	return size();
+}
@@ -0,0 +1,391 @@
+#include "snapshot.hpp"
+#include "packets.hpp"
+#include "trace.hpp"
+
+#include <filesystem>
+#include <fstream>
+
+#ifdef _WIN32
+#include <Windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace
+{
+	// FNV-1a
+	std::uint64_t checksum(std::span<const std::byte> bytes)
+	{
+		std::uint64_t hash = 14695981039346656037ull;
+
+		for (std::byte b : bytes)
+		{
+			hash ^= static_cast<std::uint64_t>(b);
+			hash *= 1099511628211ull;
+		}
+		return hash;
+	}
+
+	void add_instance(PacketBuilder& builder, const BugzillaInstance& instance)
+	{
+		builder.add(instance.instanceID);
+		builder.add(instance.bugzillaName);
+		builder.add(instance.bugzillaURL);
+		builder.add(instance.bugzillaApiKey);
+		builder.add(instance.bugzillaUsername);
+		builder.add(instance.bugzillaRootTaskID);
+		builder.add(instance.lastBugzillaRefresh.value_or(std::chrono::milliseconds(0)));
+
+		builder.add(static_cast<std::int32_t>(instance.bugzillaGroupTasksBy.size()));
+
+		for (auto&& groupBy : instance.bugzillaGroupTasksBy)
+		{
+			builder.add(groupBy);
+		}
+
+		builder.add(static_cast<std::int32_t>(instance.bugToTaskID.size()));
+
+		for (auto&& [bug, task] : instance.bugToTaskID)
+		{
+			builder.add(static_cast<std::int32_t>(bug));
+			builder.add(task);
+		}
+	}
+
+	BugzillaInstance parse_instance(PacketParser& parser)
+	{
+		BugzillaInstance instance = BugzillaInstance(parser.read<BugzillaInstanceID>("instanceID"));
+		instance.bugzillaName = parser.read<std::string>("name");
+		instance.bugzillaURL = parser.read<std::string>("URL");
+		instance.bugzillaApiKey = parser.read<std::string>("apiKey");
+		instance.bugzillaUsername = parser.read<std::string>("username");
+		instance.bugzillaRootTaskID = parser.read<TaskID>("rootTaskID");
+		instance.lastBugzillaRefresh = parser.read<std::chrono::milliseconds>("lastRefresh");
+
+		const auto groupByCount = parser.read<std::int32_t>("groupByCount");
+
+		for (std::int32_t i = 0; i < groupByCount && !parser.error(); i++)
+		{
+			instance.bugzillaGroupTasksBy.push_back(parser.read<std::string>("groupBy"));
+		}
+
+		const auto bugCount = parser.read<std::int32_t>("bugCount");
+
+		for (std::int32_t i = 0; i < bugCount && !parser.error(); i++)
+		{
+			const auto bug = parser.read<std::int32_t>("bug");
+			instance.bugToTaskID.emplace(bug, parser.read<TaskID>("taskID"));
+		}
+		return instance;
+	}
+
+	// read-only view of a whole file
+	class MappedFile
+	{
+	public:
+		explicit MappedFile(const std::string& file)
+		{
+#ifdef _WIN32
+			m_file = CreateFileA(file.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+
+			if (m_file == INVALID_HANDLE_VALUE)
+			{
+				return;
+			}
+
+			LARGE_INTEGER size;
+
+			if (!GetFileSizeEx(m_file, &size) || size.QuadPart == 0)
+			{
+				return;
+			}
+
+			m_mapping = CreateFileMappingA(m_file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+
+			if (m_mapping == nullptr)
+			{
+				return;
+			}
+
+			m_data = MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0);
+			m_size = m_data ? static_cast<std::size_t>(size.QuadPart) : 0;
+#else
+			m_file = open(file.c_str(), O_RDONLY);
+
+			if (m_file == -1)
+			{
+				return;
+			}
+
+			struct stat info;
+
+			if (fstat(m_file, &info) != 0 || info.st_size == 0)
+			{
+				return;
+			}
+
+			void* data = mmap(nullptr, info.st_size, PROT_READ, MAP_PRIVATE, m_file, 0);
+
+			if (data != MAP_FAILED)
+			{
+				m_data = data;
+				m_size = info.st_size;
+			}
+#endif
+		}
+
+		MappedFile(const MappedFile&) = delete;
+		MappedFile& operator=(const MappedFile&) = delete;
+
+		~MappedFile()
+		{
+#ifdef _WIN32
+			if (m_data) UnmapViewOfFile(m_data);
+			if (m_mapping) CloseHandle(m_mapping);
+			if (m_file != INVALID_HANDLE_VALUE) CloseHandle(m_file);
+#else
+			if (m_data) munmap(m_data, m_size);
+			if (m_file != -1) close(m_file);
+#endif
+		}
+
+		std::span<const std::byte> bytes() const
+		{
+			return { static_cast<const std::byte*>(m_data), m_size };
+		}
+
+	private:
+#ifdef _WIN32
+		HANDLE m_file = INVALID_HANDLE_VALUE;
+		HANDLE m_mapping = nullptr;
+#else
+		int m_file = -1;
+#endif
+		void* m_data = nullptr;
+		std::size_t m_size = 0;
+	};
+}
+
+void add_time_entry(PacketBuilder& builder, std::span<const TimeEntry> timeEntry)
+{
+	builder.add(static_cast<std::int32_t>(timeEntry.size()));
+
+	for (auto&& entry : timeEntry)
+	{
+		builder.add(entry.categoryID);
+		builder.add(entry.codeID);
+	}
+}
+
+SmallVector<TimeEntry, 2> parse_time_entry(PacketParser& parser, const TimeCategories& timeCategories)
+{
+	SmallVector<TimeEntry, 2> timeEntry;
+
+	const auto count = parser.read<std::int32_t>("timeEntryCount");
+
+	for (std::int32_t i = 0; i < count && !parser.error(); i++)
+	{
+		const auto category = parser.read<TimeCategoryID>("timeCategoryID");
+		const auto code = parser.read<TimeCodeID>("timeCodeID");
+
+		timeEntry.push_back(timeCategories.find(category, code));
+	}
+	return timeEntry;
+}
+
+void add_task_image(PacketBuilder& builder, const Task& task)
+{
+	builder.add(task.taskID());
+	builder.add(task.parentID());
+	builder.add(task.m_name.str());
+	builder.add(task.state);
+	builder.add(task.createTime());
+	builder.add(task.m_finishTime.value_or(std::chrono::milliseconds(0)));
+	builder.add(task.locked);
+	builder.add(task.serverControlled);
+	builder.add(task.indexInParent);
+
+	add_time_entry(builder, task.timeEntry);
+
+	builder.add(task.sessionsLoaded);
+	builder.add(static_cast<std::int32_t>(task.m_times.size()));
+
+	for (auto&& times : task.m_times)
+	{
+		builder.add(times.start);
+		builder.add(times.stop.value_or(std::chrono::milliseconds(0)));
+
+		// the database stores a session without time entry as the unknown category and code, match it so that loading
+		// from the snapshot gives the same result as loading from the database
+		if (times.timeEntry.empty())
+		{
+			builder.add(static_cast<std::int32_t>(1));
+			builder.add(TimeCategoryID(0));
+			builder.add(TimeCodeID(0));
+		}
+		else
+		{
+			add_time_entry(builder, times.timeEntry);
+		}
+	}
+}
+
+Task parse_task_image(PacketParser& parser, const TimeCategories& timeCategories)
+{
+	const auto taskID = parser.read<TaskID>("taskID");
+	const auto parentID = parser.read<TaskID>("parentID");
+	auto name = parser.read<std::string>("name");
+	const auto state = parser.read<TaskState>("state");
+	const auto createTime = parser.read<std::chrono::milliseconds>("createTime");
+	const auto finishTime = parser.read<std::chrono::milliseconds>("finishTime");
+
+	Task task = Task(std::move(name), taskID, parentID, createTime);
+	task.state = state;
+	task.m_finishTime = finishTime.count() == 0 ? std::nullopt : std::optional(finishTime);
+	task.locked = parser.read<bool>("locked");
+	task.serverControlled = parser.read<bool>("serverControlled");
+	task.indexInParent = parser.read<std::int32_t>("indexInParent");
+	task.timeEntry = parse_time_entry(parser, timeCategories);
+	task.sessionsLoaded = parser.read<bool>("sessionsLoaded");
+
+	const auto sessionCount = parser.read<std::int32_t>("sessionCount");
+
+	for (std::int32_t i = 0; i < sessionCount && !parser.error(); i++)
+	{
+		TaskTimes times{ parser.read<std::chrono::milliseconds>("start") };
+
+		const auto stop = parser.read<std::chrono::milliseconds>("stop");
+		times.stop = stop.count() == 0 ? std::nullopt : std::optional(stop);
+		times.timeEntry = parse_time_entry(parser, timeCategories);
+
+		task.m_times.push_back(std::move(times));
+	}
+	return task;
+}
+
+std::vector<std::byte> build_snapshot(std::int64_t sequence, MicroTask& app, const Bugzilla& bugzilla)
+{
+	TG_TRACE_SPAN("build_snapshot", "snapshot");
+
+	const StringLengthScope strings(PERSISTED_STRING_LENGTH);
+
+	PacketBuilder payload;
+
+	// the unspecified task is kept separately but loads the same as any other task
+	payload.add(static_cast<std::int32_t>(app.task_count() + 1));
+
+	add_task_image(payload, app.unspecified_task());
+
+	{
+		// snapshots are taken between requests, release the sorted keys here instead of with the next request
+		const RequestArena::Scope scratch(app.scratch());
+
+		app.for_each_task_sorted([&](const Task& task) { add_task_image(payload, task); });
+	}
+
+	payload.add(static_cast<std::int32_t>(bugzilla.instances().size()));
+
+	for (auto&& [name, instance] : bugzilla.instances())
+	{
+		add_instance(payload, instance);
+	}
+
+	PacketBuilder header;
+	header.add(Snapshot::MAGIC);
+	header.add(Snapshot::VERSION);
+	header.add(sequence);
+	header.add(static_cast<std::int64_t>(payload.bytes().size()));
+	header.add(checksum(payload.bytes()));
+
+	std::vector<std::byte> bytes = header.bytes();
+	bytes.insert(bytes.end(), payload.bytes().begin(), payload.bytes().end());
+
+	return bytes;
+}
+
+std::optional<Snapshot> parse_snapshot(std::span<const std::byte> bytes, const TimeCategories& timeCategories)
+{
+	TG_TRACE_SPAN("parse_snapshot", "snapshot");
+
+	const StringLengthScope strings(PERSISTED_STRING_LENGTH);
+
+	auto parser = PacketParser(bytes);
+
+	const auto magic = parser.read<std::int32_t>("magic");
+	const auto version = parser.read<std::int32_t>("version");
+
+	if (parser.error() || magic != Snapshot::MAGIC || version != Snapshot::VERSION)
+	{
+		return std::nullopt;
+	}
+
+	Snapshot snapshot;
+	snapshot.sequence = parser.read<std::int64_t>("sequence");
+
+	const auto size = parser.read<std::int64_t>("size");
+	const auto expectedChecksum = parser.read<std::uint64_t>("checksum");
+
+	constexpr std::size_t HEADER_SIZE = 32;
+
+	if (parser.error() || size < 0 || bytes.size() - HEADER_SIZE != static_cast<std::size_t>(size) || checksum(bytes.subspan(HEADER_SIZE)) != expectedChecksum)
+	{
+		return std::nullopt;
+	}
+
+	const auto taskCount = parser.read<std::int32_t>("taskCount");
+	snapshot.tasks.reserve(taskCount);
+
+	for (std::int32_t i = 0; i < taskCount && !parser.error(); i++)
+	{
+		snapshot.tasks.push_back(parse_task_image(parser, timeCategories));
+	}
+
+	const auto instanceCount = parser.read<std::int32_t>("instanceCount");
+
+	for (std::int32_t i = 0; i < instanceCount && !parser.error(); i++)
+	{
+		snapshot.instances.push_back(parse_instance(parser));
+	}
+
+	if (parser.error())
+	{
+		return std::nullopt;
+	}
+	return snapshot;
+}
+
+bool save_snapshot(const std::string& file, std::span<const std::byte> bytes)
+{
+	TG_TRACE_SPAN("save_snapshot", "snapshot");
+
+	const std::string temp = file + ".tmp";
+
+	{
+		std::ofstream output(temp, std::ios::binary | std::ios::trunc);
+
+		output.write(reinterpret_cast<const char*>(bytes.data()), bytes.size());
+		output.flush();
+
+		if (!output)
+		{
+			return false;
+		}
+	}
+
+	std::error_code error;
+	std::filesystem::rename(temp, file, error);
+
+	return !error;
+}
+
+std::optional<Snapshot> load_snapshot(const std::string& file, const TimeCategories& timeCategories)
+{
+	TG_TRACE_SPAN("load_snapshot", "snapshot");
+
+	const MappedFile mapped(file);
+
+	return parse_snapshot(mapped.bytes(), timeCategories);
+}
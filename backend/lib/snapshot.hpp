@@ -0,0 +1,54 @@
+#pragma once
+
+#include "server.hpp"
+#include "bugzilla.hpp"
+#include "packets/string_length.hpp"
+
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <string>
+#include <vector>
+
+class PacketBuilder;
+class PacketParser;
+
+// binary copy of the tasks and bugzilla instances. loading it replaces most of the queries done at startup, only the
+// rows written after the snapshot's sequence number are read from the database
+//
+// the file is a header (magic, version, sequence, payload size, payload checksum) followed by the payload. values are
+// big endian, the same as packets. version 3 changed the strings to PERSISTED_STRING_LENGTH
+struct Snapshot
+{
+	static constexpr std::int32_t MAGIC = 0x54475353; // TGSS
+	static constexpr std::int32_t VERSION = 3;
+
+	std::int64_t sequence = 0;
+
+	std::vector<Task> tasks;
+	std::vector<BugzillaInstance> instances;
+};
+
+// strings in everything written to disk have a 4 byte length so that long names aren't cut off. snapshots, journal
+// segments and archived tasks are built and parsed inside a StringLengthScope for it
+inline constexpr StringLength PERSISTED_STRING_LENGTH = StringLength::LONG;
+
+// time entries are stored as their IDs and looked up in the time categories when parsed
+void add_time_entry(PacketBuilder& builder, std::span<const TimeEntry> timeEntry);
+SmallVector<TimeEntry, 2> parse_time_entry(PacketParser& parser, const TimeCategories& timeCategories);
+
+// the whole task, in the same form the database stores it. shared with the event journal and the task archive. both
+// parse functions read through the parser, check parser.error() before using what they return
+void add_task_image(PacketBuilder& builder, const Task& task);
+Task parse_task_image(PacketParser& parser, const TimeCategories& timeCategories);
+
+std::vector<std::byte> build_snapshot(std::int64_t sequence, MicroTask& app, const Bugzilla& bugzilla);
+
+// time entries are stored as IDs and looked up in the time categories, which are always loaded from the database
+std::optional<Snapshot> parse_snapshot(std::span<const std::byte> bytes, const TimeCategories& timeCategories);
+
+// written to a temporary file first so that a crash never leaves a partial snapshot behind
+bool save_snapshot(const std::string& file, std::span<const std::byte> bytes);
+
+// maps the file into memory and parses it. anything wrong with the file, including a bad checksum, returns nullopt
+std::optional<Snapshot> load_snapshot(const std::string& file, const TimeCategories& timeCategories);
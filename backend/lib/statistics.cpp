@@ -0,0 +1,187 @@
+#include "statistics.hpp"
+
+namespace
+{
+	// the request being handled on this thread. only touched by its own thread
+	struct ActiveRequest
+	{
+		int depth = 0;
+		PacketType type = static_cast<PacketType>(0);
+		std::chrono::steady_clock::time_point start;
+		std::chrono::steady_clock::duration databaseTime{};
+		std::chrono::steady_clock::duration sendTime{};
+		std::size_t bytesOut = 0;
+	};
+
+	thread_local ActiveRequest activeRequest;
+
+	std::uint64_t to_microseconds(std::chrono::steady_clock::duration time)
+	{
+		return std::chrono::duration_cast<std::chrono::microseconds>(time).count();
+	}
+}
+
+HistogramData Histogram::data() const
+{
+	HistogramData data;
+	data.count = m_count.load(std::memory_order_relaxed);
+	data.sum = m_sum.load(std::memory_order_relaxed);
+
+	std::size_t used = 0;
+
+	for (std::size_t i = 0; i < BUCKET_COUNT; i++)
+	{
+		if (m_buckets[i].load(std::memory_order_relaxed) != 0)
+		{
+			used = i + 1;
+		}
+	}
+
+	// trailing empty buckets are left off
+	data.buckets.reserve(used);
+
+	for (std::size_t i = 0; i < used; i++)
+	{
+		data.buckets.push_back(m_buckets[i].load(std::memory_order_relaxed));
+	}
+	return data;
+}
+
+void Histogram::reset()
+{
+	for (auto&& bucket : m_buckets)
+	{
+		bucket.store(0, std::memory_order_relaxed);
+	}
+	m_count.store(0, std::memory_order_relaxed);
+	m_sum.store(0, std::memory_order_relaxed);
+}
+
+void Statistics::start_request(PacketType type)
+{
+	// requests handled while handling another request are part of the outer request
+	if (activeRequest.depth++ > 0)
+	{
+		return;
+	}
+
+	activeRequest.type = type;
+	activeRequest.start = std::chrono::steady_clock::now();
+	activeRequest.databaseTime = {};
+	activeRequest.sendTime = {};
+	activeRequest.bytesOut = 0;
+}
+
+void Statistics::finish_request()
+{
+	if (--activeRequest.depth > 0)
+	{
+		return;
+	}
+
+	auto& stats = histograms(activeRequest.type);
+
+	stats.requestTime.record(to_microseconds(std::chrono::steady_clock::now() - activeRequest.start));
+	stats.databaseTime.record(to_microseconds(activeRequest.databaseTime));
+	stats.sendTime.record(to_microseconds(activeRequest.sendTime));
+	stats.bytesOut.record(activeRequest.bytesOut);
+}
+
+void Statistics::record_bytes_in(PacketType type, std::size_t bytes)
+{
+	histograms(type).bytesIn.record(bytes);
+}
+
+void Statistics::record_database_time(std::chrono::steady_clock::duration time)
+{
+	if (activeRequest.depth > 0)
+	{
+		activeRequest.databaseTime += time;
+	}
+	else
+	{
+		histograms(static_cast<PacketType>(0)).databaseTime.record(to_microseconds(time));
+	}
+}
+
+void Statistics::record_database_time(PacketType type, std::chrono::steady_clock::duration time)
+{
+	histograms(type).databaseTime.record(to_microseconds(time));
+}
+
+std::optional<PacketType> Statistics::active_request() const
+{
+	if (activeRequest.depth > 0)
+	{
+		return activeRequest.type;
+	}
+	return std::nullopt;
+}
+
+void Statistics::record_send(std::chrono::steady_clock::duration time, std::size_t bytes)
+{
+	if (activeRequest.depth > 0)
+	{
+		activeRequest.sendTime += time;
+		activeRequest.bytesOut += bytes;
+	}
+	else
+	{
+		auto& stats = histograms(static_cast<PacketType>(0));
+
+		stats.sendTime.record(to_microseconds(time));
+		stats.bytesOut.record(bytes);
+	}
+}
+
+std::vector<PacketStats> Statistics::data() const
+{
+	std::vector<PacketStats> result;
+
+	for (std::size_t i = 0; i < PACKET_TYPE_COUNT; i++)
+	{
+		const auto& stats = m_histograms[i];
+
+		if (stats.requestTime.count() == 0 && stats.databaseTime.count() == 0 && stats.sendTime.count() == 0 && stats.bytesIn.count() == 0)
+		{
+			continue;
+		}
+
+		PacketStats packet;
+		packet.packetType = static_cast<PacketType>(i);
+		packet.requestTime = stats.requestTime.data();
+		packet.databaseTime = stats.databaseTime.data();
+		packet.sendTime = stats.sendTime.data();
+		packet.bytesIn = stats.bytesIn.data();
+		packet.bytesOut = stats.bytesOut.data();
+
+		result.push_back(packet);
+	}
+	return result;
+}
+
+void Statistics::reset()
+{
+	for (auto&& stats : m_histograms)
+	{
+		stats.requestTime.reset();
+		stats.databaseTime.reset();
+		stats.sendTime.reset();
+		stats.bytesIn.reset();
+		stats.bytesOut.reset();
+	}
+}
+
+Statistics::Histograms& Statistics::histograms(PacketType type)
+{
+	const auto index = static_cast<std::size_t>(type);
+
+	// anything out of range is grouped with the unattributed time
+	return m_histograms[index < PACKET_TYPE_COUNT ? index : 0];
+}
+
+Statistics& statistics()
+{
+	static Statistics stats;
+	return stats;
+}
@@ -0,0 +1,145 @@
+#pragma once
+
+#include "packets/message.hpp"
+#include "packets/stats.hpp"
+
+#include <array>
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+// fixed bucket histogram. recording is a few relaxed atomic increments, there is no locking
+class Histogram
+{
+public:
+	static constexpr std::size_t BUCKET_COUNT = 40;
+
+	void record(std::uint64_t value)
+	{
+		const std::size_t bucket = std::min<std::size_t>(std::bit_width(value), BUCKET_COUNT - 1);
+
+		m_buckets[bucket].fetch_add(1, std::memory_order_relaxed);
+		m_count.fetch_add(1, std::memory_order_relaxed);
+		m_sum.fetch_add(value, std::memory_order_relaxed);
+	}
+
+	std::uint64_t count() const { return m_count.load(std::memory_order_relaxed); }
+
+	HistogramData data() const;
+
+	void reset();
+
+private:
+	std::array<std::atomic<std::uint64_t>, BUCKET_COUNT> m_buckets{};
+	std::atomic<std::uint64_t> m_count = 0;
+	std::atomic<std::uint64_t> m_sum = 0;
+};
+
+// process wide statistics, indexed by packet type
+//
+// database and send times are accumulated for the request active on the calling thread and recorded
+// once the request finishes. time spent outside of a request is recorded against packet type 0, unless the
+// work was handed off by a request, like the writes committed by the database writer thread. those are recorded
+// against the request that queued them as samples of their own. the transaction they're committed in is shared
+// and stays on type 0
+class Statistics
+{
+public:
+	// one set of histograms for every packet type, up to the largest one in the enum
+	static constexpr std::size_t PACKET_TYPE_COUNT = static_cast<std::size_t>(magic_enum::enum_values<PacketType>().back()) + 1;
+
+	struct Histograms
+	{
+		Histogram requestTime;
+		Histogram databaseTime;
+		Histogram sendTime;
+		Histogram bytesIn;
+		Histogram bytesOut;
+	};
+
+	void start_request(PacketType type);
+	void finish_request();
+
+	void record_bytes_in(PacketType type, std::size_t bytes);
+	void record_database_time(std::chrono::steady_clock::duration time);
+	void record_database_time(PacketType type, std::chrono::steady_clock::duration time);
+	void record_send(std::chrono::steady_clock::duration time, std::size_t bytes);
+
+	// type of the request being handled on this thread, if there is one
+	std::optional<PacketType> active_request() const;
+
+	// packet types that have recorded anything
+	std::vector<PacketStats> data() const;
+
+	void reset();
+
+private:
+	Histograms& histograms(PacketType type);
+
+	std::array<Histograms, PACKET_TYPE_COUNT> m_histograms;
+};
+
+Statistics& statistics();
+
+// times a Database call and adds it to the request active on this thread. calls made from within another
+// Database call are already covered by the outer timer
+class DatabaseTimer
+{
+public:
+	DatabaseTimer() : m_start(std::chrono::steady_clock::now())
+	{
+		++s_depth;
+	}
+
+	// for work done on behalf of a request from another thread. nullopt when it wasn't queued by a request
+	explicit DatabaseTimer(std::optional<PacketType> request) : m_request(request), m_start(std::chrono::steady_clock::now())
+	{
+		++s_depth;
+	}
+
+	DatabaseTimer(const DatabaseTimer&) = delete;
+	DatabaseTimer& operator=(const DatabaseTimer&) = delete;
+
+	~DatabaseTimer()
+	{
+		if (--s_depth == 0)
+		{
+			if (m_request)
+			{
+				statistics().record_database_time(*m_request, std::chrono::steady_clock::now() - m_start);
+			}
+			else
+			{
+				statistics().record_database_time(std::chrono::steady_clock::now() - m_start);
+			}
+		}
+	}
+
+private:
+	static inline thread_local int s_depth = 0;
+
+	std::optional<PacketType> m_request;
+
+	std::chrono::steady_clock::time_point m_start;
+};
+
+// marks the start and finish of handling a single request
+class RequestTimer
+{
+public:
+	explicit RequestTimer(PacketType type)
+	{
+		statistics().start_request(type);
+	}
+
+	RequestTimer(const RequestTimer&) = delete;
+	RequestTimer& operator=(const RequestTimer&) = delete;
+
+	~RequestTimer()
+	{
+		statistics().finish_request();
+	}
+};
@@ -0,0 +1,102 @@
+#include "task_deltas.hpp"
+
+#include "server.hpp"
+
+#include <functional>
+
+static std::size_t session_hash(const TaskTimes& session)
+{
+	std::size_t hash = std::hash<std::int64_t>{}(session.start.count());
+
+	const auto combine = [&](std::int64_t value)
+		{
+			hash ^= std::hash<std::int64_t>{}(value) + 0x9e3779b97f4a7c15 + (hash << 6) + (hash >> 2);
+		};
+
+	combine(session.stop.has_value());
+	combine(session.stop.value_or(std::chrono::milliseconds(0)).count());
+
+	for (auto&& entry : session.timeEntry)
+	{
+		combine(entry.categoryID._val);
+		combine(entry.codeID._val);
+	}
+	return hash;
+}
+
+TaskDeltas::Change TaskDeltas::update(const Task& task, const std::vector<TaskTimes>& sessions)
+{
+	std::vector<std::size_t> hashes;
+	hashes.reserve(sessions.size());
+
+	for (const TaskTimes& session : sessions)
+	{
+		hashes.push_back(session_hash(session));
+	}
+
+	auto [it, inserted] = m_sent.try_emplace(task.taskID());
+	SentTask& sent = it->second;
+
+	Change change;
+
+	if (!inserted)
+	{
+		change.delta = std::make_unique<TaskInfoDeltaMessage>(task.taskID());
+		change.base = sent.version;
+
+		auto& delta = change.delta;
+
+		const auto check = [&](auto& sentValue, const auto& value, TaskInfoDeltaMessage::Field field, auto& deltaValue)
+			{
+				if (sentValue != value)
+				{
+					delta->changed |= field;
+					deltaValue = value;
+				}
+			};
+
+		check(sent.parentID, task.parentID(), TaskInfoDeltaMessage::PARENT, delta->parentID);
+		check(sent.name, task.m_name, TaskInfoDeltaMessage::NAME, delta->name);
+		check(sent.state, task.state, TaskInfoDeltaMessage::STATE, delta->state);
+		check(sent.indexInParent, task.indexInParent, TaskInfoDeltaMessage::INDEX_IN_PARENT, delta->indexInParent);
+		check(sent.serverControlled, task.serverControlled, TaskInfoDeltaMessage::SERVER_CONTROLLED, delta->serverControlled);
+		check(sent.locked, task.locked, TaskInfoDeltaMessage::LOCKED, delta->locked);
+		check(sent.finishTime, task.m_finishTime, TaskInfoDeltaMessage::FINISH_TIME, delta->finishTime);
+		check(sent.timeEntry, task.timeEntry, TaskInfoDeltaMessage::TIME_ENTRY, delta->timeEntry);
+
+		// the labels of the message are plain strings
+		if (sent.labels != task.labels)
+		{
+			delta->changed |= TaskInfoDeltaMessage::LABELS;
+			delta->labels.assign(task.labels.begin(), task.labels.end());
+		}
+
+		// sessions are almost always added or stopped at the end, only send from the first one that's different
+		const auto mismatch = std::mismatch(sent.sessions.begin(), sent.sessions.end(), hashes.begin(), hashes.end());
+		const auto first = static_cast<std::size_t>(mismatch.second - hashes.begin());
+
+		if (first != hashes.size() || sent.sessions.size() != hashes.size())
+		{
+			delta->changed |= TaskInfoDeltaMessage::SESSIONS;
+			delta->sessionCount = static_cast<std::int32_t>(sessions.size());
+			delta->firstSession = static_cast<std::int32_t>(first);
+			delta->sessions.assign(sessions.begin() + first, sessions.end());
+		}
+	}
+
+	change.version = m_nextVersion++;
+
+	sent.version = change.version;
+	sent.parentID = task.parentID();
+	sent.name = task.m_name;
+	sent.state = task.state;
+	sent.indexInParent = task.indexInParent;
+	sent.serverControlled = task.serverControlled;
+	sent.locked = task.locked;
+	sent.finishTime = task.m_finishTime;
+	sent.sessions = std::move(hashes);
+	sent.labels = task.labels;
+	sent.timeEntry = task.timeEntry;
+
+	return change;
+}
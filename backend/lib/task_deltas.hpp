@@ -0,0 +1,66 @@
+#pragma once
+
+#include "interned_string.hpp"
+
+#include "packets/small_vector.hpp"
+#include "packets/task_id.hpp"
+#include "packets/task_info_delta.hpp"
+#include "packets/task_state.hpp"
+#include "packets/task_times.hpp"
+#include "packets/time_entry.hpp"
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+class Task;
+
+// remembers what was last broadcast for each task so that its next change can be sent as a TASK_INFO_DELTA. sessions
+// are remembered by their hash, a task with thousands of sessions isn't kept twice
+//
+// every broadcast of a task gets a new version. a delta only applies for clients that received the broadcast with the
+// version it's based on, see Broadcaster
+class TaskDeltas
+{
+public:
+	struct Change
+	{
+		// the changes since the task was last broadcast, nullptr if it hasn't been
+		std::unique_ptr<TaskInfoDeltaMessage> delta;
+
+		// version of the last broadcast that the delta is against, 0 without a delta
+		std::uint64_t base = 0;
+		std::uint64_t version = 0;
+	};
+
+	// either way the task is remembered as it is now, with a new version
+	Change update(const Task& task, const std::vector<TaskTimes>& sessions);
+
+	void forget(TaskID task) { m_sent.erase(task); }
+
+private:
+	struct SentTask
+	{
+		std::uint64_t version = 0;
+		TaskID parentID;
+		InternedString name;
+		TaskState state = TaskState::PENDING;
+		std::int32_t indexInParent = 0;
+		bool serverControlled = false;
+		bool locked = false;
+		std::optional<std::chrono::milliseconds> finishTime;
+		std::vector<std::size_t> sessions;
+		SmallVector<InternedString, 2> labels;
+		SmallVector<TimeEntry, 2> timeEntry;
+	};
+
+	std::unordered_map<TaskID, SentTask> m_sent;
+
+	// versions aren't reused, not even by a task that's forgotten and broadcast again
+	std::uint64_t m_nextVersion = 1;
+};
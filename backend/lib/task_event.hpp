@@ -0,0 +1,26 @@
+#pragma once
+
+#include <cstdint>
+
+// what changed about a task. storage that can record the change by itself, like the event journal, only has to write
+// the fields the event touches instead of the whole task
+enum class TaskEventType : std::int8_t
+{
+	CREATED,
+	SESSION_STARTED,
+	SESSION_STOPPED,
+	FINISHED,
+	RENAMED,
+	REPARENTED,
+	TIME_ENTRY_CHANGED,
+	// anything else, the whole task is written
+	UPDATED,
+};
+
+struct TaskEvent
+{
+	TaskEventType type = TaskEventType::UPDATED;
+
+	// index of the session that SESSION_STARTED, SESSION_STOPPED and FINISHED changed, -1 if FINISHED didn't stop a session
+	std::int32_t session = -1;
+};
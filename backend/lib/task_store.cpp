@@ -0,0 +1,214 @@
+#include "task_store.hpp"
+#include "server.hpp"
+
+#include <array>
+#include <optional>
+
+struct TaskChunk
+{
+	std::array<std::optional<Task>, TaskStore::CHUNK_SIZE> tasks;
+};
+
+static void copy_fields(TaskStore::Record& record, const Task& task)
+{
+	record.finishTime = task.m_finishTime ? task.m_finishTime->count() : TaskStore::NO_FINISH_TIME;
+	record.indexInParent = task.indexInParent;
+	record.state = task.state;
+	record.flags = (task.serverControlled ? TaskStore::SERVER_CONTROLLED : 0) | (task.locked ? TaskStore::LOCKED : 0);
+}
+
+TaskStore::TaskStore() = default;
+TaskStore::~TaskStore() = default;
+
+Task& TaskStore::insert(const Task& task)
+{
+	const TaskID id = task.taskID();
+
+	if (const std::uint32_t slot = slot_of(id); slot != NO_SLOT)
+	{
+		*m_tasks[slot] = task;
+
+		copy_fields(m_records[slot], task);
+
+		if (m_records[slot].parentID != task.parentID())
+		{
+			unlink(slot);
+			link(slot, task.parentID());
+		}
+		return *m_tasks[slot];
+	}
+
+	const std::uint32_t slot = allocate_slot();
+
+	std::optional<Task>& stored = m_chunks[slot / CHUNK_SIZE]->tasks[slot % CHUNK_SIZE];
+	stored.emplace(task);
+
+	m_tasks[slot] = &*stored;
+	m_records[slot].id = id;
+
+	copy_fields(m_records[slot], task);
+
+	if (static_cast<std::size_t>(id._val) >= m_slots.size())
+	{
+		m_slots.resize(id._val + 1, NO_SLOT);
+	}
+	m_slots[id._val] = slot;
+
+	link(slot, task.parentID());
+
+	m_size++;
+
+	return *stored;
+}
+
+void TaskStore::erase(TaskID id)
+{
+	const std::uint32_t slot = slot_of(id);
+
+	if (slot == NO_SLOT)
+	{
+		return;
+	}
+
+	unlink(slot);
+
+	m_chunks[slot / CHUNK_SIZE]->tasks[slot % CHUNK_SIZE].reset();
+	m_tasks[slot] = nullptr;
+
+	Record& record = m_records[slot];
+	record.id = NO_PARENT;
+	record.parentID = NO_PARENT;
+	record.generation++;
+	record.finishTime = NO_FINISH_TIME;
+	record.indexInParent = 0;
+	record.state = TaskState::PENDING;
+	record.flags = 0;
+
+	m_slots[id._val] = NO_SLOT;
+	m_freeSlots.push_back(slot);
+
+	m_size--;
+}
+
+void TaskStore::update(const Task& task)
+{
+	if (const std::uint32_t slot = slot_of(task.taskID()); slot != NO_SLOT)
+	{
+		copy_fields(m_records[slot], task);
+	}
+}
+
+void TaskStore::set_parent(TaskID id, TaskID parentID)
+{
+	const std::uint32_t slot = slot_of(id);
+
+	if (slot == NO_SLOT || m_records[slot].parentID == parentID)
+	{
+		return;
+	}
+
+	unlink(slot);
+	link(slot, parentID);
+}
+
+std::uint32_t TaskStore::allocate_slot()
+{
+	if (!m_freeSlots.empty())
+	{
+		const std::uint32_t slot = m_freeSlots.back();
+		m_freeSlots.pop_back();
+		return slot;
+	}
+
+	const auto slot = static_cast<std::uint32_t>(m_records.size());
+
+	if (slot % CHUNK_SIZE == 0)
+	{
+		m_chunks.push_back(std::make_unique<TaskChunk>());
+	}
+
+	m_records.emplace_back();
+	m_tasks.push_back(nullptr);
+
+	return slot;
+}
+
+void TaskStore::link(std::uint32_t slot, TaskID parentID)
+{
+	if (static_cast<std::size_t>(parentID._val) >= m_children.size())
+	{
+		m_children.resize(parentID._val + 1);
+	}
+
+	ChildList& list = m_children[parentID._val];
+	Record& record = m_records[slot];
+
+	record.parentID = parentID;
+
+	// new tasks have the highest ID so far and go on the end. only reparenting has to look for the place
+	std::uint32_t next = NO_SLOT;
+
+	if (list.last != NO_SLOT && m_records[list.last].id > record.id)
+	{
+		next = list.first;
+
+		while (m_records[next].id < record.id)
+		{
+			next = m_records[next].nextSibling;
+		}
+	}
+
+	const std::uint32_t previous = next != NO_SLOT ? m_records[next].previousSibling : list.last;
+
+	record.previousSibling = previous;
+	record.nextSibling = next;
+
+	if (previous != NO_SLOT)
+	{
+		m_records[previous].nextSibling = slot;
+	}
+	else
+	{
+		list.first = slot;
+	}
+
+	if (next != NO_SLOT)
+	{
+		m_records[next].previousSibling = slot;
+	}
+	else
+	{
+		list.last = slot;
+	}
+
+	list.count++;
+}
+
+void TaskStore::unlink(std::uint32_t slot)
+{
+	Record& record = m_records[slot];
+	ChildList& list = m_children[record.parentID._val];
+
+	if (record.previousSibling != NO_SLOT)
+	{
+		m_records[record.previousSibling].nextSibling = record.nextSibling;
+	}
+	else
+	{
+		list.first = record.nextSibling;
+	}
+
+	if (record.nextSibling != NO_SLOT)
+	{
+		m_records[record.nextSibling].previousSibling = record.previousSibling;
+	}
+	else
+	{
+		list.last = record.previousSibling;
+	}
+
+	record.previousSibling = NO_SLOT;
+	record.nextSibling = NO_SLOT;
+
+	list.count--;
+}
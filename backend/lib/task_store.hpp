@@ -0,0 +1,268 @@
+#pragma once
+
+#include "packets/task_id.hpp"
+#include "packets/task_state.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <memory>
+#include <span>
+#include <vector>
+
+class Task;
+struct TaskChunk;
+
+// a task in the store that can be kept across requests. unlike a TaskID it won't find a different task that was
+// given the same slot after this one was removed
+struct TaskHandle
+{
+	std::uint32_t slot = UINT32_MAX;
+	std::uint32_t generation = 0;
+
+	friend bool operator==(const TaskHandle&, const TaskHandle&) = default;
+};
+
+// the tasks in memory, in a slot map instead of a node per task
+//
+// every slot has a small record with what walking and filtering the tree needs: the IDs, links to the previous and
+// next sibling in ID order and a copy of the task's state, finish time, index and flags. the records are kept together
+// in one array so that tree walks don't touch the tasks themselves. the tasks, with their names, sessions and
+// everything else, live in chunks that never move, so a Task* stays valid until the task is removed
+//
+// the copies are taken by insert and update. anything that changes those fields of a stored task calls update after
+//
+// lookups by ID go through an array indexed by the ID. task IDs are handed out in order so it's as dense as the tasks
+class TaskStore
+{
+public:
+	static constexpr std::uint32_t NO_SLOT = UINT32_MAX;
+
+	// tasks per chunk of memory
+	static constexpr std::size_t CHUNK_SIZE = 64;
+
+	struct Record
+	{
+		// NO_PARENT while the slot is free
+		TaskID id = NO_PARENT;
+		TaskID parentID = NO_PARENT;
+
+		// incremented every time the slot is freed
+		std::uint32_t generation = 0;
+
+		std::uint32_t previousSibling = NO_SLOT;
+		std::uint32_t nextSibling = NO_SLOT;
+
+		// NO_FINISH_TIME until the task is finished
+		std::int64_t finishTime = NO_FINISH_TIME;
+		std::int32_t indexInParent = 0;
+		TaskState state = TaskState::PENDING;
+		std::uint8_t flags = 0;
+	};
+
+	static constexpr std::int64_t NO_FINISH_TIME = INT64_MAX;
+
+	// Record::flags
+	static constexpr std::uint8_t SERVER_CONTROLLED = 1;
+	static constexpr std::uint8_t LOCKED = 2;
+
+	// the children of a task in ID order. following the sibling links of the records
+	class Children
+	{
+	public:
+		class iterator
+		{
+		public:
+			using iterator_category = std::forward_iterator_tag;
+			using value_type = TaskID;
+			using difference_type = std::ptrdiff_t;
+			using pointer = const TaskID*;
+			using reference = const TaskID&;
+
+			iterator() = default;
+			iterator(const Record* records, std::uint32_t slot) : m_records(records), m_slot(slot) {}
+
+			const TaskID& operator*() const { return m_records[m_slot].id; }
+
+			iterator& operator++()
+			{
+				m_slot = m_records[m_slot].nextSibling;
+				return *this;
+			}
+
+			iterator operator++(int)
+			{
+				iterator previous = *this;
+				++*this;
+				return previous;
+			}
+
+			friend bool operator==(const iterator& a, const iterator& b) { return a.m_slot == b.m_slot; }
+
+		private:
+			const Record* m_records = nullptr;
+			std::uint32_t m_slot = NO_SLOT;
+		};
+
+		Children(const Record* records, std::uint32_t first, std::size_t count) : m_records(records), m_first(first), m_count(count) {}
+
+		iterator begin() const { return iterator(m_records, m_first); }
+		iterator end() const { return iterator(m_records, NO_SLOT); }
+
+		std::size_t size() const { return m_count; }
+		bool empty() const { return m_count == 0; }
+
+	private:
+		const Record* m_records;
+		std::uint32_t m_first;
+		std::size_t m_count;
+	};
+
+	TaskStore();
+	~TaskStore();
+
+	TaskStore(const TaskStore&) = delete;
+	TaskStore& operator=(const TaskStore&) = delete;
+
+	std::size_t size() const { return m_size; }
+
+	bool contains(TaskID id) const { return slot_of(id) != NO_SLOT; }
+
+	Task* find(TaskID id)
+	{
+		const std::uint32_t slot = slot_of(id);
+
+		return slot != NO_SLOT ? m_tasks[slot] : nullptr;
+	}
+
+	const Task* find(TaskID id) const
+	{
+		const std::uint32_t slot = slot_of(id);
+
+		return slot != NO_SLOT ? m_tasks[slot] : nullptr;
+	}
+
+	TaskHandle handle(TaskID id) const
+	{
+		const std::uint32_t slot = slot_of(id);
+
+		return slot != NO_SLOT ? TaskHandle{ slot, m_records[slot].generation } : TaskHandle{};
+	}
+
+	// nullptr once the task has been removed
+	Task* find(TaskHandle handle)
+	{
+		if (handle.slot >= m_records.size() || m_records[handle.slot].generation != handle.generation)
+		{
+			return nullptr;
+		}
+		return m_tasks[handle.slot];
+	}
+
+	const Task* find(TaskHandle handle) const
+	{
+		if (handle.slot >= m_records.size() || m_records[handle.slot].generation != handle.generation)
+		{
+			return nullptr;
+		}
+		return m_tasks[handle.slot];
+	}
+
+	// nullptr when there's no task with the ID
+	const Record* record(TaskID id) const
+	{
+		const std::uint32_t slot = slot_of(id);
+
+		return slot != NO_SLOT ? &m_records[slot] : nullptr;
+	}
+
+	// adds the task, or replaces the task with the same ID in place
+	Task& insert(const Task& task);
+
+	void erase(TaskID id);
+
+	// copies the state, finish time, index and flags of a task that was changed in place into its record
+	void update(const Task& task);
+
+	// moves the task to the children of another parent. the task's own parent ID is up to the caller
+	void set_parent(TaskID id, TaskID parentID);
+
+	Children children(TaskID parentID) const
+	{
+		if (parentID._val < 0 || static_cast<std::size_t>(parentID._val) >= m_children.size())
+		{
+			return Children(m_records.data(), NO_SLOT, 0);
+		}
+
+		const ChildList& list = m_children[parentID._val];
+
+		return Children(m_records.data(), list.first, list.count);
+	}
+
+	// one record per slot, including the free ones
+	std::span<const Record> records() const { return m_records; }
+
+	// every task in slot order, the fastest way through all of them
+	template<typename Func>
+	void for_each(Func&& func)
+	{
+		for (std::size_t slot = 0; slot < m_records.size(); slot++)
+		{
+			if (m_records[slot].id != NO_PARENT)
+			{
+				func(*m_tasks[slot]);
+			}
+		}
+	}
+
+	// every task in ID order
+	template<typename Func>
+	void for_each_sorted(Func&& func)
+	{
+		for (std::uint32_t slot : m_slots)
+		{
+			if (slot != NO_SLOT)
+			{
+				func(*m_tasks[slot]);
+			}
+		}
+	}
+
+private:
+	struct ChildList
+	{
+		std::uint32_t first = NO_SLOT;
+		std::uint32_t last = NO_SLOT;
+		std::uint32_t count = 0;
+	};
+
+	std::uint32_t slot_of(TaskID id) const
+	{
+		if (id._val <= 0 || static_cast<std::size_t>(id._val) >= m_slots.size())
+		{
+			return NO_SLOT;
+		}
+		return m_slots[id._val];
+	}
+
+	std::uint32_t allocate_slot();
+
+	void link(std::uint32_t slot, TaskID parentID);
+	void unlink(std::uint32_t slot);
+
+	std::vector<Record> m_records;
+
+	// the task in each slot, nullptr for free slots
+	std::vector<Task*> m_tasks;
+
+	std::vector<std::unique_ptr<TaskChunk>> m_chunks;
+	std::vector<std::uint32_t> m_freeSlots;
+
+	// slot of each task, indexed by task ID
+	std::vector<std::uint32_t> m_slots;
+
+	// children of each task, indexed by the parent's task ID. 0 for the top level
+	std::vector<ChildList> m_children;
+
+	std::size_t m_size = 0;
+};
@@ -0,0 +1,101 @@
+#include "trace.hpp"
+
+#include <format>
+
+namespace
+{
+	// small sequential IDs read better in the trace viewer than hashed thread IDs
+	int current_thread_id()
+	{
+		static std::atomic<int> nextID = 1;
+		thread_local int id = nextID++;
+
+		return id;
+	}
+
+	// the server is usually stopped by killing it, so events are written out regularly instead of only at close
+	constexpr std::size_t FLUSH_SIZE = 64 * 1024;
+	constexpr auto FLUSH_INTERVAL = std::chrono::seconds(1);
+}
+
+bool Tracer::open(const std::string& file)
+{
+	std::lock_guard lock(m_mutex);
+
+	m_file = std::ofstream(file, std::ios::trunc);
+
+	if (!m_file)
+	{
+		return false;
+	}
+
+	m_origin = std::chrono::steady_clock::now();
+	m_lastFlush = m_origin;
+	m_firstEvent = true;
+
+	// the closing bracket is optional in the trace format, a trace cut short by killing the server is still readable
+	m_file << "[\n";
+
+	s_enabled.store(true, std::memory_order_relaxed);
+
+	return true;
+}
+
+void Tracer::close()
+{
+	std::lock_guard lock(m_mutex);
+
+	if (!m_file.is_open())
+	{
+		return;
+	}
+
+	s_enabled.store(false, std::memory_order_relaxed);
+
+	flush();
+
+	m_file << "\n]\n";
+	m_file.close();
+}
+
+void Tracer::record(std::string_view name, std::string_view category, std::chrono::steady_clock::time_point start, std::chrono::steady_clock::time_point finish)
+{
+	const auto timestamp = std::chrono::duration<double, std::micro>(start - m_origin).count();
+	const auto duration = std::chrono::duration<double, std::micro>(finish - start).count();
+	const int thread = current_thread_id();
+
+	std::lock_guard lock(m_mutex);
+
+	if (!m_file.is_open())
+	{
+		return;
+	}
+
+	if (!m_firstEvent)
+	{
+		m_buffer += ",\n";
+	}
+	m_firstEvent = false;
+
+	std::format_to(std::back_inserter(m_buffer), R"({{"name":"{}","cat":"{}","ph":"X","ts":{:.3f},"dur":{:.3f},"pid":1,"tid":{}}})", name, category, timestamp, duration, thread);
+
+	if (m_buffer.size() >= FLUSH_SIZE || finish - m_lastFlush >= FLUSH_INTERVAL)
+	{
+		flush();
+	}
+}
+
+void Tracer::flush()
+{
+	m_file << m_buffer;
+	m_file.flush();
+
+	m_buffer.clear();
+	m_lastFlush = std::chrono::steady_clock::now();
+}
+
+Tracer& tracer()
+{
+	static Tracer tracer;
+	return tracer;
+}
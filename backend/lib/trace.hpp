@@ -0,0 +1,80 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <string_view>
+
+// writes spans in the chrome trace event format. the output can be opened with Perfetto (ui.perfetto.dev)
+//
+// tracing is off until a file is opened. spans created while tracing is off cost a single branch
+class Tracer
+{
+public:
+	static bool enabled() { return s_enabled.load(std::memory_order_relaxed); }
+
+	bool open(const std::string& file);
+	void close();
+
+	void record(std::string_view name, std::string_view category, std::chrono::steady_clock::time_point start, std::chrono::steady_clock::time_point finish);
+
+private:
+	void flush();
+
+	static inline std::atomic<bool> s_enabled = false;
+
+	std::mutex m_mutex;
+	std::ofstream m_file;
+	std::string m_buffer;
+	bool m_firstEvent = true;
+
+	std::chrono::steady_clock::time_point m_origin;
+	std::chrono::steady_clock::time_point m_lastFlush;
+};
+
+Tracer& tracer();
+
+// records the time from construction to destruction as a single complete event
+class TraceSpan
+{
+public:
+	TraceSpan(std::string_view name, std::string_view category)
+	{
+		if (Tracer::enabled()) [[unlikely]]
+		{
+			m_name = name;
+			m_category = category;
+			m_start = std::chrono::steady_clock::now();
+			m_active = true;
+		}
+	}
+
+	TraceSpan(const TraceSpan&) = delete;
+	TraceSpan& operator=(const TraceSpan&) = delete;
+
+	~TraceSpan()
+	{
+		if (m_active) [[unlikely]]
+		{
+			tracer().record(m_name, m_category, m_start, std::chrono::steady_clock::now());
+		}
+	}
+
+private:
+	bool m_active = false;
+	std::string_view m_name;
+	std::string_view m_category;
+	std::chrono::steady_clock::time_point m_start;
+};
+
+// names and categories must outlive the span, string literals or magic_enum names
+#define TG_TRACE_CONCAT_(a, b) a##b
+#define TG_TRACE_CONCAT(a, b) TG_TRACE_CONCAT_(a, b)
+
+#ifdef TG_ENABLE_TRACING
+#define TG_TRACE_SPAN(name, category) TraceSpan TG_TRACE_CONCAT(trace_span_, __LINE__)(name, category)
+#else
+#define TG_TRACE_SPAN(name, category)
+#endif
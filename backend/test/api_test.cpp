@@ -5,10 +5,13 @@
 #include "server.hpp"
 #include "packets.hpp"
 #include "utils.h"
+#include "statistics.hpp"
+#include "trace.hpp"
 
 #include <vector>
 #include <source_location>
 #include <fstream>
+#include <random>
 
 using namespace std::chrono_literals;
 
@@ -25,8 +28,8 @@ static const TimeCategory TEST_TIME_CATEGORY_3 = TimeCategory(TimeCategoryID(3),
 static const TimeCategory TEST_TIME_CATEGORY_4 = TimeCategory(TimeCategoryID(4), "Test Category 4");
 static const TimeCategory TEST_TIME_CATEGORY_5 = TimeCategory(TimeCategoryID(5), "Test Category 5");
 
-static const TimeEntry TEST_TIME_ENTRY_1 = TimeEntry(TEST_TIME_CATEGORY_1, TEST_TIME_CODE_1);
-static const TimeEntry TEST_TIME_ENTRY_2 = TimeEntry(TEST_TIME_CATEGORY_2, TEST_TIME_CODE_2);
+static const TimeEntry TEST_TIME_ENTRY_1 = TimeEntry{ TEST_TIME_CATEGORY_1.id, TEST_TIME_CODE_1.id };
+static const TimeEntry TEST_TIME_ENTRY_2 = TimeEntry{ TEST_TIME_CATEGORY_2.id, TEST_TIME_CODE_2.id };
 
 TEST_CASE("no parent ID is 0", "[task]")
 {
@@ -67,7 +70,7 @@ TEST_CASE("Create Task", "[api][task]")
 	SECTION("Success - Create Task Time Entry")
 	{
 		auto create = CreateTaskMessage(NO_PARENT, helper.next_request_id(), "test 1");
-		create.timeEntry = std::vector{ TEST_TIME_ENTRY_1, TEST_TIME_ENTRY_2 };
+		create.timeEntry = { TEST_TIME_ENTRY_1, TEST_TIME_ENTRY_2 };
 
 		helper.expect_success(create);
 
@@ -77,7 +80,7 @@ TEST_CASE("Create Task", "[api][task]")
 		taskInfo.state = TaskState::PENDING;
 		taskInfo.newTask = true;
 
-		taskInfo.timeEntry = std::vector{ TEST_TIME_ENTRY_1, TEST_TIME_ENTRY_2 };
+		taskInfo.timeEntry = { TEST_TIME_ENTRY_1, TEST_TIME_ENTRY_2 };
 		
 		helper.required_messages({ &taskInfo });
 	}
@@ -212,7 +215,7 @@ TEST_CASE("Start Task - Time Entry", "[api][task]")
 	SECTION("Success")
 	{
 		CreateTaskMessage create(NO_PARENT, helper.next_request_id(), "test 1");
-		create.timeEntry = std::vector{ TEST_TIME_ENTRY_1, TEST_TIME_ENTRY_2 };
+		create.timeEntry = { TEST_TIME_ENTRY_1, TEST_TIME_ENTRY_2 };
 
 		helper.expect_success(create);
 		
@@ -224,12 +227,12 @@ TEST_CASE("Start Task - Time Entry", "[api][task]")
 
 		TaskTimes times;
 		times.start = std::chrono::milliseconds(1737344939870);
-		times.timeEntry = std::vector{ TEST_TIME_ENTRY_1, TEST_TIME_ENTRY_2 };
+		times.timeEntry = { TEST_TIME_ENTRY_1, TEST_TIME_ENTRY_2 };
 
 		taskInfo.times.push_back(times);
 		taskInfo.state = TaskState::ACTIVE;
 		taskInfo.newTask = false;
-		taskInfo.timeEntry = std::vector{ TEST_TIME_ENTRY_1, TEST_TIME_ENTRY_2 };
+		taskInfo.timeEntry = { TEST_TIME_ENTRY_1, TEST_TIME_ENTRY_2 };
 
 		helper.required_messages({ &taskInfo });
 	}
@@ -237,12 +240,12 @@ TEST_CASE("Start Task - Time Entry", "[api][task]")
 	SECTION("Time codes on task take priority over parent")
 	{
 		CreateTaskMessage create1(NO_PARENT, helper.next_request_id(), "test 1");
-		create1.timeEntry = std::vector{ TEST_TIME_ENTRY_1, TEST_TIME_ENTRY_2 };
+		create1.timeEntry = { TEST_TIME_ENTRY_1, TEST_TIME_ENTRY_2 };
 
 		helper.expect_success(create1);
 
 		CreateTaskMessage create2(TaskID(1), helper.next_request_id(), "test 2");
-		create2.timeEntry = std::vector{ TEST_TIME_ENTRY_1, TEST_TIME_ENTRY_2 };
+		create2.timeEntry = { TEST_TIME_ENTRY_1, TEST_TIME_ENTRY_2 };
 
 		helper.expect_success(create2);
 
@@ -256,12 +259,12 @@ TEST_CASE("Start Task - Time Entry", "[api][task]")
 
 		TaskTimes times;
 		times.start = std::chrono::milliseconds(1737345839870);
-		times.timeEntry = std::vector{ TEST_TIME_ENTRY_1, TEST_TIME_ENTRY_2 };
+		times.timeEntry = { TEST_TIME_ENTRY_1, TEST_TIME_ENTRY_2 };
 
 		taskInfo.times.push_back(times);
 		taskInfo.state = TaskState::ACTIVE;
 		taskInfo.newTask = false;
-		taskInfo.timeEntry = std::vector{ TEST_TIME_ENTRY_1, TEST_TIME_ENTRY_2 };
+		taskInfo.timeEntry = { TEST_TIME_ENTRY_1, TEST_TIME_ENTRY_2 };
 
 		helper.required_messages({ &taskInfo });
 	}
@@ -269,7 +272,7 @@ TEST_CASE("Start Task - Time Entry", "[api][task]")
 	SECTION("Inherit from parent if no time code is found for category")
 	{
 		CreateTaskMessage create1(NO_PARENT, helper.next_request_id(), "test 1");
-		create1.timeEntry = std::vector{ TEST_TIME_ENTRY_1, TEST_TIME_ENTRY_2 };
+		create1.timeEntry = { TEST_TIME_ENTRY_1, TEST_TIME_ENTRY_2 };
 
 		helper.expect_success(create1);
 
@@ -287,7 +290,7 @@ TEST_CASE("Start Task - Time Entry", "[api][task]")
 
 		TaskTimes times;
 		times.start = std::chrono::milliseconds(1737345839870);
-		times.timeEntry = std::vector{ TEST_TIME_ENTRY_1, TEST_TIME_ENTRY_2 };
+		times.timeEntry = { TEST_TIME_ENTRY_1, TEST_TIME_ENTRY_2 };
 
 		taskInfo.times.push_back(times);
 		taskInfo.state = TaskState::ACTIVE;
@@ -299,7 +302,7 @@ TEST_CASE("Start Task - Time Entry", "[api][task]")
 	SECTION("Move to next parent if parent has no time codes")
 	{
 		CreateTaskMessage create1(NO_PARENT, helper.next_request_id(), "test 1");
-		create1.timeEntry = std::vector{ TEST_TIME_ENTRY_1, TEST_TIME_ENTRY_2 };
+		create1.timeEntry = { TEST_TIME_ENTRY_1, TEST_TIME_ENTRY_2 };
 
 		helper.expect_success(create1);
 
@@ -319,7 +322,7 @@ TEST_CASE("Start Task - Time Entry", "[api][task]")
 
 		TaskTimes times;
 		times.start = std::chrono::milliseconds(1737346739870);
-		times.timeEntry = std::vector{ TEST_TIME_ENTRY_1, TEST_TIME_ENTRY_2 };
+		times.timeEntry = { TEST_TIME_ENTRY_1, TEST_TIME_ENTRY_2 };
 
 		taskInfo.times.push_back(times);
 		taskInfo.state = TaskState::ACTIVE;
@@ -338,7 +341,7 @@ TEST_CASE("Start Task - Time Entry", "[api][task]")
 		helper.expect_success(addTimeEntry);
 
 		CreateTaskMessage create1(NO_PARENT, helper.next_request_id(), "test 1");
-		create1.timeEntry = std::vector{ TEST_TIME_ENTRY_1, TEST_TIME_ENTRY_2 };
+		create1.timeEntry = { TEST_TIME_ENTRY_1, TEST_TIME_ENTRY_2 };
 
 		helper.expect_success(create1);
 
@@ -346,7 +349,7 @@ TEST_CASE("Start Task - Time Entry", "[api][task]")
 		helper.expect_success(create2);
 
 		CreateTaskMessage create3(TaskID(2), helper.next_request_id(), "test 3");
-		create3.timeEntry = std::vector{ TimeEntry{TEST_TIME_CATEGORY_1, TimeCode(TimeCodeID(5), "Five") } };
+		create3.timeEntry = { TimeEntry{ TEST_TIME_CATEGORY_1.id, TimeCodeID(5) } };
 
 		helper.expect_success(create3);
 
@@ -360,12 +363,12 @@ TEST_CASE("Start Task - Time Entry", "[api][task]")
 
 		TaskTimes times;
 		times.start = std::chrono::milliseconds(1737346739870);
-		times.timeEntry = std::vector{ TimeEntry{TEST_TIME_CATEGORY_1, TimeCode(TimeCodeID(5), "Five") }, TEST_TIME_ENTRY_2, TimeEntry{ TimeCategory(TimeCategoryID(3), "Three"), TEST_TIME_CODE_UNKNOWN } };
+		times.timeEntry = { TimeEntry{ TEST_TIME_CATEGORY_1.id, TimeCodeID(5) }, TEST_TIME_ENTRY_2, TimeEntry{ TimeCategoryID(3), TEST_TIME_CODE_UNKNOWN.id } };
 
 		taskInfo.times.push_back(times);
 		taskInfo.state = TaskState::ACTIVE;
 		taskInfo.newTask = false;
-		taskInfo.timeEntry = std::vector{ TimeEntry{TEST_TIME_CATEGORY_1, TimeCode(TimeCodeID(5), "Five") } };
+		taskInfo.timeEntry = { TimeEntry{ TEST_TIME_CATEGORY_1.id, TimeCodeID(5) } };
 
 		helper.required_messages({ &taskInfo });
 	}
@@ -392,7 +395,7 @@ TEST_CASE("Start Task - Time Entry", "[api][task]")
 
 		TaskTimes times;
 		times.start = std::chrono::milliseconds(1737346739870);
-		times.timeEntry = std::vector{ TimeEntry{ TEST_TIME_CATEGORY_1, TEST_TIME_CODE_UNKNOWN }, TimeEntry{ TEST_TIME_CATEGORY_2, TEST_TIME_CODE_UNKNOWN } };
+		times.timeEntry = { TimeEntry{ TEST_TIME_CATEGORY_1.id, TEST_TIME_CODE_UNKNOWN.id }, TimeEntry{ TEST_TIME_CATEGORY_2.id, TEST_TIME_CODE_UNKNOWN.id } };
 
 		taskInfo.times.push_back(times);
 		taskInfo.state = TaskState::ACTIVE;
@@ -418,7 +421,7 @@ TEST_CASE("Start Task - Empty Time Entry", "[api][task]")
 
 	TaskTimes times;
 	times.start = std::chrono::milliseconds(1737344939870);
-	times.timeEntry = std::vector{ TimeEntry{ TimeCategory(TimeCategoryID(0), "Unknown"), TEST_TIME_CODE_UNKNOWN } };
+	times.timeEntry = { TimeEntry{ TimeCategoryID(0), TEST_TIME_CODE_UNKNOWN.id } };
 
 	taskInfo.times.push_back(times);
 	taskInfo.state = TaskState::ACTIVE;
@@ -751,7 +754,7 @@ TEST_CASE("Modify Task", "[api][task]")
 		helper.expect_success(CreateTaskMessage(NO_PARENT, helper.next_request_id(), "test"));
 
 		UpdateTaskMessage update(helper.next_request_id(), TaskID(1), NO_PARENT, "test");
-		update.timeEntry = std::vector{ TEST_TIME_ENTRY_1, TEST_TIME_ENTRY_2 };
+		update.timeEntry = { TEST_TIME_ENTRY_1, TEST_TIME_ENTRY_2 };
 
 		helper.expect_success(update);
 
@@ -760,7 +763,7 @@ TEST_CASE("Modify Task", "[api][task]")
 		taskInfo.createTime = std::chrono::milliseconds(1737344039870);
 		taskInfo.state = TaskState::PENDING;
 		taskInfo.newTask = false;
-		taskInfo.timeEntry = std::vector{ TEST_TIME_ENTRY_1, TEST_TIME_ENTRY_2 };
+		taskInfo.timeEntry = { TEST_TIME_ENTRY_1, TEST_TIME_ENTRY_2 };
 
 		helper.required_messages({ &taskInfo });
 	}
@@ -837,7 +840,7 @@ TEST_CASE("Modify Task", "[api][task]")
 		taskInfo.createTime = std::chrono::milliseconds(1737344039870);
 		taskInfo.state = TaskState::ACTIVE;
 		taskInfo.newTask = false;
-		taskInfo.times.emplace_back(1737344939870ms, std::nullopt, std::vector{ TimeEntry{TEST_TIME_CATEGORY_UNKNOWN, TEST_TIME_CODE_UNKNOWN} });
+		taskInfo.times.emplace_back(1737344939870ms, std::nullopt, SmallVector<TimeEntry, 2>{ TimeEntry{ TEST_TIME_CATEGORY_UNKNOWN.id, TEST_TIME_CODE_UNKNOWN.id } });
 
 		helper.required_messages({ &taskInfo });
 	}
@@ -858,7 +861,7 @@ TEST_CASE("Modify Task", "[api][task]")
 		taskInfo.createTime = std::chrono::milliseconds(1737344039870);
 		taskInfo.state = TaskState::ACTIVE;
 		taskInfo.newTask = false;
-		taskInfo.times.emplace_back(1737344939870ms, std::nullopt, std::vector{ TimeEntry{TEST_TIME_CATEGORY_UNKNOWN, TEST_TIME_CODE_UNKNOWN} });
+		taskInfo.times.emplace_back(1737344939870ms, std::nullopt, SmallVector<TimeEntry, 2>{ TimeEntry{ TEST_TIME_CATEGORY_UNKNOWN.id, TEST_TIME_CODE_UNKNOWN.id } });
 
 		helper.required_messages({ &taskInfo });
 	}
@@ -1173,8 +1176,8 @@ TEST_CASE("Request Daily Report", "[api][task]")
 		report.report.startTime = date_to_ms(2, 3, 2025) + std::chrono::hours(5) + std::chrono::minutes(15);
 		report.report.times.emplace_back(TaskID(1), 0);
 		report.report.totalTime = std::chrono::minutes(30);
-		report.report.timePerTimeEntry.emplace(TimeEntry{ TEST_TIME_CATEGORY_1, TEST_TIME_CODE_UNKNOWN }, std::chrono::minutes(30));
-		report.report.timePerTimeEntry.emplace(TimeEntry{ TEST_TIME_CATEGORY_2, TEST_TIME_CODE_UNKNOWN }, std::chrono::minutes(30));
+		report.report.timePerTimeEntry.emplace(TimeEntry{ TEST_TIME_CATEGORY_1.id, TEST_TIME_CODE_UNKNOWN.id }, std::chrono::minutes(30));
+		report.report.timePerTimeEntry.emplace(TimeEntry{ TEST_TIME_CATEGORY_2.id, TEST_TIME_CODE_UNKNOWN.id }, std::chrono::minutes(30));
 
 		helper.required_messages({ &report });
 	}
@@ -1201,8 +1204,8 @@ TEST_CASE("Request Daily Report", "[api][task]")
 		report.report.startTime = date_to_ms(2, 3, 2025) + std::chrono::hours(5) + std::chrono::minutes(15);
 		report.report.times.emplace_back(TaskID(1), 0);
 		report.report.totalTime = std::chrono::milliseconds(88200000);
-		report.report.timePerTimeEntry.emplace(TimeEntry{ TEST_TIME_CATEGORY_1, TEST_TIME_CODE_UNKNOWN }, std::chrono::milliseconds(88200000));
-		report.report.timePerTimeEntry.emplace(TimeEntry{ TEST_TIME_CATEGORY_2, TEST_TIME_CODE_UNKNOWN }, std::chrono::milliseconds(88200000));
+		report.report.timePerTimeEntry.emplace(TimeEntry{ TEST_TIME_CATEGORY_1.id, TEST_TIME_CODE_UNKNOWN.id }, std::chrono::milliseconds(88200000));
+		report.report.timePerTimeEntry.emplace(TimeEntry{ TEST_TIME_CATEGORY_2.id, TEST_TIME_CODE_UNKNOWN.id }, std::chrono::milliseconds(88200000));
 
 		helper.required_messages({ &report });
 	}
@@ -1249,8 +1252,8 @@ TEST_CASE("Request Daily Report", "[api][task]")
 		report.report.startTime = date_to_ms(2, 3, 2025) + std::chrono::hours(5) + std::chrono::minutes(15);
 		report.report.times.emplace_back(TaskID(1), 0);
 		report.report.totalTime = std::chrono::minutes(30);
-		report.report.timePerTimeEntry.emplace(TimeEntry{ TEST_TIME_CATEGORY_1, TEST_TIME_CODE_UNKNOWN }, std::chrono::minutes(30));
-		report.report.timePerTimeEntry.emplace(TimeEntry{ TEST_TIME_CATEGORY_2, TEST_TIME_CODE_UNKNOWN }, std::chrono::minutes(30));
+		report.report.timePerTimeEntry.emplace(TimeEntry{ TEST_TIME_CATEGORY_1.id, TEST_TIME_CODE_UNKNOWN.id }, std::chrono::minutes(30));
+		report.report.timePerTimeEntry.emplace(TimeEntry{ TEST_TIME_CATEGORY_2.id, TEST_TIME_CODE_UNKNOWN.id }, std::chrono::minutes(30));
 
 		helper.required_messages({ &report });
 	}
@@ -1280,8 +1283,8 @@ TEST_CASE("Request Daily Report", "[api][task]")
 		report.report.endTime = date_to_ms(2, 3, 2025) + std::chrono::hours(7);
 		report.report.times.emplace_back(TaskID(1), 0);
 		report.report.totalTime = std::chrono::hours(2);
-		report.report.timePerTimeEntry.emplace(TimeEntry{ TEST_TIME_CATEGORY_1, TEST_TIME_CODE_UNKNOWN }, std::chrono::hours(2));
-		report.report.timePerTimeEntry.emplace(TimeEntry{ TEST_TIME_CATEGORY_2, TEST_TIME_CODE_UNKNOWN }, std::chrono::hours(2));
+		report.report.timePerTimeEntry.emplace(TimeEntry{ TEST_TIME_CATEGORY_1.id, TEST_TIME_CODE_UNKNOWN.id }, std::chrono::hours(2));
+		report.report.timePerTimeEntry.emplace(TimeEntry{ TEST_TIME_CATEGORY_2.id, TEST_TIME_CODE_UNKNOWN.id }, std::chrono::hours(2));
 		helper.required_messages({ &report });
 	}
 
@@ -1310,8 +1313,8 @@ TEST_CASE("Request Daily Report", "[api][task]")
 		report.report.endTime = date_to_ms(2, 3, 2025) + std::chrono::hours(7);
 		report.report.times.emplace_back(TaskID(1), 0);
 		report.report.totalTime = std::chrono::hours(2);
-		report.report.timePerTimeEntry.emplace(TimeEntry{ TEST_TIME_CATEGORY_1, TEST_TIME_CODE_UNKNOWN }, std::chrono::hours(2));
-		report.report.timePerTimeEntry.emplace(TimeEntry{ TEST_TIME_CATEGORY_2, TEST_TIME_CODE_UNKNOWN }, std::chrono::hours(2));
+		report.report.timePerTimeEntry.emplace(TimeEntry{ TEST_TIME_CATEGORY_1.id, TEST_TIME_CODE_UNKNOWN.id }, std::chrono::hours(2));
+		report.report.timePerTimeEntry.emplace(TimeEntry{ TEST_TIME_CATEGORY_2.id, TEST_TIME_CODE_UNKNOWN.id }, std::chrono::hours(2));
 		helper.required_messages({ &report });
 	}
 
@@ -1352,8 +1355,8 @@ TEST_CASE("Request Daily Report", "[api][task]")
 		report.report.endTime = date_to_ms(2, 3, 2025) + std::chrono::hours(7);
 		report.report.times.emplace_back(TaskID(1), 1);
 		report.report.totalTime = std::chrono::hours(2);
-		report.report.timePerTimeEntry.emplace(TimeEntry{ TEST_TIME_CATEGORY_1, TEST_TIME_CODE_UNKNOWN }, std::chrono::hours(2));
-		report.report.timePerTimeEntry.emplace(TimeEntry{ TEST_TIME_CATEGORY_2, TEST_TIME_CODE_UNKNOWN }, std::chrono::hours(2));
+		report.report.timePerTimeEntry.emplace(TimeEntry{ TEST_TIME_CATEGORY_1.id, TEST_TIME_CODE_UNKNOWN.id }, std::chrono::hours(2));
+		report.report.timePerTimeEntry.emplace(TimeEntry{ TEST_TIME_CATEGORY_2.id, TEST_TIME_CODE_UNKNOWN.id }, std::chrono::hours(2));
 		helper.required_messages({ &report });
 	}
 
@@ -1380,8 +1383,8 @@ TEST_CASE("Request Daily Report", "[api][task]")
 		auto create2 = CreateTaskMessage(NO_PARENT, helper.next_request_id(), "test 2");
 		auto create3 = CreateTaskMessage(NO_PARENT, helper.next_request_id(), "test 3");
 
-		create1.timeEntry = std::vector{ TEST_TIME_ENTRY_1, TEST_TIME_ENTRY_2 };
-		create2.timeEntry = std::vector{ TimeEntry{TEST_TIME_CATEGORY_3, TimeCode(TimeCodeID(4), "")}, TimeEntry{TEST_TIME_CATEGORY_4, TimeCode(TimeCodeID(5), "")} };
+		create1.timeEntry = { TEST_TIME_ENTRY_1, TEST_TIME_ENTRY_2 };
+		create2.timeEntry = { TimeEntry{ TEST_TIME_CATEGORY_3.id, TimeCodeID(4) }, TimeEntry{ TEST_TIME_CATEGORY_4.id, TimeCodeID(5) } };
 
 		helper.expect_success(create1);
 		helper.expect_success(create2);
@@ -1431,14 +1434,14 @@ TEST_CASE("Request Daily Report", "[api][task]")
 		report.report.times.emplace_back(TaskID(1), 2);
 		report.report.times.emplace_back(TaskID(2), 1);
 		report.report.times.emplace_back(TaskID(3), 0);
-		report.report.timePerTimeEntry.emplace(TimeEntry{ TEST_TIME_CATEGORY_1, TEST_TIME_CODE_UNKNOWN }, std::chrono::hours(4));
-		report.report.timePerTimeEntry.emplace(TimeEntry{ TEST_TIME_CATEGORY_1, TimeCodeID(2) }, std::chrono::hours(5));
-		report.report.timePerTimeEntry.emplace(TimeEntry{ TEST_TIME_CATEGORY_2, TEST_TIME_CODE_UNKNOWN }, std::chrono::hours(4));
-		report.report.timePerTimeEntry.emplace(TimeEntry{ TEST_TIME_CATEGORY_2, TimeCodeID(3) }, std::chrono::hours(5));
-		report.report.timePerTimeEntry.emplace(TimeEntry{ TEST_TIME_CATEGORY_3, TEST_TIME_CODE_UNKNOWN }, std::chrono::hours(7));
-		report.report.timePerTimeEntry.emplace(TimeEntry{ TEST_TIME_CATEGORY_3, TimeCodeID(4) }, std::chrono::hours(2));
-		report.report.timePerTimeEntry.emplace(TimeEntry{ TEST_TIME_CATEGORY_4, TimeCodeID(0) }, std::chrono::hours(7));
-		report.report.timePerTimeEntry.emplace(TimeEntry{ TEST_TIME_CATEGORY_4, TimeCodeID(5) }, std::chrono::hours(2));
+		report.report.timePerTimeEntry.emplace(TimeEntry{ TEST_TIME_CATEGORY_1.id, TEST_TIME_CODE_UNKNOWN.id }, std::chrono::hours(4));
+		report.report.timePerTimeEntry.emplace(TimeEntry{ TEST_TIME_CATEGORY_1.id, TimeCodeID(2) }, std::chrono::hours(5));
+		report.report.timePerTimeEntry.emplace(TimeEntry{ TEST_TIME_CATEGORY_2.id, TEST_TIME_CODE_UNKNOWN.id }, std::chrono::hours(4));
+		report.report.timePerTimeEntry.emplace(TimeEntry{ TEST_TIME_CATEGORY_2.id, TimeCodeID(3) }, std::chrono::hours(5));
+		report.report.timePerTimeEntry.emplace(TimeEntry{ TEST_TIME_CATEGORY_3.id, TEST_TIME_CODE_UNKNOWN.id }, std::chrono::hours(7));
+		report.report.timePerTimeEntry.emplace(TimeEntry{ TEST_TIME_CATEGORY_3.id, TimeCodeID(4) }, std::chrono::hours(2));
+		report.report.timePerTimeEntry.emplace(TimeEntry{ TEST_TIME_CATEGORY_4.id, TimeCodeID(0) }, std::chrono::hours(7));
+		report.report.timePerTimeEntry.emplace(TimeEntry{ TEST_TIME_CATEGORY_4.id, TimeCodeID(5) }, std::chrono::hours(2));
 		report.report.totalTime = std::chrono::hours(9);
 
 		helper.required_messages({ &report });
@@ -1454,7 +1457,7 @@ TEST_CASE("Request Daily Report", "[api][task]")
 		auto create2 = CreateTaskMessage(TaskID(1), helper.next_request_id(), "test 2");
 		auto create3 = CreateTaskMessage(TaskID(2), helper.next_request_id(), "test 3");
 
-		create1.timeEntry = std::vector{ TEST_TIME_ENTRY_1, TEST_TIME_ENTRY_2 };
+		create1.timeEntry = { TEST_TIME_ENTRY_1, TEST_TIME_ENTRY_2 };
 
 		helper.expect_success(create1);
 		helper.expect_success(create2);
@@ -1480,8 +1483,8 @@ TEST_CASE("Request Daily Report", "[api][task]")
 		report.report.startTime = date_to_ms(2, 3, 2025) + std::chrono::hours(5);
 		report.report.endTime = date_to_ms(2, 3, 2025) + std::chrono::hours(8);
 		report.report.times.emplace_back(TaskID(3), 0);
-		report.report.timePerTimeEntry.emplace(TimeEntry{ TEST_TIME_CATEGORY_1, TimeCode(TimeCodeID(2), "") }, std::chrono::hours(3));
-		report.report.timePerTimeEntry.emplace(TimeEntry{ TEST_TIME_CATEGORY_2, TimeCode(TimeCodeID(3), "") }, std::chrono::hours(3));
+		report.report.timePerTimeEntry.emplace(TimeEntry{ TEST_TIME_CATEGORY_1.id, TimeCodeID(2) }, std::chrono::hours(3));
+		report.report.timePerTimeEntry.emplace(TimeEntry{ TEST_TIME_CATEGORY_2.id, TimeCodeID(3) }, std::chrono::hours(3));
 		report.report.totalTime = std::chrono::hours(3);
 
 		helper.required_messages({ &report });
@@ -1563,7 +1566,9 @@ TEST_CASE("request configuration at startup", "[api]")
 	// now that we're setup, request the configuration and check the output
 	api.process_packet(BasicMessage{ PacketType::REQUEST_CONFIGURATION });
 
-	REQUIRE(sender.output.size() == 10);
+	REQUIRE(sender.output.size() == 11);
+
+	CHECK(sender.output[0]->packetType() == PacketType::SYNC_POSITION);
 
 	auto timeCategoriesData = TimeEntryDataPacket({});
 	auto& category1 = timeCategoriesData.timeCategories.emplace_back(TimeCategoryID(1), "A");
@@ -1574,18 +1579,18 @@ TEST_CASE("request configuration at startup", "[api]")
 	category2.codes.emplace_back(TimeCodeID(3), "Code 3", false);
 	category2.codes.emplace_back(TimeCodeID(4), "Code 4", true);
 
-	verify_message(timeCategoriesData, *sender.output[0]);
+	verify_message(timeCategoriesData, *sender.output[1]);
 
-	verify_message(TaskInfoMessage(TaskID(1), NO_PARENT, "task 1", std::chrono::milliseconds(1737344039870)), *sender.output[2]);
-	verify_message(TaskInfoMessage(TaskID(2), TaskID(1), "task 2", std::chrono::milliseconds(1737344939870)), *sender.output[3]);
-	verify_message(TaskInfoMessage(TaskID(3), TaskID(2), "task 3", std::chrono::milliseconds(1737345839870)), *sender.output[4]);
+	verify_message(TaskInfoMessage(TaskID(1), NO_PARENT, "task 1", std::chrono::milliseconds(1737344039870)), *sender.output[3]);
+	verify_message(TaskInfoMessage(TaskID(2), TaskID(1), "task 2", std::chrono::milliseconds(1737344939870)), *sender.output[4]);
+	verify_message(TaskInfoMessage(TaskID(3), TaskID(2), "task 3", std::chrono::milliseconds(1737345839870)), *sender.output[5]);
 	auto task4 = TaskInfoMessage(TaskID(4), TaskID(2), "task 4", std::chrono::milliseconds(1737346739870));
 	task4.indexInParent = 1;
-	verify_message(task4, *sender.output[5]);
-	verify_message(TaskInfoMessage(TaskID(5), TaskID(3), "task 5", std::chrono::milliseconds(1737347639870)), *sender.output[6]);
-	verify_message(TaskInfoMessage(TaskID(6), TaskID(4), "task 6", std::chrono::milliseconds(1737348539870)), *sender.output[7]);
+	verify_message(task4, *sender.output[6]);
+	verify_message(TaskInfoMessage(TaskID(5), TaskID(3), "task 5", std::chrono::milliseconds(1737347639870)), *sender.output[7]);
+	verify_message(TaskInfoMessage(TaskID(6), TaskID(4), "task 6", std::chrono::milliseconds(1737348539870)), *sender.output[8]);
 
-	verify_message(BasicMessage(PacketType::REQUEST_CONFIGURATION_COMPLETE), *sender.output[9]);
+	verify_message(BasicMessage(PacketType::REQUEST_CONFIGURATION_COMPLETE), *sender.output[10]);
 }
 
 TEST_CASE("Request Version", "[api]")
@@ -1605,6 +1610,76 @@ TEST_CASE("Request Version", "[api]")
 	verify_message(VersionMessage("0.14.1"), *sender.output[0]);
 }
 
+TEST_CASE("Request Stats", "[api]")
+{
+	TestHelper<nullDatabase> helper;
+
+	statistics().reset();
+
+	helper.expect_success(CreateTaskMessage(NO_PARENT, helper.next_request_id(), "task 1"));
+	helper.expect_success(CreateTaskMessage(NO_PARENT, helper.next_request_id(), "task 2"));
+
+	helper.clear_message_output();
+
+	helper.api.process_packet(RequestMessage(PacketType::REQUEST_STATS, helper.next_request_id()));
+
+	REQUIRE(helper.sender.output.size() == 1);
+
+	const auto* stats = dynamic_cast<const StatsMessage*>(helper.sender.output[0].get());
+
+	REQUIRE(stats);
+	CHECK(stats->request == RequestOrigin{ PacketType::REQUEST_STATS, helper.prev_request_id() });
+
+	// the stats request itself is still in progress and is not included
+	REQUIRE(stats->packets.size() == 1);
+
+	CHECK(stats->packets[0].packetType == PacketType::CREATE_TASK);
+	CHECK(stats->packets[0].requestTime.count == 2);
+	CHECK(stats->packets[0].databaseTime.count == 2);
+	CHECK(stats->packets[0].sendTime.count == 2);
+	CHECK(stats->packets[0].bytesOut.count == 2);
+	CHECK(stats->packets[0].bytesIn.count == 0);
+}
+
+TEST_CASE("Stats Are Kept For Every Packet Type", "[api]")
+{
+	statistics().reset();
+
+	statistics().record_bytes_in(PacketType::TASKS_ARCHIVED, 10);
+
+	const auto stats = statistics().data();
+
+	REQUIRE(stats.size() == 1);
+	CHECK(stats[0].packetType == PacketType::TASKS_ARCHIVED);
+	CHECK(stats[0].bytesIn.sum == 10);
+
+	statistics().reset();
+}
+
+TEST_CASE("Trace Request Handling", "[api]")
+{
+	TestHelper<nullDatabase> helper;
+
+	REQUIRE(tracer().open("trace_test.json"));
+
+	helper.expect_success(CreateTaskMessage(NO_PARENT, helper.next_request_id(), "task 1"));
+
+	tracer().close();
+
+	CHECK(!Tracer::enabled());
+
+	std::ifstream file("trace_test.json");
+	std::stringstream contents;
+	contents << file.rdbuf();
+
+#ifdef TG_ENABLE_TRACING
+	CHECK_THAT(contents.str(), Catch::Matchers::StartsWith("[\n"));
+	CHECK_THAT(contents.str(), Catch::Matchers::ContainsSubstring(R"("name":"CREATE_TASK","cat":"api","ph":"X")"));
+	CHECK_THAT(contents.str(), Catch::Matchers::ContainsSubstring(R"("name":"create_task","cat":"task","ph":"X")"));
+	CHECK_THAT(contents.str(), Catch::Matchers::EndsWith("}\n]\n"));
+#endif
+}
+
 TEST_CASE("Start Unspecified Task", "[api][task]")
 {
 	TestHelper<nullDatabase> helper;
@@ -1801,7 +1876,7 @@ TEST_CASE("Add Sessions", "[api][task]")
 		helper.expect_success(addTimeEntry);
 
 		auto create = CreateTaskMessage(NO_PARENT, helper.next_request_id(), "a");
-		create.timeEntry = std::vector{ TEST_TIME_ENTRY_1, TEST_TIME_ENTRY_2 };
+		create.timeEntry = { TEST_TIME_ENTRY_1, TEST_TIME_ENTRY_2 };
 
 		helper.expect_success(create);
 
@@ -1812,9 +1887,9 @@ TEST_CASE("Add Sessions", "[api][task]")
 		auto taskInfo = TaskInfoMessage(TaskID(1), NO_PARENT, "a");
 
 		taskInfo.createTime = std::chrono::milliseconds(1737344039870);
-		taskInfo.timeEntry = create.timeEntry;
+		taskInfo.timeEntry.assign(create.timeEntry.begin(), create.timeEntry.end());
 		taskInfo.times.push_back(create_times_with_unknown_time_entry(10000ms, 20000ms));
-		taskInfo.times.back().timeEntry = create.timeEntry;
+		taskInfo.times.back().timeEntry.assign(create.timeEntry.begin(), create.timeEntry.end());
 		taskInfo.state = TaskState::PENDING;
 		taskInfo.newTask = false;
 
@@ -1887,7 +1962,7 @@ TEST_CASE("Add Sessions", "[api][task]")
 		helper.expect_success(addTimeEntry);
 
 		auto create = CreateTaskMessage(NO_PARENT, helper.next_request_id(), "a");
-		create.timeEntry = std::vector{ TEST_TIME_ENTRY_1, TEST_TIME_ENTRY_2 };
+		create.timeEntry = { TEST_TIME_ENTRY_1, TEST_TIME_ENTRY_2 };
 
 		helper.expect_success(create);
 
@@ -1903,7 +1978,7 @@ TEST_CASE("Add Sessions", "[api][task]")
 		auto taskInfo = TaskInfoMessage(TaskID(1), NO_PARENT, "a");
 
 		taskInfo.createTime = std::chrono::milliseconds(1737344039870);
-		taskInfo.timeEntry = create.timeEntry;
+		taskInfo.timeEntry.assign(create.timeEntry.begin(), create.timeEntry.end());
 		taskInfo.state = TaskState::PENDING;
 		taskInfo.newTask = false;
 
@@ -1933,7 +2008,7 @@ TEST_CASE("Add Sessions", "[api][task]")
 		auto taskInfo = TaskInfoMessage(TaskID(1), NO_PARENT, "a");
 
 		taskInfo.createTime = std::chrono::milliseconds(1737344039870);
-		taskInfo.times.emplace_back(10000ms, 20000ms, std::vector{ TimeEntry{TEST_TIME_CATEGORY_1, TEST_TIME_CODE_UNKNOWN}, TimeEntry{TEST_TIME_CATEGORY_2, TEST_TIME_CODE_UNKNOWN} });
+		taskInfo.times.emplace_back(10000ms, 20000ms, SmallVector<TimeEntry, 2>{ TimeEntry{ TEST_TIME_CATEGORY_1.id, TEST_TIME_CODE_UNKNOWN.id }, TimeEntry{ TEST_TIME_CATEGORY_2.id, TEST_TIME_CODE_UNKNOWN.id } });
 		taskInfo.state = TaskState::PENDING;
 		taskInfo.newTask = false;
 
@@ -2358,3 +2433,1190 @@ TEST_CASE("Remove Sessions", "[api][task]")
 		helper.expect_failure(remove, "Invalid session index.");
 	}
 }
+
+
+TEST_CASE("Request Tasks", "[api][task]")
+{
+	TestHelper<nullDatabase> helper;
+
+	helper.expect_success(CreateTaskMessage(NO_PARENT, helper.next_request_id(), "task 1"));
+	helper.expect_success(CreateTaskMessage(TaskID(1), helper.next_request_id(), "task 2"));
+	helper.expect_success(CreateTaskMessage(TaskID(1), helper.next_request_id(), "task 3"));
+	helper.expect_success(CreateTaskMessage(TaskID(1), helper.next_request_id(), "task 4"));
+	helper.expect_success(CreateTaskMessage(TaskID(2), helper.next_request_id(), "task 5"));
+	helper.expect_success(CreateTaskMessage(NO_PARENT, helper.next_request_id(), "task 6"));
+	helper.expect_success(TaskMessage(PacketType::FINISH_TASK, helper.next_request_id(), TaskID(3)));
+
+	SECTION("Children")
+	{
+		auto request = RequestTasksMessage(helper.next_request_id(), TaskID(1));
+
+		helper.expect_success(request);
+
+		auto page = TaskPageMessage(request.requestID, TaskID(1));
+		page.total = 3;
+		page.tasks = { { TaskID(2), 1 }, { TaskID(3), 0 }, { TaskID(4), 0 } };
+
+		REQUIRE(helper.sender.output.size() == 4);
+
+		verify_message(page, *helper.sender.output[0]);
+
+		CHECK(helper.sender.output[1]->packetType() == PacketType::TASK_INFO);
+	}
+
+	SECTION("Offset and Limit")
+	{
+		auto request = RequestTasksMessage(helper.next_request_id(), TaskID(1));
+		request.offset = 1;
+		request.limit = 1;
+
+		helper.expect_success(request);
+
+		auto page = TaskPageMessage(request.requestID, TaskID(1));
+		page.offset = 1;
+		page.total = 3;
+		page.tasks = { { TaskID(3), 0 } };
+
+		REQUIRE(helper.sender.output.size() == 2);
+
+		verify_message(page, *helper.sender.output[0]);
+
+		// past the end
+		request.requestID = helper.next_request_id();
+		request.offset = 10;
+
+		helper.expect_success(request);
+
+		page.requestID = request.requestID;
+		page.offset = 3;
+		page.tasks.clear();
+
+		helper.required_messages({ &page });
+	}
+
+	SECTION("Subtree")
+	{
+		auto request = RequestTasksMessage(helper.next_request_id(), NO_PARENT);
+		request.subtree = true;
+
+		helper.expect_success(request);
+
+		auto page = TaskPageMessage(request.requestID, NO_PARENT);
+		page.total = 6;
+		page.tasks = { { TaskID(1), 3 }, { TaskID(6), 0 }, { TaskID(2), 1 }, { TaskID(3), 0 }, { TaskID(4), 0 }, { TaskID(5), 0 } };
+
+		REQUIRE(helper.sender.output.size() == 7);
+
+		verify_message(page, *helper.sender.output[0]);
+	}
+
+	SECTION("Unfinished Only")
+	{
+		auto request = RequestTasksMessage(helper.next_request_id(), NO_PARENT);
+		request.subtree = true;
+		request.unfinishedOnly = true;
+
+		helper.expect_success(request);
+
+		auto page = TaskPageMessage(request.requestID, NO_PARENT);
+		page.total = 5;
+		page.tasks = { { TaskID(1), 2 }, { TaskID(6), 0 }, { TaskID(2), 1 }, { TaskID(4), 0 }, { TaskID(5), 0 } };
+
+		REQUIRE(helper.sender.output.size() == 6);
+
+		verify_message(page, *helper.sender.output[0]);
+	}
+
+	SECTION("Failure - Parent Does Not Exist")
+	{
+		helper.expect_failure(RequestTasksMessage(helper.next_request_id(), TaskID(10)), "Task with ID 10 does not exist.");
+	}
+
+	SECTION("Configuration Without Tasks")
+	{
+		helper.clear_message_output();
+
+		helper.api.process_packet(BasicMessage{ PacketType::REQUEST_CONFIGURATION_WITHOUT_TASKS });
+
+		for (auto&& message : helper.sender.output)
+		{
+			CHECK(message->packetType() != PacketType::TASK_INFO);
+		}
+
+		CHECK(helper.sender.output.back()->packetType() == PacketType::REQUEST_CONFIGURATION_COMPLETE);
+	}
+}
+
+TEST_CASE("Resync", "[api]")
+{
+	TestHelper<nullDatabase> helper;
+
+	helper.expect_success(CreateTaskMessage(NO_PARENT, helper.next_request_id(), "task 1"));
+	helper.expect_success(CreateTaskMessage(NO_PARENT, helper.next_request_id(), "task 2"));
+
+	// a client that has never synced gets everything
+	helper.expect_success(RequestResyncMessage(helper.next_request_id(), 0, 0));
+
+	REQUIRE(helper.sender.output.size() > 1);
+	REQUIRE(helper.sender.output[0]->packetType() == PacketType::SYNC_POSITION);
+
+	const auto position = static_cast<const SyncPositionMessage&>(*helper.sender.output[0]);
+
+	CHECK(position.fullSync);
+	CHECK(helper.sender.output.back()->packetType() == PacketType::REQUEST_CONFIGURATION_COMPLETE);
+
+	const auto task_ids = [&]()
+		{
+			std::vector<TaskID> ids;
+
+			for (auto&& message : helper.sender.output)
+			{
+				if (message->packetType() == PacketType::TASK_INFO)
+				{
+					ids.push_back(static_cast<const TaskInfoMessage&>(*message).taskID);
+				}
+			}
+			return ids;
+		};
+
+	CHECK(task_ids() == std::vector{ TaskID(1), TaskID(2) });
+
+	SECTION("Only Changed Tasks")
+	{
+		helper.expect_success(TaskMessage(PacketType::START_TASK, helper.next_request_id(), TaskID(2)));
+		helper.expect_success(CreateTaskMessage(TaskID(2), helper.next_request_id(), "task 3"));
+		helper.expect_success(TaskMessage(PacketType::START_TASK, helper.next_request_id(), TaskID(3)));
+
+		helper.expect_success(RequestResyncMessage(helper.next_request_id(), position.epoch, position.sequence));
+
+		REQUIRE(helper.sender.output.size() == 5);
+
+		const auto next = static_cast<const SyncPositionMessage&>(*helper.sender.output[0]);
+
+		CHECK(next.epoch == position.epoch);
+		CHECK(next.sequence > position.sequence);
+		CHECK(!next.fullSync);
+
+		CHECK(helper.sender.output[1]->packetType() == PacketType::BULK_TASK_INFO_START);
+		CHECK(task_ids() == std::vector{ TaskID(2), TaskID(3) });
+		CHECK(helper.sender.output[4]->packetType() == PacketType::BULK_TASK_INFO_FINISH);
+
+		// nothing has changed since
+		helper.expect_success(RequestResyncMessage(helper.next_request_id(), next.epoch, next.sequence));
+
+		auto same = SyncPositionMessage(next.epoch, next.sequence, false);
+		auto start = BasicMessage(PacketType::BULK_TASK_INFO_START);
+		auto finish = BasicMessage(PacketType::BULK_TASK_INFO_FINISH);
+
+		helper.required_messages({ &same, &start, &finish });
+	}
+
+	SECTION("Time Categories")
+	{
+		auto modify = TimeEntryModifyPacket(helper.next_request_id());
+		modify.categories.emplace_back(TimeCategoryModType::ADD, TimeCategoryID(0), "A");
+
+		helper.expect_success(modify);
+
+		helper.expect_success(RequestResyncMessage(helper.next_request_id(), position.epoch, position.sequence));
+
+		REQUIRE(helper.sender.output.size() == 4);
+
+		CHECK(helper.sender.output[1]->packetType() == PacketType::TIME_ENTRY_DATA);
+		CHECK(task_ids().empty());
+	}
+
+	SECTION("Different Epoch")
+	{
+		helper.expect_success(RequestResyncMessage(helper.next_request_id(), position.epoch + 1, position.sequence));
+
+		CHECK(static_cast<const SyncPositionMessage&>(*helper.sender.output[0]).fullSync);
+		CHECK(task_ids() == std::vector{ TaskID(1), TaskID(2) });
+	}
+
+	SECTION("Sequence From The Future")
+	{
+		helper.expect_success(RequestResyncMessage(helper.next_request_id(), position.epoch, position.sequence + 1));
+
+		CHECK(static_cast<const SyncPositionMessage&>(*helper.sender.output[0]).fullSync);
+	}
+
+	SECTION("Archived Tasks")
+	{
+		helper.api.archive_after(std::chrono::days(1));
+
+		helper.expect_success(TaskMessage(PacketType::FINISH_TASK, helper.next_request_id(), TaskID(1)));
+
+		helper.clock.time += std::chrono::days(2);
+
+		helper.api.archive_finished_tasks();
+
+		helper.expect_success(RequestResyncMessage(helper.next_request_id(), position.epoch, position.sequence));
+
+		// removed instead of syncing everything again
+		CHECK_FALSE(static_cast<const SyncPositionMessage&>(*helper.sender.output[0]).fullSync);
+		CHECK(task_ids().empty());
+
+		verify_message(TaskMessage(PacketType::TASKS_ARCHIVED, RequestID(0), TaskID(1)), *helper.sender.output.back());
+
+		// and the next resync from there has nothing to do
+		const auto next = static_cast<const SyncPositionMessage&>(*helper.sender.output[0]);
+
+		helper.expect_success(RequestResyncMessage(helper.next_request_id(), next.epoch, next.sequence));
+
+		CHECK_FALSE(static_cast<const SyncPositionMessage&>(*helper.sender.output[0]).fullSync);
+		CHECK(helper.sender.output.size() == 3);
+	}
+
+	SECTION("Configuration Starts With The Sync Position")
+	{
+		helper.api.process_packet(BasicMessage(PacketType::REQUEST_CONFIGURATION));
+
+		REQUIRE(helper.sender.output.size() > 1);
+		REQUIRE(helper.sender.output[0]->packetType() == PacketType::SYNC_POSITION);
+
+		const auto configured = static_cast<const SyncPositionMessage&>(*helper.sender.output[0]);
+
+		CHECK(configured.fullSync);
+		CHECK(configured.epoch == position.epoch);
+		CHECK(configured.sequence == position.sequence);
+	}
+}
+
+TEST_CASE("Change Log", "[api]")
+{
+	nullDatabase database;
+	TestPacketSender sender;
+
+	ChangeLog log(database, 2);
+
+	CHECK(log.epoch() != 0);
+	CHECK(log.sequence() == 0);
+	REQUIRE(log.changes_since(log.epoch(), 0));
+	CHECK(log.changes_since(log.epoch(), 0)->empty());
+
+	log.write_task(Task("a", TaskID(1), NO_PARENT, std::chrono::milliseconds(0)), sender);
+	log.write_task(Task("b", TaskID(2), NO_PARENT, std::chrono::milliseconds(0)), sender);
+	log.write_task(Task("c", TaskID(3), NO_PARENT, std::chrono::milliseconds(0)), sender);
+
+	CHECK(log.sequence() == 3);
+
+	// the first change has been dropped
+	CHECK(!log.changes_since(log.epoch(), 0));
+
+	const auto changes = log.changes_since(log.epoch(), 1);
+
+	REQUIRE(changes);
+	REQUIRE(changes->size() == 2);
+	CHECK(changes->at(0).sequence == 2);
+	CHECK(changes->at(0).taskID == TaskID(2));
+	CHECK(changes->at(1).sequence == 3);
+	CHECK(changes->at(1).taskID == TaskID(3));
+
+	CHECK(log.changes_since(log.epoch(), 3)->empty());
+}
+
+TEST_CASE("Broadcast Task Changes", "[api]")
+{
+	TestClock clock;
+	curlTest curl;
+	nullDatabase db;
+	Broadcaster sender;
+	API api(clock, curl, db, sender);
+
+	ClientQueue client1;
+	ClientQueue client2;
+
+	sender.add_client(client1);
+	sender.add_client(client2);
+
+	const auto process = [&](ClientQueue& client, const Message& message)
+		{
+			sender.set_current(&client);
+			api.process_packet(message);
+			sender.set_current(nullptr);
+		};
+
+	const auto received = [](ClientQueue& client)
+		{
+			std::vector<Frame> frames;
+
+			while (client.size() > 0)
+			{
+				frames.push_back(client.pop());
+			}
+			return frames;
+		};
+
+	// the bytes written to the socket for the frame
+	const auto frame_bytes = [](const Frame& frame)
+		{
+			std::vector<std::byte> bytes(frame.header().begin(), frame.header().end());
+			bytes.insert(bytes.end(), frame.payload().begin(), frame.payload().end());
+			return bytes;
+		};
+
+	const auto packet_type = [&](const Frame& frame)
+		{
+			const auto bytes = frame_bytes(frame);
+			return static_cast<PacketType>(std::byteswap(*reinterpret_cast<const std::int32_t*>(bytes.data() + 4)));
+		};
+
+	process(client1, CreateTaskMessage(NO_PARENT, RequestID(1), "task 1"));
+	process(client1, CreateTaskMessage(TaskID(1), RequestID(2), "task 2"));
+	process(client1, CreateTaskMessage(NO_PARENT, RequestID(3), "task 3"));
+
+	// responses only go to the client that sent the request, the new tasks go to both
+	CHECK(received(client1).size() == 6);
+	CHECK(received(client2).size() == 3);
+
+	SECTION("Packed Once")
+	{
+		process(client1, TaskMessage(PacketType::START_TASK, RequestID(4), TaskID(2)));
+
+		const auto packets1 = received(client1);
+		const auto packets2 = received(client2);
+
+		REQUIRE(packets1.size() == 2);
+		REQUIRE(packets2.size() == 1);
+
+		CHECK(packet_type(packets1[0]) == PacketType::SUCCESS_RESPONSE);
+		CHECK(packet_type(packets1[1]) == PacketType::TASK_INFO);
+
+		// the same buffer is queued for both clients
+		CHECK(packets1[1].packet == packets2[0].packet);
+	}
+
+	SECTION("Subscribe To Subtree")
+	{
+		process(client2, TaskMessage(PacketType::UNSUBSCRIBE_TASKS, RequestID(4), NO_PARENT));
+		process(client2, TaskMessage(PacketType::SUBSCRIBE_TASKS, RequestID(5), TaskID(1)));
+
+		CHECK(received(client2).size() == 2);
+
+		// task 2 is below task 1
+		process(client1, TaskMessage(PacketType::START_TASK, RequestID(6), TaskID(2)));
+
+		CHECK(received(client1).size() == 2);
+		CHECK(received(client2).size() == 1);
+
+		// task 3 isn't, but task 2 is stopped when it starts
+		process(client1, TaskMessage(PacketType::START_TASK, RequestID(7), TaskID(3)));
+
+		CHECK(received(client1).size() == 3);
+
+		const auto packets2 = received(client2);
+
+		REQUIRE(packets2.size() == 1);
+		CHECK(packet_type(packets2[0]) == PacketType::TASK_INFO);
+
+		// the client that made the change always sees it
+		process(client2, TaskMessage(PacketType::FINISH_TASK, RequestID(8), TaskID(3)));
+
+		CHECK(received(client2).size() == 2);
+		CHECK(received(client1).size() == 1);
+	}
+
+	SECTION("Subscribe To Missing Task")
+	{
+		process(client2, TaskMessage(PacketType::SUBSCRIBE_TASKS, RequestID(4), TaskID(10)));
+
+		const auto packets = received(client2);
+
+		REQUIRE(packets.size() == 1);
+		CHECK(packet_type(packets[0]) == PacketType::FAILURE_RESPONSE);
+	}
+
+	SECTION("Send To All While Handling A Request")
+	{
+		// like a scheduled backup finishing on its own thread while client 1 has a request in progress
+		sender.set_current(&client1);
+		sender.send_to_all(std::make_unique<BackupPerformedMessage>(std::chrono::milliseconds(1000)));
+		sender.set_current(nullptr);
+
+		const auto packets1 = received(client1);
+		const auto packets2 = received(client2);
+
+		REQUIRE(packets1.size() == 1);
+		REQUIRE(packets2.size() == 1);
+
+		CHECK(packet_type(packets2[0]) == PacketType::BACKUP_PERFORMED);
+	}
+
+	SECTION("Sends Are Recorded For The Request")
+	{
+		statistics().reset();
+
+		process(client1, TaskMessage(PacketType::START_TASK, RequestID(4), TaskID(2)));
+
+		std::size_t bytes = 0;
+
+		for (const auto& frame : received(client1)) bytes += frame.size();
+		for (const auto& frame : received(client2)) bytes += frame.size();
+
+		const auto stats = statistics().data();
+
+		REQUIRE(stats.size() == 1);
+		CHECK(stats[0].packetType == PacketType::START_TASK);
+
+		// the success response and the task info queued for both clients
+		CHECK(stats[0].bytesOut.count == 1);
+		CHECK(stats[0].bytesOut.sum == bytes);
+	}
+
+	SECTION("Client That Falls Behind Is Disconnected")
+	{
+		ClientQueue slow(100);
+
+		sender.add_client(slow);
+
+		process(client1, TaskMessage(PacketType::START_TASK, RequestID(4), TaskID(2)));
+
+		CHECK(!slow.overflowed());
+		CHECK(slow.size() == 1);
+
+		process(client1, TaskMessage(PacketType::START_TASK, RequestID(5), TaskID(3)));
+
+		CHECK(slow.overflowed());
+
+		// everything waiting was dropped and nothing else is queued
+		CHECK(!slow.pop());
+
+		process(client1, TaskMessage(PacketType::FINISH_TASK, RequestID(6), TaskID(3)));
+
+		CHECK(slow.size() == 0);
+
+		sender.remove_client(slow);
+	}
+
+	SECTION("Deltas For Clients That Enabled Them")
+	{
+		process(client2, RequestMessage(PacketType::ENABLE_TASK_INFO_DELTA, RequestID(4)));
+
+		CHECK(received(client2).size() == 1);
+
+		// task 1 hasn't changed since it was created, which was sent in full
+		process(client1, TaskMessage(PacketType::START_TASK, RequestID(5), TaskID(1)));
+
+		const auto packets1 = received(client1);
+		const auto packets2 = received(client2);
+
+		REQUIRE(packets1.size() == 2);
+		REQUIRE(packets2.size() == 1);
+
+		CHECK(packet_type(packets1[1]) == PacketType::TASK_INFO);
+		CHECK(packet_type(packets2[0]) == PacketType::TASK_INFO_DELTA);
+		CHECK(packets2[0].size() < packets1[1].size());
+	}
+
+	SECTION("Full Task Info For Clients That Missed The Last Broadcast")
+	{
+		process(client2, RequestMessage(PacketType::ENABLE_TASK_INFO_DELTA, RequestID(4)));
+		process(client2, TaskMessage(PacketType::UNSUBSCRIBE_TASKS, RequestID(5), NO_PARENT));
+
+		CHECK(received(client2).size() == 2);
+
+		// client 2 doesn't see the task start
+		process(client1, TaskMessage(PacketType::START_TASK, RequestID(6), TaskID(1)));
+
+		CHECK(received(client2).empty());
+
+		process(client2, TaskMessage(PacketType::SUBSCRIBE_TASKS, RequestID(7), NO_PARENT));
+
+		CHECK(received(client2).size() == 1);
+
+		// a delta against the start would be wrong for client 2
+		process(client1, TaskMessage(PacketType::STOP_TASK, RequestID(8), TaskID(1)));
+
+		auto packets2 = received(client2);
+
+		REQUIRE(packets2.size() == 1);
+		CHECK(packet_type(packets2[0]) == PacketType::TASK_INFO);
+
+		// and now that it has the stop it gets deltas again
+		process(client1, TaskMessage(PacketType::START_TASK, RequestID(9), TaskID(1)));
+
+		packets2 = received(client2);
+
+		REQUIRE(packets2.size() == 1);
+		CHECK(packet_type(packets2[0]) == PacketType::TASK_INFO_DELTA);
+
+		// a client that connects later hasn't received any of them
+		ClientQueue client3;
+
+		sender.add_client(client3);
+
+		process(client3, RequestMessage(PacketType::ENABLE_TASK_INFO_DELTA, RequestID(10)));
+
+		CHECK(received(client3).size() == 1);
+
+		process(client1, TaskMessage(PacketType::STOP_TASK, RequestID(11), TaskID(1)));
+
+		const auto packets3 = received(client3);
+
+		REQUIRE(packets3.size() == 1);
+		CHECK(packet_type(packets3[0]) == PacketType::TASK_INFO);
+		CHECK(packet_type(received(client2)[0]) == PacketType::TASK_INFO_DELTA);
+
+		sender.remove_client(client3);
+	}
+
+	SECTION("Compact For Clients That Negotiated It")
+	{
+		process(client2, RequestProtocolVersionMessage(RequestID(4), COMPACT_WIRE_FORMAT_PROTOCOL_VERSION));
+
+		CHECK(received(client2).size() == 2);
+
+		process(client1, TaskMessage(PacketType::START_TASK, RequestID(5), TaskID(2)));
+
+		const auto packets1 = received(client1);
+		const auto packets2 = received(client2);
+
+		REQUIRE(packets1.size() == 2);
+		REQUIRE(packets2.size() == 1);
+
+		CHECK(packet_type(packets2[0]) == PacketType::TASK_INFO);
+		CHECK(packets2[0].size() < packets1[1].size());
+
+		const auto compact = TaskInfoMessage::unpack_compact(packets2[0].payload().subspan(4), TimeCategories{});
+
+		REQUIRE(compact.has_value());
+
+		CHECK(compact->taskID == TaskID(2));
+		CHECK(compact->parentID == TaskID(1));
+		CHECK(compact->name == "task 2");
+		CHECK(compact->state == TaskState::ACTIVE);
+		REQUIRE(compact->times.size() == 1);
+		CHECK(!compact->times[0].stop.has_value());
+	}
+
+	SECTION("Long Strings In Chunks For Clients That Negotiated Them")
+	{
+		process(client2, RequestProtocolVersionMessage(RequestID(4), LONG_STRING_PROTOCOL_VERSION));
+
+		CHECK(received(client2).size() == 2);
+
+		const std::string name(100'000, 'a');
+
+		process(client1, UpdateTaskMessage(RequestID(5), TaskID(2), TaskID(1), name));
+
+		const auto packets1 = received(client1);
+		const auto packets2 = received(client2);
+
+		REQUIRE(packets1.size() == 2);
+		CHECK(packet_type(packets1[1]) == PacketType::TASK_INFO);
+
+		// version 1 can only send part of the name
+		const auto truncated = TaskInfoMessage::unpack(packets1[1].payload().subspan(4), TimeCategories{});
+
+		REQUIRE(truncated.has_value());
+		CHECK(truncated->name.size() == MAX_SHORT_STRING_LENGTH);
+
+		REQUIRE(packets2.size() == 2);
+
+		ChunkAssembler assembler;
+		std::optional<std::vector<std::byte>> packet;
+
+		for (const Frame& frame : packets2)
+		{
+			CHECK(packet_type(frame) == PacketType::CHUNK);
+			CHECK(frame.size() <= MAX_CHUNK_SIZE + CHUNK_HEADER_SIZE);
+
+			// the chunks carry parts of one packed packet instead of copies of it
+			CHECK(frame.packet == packets2[0].packet);
+
+			const auto bytes = frame_bytes(frame);
+			const auto chunk = ChunkMessage::unpack(std::span(bytes).subspan(4));
+
+			REQUIRE(chunk.has_value());
+
+			packet = assembler.add(chunk.value());
+		}
+
+		REQUIRE(packet.has_value());
+
+		const StringLengthScope scope(StringLength::LONG);
+
+		const auto info = TaskInfoMessage::unpack_compact(std::span(*packet).subspan(4), TimeCategories{});
+
+		REQUIRE(info.has_value());
+		CHECK(info->name == name);
+	}
+
+	SECTION("Closed Queue")
+	{
+		client1.close();
+
+		CHECK(!client1.pop());
+	}
+}
+
+TEST_CASE("Task Info Delta", "[api][task]")
+{
+	TestHelper<nullDatabase> helper;
+
+	helper.expect_success(CreateTaskMessage(NO_PARENT, helper.next_request_id(), "task 1"));
+
+	const auto delta = [&]() -> const TaskInfoDeltaMessage&
+		{
+			REQUIRE(helper.sender.output.size() == 1);
+			REQUIRE(helper.sender.output[0]->packetType() == PacketType::TASK_INFO_DELTA);
+
+			return static_cast<const TaskInfoDeltaMessage&>(*helper.sender.output[0]);
+		};
+
+	SECTION("Full Task Info Until Enabled")
+	{
+		helper.expect_success(TaskMessage(PacketType::START_TASK, helper.next_request_id(), TaskID(1)));
+
+		REQUIRE(helper.sender.output.size() == 1);
+		CHECK(helper.sender.output[0]->packetType() == PacketType::TASK_INFO);
+	}
+
+	SECTION("Only Changed Fields")
+	{
+		helper.expect_success(RequestMessage(PacketType::ENABLE_TASK_INFO_DELTA, helper.next_request_id()));
+
+		helper.expect_success(TaskMessage(PacketType::START_TASK, helper.next_request_id(), TaskID(1)));
+
+		CHECK(delta().changed == (TaskInfoDeltaMessage::STATE | TaskInfoDeltaMessage::SESSIONS));
+		CHECK(delta().state == TaskState::ACTIVE);
+		CHECK(delta().sessionCount == 1);
+		CHECK(delta().firstSession == 0);
+		CHECK(delta().sessions.size() == 1);
+
+		helper.expect_success(TaskMessage(PacketType::STOP_TASK, helper.next_request_id(), TaskID(1)));
+		helper.expect_success(TaskMessage(PacketType::START_TASK, helper.next_request_id(), TaskID(1)));
+
+		// only the new session is sent
+		CHECK(delta().sessionCount == 2);
+		CHECK(delta().firstSession == 1);
+		CHECK(delta().sessions.size() == 1);
+
+		helper.expect_success(TaskMessage(PacketType::STOP_TASK, helper.next_request_id(), TaskID(1)));
+
+		CHECK(delta().changed == (TaskInfoDeltaMessage::STATE | TaskInfoDeltaMessage::SESSIONS));
+		CHECK(delta().firstSession == 1);
+		CHECK(delta().sessions.size() == 1);
+		CHECK(delta().sessions[0].stop.has_value());
+
+		auto rename = UpdateTaskMessage(helper.next_request_id(), TaskID(1), NO_PARENT, "renamed");
+
+		helper.expect_success(rename);
+
+		CHECK(delta().changed == TaskInfoDeltaMessage::NAME);
+		CHECK(delta().name == "renamed");
+		CHECK(delta().sessions.empty());
+	}
+
+	SECTION("New Tasks Are Always Sent In Full")
+	{
+		helper.expect_success(RequestMessage(PacketType::ENABLE_TASK_INFO_DELTA, helper.next_request_id()));
+
+		helper.expect_success(CreateTaskMessage(NO_PARENT, helper.next_request_id(), "task 2"));
+
+		REQUIRE(helper.sender.output.size() == 1);
+		CHECK(helper.sender.output[0]->packetType() == PacketType::TASK_INFO);
+	}
+}
+
+TEST_CASE("Protocol Version", "[api]")
+{
+	TestHelper<nullDatabase> helper;
+
+	helper.expect_success(CreateTaskMessage(NO_PARENT, helper.next_request_id(), "task 1"));
+	helper.expect_success(CreateTaskMessage(TaskID(1), helper.next_request_id(), "task 2"));
+	helper.expect_success(CreateTaskMessage(NO_PARENT, helper.next_request_id(), "task 3"));
+
+	const auto request_configuration = [&]()
+		{
+			helper.clear_message_output();
+
+			helper.api.process_packet(BasicMessage{ PacketType::REQUEST_CONFIGURATION });
+
+			std::vector<PacketType> types;
+
+			for (auto&& message : helper.sender.output)
+			{
+				if (message->packetType() == PacketType::TASK_INFO || message->packetType() == PacketType::BULK_TASK_INFO)
+				{
+					types.push_back(message->packetType());
+				}
+			}
+			return types;
+		};
+
+	SECTION("Version 1 Until Negotiated")
+	{
+		CHECK(request_configuration() == std::vector{ PacketType::TASK_INFO, PacketType::TASK_INFO, PacketType::TASK_INFO });
+	}
+
+	SECTION("Newest Version Both Understand")
+	{
+		helper.expect_success(RequestProtocolVersionMessage(helper.next_request_id(), 100));
+
+		auto response = ProtocolVersionMessage(CURRENT_PROTOCOL_VERSION);
+
+		helper.required_messages({ &response });
+
+		helper.expect_success(RequestProtocolVersionMessage(helper.next_request_id(), 1));
+
+		response = ProtocolVersionMessage(1);
+
+		helper.required_messages({ &response });
+	}
+
+	SECTION("Bulk Task Info")
+	{
+		helper.expect_success(RequestProtocolVersionMessage(helper.next_request_id(), 2));
+
+		REQUIRE(request_configuration() == std::vector{ PacketType::BULK_TASK_INFO });
+
+		const auto bulk = std::find_if(helper.sender.output.begin(), helper.sender.output.end(), [](auto&& message) { return message->packetType() == PacketType::BULK_TASK_INFO; });
+
+		const auto& message = static_cast<const BulkTaskInfoMessage&>(**bulk);
+
+		// parents first, the same order as the TASK_INFO messages
+		CHECK(message.taskIDs == std::vector<std::int32_t>{ 1, 3, 2 });
+
+		CHECK((*std::prev(bulk))->packetType() == PacketType::BULK_TASK_INFO_START);
+		CHECK((*std::next(bulk))->packetType() == PacketType::BULK_TASK_INFO_FINISH);
+
+		const auto task = message.task(2, TimeCategories{});
+
+		CHECK(task.taskID == TaskID(2));
+		CHECK(task.parentID == TaskID(1));
+		CHECK(task.name == "task 2");
+	}
+}
+
+TEST_CASE("Process Decoded Request", "[api]")
+{
+	TestHelper<nullDatabase> helper;
+
+	RequestPacket request;
+
+	// the request points into the bytes, they have to outlive it
+	auto bytes = CreateTaskMessage(NO_PARENT, RequestID(1), "task 1").pack();
+
+	parse_request(bytes, helper.api.m_app.timeCategories(), request);
+
+	helper.api.process_packet(request);
+
+	REQUIRE(helper.sender.output.size() == 2);
+
+	verify_message(SuccessResponse(RequestOrigin{ PacketType::CREATE_TASK, RequestID(1) }), *helper.sender.output[0]);
+	CHECK(helper.sender.output[1]->packetType() == PacketType::TASK_INFO);
+
+	// the task has its own copy of the name
+	std::fill(bytes.begin(), bytes.end(), std::byte(0));
+
+	REQUIRE(helper.api.m_app.find_task(TaskID(1)) != nullptr);
+	CHECK(helper.api.m_app.find_task(TaskID(1))->m_name == "task 1");
+
+	helper.clear_message_output();
+
+	// nothing decoded, nothing to do
+	request.emplace<std::monostate>();
+
+	helper.api.process_packet(request);
+
+	CHECK(helper.sender.output.empty());
+}
+
+TEST_CASE("Request Arena", "[api]")
+{
+	SECTION("Released When The Scope Ends")
+	{
+		RequestArena arena;
+
+		void* first = nullptr;
+
+		{
+			RequestArena::Scope scope(arena);
+
+			first = arena.resource()->allocate(1000);
+		}
+
+		RequestArena::Scope scope(arena);
+
+		CHECK(arena.resource()->allocate(1000) == first);
+	}
+
+	SECTION("Nested Scopes")
+	{
+		RequestArena arena;
+
+		RequestArena::Scope outer(arena);
+
+		void* inner = nullptr;
+
+		{
+			RequestArena::Scope scope(arena);
+
+			inner = arena.resource()->allocate(1000);
+		}
+
+		// still in use by the outer scope
+		CHECK(arena.resource()->allocate(1000) != inner);
+	}
+
+	SECTION("Grows To Fit")
+	{
+		RequestArena arena;
+
+		{
+			RequestArena::Scope scope(arena);
+
+			std::pmr::vector<std::byte> bytes(RequestArena::DEFAULT_SIZE * 2, arena.resource());
+		}
+
+		CHECK(arena.capacity() > RequestArena::DEFAULT_SIZE * 2);
+	}
+
+	SECTION("Released After Each Request")
+	{
+		TestHelper<nullDatabase> helper;
+
+		auto& arena = helper.api.m_app.scratch();
+
+		void* first = arena.resource()->allocate(16);
+
+		helper.expect_success(CreateTaskMessage(NO_PARENT, helper.next_request_id(), "task 1"));
+		helper.expect_success(TaskMessage(PacketType::START_TASK, helper.next_request_id(), TaskID(1)));
+
+		CHECK(arena.resource()->allocate(16) == first);
+	}
+}
+
+TEST_CASE("Task Store", "[api]")
+{
+	const auto task = [](TaskID id, TaskID parentID)
+	{
+		return Task("task", id, parentID, std::chrono::milliseconds(0));
+	};
+
+	const auto children = [](const TaskStore& store, TaskID parentID)
+	{
+		auto range = store.children(parentID);
+
+		return std::vector<TaskID>(range.begin(), range.end());
+	};
+
+	TaskStore store;
+
+	SECTION("Children In ID Order")
+	{
+		store.insert(task(TaskID(1), NO_PARENT));
+		store.insert(task(TaskID(2), TaskID(1)));
+		store.insert(task(TaskID(3), NO_PARENT));
+		store.insert(task(TaskID(4), TaskID(1)));
+		store.insert(task(TaskID(5), TaskID(3)));
+
+		store.set_parent(TaskID(5), TaskID(1));
+		store.set_parent(TaskID(2), TaskID(3));
+
+		CHECK(store.size() == 5);
+		CHECK(children(store, NO_PARENT) == std::vector{ TaskID(1), TaskID(3) });
+		CHECK(children(store, TaskID(1)) == std::vector{ TaskID(4), TaskID(5) });
+		CHECK(children(store, TaskID(3)) == std::vector{ TaskID(2) });
+		CHECK(store.children(TaskID(3)).size() == 1);
+		CHECK(store.children(TaskID(4)).empty());
+	}
+
+	SECTION("Replacing A Task Moves It To Its New Parent")
+	{
+		store.insert(task(TaskID(1), NO_PARENT));
+		Task& original = store.insert(task(TaskID(2), NO_PARENT));
+
+		Task& replaced = store.insert(task(TaskID(2), TaskID(1)));
+
+		CHECK(&original == &replaced);
+		CHECK(store.size() == 2);
+		CHECK(children(store, NO_PARENT) == std::vector{ TaskID(1) });
+		CHECK(children(store, TaskID(1)) == std::vector{ TaskID(2) });
+	}
+
+	SECTION("Tasks Don't Move")
+	{
+		Task* first = &store.insert(task(TaskID(1), NO_PARENT));
+
+		for (int id = 2; id <= 1000; id++)
+		{
+			store.insert(task(TaskID(id), NO_PARENT));
+		}
+
+		CHECK(store.find(TaskID(1)) == first);
+		CHECK(store.find(TaskID(1000))->taskID() == TaskID(1000));
+	}
+
+	SECTION("Handles Of Removed Tasks")
+	{
+		store.insert(task(TaskID(1), NO_PARENT));
+		store.insert(task(TaskID(2), TaskID(1)));
+
+		const TaskHandle handle = store.handle(TaskID(2));
+
+		CHECK(store.find(handle) == store.find(TaskID(2)));
+
+		store.erase(TaskID(2));
+
+		// the new task is given the slot of the removed one
+		store.insert(task(TaskID(3), TaskID(1)));
+
+		CHECK(store.find(handle) == nullptr);
+		CHECK(store.find(TaskID(2)) == nullptr);
+		CHECK(store.handle(TaskID(3)).slot == handle.slot);
+		CHECK(children(store, TaskID(1)) == std::vector{ TaskID(3) });
+	}
+
+	SECTION("Records Copy The State, Finish Time, Index And Flags")
+	{
+		Task& stored = store.insert(task(TaskID(1), NO_PARENT));
+
+		REQUIRE(store.record(TaskID(1)) != nullptr);
+		CHECK(store.record(TaskID(1))->state == TaskState::PENDING);
+		CHECK(store.record(TaskID(1))->finishTime == TaskStore::NO_FINISH_TIME);
+
+		stored.state = TaskState::FINISHED;
+		stored.m_finishTime = std::chrono::milliseconds(1000);
+		stored.indexInParent = 3;
+		stored.locked = true;
+
+		// changes in place are only seen once the record is updated
+		CHECK(store.record(TaskID(1))->state == TaskState::PENDING);
+
+		store.update(stored);
+
+		const TaskStore::Record& record = *store.record(TaskID(1));
+
+		CHECK(record.state == TaskState::FINISHED);
+		CHECK(record.finishTime == 1000);
+		CHECK(record.indexInParent == 3);
+		CHECK(record.flags == TaskStore::LOCKED);
+
+		store.erase(TaskID(1));
+
+		CHECK(store.record(TaskID(1)) == nullptr);
+	}
+
+	SECTION("Every Task In ID Order")
+	{
+		store.insert(task(TaskID(1), NO_PARENT));
+		store.insert(task(TaskID(2), NO_PARENT));
+		store.insert(task(TaskID(3), NO_PARENT));
+
+		store.erase(TaskID(1));
+		store.insert(task(TaskID(4), NO_PARENT));
+
+		std::vector<TaskID> ids;
+
+		store.for_each_sorted([&](const Task& task) { ids.push_back(task.taskID()); });
+
+		CHECK(ids == std::vector{ TaskID(2), TaskID(3), TaskID(4) });
+	}
+}
+
+TEST_CASE("Session Columns", "[api]")
+{
+	std::mt19937 random(1234);
+
+	std::vector<TaskTimes> sessions;
+
+	// enough rows to fill the vector lanes and leave some over
+	for (int i = 0; i < 103; i++)
+	{
+		const auto start = std::chrono::milliseconds(random() % 1000);
+
+		if (i % 10 == 0)
+		{
+			sessions.emplace_back(start);
+		}
+		else
+		{
+			sessions.emplace_back(start, start + std::chrono::milliseconds(1 + random() % 100));
+		}
+	}
+
+	SessionColumns columns;
+
+	for (std::size_t i = 0; i < sessions.size(); i++)
+	{
+		columns.add(TaskID(static_cast<std::int32_t>(i + 1)), static_cast<std::int32_t>(i), sessions[i]);
+	}
+
+	REQUIRE(columns.size() == sessions.size());
+	CHECK(columns.task(5) == TaskID(6));
+	CHECK(columns.session(5) == 5);
+
+	SECTION("Starting Or Stopping")
+	{
+		const auto start = 400ms;
+		const auto end = 500ms;
+
+		std::pmr::vector<std::uint32_t> rows;
+
+		columns.find_starting_or_stopping(start, end, rows);
+
+		std::pmr::vector<std::uint32_t> expected;
+
+		for (std::size_t i = 0; i < sessions.size(); i++)
+		{
+			const TaskTimes& times = sessions[i];
+
+			if ((times.start >= start && times.start < end) || (times.stop >= start && times.stop < end))
+			{
+				expected.push_back(static_cast<std::uint32_t>(i));
+			}
+		}
+
+		CHECK(!expected.empty());
+		CHECK(rows == expected);
+	}
+
+	SECTION("Overlap")
+	{
+		const auto start = 700ms;
+		const auto stop = 705ms;
+
+		std::vector<std::size_t> rows;
+
+		for (std::size_t row = columns.find_overlap(start, stop); row < columns.size(); row = columns.find_overlap(start, stop, row + 1))
+		{
+			rows.push_back(row);
+		}
+
+		std::vector<std::size_t> expected;
+
+		for (std::size_t i = 0; i < sessions.size(); i++)
+		{
+			const TaskTimes& times = sessions[i];
+
+			if (times.start <= stop && (!times.stop || start <= times.stop.value()))
+			{
+				expected.push_back(i);
+			}
+		}
+
+		CHECK(!expected.empty());
+		CHECK(rows == expected);
+	}
+
+	SECTION("Rows Of A Task Change In Place")
+	{
+		SessionColumns changed;
+		changed.add(TaskID(1), 0, TaskTimes(10ms, 20ms));
+		changed.add(TaskID(3), 0, TaskTimes(30ms, 40ms));
+
+		changed.append(TaskID(2), 0, TaskTimes(50ms));
+		changed.append(TaskID(4), 0, TaskTimes(60ms));
+
+		REQUIRE(changed.size() == 4);
+		CHECK(changed.task(1) == TaskID(2));
+		CHECK(changed.task(3) == TaskID(4));
+
+		CHECK(changed.update(TaskID(2), 0, TaskTimes(50ms, 55ms)));
+		CHECK(!changed.update(TaskID(2), 1, TaskTimes(50ms, 55ms)));
+		CHECK(changed.find_overlap(56ms, 57ms) == changed.size());
+		CHECK(changed.find_overlap(54ms, 57ms) == 1);
+
+		changed.replace(TaskID(3), { TaskTimes(1ms, 2ms), TaskTimes(3ms, 4ms) });
+
+		REQUIRE(changed.size() == 5);
+		CHECK(changed.task(3) == TaskID(3));
+		CHECK(changed.session(3) == 1);
+		CHECK(changed.find_overlap(35ms, 36ms) == changed.size());
+
+		const std::vector<TaskID> removed = { TaskID(1), TaskID(3) };
+		changed.remove(removed);
+
+		REQUIRE(changed.size() == 2);
+		CHECK(changed.task(0) == TaskID(2));
+		CHECK(changed.task(1) == TaskID(4));
+	}
+
+	SECTION("Running Sessions Overlap Everything After They Start")
+	{
+		SessionColumns running;
+		running.add(TaskID(1), 0, TaskTimes(10ms));
+
+		CHECK(running.find_overlap(5ms, 9ms) == running.size());
+		CHECK(running.find_overlap(5ms, 10ms) == 0);
+		CHECK(running.find_overlap(1000000ms, 2000000ms) == 0);
+	}
+}
+
+TEST_CASE("Interned String", "[api]")
+{
+	SECTION("Same String Is Stored Once")
+	{
+		const InternedString a("interned 1");
+		const InternedString b(std::string("interned 1"));
+
+		const auto size = InternedString::pool_size();
+
+		const InternedString c("interned 1");
+
+		CHECK(a == b);
+		CHECK(&a.str() == &c.str());
+		CHECK(InternedString::pool_size() == size);
+		CHECK(a == "interned 1");
+		CHECK(a != InternedString("interned 2"));
+	}
+
+	SECTION("Find Doesn't Store")
+	{
+		const auto size = InternedString::pool_size();
+
+		CHECK(!InternedString::find("interned never stored"));
+		CHECK(InternedString::pool_size() == size);
+
+		const InternedString stored("interned 3");
+
+		CHECK(InternedString::find("interned 3") == stored);
+	}
+
+	SECTION("Removed With The Last Handle")
+	{
+		const auto size = InternedString::pool_size();
+
+		std::optional<InternedString> a = InternedString("interned 4");
+		std::optional<InternedString> b = a;
+
+		InternedString renamed("interned 5");
+		renamed = a.value();
+
+		CHECK(InternedString::pool_size() == size + 1);
+		CHECK(!InternedString::find("interned 5"));
+
+		a.reset();
+
+		CHECK(InternedString::find("interned 4") == b.value());
+
+		b.reset();
+		renamed = "";
+
+		CHECK(InternedString::pool_size() == size);
+		CHECK(!InternedString::find("interned 4"));
+		CHECK(renamed.empty());
+	}
+
+	SECTION("Ordered By Content")
+	{
+		CHECK(InternedString("interned b") > InternedString("interned a"));
+		CHECK(InternedString("interned a") < InternedString("interned b"));
+		CHECK(InternedString() == "");
+	}
+
+	SECTION("Tasks Share Names")
+	{
+		TestHelper<nullDatabase> helper;
+
+		helper.expect_success(CreateTaskMessage(NO_PARENT, helper.next_request_id(), "shared"));
+		helper.expect_success(CreateTaskMessage(TaskID(1), helper.next_request_id(), "shared"));
+
+		CHECK(&helper.api.m_app.find_task(TaskID(1))->m_name.str() == &helper.api.m_app.find_task(TaskID(2))->m_name.str());
+		CHECK(helper.api.m_app.find_task_with_parent_and_name("shared", TaskID(1)) == helper.api.m_app.find_task(TaskID(2)));
+		CHECK(helper.api.m_app.find_task_with_parent_and_name("interned never stored", TaskID(1)) == nullptr);
+	}
+}
@@ -59,11 +59,7 @@ TEST_CASE("Request Bugzilla Information", "[bugzilla][api]")
 	helper.curl.requestResponse.emplace_back("{ \"bugs\": [] }");
 
 	helper.api.process_packet(configure);
-	helper.clear_message_output();
-
-	auto request = BasicMessage(PacketType::REQUEST_CONFIGURATION);
-
-	helper.api.process_packet(request);
+	helper.request_configuration();
 
 	auto timeCategories = TimeEntryDataPacket({});
 	auto complete = BasicMessage(PacketType::REQUEST_CONFIGURATION_COMPLETE);
@@ -202,11 +198,7 @@ TEST_CASE("Configuring Multiple Bugzilla Instances", "[bugzilla][api]")
 
 	SECTION("Information is Set in Memory")
 	{
-		helper.clear_message_output();
-
-		auto request = BasicMessage(PacketType::REQUEST_CONFIGURATION);
-
-		helper.api.process_packet(request);
+		helper.request_configuration();
 
 		auto timeCategories = TimeEntryDataPacket({});
 		auto complete = BasicMessage(PacketType::REQUEST_CONFIGURATION_COMPLETE);
@@ -373,6 +365,55 @@ TEST_CASE("Bugzilla Refresh", "[bugzilla][api]")
 		helper.required_messages({ &configure });
 	}
 
+	SECTION("Reopened Bug With An Archived Task")
+	{
+		helper.api.archive_after(std::chrono::days(1));
+
+		const auto refresh_with = [&](std::string_view status)
+			{
+				helper.curl.clear();
+
+				helper.curl.requestResponse.emplace_back(std::format("{{ \"bugs\": [ {{ \"id\": 50, \"assigned_to\": \"test\", \"summary\": \"bug 1\", \"status\": \"{}\", \"priority\": \"P2\", \"severity\": \"Minor\" }} ] }}", status));
+				helper.curl.requestResponse.emplace_back("{ \"bugs\": [] }");
+
+				helper.expect_success(RequestMessage(PacketType::BUGZILLA_REFRESH, helper.next_request_id()));
+			};
+
+		refresh_with("Assigned");
+
+		const Task* bug = helper.api.m_app.find_task(TaskID(4));
+
+		REQUIRE(bug);
+		CHECK(bug->m_name == "50 - bug 1");
+
+		refresh_with("RESOLVED");
+
+		helper.clock.time += std::chrono::days(2);
+
+		helper.api.archive_finished_tasks();
+
+		REQUIRE(helper.api.m_app.find_task(TaskID(4)) == nullptr);
+
+		helper.clear_message_output();
+
+		refresh_with("REOPENED");
+
+		// a new task instead of skipping the bug because its old task isn't in memory
+		const auto created = std::ranges::find_if(helper.sender.output, [](const auto& message)
+			{
+				const auto* info = dynamic_cast<const TaskInfoMessage*>(message.get());
+
+				return info && info->newTask && info->name == "50 - bug 1";
+			});
+
+		REQUIRE(created != helper.sender.output.end());
+
+		const Task* reopened = helper.api.m_app.find_task(static_cast<const TaskInfoMessage&>(**created).taskID);
+
+		REQUIRE(reopened);
+		CHECK(reopened->state == TaskState::PENDING);
+	}
+
 	SECTION("Group By Task as Strings")
 	{
 		helper.curl.clear();
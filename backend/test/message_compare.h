@@ -69,6 +69,24 @@ inline void verify_task_info(const TaskInfoMessage& expected, const TaskInfoMess
 	CHECK(expected.timeEntry == actual.timeEntry);
 }
 
+inline void verify_task_info_delta(const TaskInfoDeltaMessage& expected, const TaskInfoDeltaMessage& actual, std::source_location location)
+{
+	CHECK(expected.taskID == actual.taskID);
+	CHECK(expected.changed == actual.changed);
+	CHECK(expected.parentID == actual.parentID);
+	CHECK(expected.name == actual.name);
+	CHECK(expected.state == actual.state);
+	CHECK(expected.indexInParent == actual.indexInParent);
+	CHECK(expected.serverControlled == actual.serverControlled);
+	CHECK(expected.locked == actual.locked);
+	CHECK(expected.finishTime == actual.finishTime);
+	CHECK(expected.sessionCount == actual.sessionCount);
+	CHECK(expected.firstSession == actual.firstSession);
+	CHECK(expected.sessions == actual.sessions);
+	CHECK(expected.labels == actual.labels);
+	CHECK(expected.timeEntry == actual.timeEntry);
+}
+
 inline void verify_bugzilla_info(const BugzillaInfoMessage& expected, const BugzillaInfoMessage& actual, std::source_location location)
 {
 	CHECK(expected.instanceID == actual.instanceID);
@@ -157,6 +175,112 @@ inline void verify_task_state_change(const TaskStateChange& expected, const Task
 	CHECK(expected.state == actual.state);
 }
 
+inline void verify_request_message(const RequestMessage& expected, const RequestMessage& actual, std::source_location location)
+{
+	CHECK(expected.requestID == actual.requestID);
+}
+
+inline void verify_backup_configuration(const BackupConfigurationMessage& expected, const BackupConfigurationMessage& actual, std::source_location location)
+{
+	CHECK(expected.requestID == actual.requestID);
+	CHECK(expected.backupLocation == actual.backupLocation);
+	CHECK(expected.backupFrequencyMinutes == actual.backupFrequencyMinutes);
+	CHECK(expected.numberOfBackupsToKeep == actual.numberOfBackupsToKeep);
+}
+
+inline void verify_backup_performed(const BackupPerformedMessage& expected, const BackupPerformedMessage& actual, std::source_location location)
+{
+	CHECK(expected.backupTime == actual.backupTime);
+}
+
+inline void verify_backup_failed(const BackupFailedMessage& expected, const BackupFailedMessage& actual, std::source_location location)
+{
+	CHECK(expected.errorMessage == actual.errorMessage);
+	CHECK(expected.previousBackupTime == actual.previousBackupTime);
+}
+
+inline void verify_request_tasks(const RequestTasksMessage& expected, const RequestTasksMessage& actual, std::source_location location)
+{
+	CHECK(expected.requestID == actual.requestID);
+	CHECK(expected.parentID == actual.parentID);
+	CHECK(expected.subtree == actual.subtree);
+	CHECK(expected.unfinishedOnly == actual.unfinishedOnly);
+	CHECK(expected.offset == actual.offset);
+	CHECK(expected.limit == actual.limit);
+}
+
+inline void verify_task_page(const TaskPageMessage& expected, const TaskPageMessage& actual, std::source_location location)
+{
+	CHECK(expected.requestID == actual.requestID);
+	CHECK(expected.parentID == actual.parentID);
+	CHECK(expected.offset == actual.offset);
+	CHECK(expected.total == actual.total);
+	CHECK(expected.tasks == actual.tasks);
+}
+
+inline void verify_request_resync(const RequestResyncMessage& expected, const RequestResyncMessage& actual, std::source_location location)
+{
+	CHECK(expected.requestID == actual.requestID);
+	CHECK(expected.epoch == actual.epoch);
+	CHECK(expected.sequence == actual.sequence);
+}
+
+inline void verify_sync_position(const SyncPositionMessage& expected, const SyncPositionMessage& actual, std::source_location location)
+{
+	CHECK(expected.epoch == actual.epoch);
+	CHECK(expected.sequence == actual.sequence);
+	CHECK(expected.fullSync == actual.fullSync);
+}
+
+inline void verify_bulk_task_info(const BulkTaskInfoMessage& expected, const BulkTaskInfoMessage& actual, std::source_location location)
+{
+	CHECK(expected.taskIDs == actual.taskIDs);
+	CHECK(expected.parentIDs == actual.parentIDs);
+	CHECK(expected.states == actual.states);
+	CHECK(expected.flags == actual.flags);
+	CHECK(expected.indexInParent == actual.indexInParent);
+	CHECK(expected.createTimes == actual.createTimes);
+	CHECK(expected.finishTimes == actual.finishTimes);
+	CHECK(expected.nameOffsets == actual.nameOffsets);
+	CHECK(expected.names == actual.names);
+	CHECK(expected.labelOffsets == actual.labelOffsets);
+	CHECK(expected.labelTextOffsets == actual.labelTextOffsets);
+	CHECK(expected.labelText == actual.labelText);
+	CHECK(expected.sessionOffsets == actual.sessionOffsets);
+	CHECK(expected.sessionStarts == actual.sessionStarts);
+	CHECK(expected.sessionStops == actual.sessionStops);
+	CHECK(expected.sessionStopped == actual.sessionStopped);
+	CHECK(expected.sessionEntryOffsets == actual.sessionEntryOffsets);
+	CHECK(expected.sessionCategories == actual.sessionCategories);
+	CHECK(expected.sessionCodes == actual.sessionCodes);
+	CHECK(expected.timeEntryOffsets == actual.timeEntryOffsets);
+	CHECK(expected.timeEntryCategories == actual.timeEntryCategories);
+	CHECK(expected.timeEntryCodes == actual.timeEntryCodes);
+}
+
+inline void verify_request_protocol_version(const RequestProtocolVersionMessage& expected, const RequestProtocolVersionMessage& actual, std::source_location location)
+{
+	CHECK(expected.requestID == actual.requestID);
+	CHECK(expected.version == actual.version);
+}
+
+inline void verify_protocol_version(const ProtocolVersionMessage& expected, const ProtocolVersionMessage& actual, std::source_location location)
+{
+	CHECK(expected.version == actual.version);
+}
+
+inline void verify_chunk(const ChunkMessage& expected, const ChunkMessage& actual, std::source_location location)
+{
+	CHECK(expected.last == actual.last);
+	CHECK(expected.payload == actual.payload);
+}
+
+inline void verify_stats(const StatsMessage& expected, const StatsMessage& actual, std::source_location location)
+{
+	CHECK(expected.request == actual.request);
+	CHECK(expected.packets == actual.packets);
+}
+
 template<typename T>
 void verify_message(const T& expected, const Message& actual, std::source_location location = std::source_location::current())
 {
@@ -180,11 +304,14 @@ void verify_message(const T& expected, const Message& actual, std::source_locati
 
 	case VERSION_REQUEST:
 	case REQUEST_CONFIGURATION:
+	case REQUEST_CONFIGURATION_WITHOUT_TASKS:
 	case REQUEST_CONFIGURATION_COMPLETE:
 	case BULK_TASK_UPDATE_START:
 	case BULK_TASK_UPDATE_FINISH:
 	case BULK_TASK_INFO_START:
 	case BULK_TASK_INFO_FINISH:
+	case ARCHIVED_TASK_INFO_START:
+	case ARCHIVED_TASK_INFO_FINISH:
 	case UNSPECIFIED_TASK_ACTIVE:
 		// basic type. no fields; no verification
 		break;
@@ -202,6 +329,10 @@ void verify_message(const T& expected, const Message& actual, std::source_locati
 	case STOP_TASK:
 	case FINISH_TASK:
 	case REQUEST_TASK:
+	case REQUEST_ARCHIVED_TASKS:
+	case TASKS_ARCHIVED:
+	case SUBSCRIBE_TASKS:
+	case UNSUBSCRIBE_TASKS:
 	{
 		verify_task_message(*dynamic_cast<const TaskMessage*>(&expected), static_cast<const TaskMessage&>(actual), location);
 		break;
@@ -238,6 +369,11 @@ void verify_message(const T& expected, const Message& actual, std::source_locati
 		verify_task_info(*dynamic_cast<const TaskInfoMessage*>(&expected), static_cast<const TaskInfoMessage&>(actual), location);
 		break;
 	}
+	case TASK_INFO_DELTA:
+	{
+		verify_task_info_delta(*dynamic_cast<const TaskInfoDeltaMessage*>(&expected), static_cast<const TaskInfoDeltaMessage&>(actual), location);
+		break;
+	}
 	case DAILY_REPORT:
 	{
 		verify_daily_report(*dynamic_cast<const DailyReportMessage*>(&expected), static_cast<const DailyReportMessage&>(actual), location);
@@ -273,6 +409,74 @@ void verify_message(const T& expected, const Message& actual, std::source_locati
 		verify_time_entry_modify(*dynamic_cast<const TimeEntryModifyPacket*>(&expected), static_cast<const TimeEntryModifyPacket&>(actual), location);
 		break;
 	}
+	case BUGZILLA_REFRESH:
+	case REQUEST_STATS:
+	case DATABASE_FLUSH:
+	case ENABLE_TASK_INFO_DELTA:
+	{
+		verify_request_message(*dynamic_cast<const RequestMessage*>(&expected), static_cast<const RequestMessage&>(actual), location);
+		break;
+	}
+	case STATS:
+	{
+		verify_stats(*dynamic_cast<const StatsMessage*>(&expected), static_cast<const StatsMessage&>(actual), location);
+		break;
+	}
+	case BACKUP_CONFIGURATION:
+	{
+		verify_backup_configuration(*dynamic_cast<const BackupConfigurationMessage*>(&expected), static_cast<const BackupConfigurationMessage&>(actual), location);
+		break;
+	}
+	case BACKUP_PERFORMED:
+	{
+		verify_backup_performed(*dynamic_cast<const BackupPerformedMessage*>(&expected), static_cast<const BackupPerformedMessage&>(actual), location);
+		break;
+	}
+	case BACKUP_FAILED:
+	{
+		verify_backup_failed(*dynamic_cast<const BackupFailedMessage*>(&expected), static_cast<const BackupFailedMessage&>(actual), location);
+		break;
+	}
+	case REQUEST_TASKS:
+	{
+		verify_request_tasks(*dynamic_cast<const RequestTasksMessage*>(&expected), static_cast<const RequestTasksMessage&>(actual), location);
+		break;
+	}
+	case TASK_PAGE:
+	{
+		verify_task_page(*dynamic_cast<const TaskPageMessage*>(&expected), static_cast<const TaskPageMessage&>(actual), location);
+		break;
+	}
+	case REQUEST_RESYNC:
+	{
+		verify_request_resync(*dynamic_cast<const RequestResyncMessage*>(&expected), static_cast<const RequestResyncMessage&>(actual), location);
+		break;
+	}
+	case SYNC_POSITION:
+	{
+		verify_sync_position(*dynamic_cast<const SyncPositionMessage*>(&expected), static_cast<const SyncPositionMessage&>(actual), location);
+		break;
+	}
+	case BULK_TASK_INFO:
+	{
+		verify_bulk_task_info(*dynamic_cast<const BulkTaskInfoMessage*>(&expected), static_cast<const BulkTaskInfoMessage&>(actual), location);
+		break;
+	}
+	case REQUEST_PROTOCOL_VERSION:
+	{
+		verify_request_protocol_version(*dynamic_cast<const RequestProtocolVersionMessage*>(&expected), static_cast<const RequestProtocolVersionMessage&>(actual), location);
+		break;
+	}
+	case PROTOCOL_VERSION:
+	{
+		verify_protocol_version(*dynamic_cast<const ProtocolVersionMessage*>(&expected), static_cast<const ProtocolVersionMessage&>(actual), location);
+		break;
+	}
+	case CHUNK:
+	{
+		verify_chunk(*dynamic_cast<const ChunkMessage*>(&expected), static_cast<const ChunkMessage&>(actual), location);
+		break;
+	}
 	default:
 		FAIL("Unhandled packet type");
 	}
@@ -16,8 +16,8 @@ static const TimeCode TEST_TIME_CODE_1 = TimeCode(TimeCodeID(2), "Two");
 static const TimeCategory TEST_TIME_CATEGORY_2 = TimeCategory(TimeCategoryID(2), "Test Category 2");
 static const TimeCode TEST_TIME_CODE_2 = TimeCode(TimeCodeID(3), "Three");
 
-static const TimeEntry TEST_TIME_ENTRY_1 = TimeEntry(TEST_TIME_CATEGORY_1, TEST_TIME_CODE_1);
-static const TimeEntry TEST_TIME_ENTRY_2 = TimeEntry(TEST_TIME_CATEGORY_2, TEST_TIME_CODE_2);
+static const TimeEntry TEST_TIME_ENTRY_1 = TimeEntry{ TEST_TIME_CATEGORY_1.id, TEST_TIME_CODE_1.id };
+static const TimeEntry TEST_TIME_ENTRY_2 = TimeEntry{ TEST_TIME_CATEGORY_2.id, TEST_TIME_CODE_2.id };
 
 std::vector<std::byte> bytes(auto... a)
 {
@@ -94,6 +94,30 @@ public:
 
 		return *this;
 	}
+
+	// raw bytes without a length in front of them
+	PacketVerifier& verify_bytes(std::string_view expected, std::string_view field_name)
+	{
+		INFO("field: " << field_name << ", expected value: " << expected);
+
+		INFO("");
+		INFO(cpptrace::generate_trace().to_string());
+
+		REQUIRE(m_current_pos + expected.size() <= m_bytes.size());
+
+		std::string str;
+
+		for (auto byte : std::span(m_bytes).subspan(m_current_pos, expected.size()))
+		{
+			str.push_back(static_cast<char>(byte));
+		}
+
+		m_current_pos += expected.size();
+
+		CHECK(str == expected);
+
+		return *this;
+	}
 };
 
 struct PacketTestHelper
@@ -132,7 +156,7 @@ TEST_CASE("Create Task", "[message]")
 {
 	auto create_task = CreateTaskMessage(TaskID(5), RequestID(10), "this is a test");
 	create_task.labels = { "one", "two" };
-	create_task.timeEntry = std::vector{ TEST_TIME_ENTRY_1, TEST_TIME_ENTRY_2 };
+	create_task.timeEntry = { TEST_TIME_ENTRY_1, TEST_TIME_ENTRY_2 };
 
 	CAPTURE(create_task);
 
@@ -142,7 +166,7 @@ TEST_CASE("Create Task", "[message]")
 
 		create_task.print(ss);
 
-		auto expected_text = "CreateTaskMessage { packetType: CREATE_TASK (3), requestID: 10, parentID: 5, name: \"this is a test\", labels { \"one\", \"two\", }, timeCodes: [ [ Test Category 1 (1) Two (2) ], [ Test Category 2 (2) Three (3) ], ] }";
+		auto expected_text = "CreateTaskMessage { packetType: CREATE_TASK (3), requestID: 10, parentID: 5, name: \"this is a test\", labels { \"one\", \"two\", }, timeCodes: [ [ 1 2 ], [ 2 3 ], ] }";
 
 		CHECK(ss.str() == expected_text);
 
@@ -191,7 +215,7 @@ TEST_CASE("Update Task", "[message]")
 	auto update_task = UpdateTaskMessage(RequestID(10), TaskID(5), TaskID(1), "this is a test");
 	update_task.state = TaskState::ACTIVE;
 	update_task.labels = { "one", "two" };
-	update_task.timeEntry = std::vector{ TEST_TIME_ENTRY_1, TEST_TIME_ENTRY_2 };
+	update_task.timeEntry = { TEST_TIME_ENTRY_1, TEST_TIME_ENTRY_2 };
 
 	CAPTURE(update_task);
 
@@ -201,7 +225,7 @@ TEST_CASE("Update Task", "[message]")
 
 		update_task.print(ss);
 
-		auto expected_text = "UpdateTaskMessage { packetType: UPDATE_TASK (8), requestID: 10, taskID: 5, parentID: 1, state: 1, indexInParent: 0, serverControlled: 0, locked: 0, name: \"this is a test\", labels { \"one\", \"two\", }, timeCodes: [ [ Test Category 1 (1) Two (2) ], [ Test Category 2 (2) Three (3) ], ] }";
+		auto expected_text = "UpdateTaskMessage { packetType: UPDATE_TASK (8), requestID: 10, taskID: 5, parentID: 1, state: 1, indexInParent: 0, serverControlled: 0, locked: 0, name: \"this is a test\", labels { \"one\", \"two\", }, timeCodes: [ [ 1 2 ], [ 2 3 ], ] }";
 
 		CHECK(ss.str() == expected_text);
 
@@ -277,7 +301,7 @@ TEST_CASE("Update Task Times", "[message]")
 
 TEST_CASE("Task", "[messages]")
 {
-	const auto packet_type = GENERATE(PacketType::START_TASK, PacketType::STOP_TASK, PacketType::FINISH_TASK, PacketType::REQUEST_TASK);
+	const auto packet_type = GENERATE(PacketType::START_TASK, PacketType::STOP_TASK, PacketType::FINISH_TASK, PacketType::REQUEST_TASK, PacketType::REQUEST_ARCHIVED_TASKS, PacketType::SUBSCRIBE_TASKS, PacketType::UNSUBSCRIBE_TASKS);
 	CAPTURE(packet_type);
 
 	const auto task = TaskMessage(packet_type, RequestID(10), TaskID(20));
@@ -792,4 +816,916 @@ TEST_CASE("Bugzilla Info Packet", "[message]")
 		verify_message(packet, message);
 		CHECK(result.bytes_read == 130);
 	}
-}
\ No newline at end of file
+}
+
+TEST_CASE("Stats", "[message]")
+{
+	auto message = StatsMessage(RequestOrigin{ PacketType::REQUEST_STATS, RequestID(10) });
+
+	PacketStats stats;
+	stats.packetType = PacketType::CREATE_TASK;
+	stats.requestTime.count = 2;
+	stats.requestTime.sum = 30;
+	stats.requestTime.buckets = { 0, 0, 0, 1, 1 };
+
+	message.packets.push_back(stats);
+
+	SECTION("Pack")
+	{
+		auto verifier = PacketVerifier(message.pack(), 160);
+
+		verifier
+			.verify_value<std::uint32_t>(160, "packet length")
+			.verify_value(static_cast<std::int32_t>(PacketType::STATS), "packet ID")
+			.verify_value<std::int32_t>(10, "request ID")
+			.verify_value<std::int32_t>(1, "packet type count")
+			.verify_value(static_cast<std::int32_t>(PacketType::CREATE_TASK), "packet type")
+			.verify_value<std::uint64_t>(2, "request time count")
+			.verify_value<std::uint64_t>(30, "request time sum")
+			.verify_value<std::int32_t>(5, "request time bucket count")
+			.verify_value<std::uint64_t>(0, "request time bucket 0")
+			.verify_value<std::uint64_t>(0, "request time bucket 1")
+			.verify_value<std::uint64_t>(0, "request time bucket 2")
+			.verify_value<std::uint64_t>(1, "request time bucket 3")
+			.verify_value<std::uint64_t>(1, "request time bucket 4");
+	}
+
+	SECTION("Unpack")
+	{
+		PacketTestHelper helper;
+		helper.expect_packet<StatsMessage>(message, 160);
+	}
+
+	SECTION("Percentile")
+	{
+		CHECK(stats.requestTime.percentile(50) == 15);
+		CHECK(stats.requestTime.percentile(99) == 15);
+		CHECK(stats.requestTime.percentile(0) == 7);
+	}
+}
+
+TEST_CASE("Backup Configuration", "[message]")
+{
+	auto message = BackupConfigurationMessage(RequestID(10), "C:/backups", 60, 5);
+
+	SECTION("Pack")
+	{
+		auto verifier = PacketVerifier(message.pack(), 32);
+
+		verifier
+			.verify_value<std::uint32_t>(32, "packet length")
+			.verify_value(static_cast<std::int32_t>(PacketType::BACKUP_CONFIGURATION), "packet ID")
+			.verify_value<std::int32_t>(10, "request ID")
+			.verify_string("C:/backups", "backup location")
+			.verify_value<std::int32_t>(60, "backup frequency")
+			.verify_value<std::int32_t>(5, "number of backups to keep");
+	}
+
+	SECTION("Unpack")
+	{
+		PacketTestHelper helper;
+		helper.expect_packet<BackupConfigurationMessage>(message, 32);
+	}
+}
+
+TEST_CASE("Backup Performed", "[message]")
+{
+	auto message = BackupPerformedMessage(std::chrono::milliseconds(1737344039870));
+
+	SECTION("Pack")
+	{
+		auto verifier = PacketVerifier(message.pack(), 16);
+
+		verifier
+			.verify_value<std::uint32_t>(16, "packet length")
+			.verify_value(static_cast<std::int32_t>(PacketType::BACKUP_PERFORMED), "packet ID")
+			.verify_value<std::int64_t>(1737344039870, "backup time");
+	}
+
+	SECTION("Unpack")
+	{
+		PacketTestHelper helper;
+		helper.expect_packet<BackupPerformedMessage>(message, 16);
+	}
+}
+
+TEST_CASE("Backup Failed", "[message]")
+{
+	auto message = BackupFailedMessage("disk full", std::chrono::milliseconds(1737344039870));
+
+	SECTION("Pack")
+	{
+		auto verifier = PacketVerifier(message.pack(), 27);
+
+		verifier
+			.verify_value<std::uint32_t>(27, "packet length")
+			.verify_value(static_cast<std::int32_t>(PacketType::BACKUP_FAILED), "packet ID")
+			.verify_string("disk full", "error message")
+			.verify_value<std::int64_t>(1737344039870, "previous backup time");
+	}
+
+	SECTION("Unpack")
+	{
+		PacketTestHelper helper;
+		helper.expect_packet<BackupFailedMessage>(message, 27);
+	}
+}
+
+TEST_CASE("Request Tasks", "[message]")
+{
+	auto message = RequestTasksMessage(RequestID(10), TaskID(5));
+	message.subtree = true;
+	message.unfinishedOnly = true;
+	message.offset = 100;
+	message.limit = 50;
+
+	SECTION("Pack")
+	{
+		auto verifier = PacketVerifier(message.pack(), 26);
+
+		verifier
+			.verify_value<std::uint32_t>(26, "packet length")
+			.verify_value(static_cast<std::int32_t>(PacketType::REQUEST_TASKS), "packet ID")
+			.verify_value<std::int32_t>(10, "request ID")
+			.verify_value<std::int32_t>(5, "parent ID")
+			.verify_value<bool>(true, "subtree")
+			.verify_value<bool>(true, "unfinished only")
+			.verify_value<std::int32_t>(100, "offset")
+			.verify_value<std::int32_t>(50, "limit");
+	}
+
+	SECTION("Unpack")
+	{
+		PacketTestHelper helper;
+		helper.expect_packet<RequestTasksMessage>(message, 26);
+	}
+}
+
+TEST_CASE("Task Page", "[message]")
+{
+	auto message = TaskPageMessage(RequestID(10), TaskID(5));
+	message.offset = 100;
+	message.total = 250;
+	message.tasks.push_back(TaskPageEntry{ TaskID(6), 3 });
+	message.tasks.push_back(TaskPageEntry{ TaskID(8), 0 });
+
+	SECTION("Pack")
+	{
+		auto verifier = PacketVerifier(message.pack(), 44);
+
+		verifier
+			.verify_value<std::uint32_t>(44, "packet length")
+			.verify_value(static_cast<std::int32_t>(PacketType::TASK_PAGE), "packet ID")
+			.verify_value<std::int32_t>(10, "request ID")
+			.verify_value<std::int32_t>(5, "parent ID")
+			.verify_value<std::int32_t>(100, "offset")
+			.verify_value<std::int32_t>(250, "total")
+			.verify_value<std::int32_t>(2, "task count")
+			.verify_value<std::int32_t>(6, "task ID")
+			.verify_value<std::int32_t>(3, "child count")
+			.verify_value<std::int32_t>(8, "task ID")
+			.verify_value<std::int32_t>(0, "child count");
+	}
+
+	SECTION("Unpack")
+	{
+		PacketTestHelper helper;
+		helper.expect_packet<TaskPageMessage>(message, 44);
+	}
+}
+
+TEST_CASE("Request Resync", "[message]")
+{
+	auto message = RequestResyncMessage(RequestID(10), 1737344039870, 500);
+
+	SECTION("Pack")
+	{
+		auto verifier = PacketVerifier(message.pack(), 28);
+
+		verifier
+			.verify_value<std::uint32_t>(28, "packet length")
+			.verify_value(static_cast<std::int32_t>(PacketType::REQUEST_RESYNC), "packet ID")
+			.verify_value<std::int32_t>(10, "request ID")
+			.verify_value<std::int64_t>(1737344039870, "epoch")
+			.verify_value<std::int64_t>(500, "sequence");
+	}
+
+	SECTION("Unpack")
+	{
+		PacketTestHelper helper;
+		helper.expect_packet<RequestResyncMessage>(message, 28);
+	}
+}
+
+TEST_CASE("Sync Position", "[message]")
+{
+	auto message = SyncPositionMessage(1737344039870, 500, true);
+
+	SECTION("Pack")
+	{
+		auto verifier = PacketVerifier(message.pack(), 25);
+
+		verifier
+			.verify_value<std::uint32_t>(25, "packet length")
+			.verify_value(static_cast<std::int32_t>(PacketType::SYNC_POSITION), "packet ID")
+			.verify_value<std::int64_t>(1737344039870, "epoch")
+			.verify_value<std::int64_t>(500, "sequence")
+			.verify_value<bool>(true, "full sync");
+	}
+
+	SECTION("Unpack")
+	{
+		PacketTestHelper helper;
+		helper.expect_packet<SyncPositionMessage>(message, 25);
+	}
+}
+
+TEST_CASE("Task Info", "[message]")
+{
+	TimeCategories categories;
+	categories.categories.push_back(TimeCategory(TEST_TIME_CATEGORY_1.id, TEST_TIME_CATEGORY_1.name, { TimeCode(TEST_TIME_CODE_1.id, TEST_TIME_CODE_1.name) }));
+
+	auto message = TaskInfoMessage(TaskID(5), TaskID(1), "test", std::chrono::milliseconds(1000));
+	message.times.push_back(TaskTimes{ std::chrono::milliseconds(2000), std::nullopt, { TEST_TIME_ENTRY_1 } });
+	message.labels.push_back("label");
+
+	SECTION("Unpack Without Finish Time Or Session Stop")
+	{
+		const auto bytes = message.pack();
+		const auto result = TaskInfoMessage::unpack(std::span(bytes).subspan(4), categories);
+
+		REQUIRE(result);
+		CHECK(result->finishTime == std::nullopt);
+		REQUIRE(result->times.size() == 1);
+		CHECK(result->times[0].start == std::chrono::milliseconds(2000));
+		CHECK(result->times[0].stop == std::nullopt);
+		CHECK(result->times[0].timeEntry.size() == 1);
+		CHECK(result->labels == SmallVector<std::string, 2>{ "label" });
+	}
+
+	SECTION("Unpack With Finish Time")
+	{
+		message.times[0].stop = std::chrono::milliseconds(3000);
+		message.finishTime = std::chrono::milliseconds(4000);
+
+		const auto bytes = message.pack();
+		const auto result = TaskInfoMessage::unpack(std::span(bytes).subspan(4), categories);
+
+		REQUIRE(result);
+		CHECK(result->finishTime == std::chrono::milliseconds(4000));
+		REQUIRE(result->times.size() == 1);
+		CHECK(result->times[0].stop == std::chrono::milliseconds(3000));
+		CHECK(result->labels == SmallVector<std::string, 2>{ "label" });
+	}
+}
+
+TEST_CASE("Version", "[message]")
+{
+	auto message = VersionMessage("0.14.1");
+
+	SECTION("Pack")
+	{
+		auto verifier = PacketVerifier(message.pack(), 16);
+
+		verifier
+			.verify_value<std::uint32_t>(16, "packet length")
+			.verify_value(static_cast<std::int32_t>(PacketType::VERSION), "packet ID")
+			.verify_string("0.14.1", "version");
+	}
+
+	SECTION("Unpack")
+	{
+		const auto bytes = message.pack();
+		const auto result = VersionMessage::unpack(std::span(bytes).subspan(4));
+
+		REQUIRE(result);
+		CHECK(result->version == "0.14.1");
+	}
+
+	SECTION("Print")
+	{
+		std::ostringstream ss;
+
+		message.print(ss);
+
+		CHECK(ss.str() == std::format("VersionMessage {{ packetType: VERSION ({}), version: \"0.14.1\" }}", static_cast<std::int32_t>(PacketType::VERSION)));
+	}
+}
+
+TEST_CASE("Schema", "[message]")
+{
+	auto message = RequestDailyReportMessage(RequestID(10), 2, 3, 2025);
+
+	SECTION("Unpack Reports The Field")
+	{
+		auto bytes = message.pack();
+		bytes.resize(bytes.size() - 1);
+
+		const auto result = RequestDailyReportMessage::unpack(std::span(bytes).subspan(4));
+
+		REQUIRE(!result);
+		CHECK(result.error() == UnpackError::NOT_ENOUGH_BYTES);
+		CHECK(result.error().field == "year");
+		CHECK(result.error().offset == 10);
+	}
+
+	SECTION("Packet Type Is Passed To The Constructor")
+	{
+		const auto bytes = TaskMessage(PacketType::FINISH_TASK, RequestID(10), TaskID(5)).pack();
+		const auto result = TaskMessage::unpack(std::span(bytes).subspan(4));
+
+		REQUIRE(result);
+		CHECK(result->packetType() == PacketType::FINISH_TASK);
+		CHECK(result->taskID == TaskID(5));
+	}
+}
+
+TEST_CASE("Task Info Delta", "[message]")
+{
+	auto message = TaskInfoDeltaMessage(TaskID(5));
+	message.changed = TaskInfoDeltaMessage::STATE | TaskInfoDeltaMessage::SESSIONS;
+	message.state = TaskState::ACTIVE;
+	message.sessionCount = 3;
+	message.firstSession = 2;
+	message.sessions.push_back(TaskTimes{ std::chrono::milliseconds(1000), std::nullopt, { TEST_TIME_ENTRY_1 } });
+
+	SECTION("Pack")
+	{
+		auto verifier = PacketVerifier(message.pack(), 61);
+
+		verifier
+			.verify_value<std::uint32_t>(61, "packet length")
+			.verify_value(static_cast<std::int32_t>(PacketType::TASK_INFO_DELTA), "packet ID")
+			.verify_value<std::int32_t>(5, "task ID")
+			.verify_value<std::uint32_t>(TaskInfoDeltaMessage::STATE | TaskInfoDeltaMessage::SESSIONS, "changed")
+			.verify_value<std::int32_t>(static_cast<std::int32_t>(TaskState::ACTIVE), "state")
+			.verify_value<std::int32_t>(3, "session count")
+			.verify_value<std::int32_t>(2, "first session")
+			.verify_value<std::int32_t>(1, "sessions")
+			.verify_value<std::int64_t>(1000, "start time")
+			.verify_value<bool>(false, "stop present")
+			.verify_value<std::int64_t>(0, "stop time")
+			.verify_value<std::int32_t>(1, "time entry count")
+			.verify_value<std::int32_t>(TEST_TIME_ENTRY_1.categoryID._val, "time category ID")
+			.verify_value<std::int32_t>(TEST_TIME_ENTRY_1.codeID._val, "time code ID");
+	}
+
+	SECTION("Unpack")
+	{
+		PacketTestHelper helper;
+		helper.expect_packet<TaskInfoDeltaMessage>(message, 61);
+	}
+}
+
+TEST_CASE("Bulk Task Info", "[message]")
+{
+	auto first = TaskInfoMessage(TaskID(1), NO_PARENT, "a", std::chrono::milliseconds(100));
+	first.state = TaskState::ACTIVE;
+	first.locked = true;
+	first.times.push_back(TaskTimes{ std::chrono::milliseconds(1000), std::chrono::milliseconds(2000), { TEST_TIME_ENTRY_1 } });
+	first.labels = { "x" };
+
+	auto second = TaskInfoMessage(TaskID(2), TaskID(1), "bc", std::chrono::milliseconds(200));
+	second.state = TaskState::FINISHED;
+	second.finishTime = std::chrono::milliseconds(3000);
+	second.serverControlled = true;
+	second.labels = { "y", "zz" };
+	second.timeEntry = { TEST_TIME_ENTRY_1 };
+
+	auto message = BulkTaskInfoMessage();
+	message.add(first);
+	message.add(second);
+
+	SECTION("Pack")
+	{
+		auto verifier = PacketVerifier(message.pack(), 184);
+
+		verifier
+			.verify_value<std::uint32_t>(184, "packet length")
+			.verify_value(static_cast<std::int32_t>(PacketType::BULK_TASK_INFO), "packet ID")
+			.verify_value<std::int32_t>(2, "task count")
+			.verify_value<std::int32_t>(1, "task ID")
+			.verify_value<std::int32_t>(2, "task ID")
+			.verify_value<std::int32_t>(0, "parent ID")
+			.verify_value<std::int32_t>(1, "parent ID")
+			.verify_value<std::uint8_t>(static_cast<std::uint8_t>(TaskState::ACTIVE), "state")
+			.verify_value<std::uint8_t>(static_cast<std::uint8_t>(TaskState::FINISHED), "state")
+			.verify_value<std::uint8_t>(BulkTaskInfoMessage::LOCKED, "flags")
+			.verify_value<std::uint8_t>(BulkTaskInfoMessage::SERVER_CONTROLLED | BulkTaskInfoMessage::FINISHED, "flags")
+			.verify_value<std::int32_t>(0, "index in parent")
+			.verify_value<std::int32_t>(0, "index in parent")
+			.verify_value<std::int64_t>(100, "create time")
+			.verify_value<std::int64_t>(200, "create time")
+			.verify_value<std::int64_t>(0, "finish time")
+			.verify_value<std::int64_t>(3000, "finish time")
+			.verify_value<std::int32_t>(0, "name offset")
+			.verify_value<std::int32_t>(1, "name offset")
+			.verify_value<std::int32_t>(3, "name offset")
+			.verify_bytes("abc", "names")
+			.verify_value<std::int32_t>(0, "label offset")
+			.verify_value<std::int32_t>(1, "label offset")
+			.verify_value<std::int32_t>(3, "label offset")
+			.verify_value<std::int32_t>(0, "label text offset")
+			.verify_value<std::int32_t>(1, "label text offset")
+			.verify_value<std::int32_t>(2, "label text offset")
+			.verify_value<std::int32_t>(4, "label text offset")
+			.verify_bytes("xyzz", "label text")
+			.verify_value<std::int32_t>(0, "session offset")
+			.verify_value<std::int32_t>(1, "session offset")
+			.verify_value<std::int32_t>(1, "session offset")
+			.verify_value<std::int64_t>(1000, "session start")
+			.verify_value<std::int64_t>(2000, "session stop")
+			.verify_value<std::uint8_t>(1, "session stopped")
+			.verify_value<std::int32_t>(0, "session entry offset")
+			.verify_value<std::int32_t>(1, "session entry offset")
+			.verify_value<std::int32_t>(TEST_TIME_ENTRY_1.categoryID._val, "session time category ID")
+			.verify_value<std::int32_t>(TEST_TIME_ENTRY_1.codeID._val, "session time code ID")
+			.verify_value<std::int32_t>(0, "time entry offset")
+			.verify_value<std::int32_t>(0, "time entry offset")
+			.verify_value<std::int32_t>(1, "time entry offset")
+			.verify_value<std::int32_t>(TEST_TIME_ENTRY_1.categoryID._val, "time category ID")
+			.verify_value<std::int32_t>(TEST_TIME_ENTRY_1.codeID._val, "time code ID");
+	}
+
+	SECTION("Unpack")
+	{
+		PacketTestHelper helper;
+		helper.expect_packet<BulkTaskInfoMessage>(message, 184);
+	}
+
+	SECTION("Tasks")
+	{
+		TimeCategories categories;
+		categories.categories.push_back(TimeCategory(TEST_TIME_CATEGORY_1.id, TEST_TIME_CATEGORY_1.name, { TimeCode(TEST_TIME_CODE_1.id, TEST_TIME_CODE_1.name) }));
+
+		REQUIRE(message.size() == 2);
+
+		verify_message(first, message.task(0, categories));
+		verify_message(second, message.task(1, categories));
+	}
+
+	SECTION("Compact")
+	{
+		const auto bytes = message.pack_compact();
+
+		CHECK(bytes.size() < message.pack().size());
+
+		const auto result = BulkTaskInfoMessage::unpack_compact(std::span(bytes).subspan(4));
+
+		REQUIRE(result.has_value());
+
+		verify_message(message, result.value());
+	}
+
+	SECTION("Offsets Going Backwards")
+	{
+		message.nameOffsets = { 0, 3, 1 };
+
+		const auto bytes = message.pack();
+
+		CHECK(BulkTaskInfoMessage::unpack(std::span(bytes).subspan(4)).error() == UnpackError::INVALID_OFFSETS);
+	}
+}
+
+TEST_CASE("Request Protocol Version", "[message]")
+{
+	auto message = RequestProtocolVersionMessage(RequestID(10), 2);
+
+	SECTION("Pack")
+	{
+		auto verifier = PacketVerifier(message.pack(), 16);
+
+		verifier
+			.verify_value<std::uint32_t>(16, "packet length")
+			.verify_value(static_cast<std::int32_t>(PacketType::REQUEST_PROTOCOL_VERSION), "packet ID")
+			.verify_value<std::int32_t>(10, "request ID")
+			.verify_value<std::int32_t>(2, "version");
+	}
+
+	SECTION("Unpack")
+	{
+		PacketTestHelper helper;
+		helper.expect_packet<RequestProtocolVersionMessage>(message, 16);
+	}
+}
+
+TEST_CASE("Protocol Version", "[message]")
+{
+	auto message = ProtocolVersionMessage(2);
+
+	SECTION("Pack")
+	{
+		auto verifier = PacketVerifier(message.pack(), 12);
+
+		verifier
+			.verify_value<std::uint32_t>(12, "packet length")
+			.verify_value(static_cast<std::int32_t>(PacketType::PROTOCOL_VERSION), "packet ID")
+			.verify_value<std::int32_t>(2, "version");
+	}
+
+	SECTION("Unpack")
+	{
+		PacketTestHelper helper;
+		helper.expect_packet<ProtocolVersionMessage>(message, 12);
+	}
+}
+
+TEST_CASE("Chunk", "[message]")
+{
+	auto message = ChunkMessage(true, { std::byte{ 1 }, std::byte{ 2 }, std::byte{ 3 } });
+
+	SECTION("Pack")
+	{
+		auto verifier = PacketVerifier(message.pack(), 12);
+
+		verifier
+			.verify_value<std::uint32_t>(12, "packet length")
+			.verify_value(static_cast<std::int32_t>(PacketType::CHUNK), "packet ID")
+			.verify_value<std::int8_t>(1, "last")
+			.verify_value<std::int8_t>(1, "payload")
+			.verify_value<std::int8_t>(2, "payload")
+			.verify_value<std::int8_t>(3, "payload");
+	}
+
+	SECTION("Unpack")
+	{
+		PacketTestHelper helper;
+		helper.expect_packet<ChunkMessage>(message, 12);
+	}
+
+	SECTION("Split And Reassemble")
+	{
+		std::vector<std::byte> packet(250);
+
+		for (std::size_t i = 0; i < packet.size(); i++)
+		{
+			packet[i] = static_cast<std::byte>(i);
+		}
+
+		const auto chunks = split_into_chunks(packet.size(), 100);
+
+		REQUIRE(chunks.size() == 3);
+
+		CHECK(chunks[0].offset == 0);
+		CHECK(chunks[0].size == 100);
+		CHECK(chunks[2].offset == 200);
+		CHECK(chunks[2].size == 50);
+
+		ChunkAssembler assembler;
+
+		for (std::size_t i = 0; i < chunks.size(); i++)
+		{
+			// the frame that's written for the chunk, its header and then its part of the packet
+			std::vector<std::byte> frame(chunks[i].header.begin(), chunks[i].header.end());
+			frame.insert(frame.end(), packet.begin() + chunks[i].offset, packet.begin() + chunks[i].offset + chunks[i].size);
+
+			CHECK(frame.size() == CHUNK_HEADER_SIZE + chunks[i].size);
+
+			const auto chunk = ChunkMessage::unpack(std::span(frame).subspan(4));
+
+			REQUIRE(chunk.has_value());
+			CHECK(chunk->last == (i == chunks.size() - 1));
+
+			const auto result = assembler.add(chunk.value());
+
+			CHECK(result.has_value() == chunk->last);
+
+			if (result)
+			{
+				CHECK(result.value() == packet);
+			}
+		}
+	}
+}
+
+TEST_CASE("String Lengths", "[message]")
+{
+	const auto message = CreateTaskMessage(TaskID(1), RequestID(2), std::string(40'000, 'a'));
+
+	SECTION("Long")
+	{
+		const StringLengthScope scope(StringLength::LONG);
+
+		const auto bytes = message.pack();
+		const auto result = CreateTaskMessage::unpack(std::span(bytes).subspan(4), TimeCategories{});
+
+		REQUIRE(result.has_value());
+		CHECK(result->name == message.name);
+	}
+
+	SECTION("Short Strings Are Cut Off")
+	{
+		const auto bytes = message.pack();
+		const auto result = CreateTaskMessage::unpack(std::span(bytes).subspan(4), TimeCategories{});
+
+		// the rest of the packet is still readable
+		REQUIRE(result.has_value());
+		CHECK(result->name == std::string(MAX_SHORT_STRING_LENGTH, 'a'));
+		CHECK(result->parentID == TaskID(1));
+	}
+
+	SECTION("Scopes Nest")
+	{
+		{
+			const StringLengthScope outer(StringLength::LONG);
+
+			{
+				const StringLengthScope inner(StringLength::SHORT);
+
+				CHECK(StringLengthScope::current() == StringLength::SHORT);
+			}
+			CHECK(StringLengthScope::current() == StringLength::LONG);
+		}
+		CHECK(StringLengthScope::current() == StringLength::SHORT);
+	}
+}
+
+TEST_CASE("Small Vector", "[message]")
+{
+	SmallVector<std::string, 2> values{ "a", "b" };
+
+	CHECK(values.is_inline());
+
+	SECTION("Grows Onto The Heap")
+	{
+		values.push_back("c");
+
+		CHECK(!values.is_inline());
+		CHECK(values == SmallVector<std::string, 2>{ "a", "b", "c" });
+
+		// the heap block is taken instead of copied
+		const auto* data = values.data();
+
+		auto moved = std::move(values);
+
+		CHECK(moved.data() == data);
+		CHECK(values.empty());
+		CHECK(values.is_inline());
+	}
+
+	SECTION("Push Back A Value Of Itself")
+	{
+		values.push_back(values[0]);
+
+		CHECK(values == SmallVector<std::string, 2>{ "a", "b", "a" });
+	}
+
+	SECTION("Copy")
+	{
+		auto copy = values;
+
+		copy[0] = "z";
+
+		CHECK(values[0] == "a");
+		CHECK(copy.is_inline());
+	}
+
+	SECTION("Insert And Erase")
+	{
+		values.insert(values.begin() + 1, "c");
+
+		CHECK(values == SmallVector<std::string, 2>{ "a", "c", "b" });
+
+		values.erase(values.begin());
+
+		CHECK(values == SmallVector<std::string, 2>{ "c", "b" });
+	}
+
+	SECTION("Ordering")
+	{
+		CHECK(values < SmallVector<std::string, 2>{ "a", "c" });
+		CHECK(values > SmallVector<std::string, 2>{ "a" });
+
+		// TimeEntry only has <
+		CHECK(SmallVector<TimeEntry, 2>{ TEST_TIME_ENTRY_1 } < SmallVector<TimeEntry, 2>{ TEST_TIME_ENTRY_2 });
+	}
+
+	SECTION("Sessions Don't Allocate For Their Time Entry")
+	{
+		const auto times = create_times_with_unknown_time_entry(std::chrono::milliseconds(1000), std::nullopt);
+
+		CHECK(times.timeEntry.is_inline());
+	}
+}
+
+TEST_CASE("Varints", "[message]")
+{
+	PacketBuilder builder;
+
+	builder.add_varint(0);
+	builder.add_varint(127);
+	builder.add_varint(300);
+	builder.add_varint(std::numeric_limits<std::uint64_t>::max());
+	builder.add_zigzag(-1);
+	builder.add_zigzag(std::numeric_limits<std::int64_t>::min());
+	builder.add_compact("abc");
+
+	const auto bytes = builder.bytes();
+
+	CHECK_THAT(std::span(bytes).subspan(0, 4), Catch::Matchers::RangeEquals(::bytes(0x00, 0x7F, 0xAC, 0x02)));
+
+	auto parser = PacketParser(bytes);
+
+	CHECK(parser.parse_varint() == 0);
+	CHECK(parser.parse_varint() == 127);
+	CHECK(parser.parse_varint() == 300);
+	CHECK(parser.parse_varint() == std::numeric_limits<std::uint64_t>::max());
+	CHECK(parser.parse_zigzag() == -1);
+	CHECK(parser.parse_zigzag() == std::numeric_limits<std::int64_t>::min());
+	CHECK(parser.parse_compact_string() == "abc");
+	CHECK(parser.parse_varint().error() == UnpackError::NOT_ENOUGH_BYTES);
+
+	SECTION("Too Long")
+	{
+		const auto continued = std::vector<std::byte>(11, std::byte{ 0x80 });
+
+		auto parser = PacketParser(continued);
+
+		CHECK(parser.parse_varint().error() == UnpackError::VARINT_TOO_LONG);
+	}
+}
+
+TEST_CASE("Compact Task Info", "[message]")
+{
+	auto message = TaskInfoMessage(TaskID(5), NO_PARENT, "abc", std::chrono::milliseconds(1000));
+	message.state = TaskState::ACTIVE;
+	message.times.push_back(TaskTimes{ std::chrono::milliseconds(1500), std::chrono::milliseconds(2000), { TEST_TIME_ENTRY_1 } });
+	message.labels = { "x" };
+
+	SECTION("Pack")
+	{
+		auto verifier = PacketVerifier(message.pack_compact(), 31);
+
+		verifier
+			.verify_value<std::uint32_t>(31, "packet length")
+			.verify_value(static_cast<std::int32_t>(PacketType::TASK_INFO), "packet ID")
+			.verify_value<std::uint8_t>(5, "task ID")
+			.verify_value<std::uint8_t>(0, "parent ID")
+			.verify_value<std::uint8_t>(0, "flags")
+			.verify_value<std::uint8_t>(static_cast<std::uint8_t>(TaskState::ACTIVE), "state")
+			.verify_value<std::uint8_t>(0, "index in parent")
+			.verify_value<std::uint8_t>(3, "name length")
+			.verify_bytes("abc", "name")
+			.verify_value<std::uint16_t>(0xD00F, "create time") // zigzag 2000
+			.verify_value<std::uint8_t>(1, "session count")
+			.verify_value<std::uint16_t>(0xE807, "start after create time") // zigzag 1000
+			.verify_value<std::uint16_t>(0xF503, "session length + 1") // 501
+			.verify_value<std::uint8_t>(1, "time entry count")
+			.verify_value<std::uint8_t>(TEST_TIME_ENTRY_1.categoryID._val, "time category ID")
+			.verify_value<std::uint8_t>(TEST_TIME_ENTRY_1.codeID._val, "time code ID")
+			.verify_value<std::uint8_t>(1, "label count")
+			.verify_value<std::uint8_t>(1, "label length")
+			.verify_bytes("x", "label")
+			.verify_value<std::uint8_t>(0, "time entry count");
+	}
+
+	SECTION("Unpack")
+	{
+		TimeCategories categories;
+		categories.categories.push_back(TimeCategory(TEST_TIME_CATEGORY_1.id, TEST_TIME_CATEGORY_1.name, { TimeCode(TEST_TIME_CODE_1.id, TEST_TIME_CODE_1.name) }));
+
+		message.finishTime = std::chrono::milliseconds(900);
+		message.times.push_back(TaskTimes{ std::chrono::milliseconds(1800), std::nullopt, {} });
+
+		const auto bytes = message.pack_compact();
+		const auto result = TaskInfoMessage::unpack_compact(std::span(bytes).subspan(4), categories);
+
+		REQUIRE(result.has_value());
+
+		verify_message(message, result.value());
+	}
+}
+
+TEST_CASE("Parse Request", "[message]")
+{
+	TimeCategories categories;
+
+	RequestPacket storage;
+
+	auto create = CreateTaskMessage(TaskID(5), RequestID(10), "this is a test");
+	create.labels.push_back("label");
+
+	const auto createBytes = create.pack();
+
+	CHECK(parse_request(createBytes, categories, storage) == createBytes.size());
+
+	REQUIRE(std::holds_alternative<CreateTaskView>(storage));
+
+	const auto& view = std::get<CreateTaskView>(storage);
+
+	CHECK(view.requestID == RequestID(10));
+	CHECK(view.parentID == TaskID(5));
+	CHECK(view.name == "this is a test");
+	REQUIRE(view.labels.size() == 1);
+	CHECK(view.labels[0] == "label");
+
+	// the strings are read in place
+	const auto* first = reinterpret_cast<const char*>(createBytes.data());
+	CHECK(view.name.data() > first);
+	CHECK(view.name.data() < first + createBytes.size());
+
+	// the storage is reused for the next request
+	auto start = TaskMessage(PacketType::START_TASK, RequestID(11), TaskID(5));
+
+	CHECK(parse_request(start.pack(), categories, storage) == 16);
+
+	REQUIRE(std::holds_alternative<TaskMessage>(storage));
+	verify_message(start, std::get<TaskMessage>(storage));
+	CHECK(request_message(storage) == &std::get<TaskMessage>(storage));
+
+	SECTION("Not A Request")
+	{
+		const auto result = parse_request(SuccessResponse(RequestOrigin{ PacketType::START_TASK, RequestID(1) }).pack(), categories, storage);
+
+		REQUIRE(!result);
+		CHECK(result.error() == UnpackError::UNKNOWN_PACKET_TYPE);
+		CHECK(result.error().field == "packetType");
+
+		CHECK(std::holds_alternative<std::monostate>(storage));
+		CHECK(request_message(storage) == nullptr);
+	}
+
+	SECTION("Truncated")
+	{
+		auto bytes = start.pack();
+		bytes.resize(14);
+
+		const auto result = parse_request(bytes, categories, storage);
+
+		REQUIRE(!result);
+		CHECK(result.error() == UnpackError::NOT_ENOUGH_BYTES);
+		CHECK(result.error().offset == 8);
+		CHECK(result.error().field == "taskID");
+
+		CHECK(std::holds_alternative<std::monostate>(storage));
+	}
+
+	SECTION("Truncated Count")
+	{
+		auto create = CreateTaskMessage(TaskID(5), RequestID(12), "test");
+		create.labels.push_back("one");
+		create.labels.push_back("two");
+
+		auto bytes = create.pack();
+		bytes.resize(bytes.size() - 6);
+
+		const auto result = parse_request(bytes, categories, storage);
+
+		REQUIRE(!result);
+		CHECK(result.error() == UnpackError::NOT_ENOUGH_BYTES);
+		CHECK(result.error().field == "labels");
+	}
+
+	SECTION("Too Short For A Packet Type")
+	{
+		const std::vector<std::byte> bytes{ std::byte(0), std::byte(0), std::byte(0), std::byte(6), std::byte(0), std::byte(0) };
+
+		const auto result = parse_request(bytes, categories, storage);
+
+		REQUIRE(!result);
+		CHECK(result.error() == UnpackError::NOT_ENOUGH_BYTES);
+		CHECK(result.error().field == "packetType");
+	}
+}
+
+TEST_CASE("Unpack Failure", "[message]")
+{
+	SECTION("Request")
+	{
+		auto bytes = TaskMessage(PacketType::START_TASK, RequestID(11), TaskID(5)).pack();
+		bytes.resize(14);
+
+		const auto failure = unpack_failure(bytes, UnpackError(UnpackError::NOT_ENOUGH_BYTES, 8, "taskID"));
+
+		CHECK(failure.request.packetType == PacketType::START_TASK);
+		CHECK(failure.request.id == RequestID(11));
+		CHECK(failure.message == "Failed to unpack 'taskID' at offset 8: not enough bytes.");
+	}
+
+	SECTION("Too Short For A Request ID")
+	{
+		const std::vector<std::byte> bytes{ std::byte(0), std::byte(0), std::byte(0), std::byte(6), std::byte(0), std::byte(0) };
+
+		const auto failure = unpack_failure(bytes, UnpackError(UnpackError::NOT_ENOUGH_BYTES, 0, "packetType"));
+
+		CHECK(failure.request.id == RequestID(0));
+		CHECK(failure.message == "Failed to unpack 'packetType' at offset 0: not enough bytes.");
+	}
+}
+
+TEST_CASE("Parse Packet Reports Unpack Errors", "[message]")
+{
+	TimeCategories categories;
+
+	auto bytes = TimeEntryDataPacket({ TimeCategory(TimeCategoryID(1), "A", { TimeCode(TimeCodeID(2), "B") }) }).pack();
+	bytes.resize(bytes.size() - 1);
+
+	const auto result = parse_packet(bytes, categories);
+
+	CHECK(!result.packet);
+	CHECK(result.bytes_read == static_cast<std::int32_t>(bytes.size() + 1));
+
+	REQUIRE(result.error);
+	CHECK(*result.error == UnpackError::NOT_ENOUGH_BYTES);
+	CHECK(result.error->field == "archived");
+}
@@ -3,9 +3,15 @@
 
 #include "packets.hpp"
 #include "database.hpp"
+#include "database_writer.hpp"
+#include "snapshot.hpp"
+#include "event_journal.hpp"
+#include "backup.hpp"
+#include "statistics.hpp"
 #include "utils.h"
 
 #include <filesystem>
+#include <future>
 
 #include "SQLiteCpp/Database.h"
 
@@ -47,8 +53,8 @@ static const TimeCategory TEST_TIME_CATEGORY_3 = TimeCategory(TimeCategoryID(3),
 static const TimeCategory TEST_TIME_CATEGORY_4 = TimeCategory(TimeCategoryID(4), "Test Category 4");
 static const TimeCategory TEST_TIME_CATEGORY_5 = TimeCategory(TimeCategoryID(5), "Test Category 5");
 
-static const TimeEntry TEST_TIME_ENTRY_1 = TimeEntry(TEST_TIME_CATEGORY_1, TEST_TIME_CODE_1);
-static const TimeEntry TEST_TIME_ENTRY_2 = TimeEntry(TEST_TIME_CATEGORY_2, TEST_TIME_CODE_2);
+static const TimeEntry TEST_TIME_ENTRY_1 = TimeEntry{ TEST_TIME_CATEGORY_1.id, TEST_TIME_CODE_1.id };
+static const TimeEntry TEST_TIME_ENTRY_2 = TimeEntry{ TEST_TIME_CATEGORY_2.id, TEST_TIME_CODE_2.id };
 
 TEST_CASE("Create Database", "[database]")
 {
@@ -74,6 +80,394 @@ TEST_CASE("Create Database", "[database]")
 	has_table("bugzillaBugToTask");
 }
 
+TEST_CASE("Durability Profiles", "[database]")
+{
+	const auto pragma = [](DatabaseImpl& db, const std::string& name)
+		{
+			return db.database().execAndGet("PRAGMA " + name + ";").getString();
+		};
+
+	std::filesystem::remove("durability_test.db3");
+
+	TestPacketSender sender;
+
+	SECTION("Default Is Balanced")
+	{
+		DatabaseImpl db("durability_test.db3", sender);
+
+		CHECK(pragma(db, "synchronous") == "1");
+		CHECK(pragma(db, "cache_size") == "-32768");
+	}
+
+	SECTION("Safe")
+	{
+		DatabaseImpl db("durability_test.db3", sender, DurabilityProfile::SAFE);
+
+		CHECK(pragma(db, "journal_mode") == "wal");
+		CHECK(pragma(db, "synchronous") == "2");
+		CHECK(pragma(db, "cache_size") == "-8192");
+		CHECK(pragma(db, "wal_autocheckpoint") == "0");
+	}
+
+	SECTION("Balanced")
+	{
+		DatabaseImpl db("durability_test.db3", sender, DurabilityProfile::BALANCED);
+
+		CHECK(pragma(db, "journal_mode") == "wal");
+		CHECK(pragma(db, "synchronous") == "1");
+		CHECK(pragma(db, "cache_size") == "-32768");
+		CHECK(pragma(db, "temp_store") == "2");
+	}
+
+	SECTION("Fast")
+	{
+		DatabaseImpl db("durability_test.db3", sender, DurabilityProfile::FAST);
+
+		CHECK(pragma(db, "journal_mode") == "wal");
+		CHECK(pragma(db, "synchronous") == "0");
+		CHECK(pragma(db, "cache_size") == "-65536");
+		CHECK(pragma(db, "temp_store") == "2");
+	}
+
+	CHECK(sender.output.empty());
+
+	std::filesystem::remove("durability_test.db3");
+}
+
+TEST_CASE("Load Database From Snapshot", "[database]")
+{
+	std::filesystem::remove("snapshot_test.db3");
+	std::filesystem::remove("snapshot_test.snap");
+
+	TestClock clock;
+	curlTest curl;
+
+	std::vector<Task> expected;
+
+	{
+		TestPacketSender sender;
+		DatabaseImpl db("snapshot_test.db3", sender);
+		db.snapshot_file("snapshot_test.snap");
+
+		API api(clock, curl, db, sender);
+
+		auto addTimeEntry = TimeEntryModifyPacket(RequestID(1));
+		addTimeEntry.categories.emplace_back(TimeCategoryModType::ADD, TimeCategoryID(0), "A");
+		addTimeEntry.codes.emplace_back(TimeCategoryModType::ADD, 0, TimeCodeID(0), "Code 1", false);
+
+		api.process_packet(addTimeEntry);
+
+		CreateTaskMessage create1(NO_PARENT, RequestID(2), "parent");
+		create1.timeEntry.emplace_back(TimeCategoryID(1), TimeCodeID(1));
+
+		api.process_packet(create1);
+		api.process_packet(CreateTaskMessage(TaskID(1), RequestID(3), "child"));
+		api.process_packet(TaskMessage(PacketType::START_TASK, RequestID(4), TaskID(1)));
+		api.process_packet(TaskMessage(PacketType::START_TASK, RequestID(5), TaskID(2)));
+
+		db.write_snapshot(api.m_app, api.m_bugzilla, sender);
+
+		// these are only in the database and have to be replayed on top of the snapshot
+		api.m_app.rename_task(TaskID(2), "renamed child");
+		api.process_packet(CreateTaskMessage(NO_PARENT, RequestID(6), "after snapshot"));
+
+		CHECK(sender.output.size() > 0);
+
+		expected.push_back(api.m_app.unspecified_task());
+
+		for (int i = 1; i <= 3; i++)
+		{
+			expected.push_back(*api.m_app.find_task(TaskID(i)));
+		}
+
+		// changing a row without going through the database class leaves its sequence number alone, the snapshot is
+		// used for it instead
+		db.database().exec("update tasks set Name = 'modified' where TaskID == 1");
+	}
+
+	const auto load_tasks = [&](const std::string& snapshot)
+		{
+			TestPacketSender sender;
+			DatabaseImpl db("snapshot_test.db3", sender);
+			db.snapshot_file(snapshot);
+
+			API api(clock, curl, db, sender);
+
+			CHECK(sender.output.empty());
+
+			std::vector<Task> tasks;
+			tasks.push_back(api.m_app.unspecified_task());
+
+			for (int i = 1; i <= 3; i++)
+			{
+				REQUIRE(api.m_app.find_task(TaskID(i)) != nullptr);
+				tasks.push_back(*api.m_app.find_task(TaskID(i)));
+			}
+
+			CHECK(api.m_app.active_task() == api.m_app.find_task(TaskID(2)));
+
+			return tasks;
+		};
+
+	SECTION("Snapshot And Newer Rows")
+	{
+		const auto tasks = load_tasks("snapshot_test.snap");
+
+		CHECK(tasks == expected);
+	}
+
+	SECTION("Without Snapshot")
+	{
+		const auto tasks = load_tasks("");
+
+		CHECK(tasks[1].m_name == "modified");
+
+		expected[1].m_name = "modified";
+
+		CHECK(tasks == expected);
+	}
+
+	SECTION("Damaged Snapshot Falls Back To The Database")
+	{
+		{
+			std::fstream file("snapshot_test.snap", std::ios::in | std::ios::out | std::ios::binary);
+			file.seekp(-1, std::ios::end);
+			file.put('\x7f');
+		}
+
+		const auto tasks = load_tasks("snapshot_test.snap");
+
+		CHECK(tasks[1].m_name == "modified");
+	}
+
+	std::filesystem::remove("snapshot_test.db3");
+	std::filesystem::remove("snapshot_test.snap");
+}
+
+TEST_CASE("Event Journal", "[database]")
+{
+	std::filesystem::remove("journal_test.db3");
+	std::filesystem::remove_all("journal_test");
+
+	TestClock clock;
+	curlTest curl;
+
+	const auto task_rows = [](DatabaseImpl& db)
+		{
+			return db.database().execAndGet("select count(*) from tasks").getInt();
+		};
+
+	std::vector<Task> expected;
+
+	{
+		TestPacketSender sender;
+		DatabaseImpl db("journal_test.db3", sender);
+		EventJournal journal(db, "journal_test");
+
+		API api(clock, curl, journal, sender);
+
+		api.process_packet(CreateTaskMessage(NO_PARENT, RequestID(1), "a"));
+		api.process_packet(CreateTaskMessage(NO_PARENT, RequestID(2), "b"));
+		api.process_packet(CreateTaskMessage(TaskID(1), RequestID(3), "c"));
+		api.process_packet(TaskMessage(PacketType::START_TASK, RequestID(4), TaskID(1)));
+		clock.time += std::chrono::minutes(5);
+		api.process_packet(TaskMessage(PacketType::START_TASK, RequestID(5), TaskID(2)));
+		clock.time += std::chrono::minutes(5);
+		api.process_packet(TaskMessage(PacketType::STOP_TASK, RequestID(6), TaskID(2)));
+		api.process_packet(TaskMessage(PacketType::START_TASK, RequestID(7), TaskID(3)));
+		clock.time += std::chrono::minutes(5);
+		api.process_packet(TaskMessage(PacketType::FINISH_TASK, RequestID(8), TaskID(3)));
+		api.m_app.rename_task(TaskID(1), "renamed");
+		api.m_app.reparent_task(TaskID(2), TaskID(1));
+		api.process_packet(TaskMessage(PacketType::START_TASK, RequestID(9), TaskID(1)));
+
+		// nothing has been compacted yet, the tasks are only in the journal
+		CHECK(task_rows(db) == 0);
+
+		for (int i = 1; i <= 3; i++)
+		{
+			expected.push_back(*api.m_app.find_task(TaskID(i)));
+		}
+	}
+
+	const auto load = [&](std::size_t compactEvents, auto&& func)
+		{
+			TestPacketSender sender;
+			DatabaseImpl db("journal_test.db3", sender);
+			EventJournal journal(db, "journal_test", compactEvents);
+
+			API api(clock, curl, journal, sender);
+
+			CHECK(sender.output.empty());
+
+			func(db, journal, api, sender);
+		};
+
+	SECTION("Replay")
+	{
+		load(1000, [&](DatabaseImpl& db, EventJournal& journal, API& api, TestPacketSender& sender)
+			{
+				for (int i = 1; i <= 3; i++)
+				{
+					REQUIRE(api.m_app.find_task(TaskID(i)) != nullptr);
+					CHECK(*api.m_app.find_task(TaskID(i)) == expected[i - 1]);
+				}
+
+				CHECK(api.m_app.active_task() == api.m_app.find_task(TaskID(1)));
+				CHECK(api.m_app.m_nextTaskID == TaskID(4));
+			});
+	}
+
+	SECTION("Compact")
+	{
+		load(1000, [&](DatabaseImpl& db, EventJournal& journal, API& api, TestPacketSender& sender)
+			{
+				journal.compact(sender);
+
+				CHECK(task_rows(db) == 3);
+
+				// the replayed segment is kept until the next compaction
+				journal.compact(sender);
+			});
+
+		std::size_t segments = 0;
+
+		for (auto&& entry : std::filesystem::directory_iterator("journal_test"))
+		{
+			segments++;
+		}
+
+		// the segment from the last compaction and the one that was still open
+		CHECK(segments == 2);
+
+		load(1000, [&](DatabaseImpl& db, EventJournal& journal, API& api, TestPacketSender& sender)
+			{
+				for (int i = 1; i <= 3; i++)
+				{
+					REQUIRE(api.m_app.find_task(TaskID(i)) != nullptr);
+					CHECK(*api.m_app.find_task(TaskID(i)) == expected[i - 1]);
+				}
+			});
+	}
+
+	SECTION("Compact Once The Segment Is Full")
+	{
+		load(2, [&](DatabaseImpl& db, EventJournal& journal, API& api, TestPacketSender& sender)
+			{
+				CHECK(task_rows(db) == 0);
+
+				api.m_app.rename_task(TaskID(2), "x");
+				api.m_app.rename_task(TaskID(2), "y");
+
+				CHECK(task_rows(db) == 3);
+				CHECK(db.database().execAndGet("select Name from tasks where TaskID == 2").getString() == "y");
+			});
+	}
+
+	SECTION("Backup Includes The Segments")
+	{
+		std::filesystem::remove_all("journal_backup_test");
+		std::filesystem::create_directories("journal_backup_test");
+
+		const auto file = std::filesystem::path("journal_backup_test") / backup_file_name(clock.time);
+
+		load(1000, [&](DatabaseImpl& db, EventJournal& journal, API& api, TestPacketSender& sender)
+			{
+				CHECK(journal.backup(file) == std::nullopt);
+			});
+
+		// none of the events have been compacted, without the segments the backup would be empty
+		{
+			TestPacketSender sender;
+			DatabaseImpl db(file.string(), sender);
+			EventJournal journal(db, backup_journal_directory(file));
+
+			API api(clock, curl, journal, sender);
+
+			for (int i = 1; i <= 3; i++)
+			{
+				REQUIRE(api.m_app.find_task(TaskID(i)) != nullptr);
+				CHECK(*api.m_app.find_task(TaskID(i)) == expected[i - 1]);
+			}
+		}
+
+		std::filesystem::remove_all("journal_backup_test");
+	}
+
+	std::filesystem::remove("journal_test.db3");
+	std::filesystem::remove_all("journal_test");
+}
+
+TEST_CASE("Persisted Strings Keep Their Length", "[database]")
+{
+	std::filesystem::remove("long_strings_test.db3");
+	std::filesystem::remove_all("long_strings_test");
+
+	TestClock clock;
+	curlTest curl;
+
+	// longer than a 2 byte length can describe
+	const std::string name(40'000, 'a');
+
+	SECTION("Snapshot")
+	{
+		TestPacketSender sender;
+		nullDatabase db;
+		API api(clock, curl, db, sender);
+
+		api.process_packet(CreateTaskMessage(NO_PARENT, RequestID(1), name));
+
+		const auto snapshot = parse_snapshot(build_snapshot(0, api.m_app, api.m_bugzilla), api.m_app.timeCategories());
+
+		REQUIRE(snapshot.has_value());
+		REQUIRE(snapshot->tasks.size() == 2);
+		CHECK(snapshot->tasks[1].m_name == name);
+	}
+
+	SECTION("Event Journal")
+	{
+		{
+			TestPacketSender sender;
+			DatabaseImpl db("long_strings_test.db3", sender);
+			EventJournal journal(db, "long_strings_test");
+
+			API api(clock, curl, journal, sender);
+
+			api.process_packet(CreateTaskMessage(NO_PARENT, RequestID(1), name));
+		}
+
+		TestPacketSender sender;
+		DatabaseImpl db("long_strings_test.db3", sender);
+		EventJournal journal(db, "long_strings_test");
+
+		API api(clock, curl, journal, sender);
+
+		REQUIRE(api.m_app.find_task(TaskID(1)) != nullptr);
+		CHECK(api.m_app.find_task(TaskID(1))->m_name == name);
+	}
+
+	SECTION("Archived Tasks")
+	{
+		TestPacketSender sender;
+		DatabaseImpl db(":memory:", sender);
+
+		API api(clock, curl, db, sender);
+
+		api.process_packet(CreateTaskMessage(NO_PARENT, RequestID(1), "parent"));
+		api.process_packet(CreateTaskMessage(TaskID(1), RequestID(2), name));
+
+		db.archive_tasks({ *api.m_app.find_task(TaskID(2)) }, sender);
+
+		const auto archived = db.load_archived_tasks(TaskID(1), api.m_app.timeCategories(), sender);
+
+		REQUIRE(archived.size() == 1);
+		CHECK(archived[0].m_name == name);
+	}
+
+	std::filesystem::remove("long_strings_test.db3");
+	std::filesystem::remove_all("long_strings_test");
+}
+
 TEST_CASE("Load Database", "[database]")
 {
 	std::filesystem::remove("database_load_test.db3");
@@ -94,20 +488,20 @@ TEST_CASE("Load Database", "[database]")
 		helper.expect_success(addTimeEntry);
 
 		CreateTaskMessage create1(NO_PARENT, RequestID(1), "parent");
-		create1.timeEntry.emplace_back(TEST_TIME_CATEGORY_1, TEST_TIME_CODE_1);
-		create1.timeEntry.emplace_back(TEST_TIME_CATEGORY_2, TimeCode(TimeCodeID(4), ""));
+		create1.timeEntry.emplace_back(TEST_TIME_CATEGORY_1.id, TEST_TIME_CODE_1.id);
+		create1.timeEntry.emplace_back(TEST_TIME_CATEGORY_2.id, TimeCodeID(4));
 
 		CreateTaskMessage create2(TaskID(1), RequestID(2), "child 1");
-		create2.timeEntry.emplace_back(TEST_TIME_CATEGORY_1, TEST_TIME_CODE_2);
-		create2.timeEntry.emplace_back(TEST_TIME_CATEGORY_2, TimeCode(TimeCodeID(3), ""));
+		create2.timeEntry.emplace_back(TEST_TIME_CATEGORY_1.id, TEST_TIME_CODE_2.id);
+		create2.timeEntry.emplace_back(TEST_TIME_CATEGORY_2.id, TimeCodeID(3));
 
 		CreateTaskMessage create3(TaskID(2), RequestID(3), "child 2");
-		create3.timeEntry.emplace_back(TEST_TIME_CATEGORY_1, TEST_TIME_CODE_2);
-		create3.timeEntry.emplace_back(TEST_TIME_CATEGORY_2, TimeCode(TimeCodeID(4), ""));
+		create3.timeEntry.emplace_back(TEST_TIME_CATEGORY_1.id, TEST_TIME_CODE_2.id);
+		create3.timeEntry.emplace_back(TEST_TIME_CATEGORY_2.id, TimeCodeID(4));
 
 		CreateTaskMessage create4(NO_PARENT, RequestID(3), "parent 2");
-		create3.timeEntry.emplace_back(TEST_TIME_CATEGORY_1, TEST_TIME_CODE_2);
-		create3.timeEntry.emplace_back(TEST_TIME_CATEGORY_2, TimeCode(TimeCodeID(4), ""));
+		create3.timeEntry.emplace_back(TEST_TIME_CATEGORY_1.id, TEST_TIME_CODE_2.id);
+		create3.timeEntry.emplace_back(TEST_TIME_CATEGORY_2.id, TimeCodeID(4));
 
 		helper.expect_success(create1);
 		helper.expect_success(create2);
@@ -230,7 +624,7 @@ TEST_CASE("Load Database", "[database]")
 		TestPacketSender sender;
 		TestHelper<DatabaseImpl> helper{ DatabaseImpl("database_load_test.db3", sender) };
 
-		helper.api.process_packet(BasicMessage{ PacketType::REQUEST_CONFIGURATION });
+		helper.request_configuration();
 
 		REQUIRE(helper.sender.output.size() == 22);
 
@@ -309,7 +703,7 @@ TEST_CASE("Load Unspecified Task from Database - Active", "[database]")
 		TestPacketSender do_not_use;
 		TestHelper<DatabaseImpl> helper{ DatabaseImpl("database_load_test.db3", do_not_use) };
 
-		helper.api.process_packet(BasicMessage{ PacketType::REQUEST_CONFIGURATION });
+		helper.request_configuration();
 
 		auto timeCategories = TimeEntryDataPacket({});
 		auto complete = BasicMessage(PacketType::REQUEST_CONFIGURATION_COMPLETE);
@@ -346,7 +740,7 @@ TEST_CASE("Load Unspecified Task from Database - Inactive", "[database]")
 		TestPacketSender do_not_use;
 		TestHelper<DatabaseImpl> helper{ DatabaseImpl("database_load_test.db3", do_not_use) };
 
-		helper.api.process_packet(BasicMessage{ PacketType::REQUEST_CONFIGURATION });
+		helper.request_configuration();
 
 		auto timeCategories = TimeEntryDataPacket({});
 		auto complete = BasicMessage(PacketType::REQUEST_CONFIGURATION_COMPLETE);
@@ -355,7 +749,7 @@ TEST_CASE("Load Unspecified Task from Database - Inactive", "[database]")
 		root.createTime = std::chrono::milliseconds(1737344039870);
 		root.state = TaskState::ACTIVE;
 		root.times.emplace_back(std::chrono::milliseconds(1737344939870));
-		root.times.back().timeEntry.emplace_back(TEST_TIME_CATEGORY_UNKNOWN, TEST_TIME_CODE_UNKNOWN);
+		root.times.back().timeEntry.emplace_back(TEST_TIME_CATEGORY_UNKNOWN.id, TEST_TIME_CODE_UNKNOWN.id);
 
 		auto bulk_start = BasicMessage(PacketType::BULK_TASK_INFO_START);
 		auto bulk_finish = BasicMessage(PacketType::BULK_TASK_INFO_FINISH);
@@ -658,8 +1052,8 @@ TEST_CASE("Write Task Session to Database", "[database]")
 	api.process_packet(addTimeEntry);
 
 	auto create = CreateTaskMessage(NO_PARENT, RequestID(2), "parent");
-	create.timeEntry.emplace_back(TEST_TIME_CATEGORY_1, TEST_TIME_CODE_1);
-	create.timeEntry.emplace_back(TEST_TIME_CATEGORY_2, TimeCode(TimeCodeID(4), ""));
+	create.timeEntry.emplace_back(TEST_TIME_CATEGORY_1.id, TEST_TIME_CODE_1.id);
+	create.timeEntry.emplace_back(TEST_TIME_CATEGORY_2.id, TimeCodeID(4));
 
 	api.process_packet(create);
 	api.process_packet(TaskMessage(PacketType::START_TASK, RequestID(3), TaskID(1)));
@@ -767,8 +1161,8 @@ TEST_CASE("Add Session - Write to Database", "[database]")
 	api.process_packet(addTimeEntry);
 
 	auto create = CreateTaskMessage(NO_PARENT, RequestID(2), "parent");
-	create.timeEntry.emplace_back(TEST_TIME_CATEGORY_1, TEST_TIME_CODE_1);
-	create.timeEntry.emplace_back(TEST_TIME_CATEGORY_2, TimeCode(TimeCodeID(4), ""));
+	create.timeEntry.emplace_back(TEST_TIME_CATEGORY_1.id, TEST_TIME_CODE_1.id);
+	create.timeEntry.emplace_back(TEST_TIME_CATEGORY_2.id, TimeCodeID(4));
 
 	api.process_packet(create);
 
@@ -841,8 +1235,8 @@ TEST_CASE("Edit Session - Write to Database", "[database]")
 	api.process_packet(addTimeEntry);
 
 	auto create = CreateTaskMessage(NO_PARENT, RequestID(2), "parent");
-	create.timeEntry.emplace_back(TEST_TIME_CATEGORY_1, TEST_TIME_CODE_1);
-	create.timeEntry.emplace_back(TEST_TIME_CATEGORY_2, TimeCode(TimeCodeID(4), ""));
+	create.timeEntry.emplace_back(TEST_TIME_CATEGORY_1.id, TEST_TIME_CODE_1.id);
+	create.timeEntry.emplace_back(TEST_TIME_CATEGORY_2.id, TimeCodeID(4));
 
 	api.process_packet(create);
 	api.process_packet(TaskMessage(PacketType::START_TASK, RequestID(3), TaskID(1)));
@@ -918,8 +1312,8 @@ TEST_CASE("Remove Session - Write to Database", "[database]")
 	api.process_packet(addTimeEntry);
 
 	auto create = CreateTaskMessage(NO_PARENT, RequestID(2), "parent");
-	create.timeEntry.emplace_back(TEST_TIME_CATEGORY_1, TEST_TIME_CODE_1);
-	create.timeEntry.emplace_back(TEST_TIME_CATEGORY_2, TimeCode(TimeCodeID(4), ""));
+	create.timeEntry.emplace_back(TEST_TIME_CATEGORY_1.id, TEST_TIME_CODE_1.id);
+	create.timeEntry.emplace_back(TEST_TIME_CATEGORY_2.id, TimeCodeID(4));
 
 	api.process_packet(create);
 	api.process_packet(TaskMessage(PacketType::START_TASK, RequestID(3), TaskID(1)));
@@ -1226,8 +1620,8 @@ TEST_CASE("Write Task Time Entry to Database", "[database]")
 	SECTION("Add")
 	{
 		auto create = CreateTaskMessage(NO_PARENT, RequestID(2), "parent");
-		create.timeEntry.emplace_back(TEST_TIME_CATEGORY_1, TEST_TIME_CODE_1);
-		create.timeEntry.emplace_back(TEST_TIME_CATEGORY_2, TimeCode(TimeCodeID(4), ""));
+		create.timeEntry.emplace_back(TEST_TIME_CATEGORY_1.id, TEST_TIME_CODE_1.id);
+		create.timeEntry.emplace_back(TEST_TIME_CATEGORY_2.id, TimeCodeID(4));
 
 		api.process_packet(create);
 
@@ -1264,12 +1658,12 @@ TEST_CASE("Write Task Time Entry to Database", "[database]")
 	SECTION("Update - Change Time Codes")
 	{
 		auto create = CreateTaskMessage(NO_PARENT, RequestID(2), "parent");
-		create.timeEntry.emplace_back(TEST_TIME_CATEGORY_1, TEST_TIME_CODE_1);
-		create.timeEntry.emplace_back(TEST_TIME_CATEGORY_2, TimeCode(TimeCodeID(4), ""));
+		create.timeEntry.emplace_back(TEST_TIME_CATEGORY_1.id, TEST_TIME_CODE_1.id);
+		create.timeEntry.emplace_back(TEST_TIME_CATEGORY_2.id, TimeCodeID(4));
 
 		auto update = UpdateTaskMessage(RequestID(2), TaskID(1), NO_PARENT, "parent");
-		update.timeEntry.emplace_back(TEST_TIME_CATEGORY_1, TimeCode(TimeCodeID(2), ""));
-		update.timeEntry.emplace_back(TEST_TIME_CATEGORY_2, TimeCode(TimeCodeID(3), ""));
+		update.timeEntry.emplace_back(TEST_TIME_CATEGORY_1.id, TimeCodeID(2));
+		update.timeEntry.emplace_back(TEST_TIME_CATEGORY_2.id, TimeCodeID(3));
 
 		api.process_packet(create);
 		api.process_packet(update);
@@ -1684,3 +2078,601 @@ TEST_CASE("Write Bugzilla Bug ID to Task ID to Database", "[database]")
 	query.executeStep();
 	CHECK(!query.hasRow());
 }
+
+TEST_CASE("Background Database Writer", "[database]")
+{
+	TestPacketSender sender;
+	TestClock clock;
+	curlTest curl;
+
+	DatabaseImpl database(":memory:", sender);
+
+	// long enough that nothing is committed until the flush
+	DatabaseWriter writer(database, CommitWindow{ std::chrono::minutes(10), 1000 });
+
+	API api(clock, curl, writer, sender);
+
+	const auto task_count = [&]()
+		{
+			SQLite::Statement query(database.database(), "select count(*) from tasks");
+			query.executeStep();
+			return query.getColumn(0).getInt();
+		};
+
+	SECTION("Writes Are Committed By Flush")
+	{
+		api.process_packet(CreateTaskMessage(NO_PARENT, RequestID(1), "a"));
+		api.process_packet(CreateTaskMessage(NO_PARENT, RequestID(2), "b"));
+		api.process_packet(TaskMessage(PacketType::START_TASK, RequestID(3), TaskID(1)));
+
+		CHECK(task_count() == 0);
+
+		sender.output.clear();
+
+		api.process_packet(RequestMessage(PacketType::DATABASE_FLUSH, RequestID(4)));
+
+		REQUIRE(sender.output.size() == 1);
+		verify_message(SuccessResponse(RequestOrigin{ PacketType::DATABASE_FLUSH, RequestID(4) }), *sender.output[0]);
+
+		CHECK(task_count() == 2);
+
+		SQLite::Statement query(database.database(), "select State from tasks where TaskID == 1");
+		query.executeStep();
+		REQUIRE(query.hasRow());
+
+		// the task was written as it was when the last write was queued
+		CHECK(query.getColumn(0).getInt() == static_cast<int>(TaskState::ACTIVE));
+	}
+
+	SECTION("Writes In A Transaction Are Held Until It Finishes")
+	{
+		writer.start_transaction(sender);
+
+		api.process_packet(CreateTaskMessage(NO_PARENT, RequestID(1), "a"));
+
+		CHECK(writer.transaction_in_progress());
+
+		writer.flush(sender);
+
+		CHECK(task_count() == 0);
+
+		writer.finish_transaction(sender);
+		writer.flush(sender);
+
+		CHECK(task_count() == 1);
+	}
+
+	SECTION("Session Events Write The Task And The Changed Session")
+	{
+		clock.auto_increment_test_time = false;
+
+		api.process_packet(CreateTaskMessage(NO_PARENT, RequestID(1), "a"));
+		api.process_packet(TaskMessage(PacketType::START_TASK, RequestID(2), TaskID(1)));
+		clock.time += std::chrono::minutes(5);
+		api.process_packet(TaskMessage(PacketType::STOP_TASK, RequestID(3), TaskID(1)));
+		api.process_packet(TaskMessage(PacketType::START_TASK, RequestID(4), TaskID(1)));
+
+		writer.flush(sender);
+
+		SQLite::Statement query(database.database(), "select SessionIndex, StartTime, StopTime from timeEntrySession where TaskID == 1 order by SessionIndex");
+
+		REQUIRE(query.executeStep());
+		CHECK(query.getColumn(0).getInt() == 0);
+		CHECK(query.getColumn(2).getInt64() - query.getColumn(1).getInt64() == std::chrono::milliseconds(std::chrono::minutes(5)).count());
+
+		REQUIRE(query.executeStep());
+		CHECK(query.getColumn(0).getInt() == 1);
+		CHECK(query.getColumn(2).getInt64() == 0);
+
+		CHECK(!query.executeStep());
+	}
+
+	SECTION("Writer Thread Time Is Recorded For The Queuing Request")
+	{
+		statistics().reset();
+
+		api.process_packet(CreateTaskMessage(NO_PARENT, RequestID(1), "a"));
+
+		writer.flush(sender);
+
+		const auto stats = statistics().data();
+
+		const auto create = std::find_if(stats.begin(), stats.end(), [](const PacketStats& packet) { return packet.packetType == PacketType::CREATE_TASK; });
+
+		REQUIRE(create != stats.end());
+
+		// once for the request and once for each write the writer thread committed for it
+		CHECK(create->databaseTime.count > 1);
+	}
+}
+
+TEST_CASE("Session History", "[database]")
+{
+	std::filesystem::remove("session_history_test.db3");
+
+	TestClock clock;
+	curlTest curl;
+
+	std::vector<TaskTimes> oldSessions;
+	std::vector<TaskTimes> currentSessions;
+
+	{
+		TestPacketSender sender;
+		DatabaseImpl db("session_history_test.db3", sender);
+
+		API api(clock, curl, db, sender);
+
+		api.process_packet(CreateTaskMessage(NO_PARENT, RequestID(1), "old 1"));
+		api.process_packet(CreateTaskMessage(NO_PARENT, RequestID(2), "old 2"));
+		api.process_packet(CreateTaskMessage(NO_PARENT, RequestID(3), "current"));
+
+		for (int i = 1; i <= 3; i++)
+		{
+			api.process_packet(TaskMessage(PacketType::START_TASK, RequestID(10 + i), TaskID(i)));
+			api.process_packet(TaskMessage(PacketType::STOP_TASK, RequestID(20 + i), TaskID(i)));
+		}
+
+		api.process_packet(TaskMessage(PacketType::FINISH_TASK, RequestID(31), TaskID(1)));
+		api.process_packet(TaskMessage(PacketType::FINISH_TASK, RequestID(32), TaskID(2)));
+
+		oldSessions = api.m_app.find_task(TaskID(1))->m_times;
+		currentSessions = api.m_app.find_task(TaskID(3))->m_times;
+	}
+
+	clock.time += std::chrono::days(60);
+	clock.auto_increment_test_time = false;
+
+	TestPacketSender sender;
+	DatabaseImpl db("session_history_test.db3", sender);
+
+	API api(clock, curl, db, sender, SessionHistory{ std::chrono::days(30), 1 });
+
+	REQUIRE(oldSessions.size() == 1);
+
+	CHECK_FALSE(api.m_app.find_task(TaskID(1))->sessionsLoaded);
+	CHECK(api.m_app.find_task(TaskID(1))->m_times.empty());
+	CHECK(api.m_app.find_task(TaskID(3))->sessionsLoaded);
+	CHECK(api.m_app.find_task(TaskID(3))->m_times == currentSessions);
+
+	const auto request_task = [&](TaskID task)
+		{
+			sender.output.clear();
+
+			api.process_packet(TaskMessage(PacketType::REQUEST_TASK, RequestID(40), task));
+
+			REQUIRE(sender.output.size() == 2);
+			return static_cast<const TaskInfoMessage&>(*sender.output[1]);
+		};
+
+	SECTION("Request Task")
+	{
+		CHECK(request_task(TaskID(1)).times == oldSessions);
+		CHECK(api.m_app.find_task(TaskID(1))->sessionsLoaded);
+
+		// the cache holds one task, the least recently used is dropped at the start of the next request
+		request_task(TaskID(2));
+		request_task(TaskID(3));
+
+		CHECK_FALSE(api.m_app.find_task(TaskID(1))->sessionsLoaded);
+		CHECK(api.m_app.find_task(TaskID(2))->sessionsLoaded);
+		CHECK(api.m_app.find_task(TaskID(3))->sessionsLoaded);
+
+		CHECK(request_task(TaskID(1)).times == oldSessions);
+	}
+
+	SECTION("Overlap With Old Session")
+	{
+		const auto& session = oldSessions[0];
+
+		api.process_packet(UpdateTaskTimesMessage(PacketType::ADD_TASK_SESSION, RequestID(50), TaskID(3), session.start, session.stop.value()));
+
+		REQUIRE(sender.output.size() == 1);
+		verify_message(FailureResponse(RequestOrigin{ PacketType::ADD_TASK_SESSION, RequestID(50) }, "Overlap detected with 'old 1'."), *sender.output[0]);
+	}
+
+	SECTION("Edited Sessions Are Only Kept For The Request")
+	{
+		auto edit = UpdateTaskTimesMessage(PacketType::EDIT_TASK_SESSION, RequestID(50), TaskID(1), oldSessions[0].start - 1min, oldSessions[0].stop.value());
+		edit.sessionIndex = 0;
+
+		api.process_packet(edit);
+
+		verify_message(SuccessResponse(edit.origin()), *sender.output[0]);
+
+		oldSessions[0].start -= 1min;
+
+		// back in the cache once the edit is done, the next request pushes it out
+		request_task(TaskID(2));
+
+		CHECK(api.m_app.find_task(TaskID(1))->sessionsLoaded);
+
+		request_task(TaskID(3));
+
+		CHECK_FALSE(api.m_app.find_task(TaskID(1))->sessionsLoaded);
+
+		CHECK(request_task(TaskID(1)).times == oldSessions);
+	}
+
+	SECTION("Edited Sessions Are Read Back Through The Writer")
+	{
+		// nothing is committed until something waits for it
+		DatabaseWriter writer(db, CommitWindow{ std::chrono::minutes(10), 1000 });
+
+		API writerAPI(clock, curl, writer, sender, SessionHistory{ std::chrono::days(30), 1 });
+
+		auto edit = UpdateTaskTimesMessage(PacketType::EDIT_TASK_SESSION, RequestID(50), TaskID(1), oldSessions[0].start - 1min, oldSessions[0].stop.value());
+		edit.sessionIndex = 0;
+
+		writerAPI.process_packet(edit);
+
+		oldSessions[0].start -= 1min;
+
+		writerAPI.process_packet(TaskMessage(PacketType::REQUEST_TASK, RequestID(51), TaskID(2)));
+		writerAPI.process_packet(TaskMessage(PacketType::REQUEST_TASK, RequestID(52), TaskID(3)));
+
+		REQUIRE_FALSE(writerAPI.m_app.find_task(TaskID(1))->sessionsLoaded);
+
+		sender.output.clear();
+
+		writerAPI.process_packet(TaskMessage(PacketType::REQUEST_TASK, RequestID(53), TaskID(1)));
+
+		REQUIRE(sender.output.size() == 2);
+		CHECK(static_cast<const TaskInfoMessage&>(*sender.output[1]).times == oldSessions);
+	}
+
+	SECTION("Sessions Edited During A Bulk Update Are Kept Until It Finishes")
+	{
+		DatabaseWriter writer(db, CommitWindow{ std::chrono::minutes(10), 1000 });
+
+		API writerAPI(clock, curl, writer, sender, SessionHistory{ std::chrono::days(30), 1 });
+
+		writerAPI.process_packet(BasicMessage(PacketType::BULK_TASK_UPDATE_START));
+
+		auto edit = UpdateTaskTimesMessage(PacketType::EDIT_TASK_SESSION, RequestID(50), TaskID(1), oldSessions[0].start - 1min, oldSessions[0].stop.value());
+		edit.sessionIndex = 0;
+
+		writerAPI.process_packet(edit);
+
+		oldSessions[0].start -= 1min;
+
+		writerAPI.process_packet(TaskMessage(PacketType::REQUEST_TASK, RequestID(51), TaskID(2)));
+		writerAPI.process_packet(TaskMessage(PacketType::REQUEST_TASK, RequestID(52), TaskID(3)));
+
+		// the edit is held by the transaction, the database still has the session from before it
+		REQUIRE(writerAPI.m_app.find_task(TaskID(1))->sessionsLoaded);
+		CHECK(writerAPI.m_app.find_task(TaskID(1))->m_times == oldSessions);
+
+		writerAPI.process_packet(BasicMessage(PacketType::BULK_TASK_UPDATE_FINISH));
+
+		writerAPI.process_packet(TaskMessage(PacketType::REQUEST_TASK, RequestID(53), TaskID(2)));
+		writerAPI.process_packet(TaskMessage(PacketType::REQUEST_TASK, RequestID(54), TaskID(3)));
+
+		REQUIRE_FALSE(writerAPI.m_app.find_task(TaskID(1))->sessionsLoaded);
+
+		sender.output.clear();
+
+		writerAPI.process_packet(TaskMessage(PacketType::REQUEST_TASK, RequestID(55), TaskID(1)));
+
+		REQUIRE(sender.output.size() == 2);
+		CHECK(static_cast<const TaskInfoMessage&>(*sender.output[1]).times == oldSessions);
+	}
+}
+
+TEST_CASE("Backups Don't Hold The Database Writer", "[database]")
+{
+	// a backup that doesn't finish until the test lets it
+	struct SlowBackup : nullDatabase
+	{
+		std::optional<std::string> backup(const std::filesystem::path& file) override
+		{
+			started.set_value();
+			finish.get_future().wait();
+			return std::nullopt;
+		}
+
+		std::promise<void> started;
+		std::promise<void> finish;
+	};
+
+	TestPacketSender sender;
+	SlowBackup database;
+
+	DatabaseWriter writer(database);
+
+	auto backup = std::async(std::launch::async, [&]() { return writer.backup("backup_writer_test.db3"); });
+
+	database.started.get_future().wait();
+
+	auto sessions = std::async(std::launch::async, [&]() { return writer.load_sessions(TaskID(1), TimeCategories{}); });
+
+	CHECK(sessions.wait_for(5s) == std::future_status::ready);
+
+	database.finish.set_value();
+
+	CHECK(backup.get() == std::nullopt);
+}
+
+TEST_CASE("Task Archive", "[database]")
+{
+	std::filesystem::remove("archive_test.db3");
+	std::filesystem::remove("archive_test.snap");
+
+	TestClock clock;
+	curlTest curl;
+
+	std::vector<TaskTimes> oldSessions;
+
+	{
+		TestPacketSender sender;
+		DatabaseImpl db("archive_test.db3", sender);
+
+		API api(clock, curl, db, sender);
+
+		api.process_packet(CreateTaskMessage(NO_PARENT, RequestID(1), "bugs"));
+		api.process_packet(CreateTaskMessage(TaskID(1), RequestID(2), "old bug"));
+		api.process_packet(CreateTaskMessage(TaskID(1), RequestID(3), "open bug"));
+		api.process_packet(CreateTaskMessage(NO_PARENT, RequestID(4), "old project"));
+		api.process_packet(CreateTaskMessage(TaskID(4), RequestID(5), "old child"));
+		api.process_packet(CreateTaskMessage(NO_PARENT, RequestID(6), "recent"));
+
+		api.process_packet(TaskMessage(PacketType::START_TASK, RequestID(7), TaskID(2)));
+		api.process_packet(TaskMessage(PacketType::FINISH_TASK, RequestID(8), TaskID(2)));
+		api.process_packet(TaskMessage(PacketType::FINISH_TASK, RequestID(9), TaskID(5)));
+		api.process_packet(TaskMessage(PacketType::FINISH_TASK, RequestID(10), TaskID(4)));
+
+		oldSessions = api.m_app.find_task(TaskID(2))->m_times;
+	}
+
+	clock.time += std::chrono::days(60);
+	clock.auto_increment_test_time = false;
+
+	TestPacketSender sender;
+	DatabaseImpl db("archive_test.db3", sender);
+	db.snapshot_file("archive_test.snap");
+
+	API api(clock, curl, db, sender);
+	api.archive_after(std::chrono::days(30));
+
+	api.process_packet(TaskMessage(PacketType::FINISH_TASK, RequestID(11), TaskID(6)));
+
+	// written before archiving, still has every task
+	db.write_snapshot(api.m_app, api.m_bugzilla, sender);
+
+	sender.output.clear();
+
+	CHECK(api.archive_finished_tasks() == 3);
+
+	// the subtrees are removed from the client
+	REQUIRE(sender.output.size() == 2);
+	verify_message(TaskMessage(PacketType::TASKS_ARCHIVED, RequestID(0), TaskID(2)), *sender.output[0]);
+	verify_message(TaskMessage(PacketType::TASKS_ARCHIVED, RequestID(0), TaskID(4)), *sender.output[1]);
+
+	sender.output.clear();
+
+	api.process_packet(BasicMessage(PacketType::REQUEST_CONFIGURATION));
+
+	std::vector<TaskID> synced;
+
+	for (auto&& message : sender.output)
+	{
+		if (message->packetType() == PacketType::TASK_INFO)
+		{
+			synced.push_back(static_cast<const TaskInfoMessage&>(*message).taskID);
+		}
+	}
+
+	std::sort(synced.begin(), synced.end());
+
+	CHECK(synced == std::vector{ TaskID(1), TaskID(3), TaskID(6) });
+
+	CHECK(api.m_app.find_task(TaskID(2)) == nullptr);
+	CHECK(api.m_app.find_task(TaskID(4)) == nullptr);
+	CHECK(api.m_app.find_task(TaskID(5)) == nullptr);
+
+	const auto request_archive = [&](API& api, TestPacketSender& sender, TaskID parent)
+		{
+			sender.output.clear();
+
+			api.process_packet(TaskMessage(PacketType::REQUEST_ARCHIVED_TASKS, RequestID(20), parent));
+
+			std::vector<TaskInfoMessage> tasks;
+
+			REQUIRE(sender.output.size() >= 3);
+
+			verify_message(SuccessResponse(RequestOrigin{ PacketType::REQUEST_ARCHIVED_TASKS, RequestID(20) }), *sender.output[0]);
+			verify_message(BasicMessage(PacketType::ARCHIVED_TASK_INFO_START), *sender.output[1]);
+			verify_message(BasicMessage(PacketType::ARCHIVED_TASK_INFO_FINISH), *sender.output.back());
+
+			for (std::size_t i = 2; i < sender.output.size() - 1; i++)
+			{
+				tasks.push_back(static_cast<const TaskInfoMessage&>(*sender.output[i]));
+			}
+			return tasks;
+		};
+
+	SECTION("Request Archived Tasks")
+	{
+		const auto top = request_archive(api, sender, NO_PARENT);
+
+		REQUIRE(top.size() == 2);
+		CHECK(top[0].taskID == TaskID(4));
+		CHECK(top[0].name == "old project");
+		CHECK(top[0].state == TaskState::FINISHED);
+		CHECK(top[1].taskID == TaskID(5));
+		CHECK(top[1].parentID == TaskID(4));
+
+		const auto bugs = request_archive(api, sender, TaskID(1));
+
+		REQUIRE(bugs.size() == 1);
+		CHECK(bugs[0].taskID == TaskID(2));
+		CHECK(bugs[0].times == oldSessions);
+
+		CHECK(request_archive(api, sender, TaskID(3)).empty());
+
+		sender.output.clear();
+
+		api.process_packet(TaskMessage(PacketType::REQUEST_ARCHIVED_TASKS, RequestID(21), TaskID(99)));
+
+		REQUIRE(sender.output.size() == 1);
+		verify_message(FailureResponse(RequestOrigin{ PacketType::REQUEST_ARCHIVED_TASKS, RequestID(21) }, "Task with ID 99 does not exist."), *sender.output[0]);
+	}
+
+	SECTION("Archived Tasks Are Not Loaded")
+	{
+		// the snapshot is older than the archive and loading it has to drop the tasks as well
+		const auto snapshot = GENERATE(as<std::string>{}, "", "archive_test.snap");
+		CAPTURE(snapshot);
+
+		TestPacketSender reloadSender;
+		DatabaseImpl reload("archive_test.db3", reloadSender);
+		reload.snapshot_file(snapshot);
+
+		API reloadAPI(clock, curl, reload, reloadSender);
+
+		CHECK(reloadSender.output.empty());
+
+		CHECK(reloadAPI.m_app.task_count() == 3);
+		CHECK(reloadAPI.m_app.find_task(TaskID(2)) == nullptr);
+		CHECK(reloadAPI.m_app.find_task(TaskID(4)) == nullptr);
+		CHECK(reloadAPI.m_app.find_task(TaskID(5)) == nullptr);
+
+		CHECK(request_archive(reloadAPI, reloadSender, TaskID(1))[0].times == oldSessions);
+	}
+
+	SECTION("Archived Subtrees Stay Below Their Parent")
+	{
+		api.process_packet(TaskMessage(PacketType::FINISH_TASK, RequestID(30), TaskID(3)));
+		api.process_packet(TaskMessage(PacketType::FINISH_TASK, RequestID(31), TaskID(1)));
+
+		clock.time += std::chrono::days(60);
+
+		api.archive_finished_tasks();
+
+		CHECK(api.m_app.task_count() == 0);
+
+		const auto top = request_archive(api, sender, NO_PARENT);
+
+		std::vector<TaskID> archived;
+
+		for (auto&& task : top)
+		{
+			archived.push_back(task.taskID);
+		}
+
+		// parents first. task 2 was archived before task 1 and is still found below it
+		CHECK(archived == std::vector{ TaskID(1), TaskID(4), TaskID(6), TaskID(2), TaskID(3), TaskID(5) });
+	}
+}
+
+TEST_CASE("Scheduled Backups", "[database]")
+{
+	std::filesystem::remove("backup_test.db3");
+	std::filesystem::remove_all("backup_test");
+
+	TestClock clock;
+	clock.auto_increment_test_time = false;
+	curlTest curl;
+
+	const auto first_backup = clock.time;
+
+	{
+		TestPacketSender sender;
+		DatabaseImpl db("backup_test.db3", sender);
+
+		API api(clock, curl, db, sender);
+
+		api.process_packet(CreateTaskMessage(NO_PARENT, RequestID(1), "task"));
+		api.process_packet(BackupConfigurationMessage(RequestID(2), "backup_test", 60, 2));
+
+		REQUIRE(sender.output.size() == 3);
+		verify_message(SuccessResponse(RequestOrigin{ PacketType::BACKUP_CONFIGURATION, RequestID(2) }), *sender.output[2]);
+
+		sender.output.clear();
+
+		SECTION("Backup Contains The Database")
+		{
+			CHECK(api.m_backup.perform_backup());
+
+			REQUIRE(sender.output.size() == 1);
+			verify_message(BackupPerformedMessage(first_backup), *sender.output[0]);
+
+			CHECK(api.m_backup.last_backup() == first_backup);
+
+			TestPacketSender backupSender;
+			DatabaseImpl backup((std::filesystem::path("backup_test") / backup_file_name(first_backup)).string(), backupSender);
+
+			API backupAPI(clock, curl, backup, backupSender);
+
+			REQUIRE(backupAPI.m_app.find_task(TaskID(1)) != nullptr);
+			CHECK(backupAPI.m_app.find_task(TaskID(1))->m_name == "task");
+			CHECK(backupSender.output.empty());
+		}
+
+		SECTION("Old Backups Are Removed")
+		{
+			for (int i = 0; i < 3; i++)
+			{
+				CHECK(api.m_backup.perform_backup());
+
+				clock.time += std::chrono::hours(1);
+			}
+
+			const auto backups = find_backups("backup_test");
+
+			REQUIRE(backups.size() == 2);
+			CHECK(backups[0].filename() == backup_file_name(first_backup + std::chrono::hours(1)));
+			CHECK(backups[1].filename() == backup_file_name(first_backup + std::chrono::hours(2)));
+		}
+
+		SECTION("Failed Backup")
+		{
+			CHECK(api.m_backup.perform_backup());
+
+			// a folder can't be created inside of a file
+			api.m_backup.configure(BackupConfiguration{ "backup_test.db3/backups", std::chrono::minutes(60), 2 });
+
+			sender.output.clear();
+
+			CHECK_FALSE(api.m_backup.perform_backup());
+
+			REQUIRE(sender.output.size() == 1);
+			REQUIRE(sender.output[0]->packetType() == PacketType::BACKUP_FAILED);
+
+			// the previous backup was in a different folder
+			CHECK(static_cast<const BackupFailedMessage&>(*sender.output[0]).previousBackupTime == 0ms);
+		}
+
+		SECTION("Invalid Configuration")
+		{
+			api.process_packet(BackupConfigurationMessage(RequestID(3), "backup_test", 0, 2));
+			verify_message(FailureResponse(RequestOrigin{ PacketType::BACKUP_CONFIGURATION, RequestID(3) }, "Backup frequency must be at least 1 minute."), *sender.output[0]);
+
+			api.process_packet(BackupConfigurationMessage(RequestID(4), "backup_test", 60, -1));
+			verify_message(FailureResponse(RequestOrigin{ PacketType::BACKUP_CONFIGURATION, RequestID(4) }, "Number of backups to keep cannot be negative."), *sender.output[1]);
+		}
+	}
+
+	SECTION("Configuration Is Loaded")
+	{
+		TestPacketSender sender;
+		DatabaseImpl db("backup_test.db3", sender);
+
+		API api(clock, curl, db, sender);
+
+		const auto configuration = api.m_backup.configuration();
+
+		CHECK(configuration.location == "backup_test");
+		CHECK(configuration.frequency == std::chrono::minutes(60));
+		CHECK(configuration.keep == 2);
+
+		api.process_packet(BasicMessage(PacketType::REQUEST_CONFIGURATION));
+
+		const auto backupMessage = std::ranges::find_if(sender.output, [](auto&& message) { return message->packetType() == PacketType::BACKUP_CONFIGURATION; });
+
+		REQUIRE(backupMessage != sender.output.end());
+		verify_message(BackupConfigurationMessage(RequestID(0), "backup_test", 60, 2), **backupMessage);
+	}
+
+	std::filesystem::remove("backup_test.db3");
+	std::filesystem::remove_all("backup_test");
+}
@@ -59,6 +59,9 @@ struct nullDatabase : Database
 {
 	void load(Bugzilla& bugzilla, MicroTask& app, API& api) override {}
 
+	std::vector<TaskTimes> load_sessions(TaskID task, const TimeCategories& timeCategories) override { return {}; }
+	std::vector<TaskID> find_tasks_with_sessions(std::chrono::milliseconds start, std::chrono::milliseconds end) override { return {}; }
+
 	// write task
 	void write_task(const Task& task, PacketSender& sender) override {}
 	void write_next_task_id(TaskID nextID, PacketSender& sender) override {}
@@ -85,10 +88,21 @@ struct nullDatabase : Database
 	void remove_time_category(const TimeCategory& entry, PacketSender& sender) override {}
 	void remove_time_code(const TimeCategory& entry, const TimeCode& code, PacketSender& sender) override {}
 
+	void write_backup_configuration(const BackupConfiguration& configuration, PacketSender& sender) override {}
+
+	void archive_tasks(const std::vector<Task>& tasks, PacketSender& sender) override {}
+	std::vector<Task> load_archived_tasks(TaskID parent, const TimeCategories& timeCategories, PacketSender& sender) override { return {}; }
+
 	void start_transaction(PacketSender& sender) override {}
 	void finish_transaction(PacketSender& sender) override {}
 
 	bool transaction_in_progress() const override { return false; }
+
+	void flush(PacketSender& sender) override {}
+
+	void write_snapshot(MicroTask& app, const Bugzilla& bugzilla, PacketSender& sender) override {}
+
+	std::optional<std::string> backup(const std::filesystem::path& file) override { return std::nullopt; }
 };
 
 struct TestPacketSender : PacketSender
@@ -157,6 +171,24 @@ struct TestHelper
 		}
 	}
 
+	void request_configuration(std::source_location location = std::source_location::current())
+	{
+		sender.output.clear();
+
+		api.process_packet(BasicMessage(PacketType::REQUEST_CONFIGURATION));
+
+		INFO("First message sent should be the sync position");
+
+		INFO("");
+		INFO(location.file_name() << ":" << location.line());
+
+		REQUIRE(!sender.output.empty());
+		REQUIRE(sender.output[0]->packetType() == PacketType::SYNC_POSITION);
+
+		// remove the sync position, it holds a random epoch. calls to required_messages will check what comes after it
+		sender.output.erase(sender.output.begin());
+	}
+
 	void expect_failure(const RequestMessage& message, const std::string& error, std::source_location location = std::source_location::current())
 	{
 		sender.output.clear();
@@ -57,7 +57,31 @@ public enum PacketType {
     BULK_TASK_ADD_START(39),
     BULK_TASK_ADD_FINISH(40),
 
-    ERROR_MESSAGE(41);
+    ERROR_MESSAGE(41),
+
+    REQUEST_STATS(46),
+    STATS(47),
+
+    DATABASE_FLUSH(48),
+
+    REQUEST_ARCHIVED_TASKS(49),
+    ARCHIVED_TASK_INFO_START(50),
+    ARCHIVED_TASK_INFO_FINISH(51),
+
+    REQUEST_TASKS(52),
+    TASK_PAGE(53),
+    REQUEST_CONFIGURATION_WITHOUT_TASKS(54),
+    REQUEST_RESYNC(55),
+    SYNC_POSITION(56),
+    SUBSCRIBE_TASKS(57),
+    UNSUBSCRIBE_TASKS(58),
+    TASK_INFO_DELTA(59),
+    ENABLE_TASK_INFO_DELTA(60),
+    BULK_TASK_INFO(61),
+    REQUEST_PROTOCOL_VERSION(62),
+    PROTOCOL_VERSION(63),
+    CHUNK(64),
+    TASKS_ARCHIVED(65);
 
     private final int value;
 